@@ -1,4 +1,5 @@
 #include "BleConnection.h"
+#include <core/Trace.h>
 #include "esp_log_custom.h"
 
 static const char* TAG = "BleCon ";
@@ -161,6 +162,8 @@ void BleConnection::slice( void) {
             }
         break;
         case STATE_IDLE:
+            // Take the request before looking at the flags it stands for, or the wait below returns at once forever
+            takeEvents(BLE_EVENT_REQUEST);
             if( m_requestOff) {
                 m_pBleScan->stop();
                 changeState( STATE_OFF);
@@ -172,10 +175,15 @@ void BleConnection::slice( void) {
                 m_scanTimer.setInterval(m_scanStartInterval);
                 ESP_LOGI(TAG, "Start scan regular: m_scanStartInterval=%u", m_scanStartInterval);
                 changeState( STATE_START_SCAN);
+            } else if(m_scanStartInterval != 0) {
+                sliceWaitFor(BLE_EVENT_REQUEST, m_scanTimer.getRemaining());
+            } else {
+                sliceWaitFor(BLE_EVENT_REQUEST);
             }
         break;
         case STATE_START_SCAN:
             m_resultsReceived = false;
+            takeEvents(BLE_EVENT_SCAN_END);
             m_pBleScan->setInterval(m_scanIntervalMs);
             m_pBleScan->setWindow(m_scanWindowMs);
             m_pBleScan->setActiveScan(m_scanActively);
@@ -183,17 +191,22 @@ void BleConnection::slice( void) {
             changeState( STATE_SCANNING);
         break;
         case STATE_SCANNING:
+            takeEvents(BLE_EVENT_REQUEST);
             if( m_requestOff) {
                 // Should trigger scan complete
                 m_pBleScan->stop();
             } else if( m_resultsReceived) {
                 ESP_LOGI(TAG, "Scan complete: count=%u", m_results.getCount());
                 m_resultsReceived = false;
+                takeEvents(BLE_EVENT_SCAN_END);
                 for(uint8_t i=0; i < MAX_BLE_DEVICES; i++) {
                     if(m_parsers[i] == nullptr) continue;
                     m_parsers[i]->scanComplete();
                 }
                 changeState( STATE_IDLE);
+            } else {
+                // onScanEnd() runs on the NimBLE host task and notifies us
+                sliceWaitFor(BLE_EVENT_SCAN_END | BLE_EVENT_REQUEST);
             }
         break;
         case STATE_OFF:
@@ -208,6 +221,7 @@ void BleConnection::slice( void) {
 }
 
 void BleConnection::onResult(const NimBLEAdvertisedDevice* advertisedDevice) {
+    TRACE_SCOPE("BleConnection::onResult");
     NimBLEAddress address = advertisedDevice->getAddress();
     for(uint8_t i=0; i < MAX_BLE_DEVICES; i++) {
         if(!m_deviceParsers[i].enabled) continue;
@@ -273,6 +287,7 @@ void BleConnection::onResult(const NimBLEAdvertisedDevice* advertisedDevice) {
 void BleConnection::off() {
     if(m_state != STATE_OFF) {
         m_requestOff = true;
+        notify(BLE_EVENT_REQUEST);
     }
 }
 bool BleConnection::isOff() {
@@ -284,6 +299,7 @@ void BleConnection::onScanEnd(const NimBLEScanResults& results, int reason) {
     m_results = results;
     m_resultsReceived = true;
     m_pBleScan->stop();
+    notify(BLE_EVENT_SCAN_END);
 }
 
 bleDeviceData_t *BleConnection::deviceData(uint8_t index) {
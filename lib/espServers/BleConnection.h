@@ -17,6 +17,9 @@
 #define MAX_BLE_DEVICES     4
 #define BLE_ADDR_LEN        20
 
+#define BLE_EVENT_SCAN_END  0x0001
+#define BLE_EVENT_REQUEST   0x0002
+
 typedef enum {
   BLE_LOG_NONE,
   BLE_LOG_ADDRESSES,
@@ -71,6 +74,7 @@ public:
     BleConnection();
     virtual ~BleConnection() { }
     virtual const char* sliceName( void) { return "BleConnection"; }
+    virtual uint16_t getSliceState( void) { return (uint16_t) m_state; }
     virtual void slice( void);
 
     void setup(Preferences &pref);
@@ -83,10 +87,10 @@ public:
     void setScanWindow(uint16_t window) { m_scanWindowMs = window; }
     void setScanDuration(uint32_t duration) { m_scanDuration = duration; }
     void setScanActively(bool actively) { m_scanActively = actively; }
-    void setScanStartInterval(uint32_t interval) { m_scanStartInterval = interval; }
+    void setScanStartInterval(uint32_t interval) { m_scanStartInterval = interval; notify(BLE_EVENT_REQUEST); }
     void setScanStartBoot(uint32_t interval) { m_scanStartBoot = interval; }
 
-    void requestScan() { m_requestScan = true; }
+    void requestScan() { m_requestScan = true; notify(BLE_EVENT_REQUEST); }
     void off();
     bool isOff();
     bleDeviceData_t *deviceData(uint8_t index);
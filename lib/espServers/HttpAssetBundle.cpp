@@ -0,0 +1,139 @@
+#include "HttpAssetBundle.h"
+
+#if defined (ESP32)
+  #include <esp_partition.h>
+#endif
+
+#include <core/Dictionary.h>
+
+#include <stddef.h>
+#include <string.h>
+
+static const char* s_mimeTypes[][ 2] = {
+  { ".html", "text/html" },
+  { ".css",  "text/css" },
+  { ".js",   "text/javascript" },
+  { ".ico",  "image/x-icon" },
+  { ".gif",  "image/gif" },
+  { ".png",  "image/png" },
+  { ".jpg",  "image/jpeg" },
+  { ".jpeg", "image/jpeg" },
+  { ".jpe",  "image/jpeg" },
+};
+
+const char* httpMimeType( const char* path) {
+  const char* rc = NULL;
+  const char* suffix = strrchr( path, '.');
+  for( uint8_t i = 0; suffix != NULL && rc == NULL && i < sizeof( s_mimeTypes) / sizeof( s_mimeTypes[ 0]); i++) {
+    if( !strcmp( suffix, s_mimeTypes[ i][ 0])) {
+      rc = s_mimeTypes[ i][ 1];
+    }
+  }
+  return rc;
+}
+
+static bool inBundle( uint32_t offset, uint32_t size, uint32_t bundleSize) {
+  return offset <= bundleSize && size <= bundleSize - offset;
+}
+
+HttpAssetBundle::HttpAssetBundle( ) {
+  m_mapped = false;
+  m_mapHandle = 0;
+  unmap();
+}
+
+HttpAssetBundle::~HttpAssetBundle( ) {
+  unmap();
+}
+
+bool HttpAssetBundle::map( const void* p, uint32_t len) {
+  bool rc = false;
+  const HttpBundleHeader* h = (const HttpBundleHeader*) p;
+  m_base = NULL;
+  m_entries = NULL;
+  m_count = 0;
+  if( p != NULL && ((uintptr_t) p % HTTP_BUNDLE_ALIGN) == 0 && len >= sizeof( HttpBundleHeader) && h->magic == HTTP_BUNDLE_MAGIC
+      && h->version == HTTP_BUNDLE_VERSION && h->size <= len && h->size >= sizeof( HttpBundleHeader) + h->count * sizeof( HttpBundleEntry)) {
+    const uint8_t* base = (const uint8_t*) p;
+    const HttpBundleEntry* e = (const HttpBundleEntry*) &base[ sizeof( HttpBundleHeader)];
+    rc = bundleCrc( p, h->size) == h->crc;
+    for( uint16_t i = 0; rc && i < h->count; i++) {
+      rc = memchr( e[ i].path, '\0', sizeof( e[ i].path)) != NULL && e[ i].path[ 0] == '/'
+        && memchr( e[ i].type, '\0', sizeof( e[ i].type)) != NULL
+        && inBundle( e[ i].offset, e[ i].size, h->size) && inBundle( e[ i].gzipOffset, e[ i].gzipSize, h->size)
+        && ((e[ i].flags & HTTP_BUNDLE_GZIP) == 0 || e[ i].gzipSize > 0)
+        && (i == 0 || strcmp( e[ i - 1].path, e[ i].path) < 0);
+    }
+    if( rc) {
+      m_base = base;
+      m_entries = e;
+      m_count = h->count;
+    }
+  }
+  return rc;
+}
+
+bool HttpAssetBundle::mapPartition( ) {
+  bool rc = false;
+  unmap();
+#if defined (ESP32)
+  const esp_partition_t* part = esp_partition_find_first( ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, HTTP_BUNDLE_PARTITION);
+  const void* p;
+  esp_partition_mmap_handle_t handle;
+  if( part != NULL && esp_partition_mmap( part, 0, sizeof( HttpBundleHeader), ESP_PARTITION_MMAP_DATA, &p, &handle) == ESP_OK) {
+    // Map only as much of the partition as the bundle takes, the MMU pages are few
+    uint32_t size = ((const HttpBundleHeader*) p)->size;
+    bool magic = ((const HttpBundleHeader*) p)->magic == HTTP_BUNDLE_MAGIC;
+    esp_partition_munmap( handle);
+    if( magic && size <= part->size && esp_partition_mmap( part, 0, size, ESP_PARTITION_MMAP_DATA, &p, &handle) == ESP_OK) {
+      m_mapHandle = handle;
+      m_mapped = true;
+      rc = map( p, size);
+      if( !rc) {
+        unmap();
+      }
+    }
+  }
+#endif
+  return rc;
+}
+
+void HttpAssetBundle::unmap( ) {
+#if defined (ESP32)
+  if( m_mapped) {
+    esp_partition_munmap( (esp_partition_mmap_handle_t) m_mapHandle);
+  }
+#endif
+  m_mapped = false;
+  m_base = NULL;
+  m_entries = NULL;
+  m_count = 0;
+}
+
+uint32_t HttpAssetBundle::bundleCrc( const void* p, uint32_t size) {
+  const uint8_t* base = (const uint8_t*) p;
+  uint32_t crc = Dictionary::crc32( 0, base, offsetof( HttpBundleHeader, crc));
+  return Dictionary::crc32( crc, &base[ sizeof( HttpBundleHeader)], size - sizeof( HttpBundleHeader));
+}
+
+const HttpBundleEntry* HttpAssetBundle::find( const char* path) {
+  const HttpBundleEntry* rc = NULL;
+  uint16_t low = 0;
+  uint16_t high = m_count;
+  while( rc == NULL && low < high) {
+    uint16_t mid = (uint16_t) ((low + high) / 2);
+    int c = strcmp( path, m_entries[ mid].path);
+    if( c == 0) {
+      rc = &m_entries[ mid];
+    } else if( c < 0) {
+      high = mid;
+    } else {
+      low = (uint16_t) (mid + 1);
+    }
+  }
+  return rc;
+}
+
+const char* HttpAssetBundle::getData( const HttpBundleEntry* e, bool gzip) {
+  return (const char*) &m_base[ gzip ? e->gzipOffset : e->offset];
+}
@@ -0,0 +1,83 @@
+#ifndef HttpAssetBundle_h
+#define HttpAssetBundle_h
+
+#include <stdint.h>
+
+#define HTTP_BUNDLE_MAGIC     0x42575259 // "YRWB"
+#define HTTP_BUNDLE_VERSION   1
+#define HTTP_BUNDLE_ALIGN     4
+#define HTTP_BUNDLE_PATH      32
+#define HTTP_BUNDLE_TYPE      24
+#define HTTP_BUNDLE_GZIP      0x01
+#ifndef HTTP_BUNDLE_PARTITION
+#define HTTP_BUNDLE_PARTITION "assets" // label of the data partition holding the bundle
+#endif
+
+/** \brief The start of a bundle, little endian like everything after it.
+ */
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;   // entries following the header
+  uint32_t size;    // bytes of the whole bundle
+  uint32_t crc;     // CRC-32 of the bundle without this field
+} HttpBundleHeader;
+
+/** \brief One file of a bundle. Offsets are from the start of the bundle, gzip ones are 0 without a .gz.
+ */
+typedef struct {
+  char     path[ HTTP_BUNDLE_PATH];  // nul terminated, the entries are sorted by it
+  char     type[ HTTP_BUNDLE_TYPE];  // MIME type, nul terminated
+  uint32_t flags;
+  uint32_t offset;
+  uint32_t size;
+  uint32_t crc;                      // CRC-32 of the file, its ETag
+  uint32_t gzipOffset;
+  uint32_t gzipSize;
+  uint32_t gzipCrc;
+} HttpBundleEntry;
+
+/** \brief Returns the MIME type the server sends a file as, from its suffix, NULL for one it does not serve.
+ */
+const char* httpMimeType( const char* path);
+
+/** \brief A read-only bundle of web files, read in place.
+
+ tools/webAssets packs the web files of data/, each with its .gz, into one image: a header, the entries
+ sorted by path, then the files, each starting on a HTTP_BUNDLE_ALIGN boundary. On the board the image is
+ written to the HTTP_BUNDLE_PARTITION data partition, which mapPartition() maps into the address space,
+ so a file is sent straight from flash. map() checks the whole image once, after that find() is a binary
+ search over the entries and nothing is copied.
+ */
+class HttpAssetBundle {
+protected:
+  const uint8_t* m_base;
+  const HttpBundleEntry* m_entries;
+  uint16_t m_count;
+  uint32_t m_mapHandle;
+  bool m_mapped;
+
+public:
+  HttpAssetBundle( void);
+  ~HttpAssetBundle( void);
+  /** \brief Uses the bundle at p, at most len bytes, false and empty if it is not a valid one.
+   */
+  bool map( const void* p, uint32_t len);
+  /** \brief Maps the bundle of the HTTP_BUNDLE_PARTITION partition, false if there is none.
+   */
+  bool mapPartition( void);
+  /** \brief Empties the bundle, and unmaps the partition if it was mapped.
+   */
+  void unmap( void);
+  uint16_t getCount( void) { return m_count; }
+  const HttpBundleEntry* getEntry( uint16_t index) { return index < m_count ? &m_entries[ index] : 0; }
+  const HttpBundleEntry* find( const char* path);
+  /** \brief The bytes of an entry, of its .gz if gzip is set.
+   */
+  const char* getData( const HttpBundleEntry* e, bool gzip);
+  /** \brief The CRC a bundle of size bytes at p should have in its header.
+   */
+  static uint32_t bundleCrc( const void* p, uint32_t size);
+};
+
+#endif
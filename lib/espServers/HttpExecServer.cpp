@@ -1,47 +1,61 @@
 #include "HttpExecServer.h"
 #include "YRShellExec.h"
 
-void HttpExecServer::exec( const char *p) {
-  if( m_shell) {
-    m_shell->execString( p);
+HttpExecServer::HttpExecServer( ) {
+  m_shell = nullptr;
+  for( uint8_t i = 0; i < HTTP_SERVER_CONNECTIONS; i++) {
+    m_auxBufIndex[ i] = 0;
+    m_execHandle[ i] = -1;
   }
-  m_auxBufIndex = 0;
 }
 
-void HttpExecServer::startExec( ) {
+bool HttpExecServer::exec( const char *p) {
   if( m_shell) {
-    m_shell->startExec();
+    m_execHandle[ m_connIndex] = m_shell->execString( p);
   }
+  m_auxBufIndex[ m_connIndex] = 0;
+  return m_execHandle[ m_connIndex] >= 0;
 }
+
 void HttpExecServer::endExec( ) {
-  if( m_shell) {
-    m_shell->endExec();
+  int8_t handle = m_execHandle[ m_connIndex];
+  if( m_shell && handle >= 0) {
+    m_shell->endExec( handle);
   }
+  m_execHandle[ m_connIndex] = -1;
 }
 
 bool HttpExecServer::sendExecReply( void) {
   bool rc = true;
-  if( m_shell && m_shell->isAuxQueueInUse() && m_shell->isExec() ) {
-    rc = false;
-    CircularQBase<char>& q = m_shell->getAuxOutq();
-    while( q.valueAvailable()) {
-      char c = q.get();
-      if( c != '\r' && c != '\n' ) {
-        m_auxBuf[ m_auxBufIndex++] = c;
-      }
-      if( c == '\r' || c == '\n' ||  m_auxBufIndex > (sizeof(m_auxBuf) - 2 ) ) {
-        m_auxBuf[ m_auxBufIndex] = '\0';
-        bool flag = true;
-        for( const char* p = m_auxBuf; flag && *p != '\0'; p++) {
-          if( *p != ' ' && *p != '\r' && *p != '\n' && *p != '\t') {
-            flag = false;
-          }
+  int8_t handle = m_execHandle[ m_connIndex];
+  char* auxBuf = m_auxBuf[ m_connIndex];
+  uint8_t& auxBufIndex = m_auxBufIndex[ m_connIndex];
+  if( m_shell && handle >= 0) {
+    // Done once the output queued before it finished has been sent
+    rc = !m_shell->isExec( handle);
+    CircularQBase<char>& q = *m_shell->getExecOutq( handle);
+    char buf[32];
+    uint32_t len;
+    while( (len = q.getN( buf, sizeof(buf))) > 0) {
+      for( uint32_t i = 0; i < len; i++) {
+        char c = buf[i];
+        if( c != '\r' && c != '\n' ) {
+          auxBuf[ auxBufIndex++] = c;
         }
-        if( c == '\r' || c == '\n' ) {
-          m_auxBuf[ m_auxBufIndex++] = c;
+        if( c == '\r' || c == '\n' ||  auxBufIndex > (sizeof(m_auxBuf[ 0]) - 2 ) ) {
+          auxBuf[ auxBufIndex] = '\0';
+          bool flag = true;
+          for( const char* p = auxBuf; flag && *p != '\0'; p++) {
+            if( *p != ' ' && *p != '\r' && *p != '\n' && *p != '\t') {
+              flag = false;
+            }
+          }
+          if( c == '\r' || c == '\n' ) {
+            auxBuf[ auxBufIndex++] = c;
+          }
+          clientWrite( auxBuf, auxBufIndex);
+          auxBufIndex = 0;
         }
-        clientWrite( m_auxBuf, m_auxBufIndex);
-        m_auxBufIndex = 0;
       }
     }
   }
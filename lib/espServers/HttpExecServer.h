@@ -8,18 +8,17 @@ class YRShellExec;
 class HttpExecServer : public HttpServer {
 protected:
   YRShellExec* m_shell;
-  char m_auxBuf[ 128];
-  uint8_t m_auxBufIndex;
+  // Per connection slot, indexed by m_connIndex
+  char m_auxBuf[ HTTP_SERVER_CONNECTIONS][ 128];
+  uint8_t m_auxBufIndex[ HTTP_SERVER_CONNECTIONS];
+  int8_t m_execHandle[ HTTP_SERVER_CONNECTIONS];
 
-  bool m_lastPromptEnable, m_lastCommandEcho;
-
-  virtual void exec( const char *p);
-  virtual void startExec( void);
+  virtual bool exec( const char *p);
   virtual void endExec( void);
   virtual bool sendExecReply( void);
 
 public:
-  HttpExecServer( ) { m_shell = nullptr; }
+  HttpExecServer( );
   virtual ~HttpExecServer() {}
   virtual const char* sliceName( ) { return "HttpExecServer"; }
   void setYRShell( YRShellExec* s) { m_shell = s; }
@@ -0,0 +1,311 @@
+#include "HttpParser.h"
+
+#include <string.h>
+
+typedef enum {
+  PARSE_METHOD       = 0,
+  PARSE_URL          = 1,
+  PARSE_VERSION      = 2,
+  PARSE_HEADER_START = 3,
+  PARSE_HEADER_NAME  = 4,
+  PARSE_HEADER_VALUE = 5,
+  PARSE_BODY         = 6,
+  PARSE_DONE         = 7,
+  PARSE_ERROR        = 8,
+} httpParserStates_t;
+
+typedef enum {
+  HEADER_OTHER             = 0,
+  HEADER_CONTENT_LENGTH    = 1,
+  HEADER_CONNECTION        = 2,
+  HEADER_TRANSFER_ENCODING = 3,
+  HEADER_ACCEPT_ENCODING   = 4,
+  HEADER_IF_NONE_MATCH     = 5,
+} httpParserHeaders_t;
+
+void HttpParser::reset( char* url, uint16_t urlSize) {
+  m_url = url;
+  m_urlSize = urlSize;
+  m_urlLength = 0;
+  if( m_url != 0 && m_urlSize > 0) {
+    m_url[ 0] = '\0';
+  }
+  m_state = PARSE_METHOD;
+  m_method = HTTP_METHOD_OTHER;
+  m_minorVersion = 0;
+  m_keepAlive = false;
+  m_close = false;
+  m_hasContentLength = false;
+  m_error = 0;
+  m_headerBytes = 0;
+  m_contentLength = 0;
+  m_bodyLeft = 0;
+  m_tokenLength = 0;
+  m_header = HEADER_OTHER;
+  m_acceptGzip = false;
+  m_gzipMatch = 0;
+  m_ifNoneMatch[ 0] = '\0';
+  m_ifNoneMatchLength = 0;
+}
+
+bool HttpParser::isStarted( ) {
+  return m_state != PARSE_METHOD || m_tokenLength > 0;
+}
+
+bool HttpParser::isComplete( ) {
+  return m_state == PARSE_DONE;
+}
+
+bool HttpParser::isKeepAlive( ) {
+  return m_state == PARSE_DONE && !m_close && (m_minorVersion >= 1 || m_keepAlive);
+}
+
+const char* HttpParser::getIfNoneMatch( ) {
+  return m_ifNoneMatchLength < sizeof( m_ifNoneMatch) ? m_ifNoneMatch : "";
+}
+
+bool HttpParser::matchesEtag( const char* etag) {
+  bool rc = false;
+  const char* p = getIfNoneMatch();
+  size_t len = strlen( etag);
+  while( !rc && *p != '\0') {
+    while( *p == ' ' || *p == '\t' || *p == ',') {
+      p++;
+    }
+    const char* end = p;
+    while( *end != '\0' && *end != ',') {
+      end++;
+    }
+    const char* last = end;
+    while( last > p && (last[ -1] == ' ' || last[ -1] == '\t')) {
+      last--;
+    }
+    if( last - p == 1 && *p == '*') {
+      rc = true;
+    } else {
+      if( last - p > 2 && p[ 0] == 'W' && p[ 1] == '/') {
+        p += 2;
+      }
+      rc = len > 0 && (size_t) (last - p) == len && !strncmp( p, etag, len);
+    }
+    p = end;
+  }
+  return rc;
+}
+
+void HttpParser::setError( uint16_t code) {
+  m_error = code;
+  m_state = PARSE_ERROR;
+}
+
+void HttpParser::endRequestLine( ) {
+  if( m_tokenLength == 8 && !strncmp( m_token, "HTTP/1.", 7) && m_token[ 7] >= '0' && m_token[ 7] <= '9') {
+    m_minorVersion = m_token[ 7] - '0';
+    m_state = PARSE_HEADER_START;
+  } else if( m_tokenLength > 5 && !strncmp( m_token, "HTTP/", 5)) {
+    setError( 505);
+  } else {
+    setError( 400);
+  }
+}
+
+void HttpParser::endHeaderName( ) {
+  m_header = HEADER_OTHER;
+  if( m_tokenLength < sizeof( m_token)) {
+    m_token[ m_tokenLength] = '\0';
+    if( !strcmp( m_token, "content-length")) {
+      m_header = HEADER_CONTENT_LENGTH;
+    } else if( !strcmp( m_token, "connection")) {
+      m_header = HEADER_CONNECTION;
+    } else if( !strcmp( m_token, "transfer-encoding")) {
+      m_header = HEADER_TRANSFER_ENCODING;
+    } else if( !strcmp( m_token, "accept-encoding")) {
+      m_header = HEADER_ACCEPT_ENCODING;
+      m_gzipMatch = 0;
+    } else if( !strcmp( m_token, "if-none-match")) {
+      // A second If-None-Match adds to the list of the first
+      m_header = HEADER_IF_NONE_MATCH;
+      if( m_ifNoneMatchLength > 0) {
+        addIfNoneMatch( ',');
+      }
+    }
+  }
+  m_tokenLength = 0;
+}
+
+void HttpParser::addIfNoneMatch( char c) {
+  // Once full the length stays past the end, so a cut list is never matched
+  if( m_ifNoneMatchLength < sizeof( m_ifNoneMatch) - 1) {
+    m_ifNoneMatch[ m_ifNoneMatchLength++] = c;
+    m_ifNoneMatch[ m_ifNoneMatchLength] = '\0';
+  } else {
+    m_ifNoneMatchLength = sizeof( m_ifNoneMatch);
+  }
+}
+
+void HttpParser::endHeaderValue( ) {
+  // Connection values longer than the token are cut, a Content-Length that long is an error
+  bool overflow = m_tokenLength >= sizeof( m_token);
+  if( overflow) {
+    m_tokenLength = sizeof( m_token) - 1;
+  }
+  while( m_tokenLength > 0 && (m_token[ m_tokenLength - 1] == ' ' || m_token[ m_tokenLength - 1] == '\t')) {
+    m_tokenLength--;
+  }
+  m_token[ m_tokenLength] = '\0';
+  if( m_header == HEADER_CONTENT_LENGTH) {
+    uint32_t value = 0;
+    bool valid = !overflow && m_tokenLength > 0;
+    for( uint8_t i = 0; valid && i < m_tokenLength; i++) {
+      char c = m_token[ i];
+      if( c < '0' || c > '9' || value > (0xFFFFFFFF - 9) / 10) {
+        valid = false;
+      } else {
+        value = value * 10 + (c - '0');
+      }
+    }
+    // Two different lengths could frame the body two ways
+    if( !valid || (m_hasContentLength && value != m_contentLength)) {
+      setError( 400);
+    } else {
+      m_contentLength = value;
+      m_hasContentLength = true;
+    }
+  } else if( m_header == HEADER_CONNECTION) {
+    if( strstr( m_token, "close") != 0) {
+      m_close = true;
+    }
+    if( strstr( m_token, "keep-alive") != 0) {
+      m_keepAlive = true;
+    }
+  } else if( m_header == HEADER_TRANSFER_ENCODING) {
+    // A chunked request body can not be framed here
+    setError( 501);
+  }
+  m_tokenLength = 0;
+}
+
+uint16_t HttpParser::parse( const char* p, uint16_t len) {
+  uint16_t i = 0;
+  while( i < len && m_state != PARSE_DONE && m_state != PARSE_ERROR) {
+    if( m_state == PARSE_BODY) {
+      uint32_t n = len - i;
+      if( n > m_bodyLeft) {
+        n = m_bodyLeft;
+      }
+      i += (uint16_t) n;
+      m_bodyLeft -= n;
+      if( m_bodyLeft == 0) {
+        m_state = PARSE_DONE;
+      }
+    } else if( ++m_headerBytes > HTTP_PARSER_MAX_HEADER) {
+      setError( 431);
+    } else {
+      char c = p[ i++];
+      switch( m_state) {
+        case PARSE_METHOD:
+          if( c == ' ' && m_tokenLength > 0) {
+            m_token[ m_tokenLength] = '\0';
+            if( !strcmp( m_token, "GET")) {
+              m_method = HTTP_METHOD_GET;
+            } else if( !strcmp( m_token, "HEAD")) {
+              m_method = HTTP_METHOD_HEAD;
+            }
+            m_tokenLength = 0;
+            m_state = PARSE_URL;
+          } else if( (c == '\r' || c == '\n') && m_tokenLength == 0) {
+            // Empty lines before a request are allowed, a client may send one after a body
+            m_headerBytes = 0;
+          } else if( c < 'A' || c > 'Z') {
+            setError( 400);
+          } else if( m_tokenLength >= sizeof( m_token) - 1) {
+            setError( 501);
+          } else {
+            m_token[ m_tokenLength++] = c;
+          }
+        break;
+        case PARSE_URL:
+          if( c == ' ' && m_urlLength > 0) {
+            m_url[ m_urlLength] = '\0';
+            m_state = PARSE_VERSION;
+          } else if( c <= ' ' || c == 0x7F) {
+            setError( 400);
+          } else if( m_urlLength + 1 >= m_urlSize) {
+            setError( 414);
+          } else {
+            m_url[ m_urlLength++] = c;
+          }
+        break;
+        case PARSE_VERSION:
+          if( c == '\n') {
+            endRequestLine();
+          } else if( c != '\r') {
+            if( m_tokenLength >= sizeof( m_token) - 1) {
+              setError( 400);
+            } else {
+              m_token[ m_tokenLength++] = c;
+            }
+          }
+        break;
+        case PARSE_HEADER_START:
+          if( c == '\n') {
+            if( m_contentLength > 0) {
+              m_bodyLeft = m_contentLength;
+              m_state = PARSE_BODY;
+            } else {
+              m_state = PARSE_DONE;
+            }
+          } else if( c == ' ' || c == '\t' || c == ':') {
+            // A folded line or a header without a name
+            setError( 400);
+          } else if( c != '\r') {
+            m_token[ 0] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+            m_tokenLength = 1;
+            m_state = PARSE_HEADER_NAME;
+          }
+        break;
+        case PARSE_HEADER_NAME:
+          if( c == ':') {
+            endHeaderName();
+            m_state = PARSE_HEADER_VALUE;
+          } else if( c == '\r' || c == '\n' || c == ' ' || c == '\t') {
+            setError( 400);
+          } else if( m_tokenLength < sizeof( m_token) - 1) {
+            m_token[ m_tokenLength++] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+          } else {
+            // Too long for any header looked at
+            m_tokenLength = sizeof( m_token);
+          }
+        break;
+        case PARSE_HEADER_VALUE:
+          if( c == '\n') {
+            endHeaderValue();
+            if( m_state != PARSE_ERROR) {
+              m_state = PARSE_HEADER_START;
+            }
+          } else if( c == '\r' || m_header == HEADER_OTHER) {
+            // Not kept
+          } else if( m_header == HEADER_ACCEPT_ENCODING) {
+            char l = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+            m_gzipMatch = l == "gzip"[ m_gzipMatch] ? m_gzipMatch + 1 : (l == 'g' ? 1 : 0);
+            if( m_gzipMatch == 4) {
+              m_acceptGzip = true;
+              m_gzipMatch = 0;
+            }
+          } else if( m_header == HEADER_IF_NONE_MATCH) {
+            if( m_ifNoneMatchLength > 0 || (c != ' ' && c != '\t')) {
+              addIfNoneMatch( c);
+            }
+          } else if( m_tokenLength > 0 || (c != ' ' && c != '\t')) {
+            if( m_tokenLength < sizeof( m_token) - 1) {
+              m_token[ m_tokenLength++] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+            } else {
+              m_tokenLength = sizeof( m_token);
+            }
+          }
+        break;
+      }
+    }
+  }
+  return i;
+}
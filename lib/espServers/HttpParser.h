@@ -0,0 +1,86 @@
+#ifndef HttpParser_h
+#define HttpParser_h
+
+#include <stdint.h>
+
+#ifndef HTTP_PARSER_MAX_HEADER
+#define HTTP_PARSER_MAX_HEADER 4096 // bytes of request line and headers before 431
+#endif
+
+#ifndef HTTP_PARSER_IF_NONE_MATCH
+#define HTTP_PARSER_IF_NONE_MATCH 64 // bytes of If-None-Match kept, a longer list matches nothing
+#endif
+
+#define HTTP_METHOD_OTHER 0
+#define HTTP_METHOD_GET   1
+#define HTTP_METHOD_HEAD  2
+
+/** \brief Incremental HTTP/1.x request parser.
+
+ parse() takes the bytes of a connection as they arrive, in pieces of any size, and stops at the end of
+ a request, so the bytes of a pipelined request that follows are left to the caller for the next one.
+ The path of the request line goes to the buffer given to reset(). Of the headers only Content-Length,
+ Connection, Transfer-Encoding, Accept-Encoding and If-None-Match are looked at, and a Content-Length body
+ is read and dropped. Accept-Encoding is only searched for gzip, q values are not looked at.
+ Nothing is allocated. A malformed request stops the parser with the status code to answer with.
+ */
+class HttpParser {
+protected:
+  char* m_url;
+  uint16_t m_urlSize;
+  uint16_t m_urlLength;
+  uint8_t m_state;
+  uint8_t m_method;
+  uint8_t m_minorVersion;
+  bool m_keepAlive;
+  bool m_close;
+  bool m_hasContentLength;
+  uint16_t m_error;
+  uint16_t m_headerBytes;
+  uint32_t m_contentLength;
+  uint32_t m_bodyLeft;
+  char m_token[ 24];
+  uint8_t m_tokenLength;
+  uint8_t m_header;
+  bool m_acceptGzip;
+  uint8_t m_gzipMatch;
+  char m_ifNoneMatch[ HTTP_PARSER_IF_NONE_MATCH];
+  uint8_t m_ifNoneMatchLength;
+
+  void setError( uint16_t code);
+  void endRequestLine( void);
+  void endHeaderName( void);
+  void endHeaderValue( void);
+  void addIfNoneMatch( char c);
+
+public:
+  HttpParser( void) { reset( 0, 0); }
+  /** \brief Starts a new request, the path is stored in url, at most urlSize - 1 characters.
+   */
+  void reset( char* url, uint16_t urlSize);
+  /** \brief Parses up to len bytes and returns the number used, which is less than len once the request is complete.
+   */
+  uint16_t parse( const char* p, uint16_t len);
+  bool isStarted( void);
+  bool isComplete( void);
+  /** \brief The status code to answer a malformed request with, 0 if there is none.
+   */
+  uint16_t getError( void) { return m_error; }
+  uint8_t getMethod( void) { return m_method; }
+  uint32_t getContentLength( void) { return m_contentLength; }
+  /** \brief HTTP/1.1 without Connection: close, or HTTP/1.0 with Connection: keep-alive.
+   */
+  bool isKeepAlive( void);
+  /** \brief The x of HTTP/1.x, 0 for HTTP/1.0, which has no chunked encoding.
+   */
+  uint8_t getMinorVersion( void) { return m_minorVersion; }
+  bool acceptsGzip( void) { return m_acceptGzip; }
+  /** \brief The If-None-Match value as sent, empty if there was none or it did not fit.
+   */
+  const char* getIfNoneMatch( void);
+  /** \brief True if If-None-Match lists etag, quotes included, or is *. W/ is ignored, as for a GET.
+   */
+  bool matchesEtag( const char* etag);
+};
+
+#endif
@@ -2,6 +2,7 @@
 
 #if defined (ESP32)
   #include <Wifi.h>
+  #include <lwip/sockets.h>
   #define WIFI_MODE_UNAVAILABLE (WIFI_MODE_NULL)
 #else
   #warning "WiFi is not supported on the selected target"
@@ -9,10 +10,15 @@
 #include <NetworkServer.h>
 #include <NetworkClient.h>
 
+#include <core/Dictionary.h>
+#include <core/Trace.h>
+
+#include <stdio.h>
+#include <string.h>
+
 #include "esp_log_custom.h"
 
 typedef enum {
-  STATE_STARTUP          = 30,
   STATE_RESET            = 0,
   STATE_IDLE            = 1,
   STATE_CONNECTING      = 20,
@@ -26,11 +32,38 @@ typedef enum {
   STATE_FINISH_EXEC     = 8,
   STATE_PROCESS_CMD     = 9,
   STATE_FINISH_CMD      = 10,
+  STATE_SEND_STATS      = 11,
+  STATE_SEND_TRACE      = 12,
+  STATE_SEND_MEMORY     = 13,
 
 } httpServerStates_t;
 
+typedef enum {
+  BODY_RAW     = 0,
+  BODY_CHUNKED = 1,
+  BODY_NONE    = 2,
+} httpBodyModes_t;
+
 static const char* TAG = "HttpS  ";
 
+static const char* statusText( uint16_t code) {
+  const char* rc;
+  switch( code) {
+    case 200: rc = "OK"; break;
+    case 304: rc = "Not Modified"; break;
+    case 400: rc = "Bad Request"; break;
+    case 404: rc = "Not Found"; break;
+    case 405: rc = "Method Not Allowed"; break;
+    case 414: rc = "URI Too Long"; break;
+    case 431: rc = "Request Header Fields Too Large"; break;
+    case 501: rc = "Not Implemented"; break;
+    case 503: rc = "Service Unavailable"; break;
+    case 505: rc = "HTTP Version Not Supported"; break;
+    default: rc = "Error"; break;
+  }
+  return rc;
+}
+
 static char charToHex( char c) {
     char value = '\0';
     if(  c >= '0' && c <= '9' ) {
@@ -45,11 +78,28 @@ static char charToHex( char c) {
 
 HttpServer::HttpServer( void) {
   m_server = NULL;
-  m_client = NULL;
-
   m_port = 0;
-  m_state = STATE_STARTUP;
-  m_urlIndex = 0;
+  m_conn = &m_connections[ 0];
+  m_connIndex = 0;
+  m_nextConnection = 0;
+  m_acceptTried = false;
+  m_assetCount = 0;
+  m_assetsLoaded = false;
+  for( uint8_t i = 0; i < HTTP_SERVER_CONNECTIONS; i++) {
+    m_connections[ i].m_state = STATE_RESET;
+    m_connections[ i].m_responseCode = 0;
+    m_connections[ i].m_statsIndex = 0;
+    m_connections[ i].m_fileOffset = 0;
+    m_connections[ i].m_sendData = NULL;
+    m_connections[ i].m_sendSize = 0;
+    m_connections[ i].m_inStart = 0;
+    m_connections[ i].m_inEnd = 0;
+    m_connections[ i].m_requests = 0;
+    m_connections[ i].m_idleSince = 0;
+    m_connections[ i].m_keepAlive = false;
+    m_connections[ i].m_closeNext = false;
+    m_connections[ i].m_bodyMode = BODY_RAW;
+  }
 }
 
 HttpServer::~HttpServer( void) {
@@ -57,51 +107,90 @@ HttpServer::~HttpServer( void) {
     delete m_server;
     m_server = NULL;
   }
-  if( m_client != NULL) {
-    delete m_client;
-    m_client = NULL;
+  for( uint8_t i = 0; i < HTTP_SERVER_CONNECTIONS; i++) {
+    m_connections[ i].m_client.stop();
   }
-  m_state = STATE_STARTUP;
-  m_responseCode = 0;
-  m_urlIndex = 0;
 }
 
 void HttpServer::init(unsigned port) {
     m_port = port;
-    m_client = NULL;
-    m_state = STATE_STARTUP;
-    m_urlIndex = 0;
+    for( uint8_t i = 0; i < HTTP_SERVER_CONNECTIONS; i++) {
+      m_connections[ i].m_state = STATE_RESET;
+    }
 }
-unsigned HttpServer::readFile( char* P, unsigned len) {
-  uint32_t start = HW_getMicros();
-  unsigned rc =  m_sendFile.readBytes( m_buf, len);
-  unsigned et =  HW_getMicros() - start;
-  if( et > 900) {
-    ESP_LOGI(TAG, "Slow file read: rc %lu, len %lu, time %lu", rc, len , time);
+uint16_t HttpServer::getSliceState( ) {
+  uint16_t rc = 0;
+  for( uint8_t i = 0; i < HTTP_SERVER_CONNECTIONS; i++) {
+    if( m_connections[ i].m_state != STATE_RESET && m_connections[ i].m_state != STATE_IDLE) {
+      rc++;
+    }
   }
   return rc;
 }
+unsigned HttpServer::readFile( char* P, unsigned len) {
+  return m_conn->m_sendFile.readBytes( P, len);
+}
 int HttpServer::clientRead( char* P, unsigned len) {
-  uint32_t start = HW_getMicros();
-  int rc = m_client->read((uint8_t*) P, len);
-  unsigned et =  HW_getMicros() - start;
-  if( rc  && et > 900) {
-    ESP_LOGI(TAG, "Slow client read: rc %lu, len %lu, time %lu", rc, len , time);
-  }
-  return rc;
+  TRACE_SCOPE( "HttpServer::clientRead");
+  return m_conn->m_client.read((uint8_t*) P, len);
 }
 void HttpServer::clientWrite( const char* P){
   clientWrite( P, strlen(P));
 }
-void HttpServer::clientWrite( const char* P, unsigned len){
-  uint32_t start = HW_getMicros();
-  size_t numWritten = m_client->write( P, len);
+void HttpServer::clientSend( const char* P, unsigned len){
+  TRACE_SCOPE( "HttpServer::clientWrite");
+  size_t numWritten = m_conn->m_client.write( P, len);
   if(numWritten != len) {
     ESP_LOGI(TAG, "Not all written: len %lu, numWritten %lu", len , numWritten);
   }
-  unsigned et =  HW_getMicros() - start;
-  if(et > 900) {
-    ESP_LOGI(TAG, "Slow client write: len %lu, time %lu", len , time);
+}
+bool HttpServer::clientWritable( ) {
+  // lwIP reports a socket writable once a good part of its send buffer is free, or once it failed
+  bool rc = false;
+  int fd = m_conn->m_client.fd();
+  if( fd >= 0) {
+    fd_set set;
+    struct timeval tv = { 0, 0 };
+    FD_ZERO( &set);
+    FD_SET( fd, &set);
+    rc = lwip_select( fd + 1, NULL, &set, NULL, &tv) > 0;
+  }
+  return rc;
+}
+unsigned HttpServer::clientSendSpace( ) {
+  // lwIP keeps a socket writable only while more than TCP_SNDLOWAT bytes of its send buffer are free,
+  // lwip_getsockopt() has no SO_SNDBUF to ask for the exact figure
+  return clientWritable() ? TCP_SNDLOWAT : 0;
+}
+int HttpServer::clientSendSome( const char* P, unsigned len){
+  TRACE_SCOPE( "HttpServer::clientSendSome");
+  int rc = -1;
+  int fd = m_conn->m_client.fd();
+  if( fd >= 0) {
+    rc = lwip_send( fd, P, len, MSG_DONTWAIT);
+    if( rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      rc = 0;
+    }
+  }
+  return rc;
+}
+void HttpServer::clientWrite( const char* P, unsigned len){
+  if( m_conn->m_bodyMode == BODY_RAW) {
+    clientSend( P, len);
+  } else if( m_conn->m_bodyMode == BODY_CHUNKED && len > 0) {
+    // Small chunks go out in one write with their framing
+    char buf[ 8 + 256 + 2];
+    unsigned n = snprintf( buf, sizeof( buf), "%X\r\n", len);
+    if( n + len + 2 <= sizeof( buf)) {
+      memcpy( &buf[ n], P, len);
+      buf[ n + len] = '\r';
+      buf[ n + len + 1] = '\n';
+      clientSend( buf, n + len + 2);
+    } else {
+      clientSend( buf, n);
+      clientSend( P, len);
+      clientSend( "\r\n", 2);
+    }
   }
 }
 char HttpServer::hexToAscii( const char* h) {
@@ -110,117 +199,380 @@ char HttpServer::hexToAscii( const char* h) {
   rc += charToHex( *h);
   return rc;
 }
-void HttpServer::sendExec(  uint8_t offset ) {
+bool HttpServer::sendExec(  uint8_t offset ) {
+  char* url = m_conn->m_url;
   uint16_t i;
-  for( i = 0; i < (sizeof(m_url) - offset -1) && m_url[ offset + (i*2)] != '\0'; i++) {
-    m_url[ offset + i] = hexToAscii( &m_url[ offset + (i *2)]);
+  for( i = 0; i < (sizeof(m_conn->m_url) - offset -1) && url[ offset + (i*2)] != '\0'; i++) {
+    url[ offset + i] = hexToAscii( &url[ offset + (i *2)]);
   }
-  m_url[ offset + i] = '\0';
-  const char*p = &m_url[ offset];
+  url[ offset + i] = '\0';
+  const char*p = &url[ offset];
   startExec();
-  exec( p);
+  return exec( p);
 }
 
 void HttpServer::sendFile( const char* type) {
-  m_sendFile = LittleFS.open(m_url, "r");
-  if( !m_sendFile) {
-    send404();
-  } else if( m_client != NULL) {
-    clientWrite("HTTP/1.0 200 OK\r\nContent-type: ");
-    clientWrite(type);
-    clientWrite("\r\nCache-Control: max-age=3600\r\n\r\n");
-    m_responseCode = 200;
+  const HttpAsset* a = findAsset( m_conn->m_url);
+  bool gzip = a != NULL && a->m_gzipSize > 0 && m_conn->m_parser.acceptsGzip();
+  char extra[ 128];
+  if( a == NULL) {
+    strcpy( extra, "Cache-Control: max-age=3600\r\n");
+  } else {
+    assetHeaders( extra, sizeof( extra), gzip ? a->m_gzipCrc : a->m_crc, gzip, a->m_gzipSize > 0);
   }
-  changeState(STATE_SEND_FILE);
+  if( a == NULL || !sendNotModified( gzip ? a->m_gzipCrc : a->m_crc, extra)) {
+    if( gzip) {
+      char path[ HTTP_SERVER_ASSET_PATH + 3];
+      snprintf( path, sizeof( path), "%s.gz", a->m_path);
+      m_conn->m_sendFile = LittleFS.open( path, "r");
+    } else {
+      m_conn->m_sendFile = LittleFS.open(m_conn->m_url, "r");
+    }
+    if( !m_conn->m_sendFile) {
+      send404();
+    } else {
+      sendHeader( 200, type, extra, (int32_t) m_conn->m_sendFile.size());
+      m_conn->m_fileOffset = 0;
+      if( m_conn->m_bodyMode == BODY_NONE) {
+        m_conn->m_sendFile.close();
+        endResponse();
+      } else {
+        changeState(STATE_SEND_FILE);
+      }
+    }
+  }
+}
+
+void HttpServer::sendBundle( const HttpBundleEntry* e) {
+  bool hasGzip = (e->flags & HTTP_BUNDLE_GZIP) != 0;
+  bool gzip = hasGzip && m_conn->m_parser.acceptsGzip();
+  uint32_t crc = gzip ? e->gzipCrc : e->crc;
+  char extra[ 128];
+  assetHeaders( extra, sizeof( extra), crc, gzip, hasGzip);
+  if( !sendNotModified( crc, extra)) {
+    uint32_t size = gzip ? e->gzipSize : e->size;
+    sendHeader( 200, e->type, extra, (int32_t) size);
+    if( m_conn->m_bodyMode == BODY_NONE || size == 0) {
+      endResponse();
+    } else {
+      m_conn->m_sendData = m_bundle.getData( e, gzip);
+      m_conn->m_sendSize = size;
+      m_conn->m_fileOffset = 0;
+      changeState( STATE_SEND_MEMORY);
+    }
+  }
+}
+
+void HttpServer::assetHeaders( char* extra, unsigned size, uint32_t crc, bool gzip, bool vary) {
+  // Each encoding is a different representation, with the CRC of its own bytes as the tag
+  snprintf( extra, size, "%sETag: \"%08lx\"\r\n%sCache-Control: max-age=3600\r\n", gzip ? "Content-Encoding: gzip\r\n" : "",
+    (unsigned long) crc, vary ? "Vary: Accept-Encoding\r\n" : "");
+}
+
+bool HttpServer::sendNotModified( uint32_t crc, const char* extra) {
+  char etag[ 12];
+  snprintf( etag, sizeof( etag), "\"%08lx\"", (unsigned long) crc);
+  bool rc = m_conn->m_parser.matchesEtag( etag);
+  if( rc) {
+    sendHeader( 304, NULL, extra, -1);
+    endResponse();
+  }
+  return rc;
+}
+
+void HttpServer::loadAssets( ) {
+  m_assetsLoaded = true;
+  m_assetCount = 0;
+  if( m_bundle.mapPartition()) {
+    ESP_LOGI(TAG, "%u files in the asset bundle", m_bundle.getCount());
+  }
+  File f = LittleFS.open( HTTP_SERVER_ASSET_MANIFEST, "r");
+  if( f) {
+    char line[ HTTP_SERVER_ASSET_PATH + 48];
+    uint8_t len = 0;
+    size_t n;
+    // m_buf is only used within a slice
+    while( (n = f.readBytes( m_buf, sizeof( m_buf))) > 0) {
+      for( size_t i = 0; i < n; i++) {
+        if( m_buf[ i] == '\n') {
+          line[ len] = '\0';
+          addAsset( line);
+          len = 0;
+        } else if( len < sizeof( line) - 1) {
+          line[ len++] = m_buf[ i];
+        }
+      }
+    }
+    if( len > 0) {
+      line[ len] = '\0';
+      addAsset( line);
+    }
+    f.close();
+  }
+  // A file with the size the manifest lists may still have been edited, its ETag would then be stale
+  uint8_t count = 0;
+  for( uint8_t i = 0; i < m_assetCount; i++) {
+    HttpAsset* a = &m_assets[ i];
+    char path[ HTTP_SERVER_ASSET_PATH + 3];
+    snprintf( path, sizeof( path), "%s.gz", a->m_path);
+    if( a->m_gzipSize > 0 && !assetMatches( path, a->m_gzipSize, a->m_gzipCrc)) {
+      a->m_gzipSize = 0;
+    }
+    if( assetMatches( a->m_path, a->m_size, a->m_crc)) {
+      m_assets[ count++] = *a;
+    } else {
+      ESP_LOGW(TAG, "%s changed since %s was written", a->m_path, HTTP_SERVER_ASSET_MANIFEST);
+    }
+  }
+  m_assetCount = count;
+  ESP_LOGI(TAG, "%u assets with an ETag", m_assetCount);
+}
+
+void HttpServer::addAsset( char* line) {
+  // path size crc gzipSize gzipCrc
+  char* end = strchr( line, ' ');
+  if( end != NULL && end - line < HTTP_SERVER_ASSET_PATH && m_assetCount < HTTP_SERVER_ASSETS) {
+    unsigned long size, crc, gzipSize, gzipCrc;
+    *end = '\0';
+    if( sscanf( end + 1, "%lu %lx %lu %lx", &size, &crc, &gzipSize, &gzipCrc) == 4) {
+      HttpAsset* a = &m_assets[ m_assetCount];
+      strcpy( a->m_path, line);
+      a->m_size = size;
+      a->m_crc = crc;
+      a->m_gzipSize = gzipSize;
+      a->m_gzipCrc = gzipCrc;
+      m_assetCount++;
+    }
+  }
+}
+
+bool HttpServer::assetMatches( const char* path, uint32_t size, uint32_t crc) {
+  File f = LittleFS.open( path, "r");
+  bool rc = f && f.size() == size;
+  if( rc) {
+    uint32_t c = 0;
+    size_t n;
+    while( (n = f.readBytes( m_buf, sizeof( m_buf))) > 0) {
+      c = Dictionary::crc32( c, m_buf, n);
+    }
+    rc = c == crc;
+  }
+  f.close();
+  return rc;
+}
+
+const HttpAsset* HttpServer::findAsset( const char* path) {
+  const HttpAsset* rc = NULL;
+  for( uint8_t i = 0; rc == NULL && i < m_assetCount; i++) {
+    if( !strcmp( path, m_assets[ i].m_path)) {
+      rc = &m_assets[ i];
+    }
+  }
+  return rc;
+}
+
+void HttpServer::sendStats( ) {
+  sendHeader( 200, "application/json", "Access-Control-Allow-Origin: *\r\nCache-Control: no-cache\r\n", -1);
+  clientWrite( "[");
+  m_conn->m_statsIndex = 0;
+  changeState( STATE_SEND_STATS);
+}
+
+void HttpServer::sendTrace( ) {
+#ifdef YRSHELL_TRACE
+  sendHeader( 200, "application/json", "Access-Control-Allow-Origin: *\r\nCache-Control: no-cache\r\n", -1);
+  clientWrite( "{\"traceEvents\":[");
+  m_conn->m_traceCursor = Trace::first();
+  m_conn->m_traceEnd = Trace::last();
+  m_conn->m_traceFirstEvent = true;
+  changeState( STATE_SEND_TRACE);
+#else
+  send404();
+#endif
 }
 
 void HttpServer::send404(  ) {
-  if( m_client != NULL) {
-    m_responseCode = 404;
-    clientWrite("HTTP/1.1 404 Not Found\r\nContent-Type: text/html\r\nCache-Control: no-cache\r\n\r\n<!DOCTYPE HTML>\r\n<html><head><title>404 Error</title></head><body><h1>404 Error</h1></body></html>");
+  sendError( 404);
+}
+
+void HttpServer::sendBusy( ) {
+  // Every shell session is running a command, the client should try again rather than take an empty reply
+  sendError( 503, "Retry-After: 1\r\nAccess-Control-Allow-Origin: *\r\n");
+}
+
+void HttpServer::sendError( uint16_t code, const char* extra) {
+  char body[ 128];
+  char headers[ 128];
+  int len = snprintf( body, sizeof( body), "<!DOCTYPE HTML>\r\n<html><head><title>%u Error</title></head><body><h1>%u Error</h1></body></html>",
+    (unsigned) code, (unsigned) code);
+  snprintf( headers, sizeof( headers), "Cache-Control: no-cache\r\n%s", extra);
+  sendHeader( code, "text/html", headers, len);
+  clientWrite( body, len);
+  endResponse();
+}
+
+void HttpServer::sendHeader( uint16_t code, const char* type, const char* extra, int32_t length) {
+  char buf[ 256];
+  if( length < 0 && code != 304 && m_conn->m_parser.getMinorVersion() < 1) {
+    // An HTTP/1.0 client knows no chunks, only the close ends a body of unknown length
+    m_conn->m_keepAlive = false;
+  }
+  int len = snprintf( buf, sizeof( buf), "HTTP/1.1 %u %s\r\n", (unsigned) code, statusText( code));
+  if( type != NULL) {
+    len += snprintf( &buf[ len], sizeof( buf) - len, "Content-Type: %s\r\n", type);
+  }
+  len += snprintf( &buf[ len], sizeof( buf) - len, "%s", extra);
+  if( length >= 0) {
+    len += snprintf( &buf[ len], sizeof( buf) - len, "Content-Length: %ld\r\n", (long) length);
+  } else if( m_conn->m_keepAlive && code != 304) {
+    len += snprintf( &buf[ len], sizeof( buf) - len, "Transfer-Encoding: chunked\r\n");
   }
-  changeState( STATE_DISCONNECTING);
+  len += snprintf( &buf[ len], sizeof( buf) - len, "Connection: %s\r\n\r\n", m_conn->m_keepAlive ? "keep-alive" : "close");
+  m_conn->m_responseCode = code;
+  m_conn->m_bodyMode = BODY_RAW;
+  clientSend( buf, len);
+  if( m_conn->m_parser.getMethod() == HTTP_METHOD_HEAD || code == 304) {
+    m_conn->m_bodyMode = BODY_NONE;
+  } else if( length < 0 && m_conn->m_keepAlive) {
+    m_conn->m_bodyMode = BODY_CHUNKED;
+  }
+}
+
+void HttpServer::endResponse( ) {
+  if( m_conn->m_bodyMode == BODY_CHUNKED) {
+    clientSend( "0\r\n\r\n", 5);
+  }
+  m_conn->m_bodyMode = BODY_RAW;
+  if( m_conn->m_keepAlive) {
+    logRequest();
+    m_conn->m_requests++;
+    m_conn->m_idleSince = HW_getMillis();
+    m_conn->m_responseCode = 0;
+    m_conn->m_parser.reset( m_conn->m_url, sizeof( m_conn->m_url));
+    m_conn->m_timer.setInterval( HTTP_SERVER_KEEP_ALIVE_MS);
+    changeState( STATE_CONNECTED);
+  } else {
+    changeState( STATE_DISCONNECTING);
+  }
+}
+
+void HttpServer::logRequest( ) {
+  uint32_t et = HW_getMicros() - m_conn->m_requestStart;
+  et = (et + 500)/1000;
+  ESP_LOGD(TAG, "Request took %lu ms to process, ret %lu, url %s", et, m_conn->m_responseCode, m_conn->m_url);
 }
 
 void HttpServer::changeState( uint8_t newState) {
-  ESP_LOGD(TAG, "Change state from %u to %u", m_state, newState);
-  m_state = newState;
+  ESP_LOGD(TAG, "Change state of %u from %u to %u", m_connIndex, m_conn->m_state, newState);
+  m_conn->m_state = newState;
 }
 
 void HttpServer::slice() {
-  uint32_t start = HW_getMicros();
-  uint8_t startState = m_state;
-  switch( m_state) {
-    case STATE_STARTUP:
-      // BAM - 20260107 - Need to wait for WiFi to be initialized before creating a server or client
-      if(WiFi.getMode() != WIFI_MODE_UNAVAILABLE) {
-        m_server = new WiFiServer(m_port);
-        m_server->begin();
-        changeState( STATE_RESET);
+  if( m_server == NULL) {
+    // BAM - 20260107 - Need to wait for WiFi to be initialized before creating a server or client
+    if(WiFi.getMode() != WIFI_MODE_UNAVAILABLE) {
+      m_server = new WiFiServer(m_port);
+      m_server->begin();
+    }
+  } else {
+    m_acceptTried = false;
+    for( uint8_t i = 0; i < HTTP_SERVER_CONNECTIONS; i++) {
+      m_connIndex = (uint8_t) ((m_nextConnection + i) % HTTP_SERVER_CONNECTIONS);
+      m_conn = &m_connections[ m_connIndex];
+      sliceConnection();
+    }
+    m_nextConnection = (uint8_t) ((m_nextConnection + 1) % HTTP_SERVER_CONNECTIONS);
+    if( !m_acceptTried && m_server->hasClient()) {
+      // No slot was idle, make room by closing a kept alive connection between requests
+      HttpConnection* busiest = NULL;
+      bool closing = false;
+      for( uint8_t i = 0; !closing && i < HTTP_SERVER_CONNECTIONS; i++) {
+        HttpConnection* c = &m_connections[ i];
+        if( c->m_state == STATE_CONNECTED && c->m_requests > 0 && !c->m_parser.isStarted() && c->m_inStart == c->m_inEnd && c->m_client.available() == 0
+            && HW_getMillis() - c->m_idleSince >= HTTP_SERVER_KEEP_ALIVE_MIN_MS) {
+          m_connIndex = i;
+          m_conn = c;
+          changeState( STATE_DISCONNECTING);
+          closing = true;
+        } else if( c->m_closeNext) {
+          // One slot freed at a time, the next waiting connection asks again once it is taken
+          closing = true;
+        } else if( c->m_state != STATE_RESET && c->m_state != STATE_IDLE && c->m_state != STATE_DISCONNECTING
+            && c->m_state != STATE_LOG_DISCONNECT && c->m_state != STATE_DISCONNECT_WAIT) {
+          if( busiest == NULL || c->m_requests > busiest->m_requests) {
+            busiest = c;
+          }
+        }
       }
-    break;
+      if( !closing && busiest != NULL) {
+        // A client sending back to back is never idle long enough, close it after its next response
+        busiest->m_closeNext = true;
+      }
+    }
+  }
+}
+
+void HttpServer::sliceConnection() {
+  unsigned space;
+  switch( m_conn->m_state) {
     case STATE_RESET:
-      m_client = new WiFiClient;
       changeState( STATE_IDLE);
-      m_responseCode = 0;
-      m_urlIndex = 0;
-      m_url[ 0] = '\0';
+      m_conn->m_responseCode = 0;
+      m_conn->m_url[ 0] = '\0';
     break;
     case STATE_IDLE:
-      *m_client = m_server->accept();
-      if( *m_client) {
-        m_timer.setInterval( 100);
-        ESP_LOGD(TAG, "Connected");
-        changeState( STATE_CONNECTING);
+      // One accept per slice, the other idle slots wait for the next one
+      if( !m_acceptTried) {
+        m_acceptTried = true;
+        m_conn->m_client = m_server->accept();
+        if( m_conn->m_client) {
+          m_conn->m_timer.setInterval( 100);
+          ESP_LOGD(TAG, "Connected %u", m_connIndex);
+          changeState( STATE_CONNECTING);
+        }
       }
     break;
     case STATE_PROCESS_REQUEST:
     {
-      m_timer.setInterval( 20000);
-      ESP_LOGD(TAG, "Request url: %s", m_url);
+      m_conn->m_timer.setInterval( 20000);
+      m_conn->m_keepAlive = m_conn->m_parser.isKeepAlive() && m_conn->m_requests + 1 < HTTP_SERVER_KEEP_ALIVE_REQUESTS && !m_conn->m_closeNext;
+      ESP_LOGD(TAG, "Request url: %s", m_conn->m_url);
 
-      if( strncmp( m_url, "GET ", 4) && strncmp( m_url, "GET ", 4)) {
-        send404();
+      uint8_t method = m_conn->m_parser.getMethod();
+      if( method == HTTP_METHOD_OTHER || (method == HTTP_METHOD_HEAD && (!strncmp( m_conn->m_url, "/exec/", 6) || !strncmp( m_conn->m_url, "/cmd/", 5)))) {
+        sendError( 405);
       } else {
-        for( uint8_t i = 4; i < sizeof( m_url); i++) {
-          char c = m_url[i];
-          if( c == ' ' ) {
-            m_url[ i - 4] = '\0';
-            break;
+        if( m_conn->m_url[0] == '/' && m_conn->m_url[ 1] == '\0') {
+          strcpy( m_conn->m_url, "/index.html");
+        }
+        if( strlen( m_conn->m_url) <  4) {
+          send404();
+        } else if( !strncmp( m_conn->m_url, "/exec/", 6)) {
+          if( sendExec( 6)) {
+            changeState( STATE_PROCESS_EXEC);
           } else {
-            m_url[ i - 4] = c;
+            sendBusy();
           }
-        }
-        if( m_url[0] == '/' && m_url[ 1] == '\0') {
-          strcpy( m_url, "/index.html");
-        }
-        if( strlen( m_url) <  4) {
-          changeState( STATE_DISCONNECTING);
-        } else if( !strncmp( m_url, "/exec/", 6)) {
-          sendExec( 6);
-          changeState( STATE_PROCESS_EXEC);
-        } else if( !strncmp( m_url, "/cmd/", 5)) {
-          sendExec( 5);
-          changeState( STATE_PROCESS_CMD);
+        } else if( !strncmp( m_conn->m_url, "/cmd/", 5)) {
+          if( sendExec( 5)) {
+            changeState( STATE_PROCESS_CMD);
+          } else {
+            sendBusy();
+          }
+        } else if( !strcmp( m_conn->m_url, "/stats")) {
+          sendStats( );
+        } else if( !strcmp( m_conn->m_url, "/trace")) {
+          sendTrace( );
         } else {
-          const char* suffix = m_url + strlen( m_url);
-          while( suffix > m_url && *suffix != '.') {
-            suffix--;
+          if( !m_assetsLoaded) {
+            loadAssets();
           }
-          if(!strcmp( suffix, ".html")) {
-            sendFile( "text/html");
-          } else if( !strcmp( suffix, ".css")) {
-            sendFile( "text/css");
-          } else if( !strcmp( suffix, ".js")) {
-            sendFile( "text/javascript");
-          } else if( !strcmp( suffix, ".ico")) {
-            sendFile( "image/x-icon");
-          } else if( !strcmp( suffix, ".gif")) {
-            sendFile("image/gif");
-          } else if( !strcmp( suffix, ".png")) {
-            sendFile("image/png");
-          } else if( !strcmp( suffix, ".jpg") || !strcmp( suffix, ".jpeg") || !strcmp( suffix, ".jpe")) {
-            sendFile("image/jpeg");
+          const HttpBundleEntry* e = m_bundle.find( m_conn->m_url);
+          const char* type = httpMimeType( m_conn->m_url);
+          if( e != NULL) {
+            sendBundle( e);
+          } else if( type != NULL) {
+            sendFile( type);
           } else {
             send404();
           }
@@ -229,107 +581,175 @@ void HttpServer::slice() {
     }
     break;
     case STATE_DISCONNECTING:
-      if( m_client != NULL) {
-        delete m_client;
-        m_client = NULL;
-      }
-      ESP_LOGD(TAG, "Disconnect");
-      m_timer.setInterval( 1);
+      m_conn->m_client.stop();
+      ESP_LOGD(TAG, "Disconnect %u", m_connIndex);
+      m_conn->m_timer.setInterval( 1);
       changeState( STATE_LOG_DISCONNECT);
     break;
     case STATE_LOG_DISCONNECT:
-      {
-        uint32_t et = HW_getMicros() - m_requestStart;
-        et = (et + 500)/1000;
-        ESP_LOGD(TAG, "Request took %lu us to process, ret %lu, url %s", et, m_responseCode, m_url);
-      }
+      logRequest();
       changeState( STATE_DISCONNECT_WAIT);
     break;
     case STATE_DISCONNECT_WAIT:
       changeState( STATE_RESET);
     break;
     case STATE_SEND_FILE:
-      if( m_timer.hasIntervalElapsed()) {
-        m_sendFile.close();
-        changeState( STATE_DISCONNECTING);
-      } else {
-        //if( m_client != NULL && m_client->availableForWrite() >= (int) sizeof(m_buf)) {
-        if( m_client != NULL) {
-          size_t br = readFile( m_buf, sizeof(m_buf)); 
-          if( br > 0) {
-            clientWrite( m_buf, br);
-          } else {
-            m_sendFile.close();
-            changeState( STATE_DISCONNECTING);
+      if( m_conn->m_timer.hasIntervalElapsed()) {
+        // The body is short of its Content-Length, only closing tells the client
+        m_conn->m_sendFile.close();
+        m_conn->m_keepAlive = false;
+        endResponse();
+      } else if( m_conn->m_fileOffset >= m_conn->m_sendFile.size()) {
+        m_conn->m_sendFile.close();
+        endResponse();
+      } else if( (space = clientSendSpace()) > 0) {
+        // Read no more than the socket takes, so nothing read is thrown away and read again
+        uint32_t left = m_conn->m_sendFile.size() - m_conn->m_fileOffset;
+        unsigned n = left < sizeof( m_buf) ? left : sizeof( m_buf);
+        size_t br = readFile( m_buf, n < space ? n : space);
+        int bw = br > 0 ? clientSendSome( m_buf, br) : -1;
+        if( bw < 0) {
+          m_conn->m_sendFile.close();
+          m_conn->m_keepAlive = false;
+          endResponse();
+        } else {
+          m_conn->m_fileOffset += bw;
+          if( (size_t) bw < br) {
+            // Only if the socket took less than it said it would
+            ESP_LOGW(TAG, "Sent %d of %u bytes, reading again", bw, (unsigned) br);
+            m_conn->m_sendFile.seek( m_conn->m_fileOffset);
           }
         }
       }
     break;
+    case STATE_SEND_MEMORY:
+      if( m_conn->m_timer.hasIntervalElapsed()) {
+        m_conn->m_keepAlive = false;
+        endResponse();
+      } else if( m_conn->m_fileOffset >= m_conn->m_sendSize) {
+        endResponse();
+      } else if( clientWritable()) {
+        // Straight from the mapped flash into the socket
+        uint32_t left = m_conn->m_sendSize - m_conn->m_fileOffset;
+        int bw = clientSendSome( &m_conn->m_sendData[ m_conn->m_fileOffset], left < HTTP_SERVER_SEND_CHUNK ? left : HTTP_SERVER_SEND_CHUNK);
+        if( bw < 0) {
+          m_conn->m_keepAlive = false;
+          endResponse();
+        } else {
+          m_conn->m_fileOffset += bw;
+        }
+      }
+    break;
 
     case STATE_PROCESS_EXEC:
-      m_responseCode = 200;
-      clientWrite( "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nAccess-Control-Allow-Origin: *\r\nCache-Control: no-cache\r\n\r\n");
-      m_timer.setInterval( 10000);
+      sendHeader( 200, "application/json", "Access-Control-Allow-Origin: *\r\nCache-Control: no-cache\r\n", -1);
+      m_conn->m_timer.setInterval( 10000);
       changeState( STATE_FINISH_EXEC);
     break;
     case STATE_FINISH_EXEC:
-      if( sendExecReply() || m_timer.hasIntervalElapsed()) {
+      if( sendExecReply() || m_conn->m_timer.hasIntervalElapsed()) {
         endExec();
-        changeState( STATE_DISCONNECTING);
+        endResponse();
       }
     break;
     case STATE_PROCESS_CMD:
-      m_responseCode = 200;
-      clientWrite( "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nAccess-Control-Allow-Origin: *\r\nCache-Control: no-cache\r\n\r\n<!DOCTYPE HTML>\r\n<html><head><title>Cmd</title></head><body><pre>\r\n");
-      m_timer.setInterval( 10000);
+      sendHeader( 200, "text/html", "Access-Control-Allow-Origin: *\r\nCache-Control: no-cache\r\n", -1);
+      clientWrite( "<!DOCTYPE HTML>\r\n<html><head><title>Cmd</title></head><body><pre>\r\n");
+      m_conn->m_timer.setInterval( 10000);
       changeState( STATE_FINISH_CMD);
     break;
     case STATE_FINISH_CMD:
-      if( sendExecReply() || m_timer.hasIntervalElapsed()) {
+      if( sendExecReply() || m_conn->m_timer.hasIntervalElapsed()) {
         clientWrite( "\r\n</pre></body></html>");
         endExec();
-        changeState( STATE_DISCONNECTING);
+        endResponse();
       }
     break;
+    case STATE_SEND_STATS:
+      if( m_conn->m_timer.hasIntervalElapsed()) {
+        endResponse();
+      } else {
+        // One sliceable per slice keeps the time spent here bounded
+        Sliceable* s = Sliceable::getSlicePointer( m_conn->m_statsIndex);
+        if( s == NULL) {
+          clientWrite( "]\r\n");
+          endResponse();
+        } else {
+          char buf[ 768];
+          buf[ 0] = ',';
+          uint32_t len = s->statsJson( &buf[ 1], sizeof( buf) - 1);
+          if( len > 0) {
+            if( m_conn->m_statsIndex == 0) {
+              clientWrite( &buf[ 1], len);
+            } else {
+              clientWrite( buf, len + 1);
+            }
+          }
+          m_conn->m_statsIndex++;
+        }
+      }
+    break;
+#ifdef YRSHELL_TRACE
+    case STATE_SEND_TRACE:
+      if( m_conn->m_timer.hasIntervalElapsed()) {
+        endResponse();
+      } else if( m_conn->m_traceCursor == m_conn->m_traceEnd) {
+        clientWrite( "]}\r\n");
+        endResponse();
+      } else {
+        char buf[ 512];
+        uint32_t len = Trace::json( buf, sizeof( buf), m_conn->m_traceCursor, m_conn->m_traceEnd, m_conn->m_traceFirstEvent);
+        if( len > 0) {
+          clientWrite( buf, len);
+        }
+      }
+    break;
+#endif
 
     case STATE_CONNECTING:
-      m_requestStart = HW_getMicros();
+      m_conn->m_requestStart = HW_getMicros();
+      m_conn->m_inStart = 0;
+      m_conn->m_inEnd = 0;
+      m_conn->m_requests = 0;
+      m_conn->m_keepAlive = false;
+      m_conn->m_closeNext = false;
+      m_conn->m_bodyMode = BODY_RAW;
+      m_conn->m_parser.reset( m_conn->m_url, sizeof( m_conn->m_url));
       changeState( STATE_CONNECTED);
     break;
     case STATE_CONNECTED:
-      if( m_client == NULL) {
-        m_responseCode = 1;
-        changeState( STATE_DISCONNECTING);
-      } else if( m_timer.hasIntervalElapsed( )) {
-        m_responseCode = 2;
-        changeState( STATE_DISCONNECTING);
-      } else if( m_urlIndex >= (sizeof(m_url) - 1) ) {
-        m_responseCode = 3;
+      if( m_conn->m_timer.hasIntervalElapsed( )) {
+        if( m_conn->m_parser.isStarted()) {
+          m_conn->m_responseCode = 2;
+        }
         changeState( STATE_DISCONNECTING);
       } else {
-        int nb = clientRead( &m_url[ m_urlIndex], sizeof(m_url) - m_urlIndex -1);
-        if( nb > 0) {
-          m_urlIndex += nb;
-          m_url[ m_urlIndex ] = '\0';
-          bool flag = true;
-          for( uint16_t i = 0; flag && i < m_urlIndex; i++) {
-            if( m_url[ i] == '\r' || m_url[i] == '\n') {
-              m_url[ i] = '\0';
-              m_client->clear();
-              if( strlen( m_url) < 5 ) {
-                changeState( STATE_DISCONNECTING);
-              } else {
-                changeState( STATE_PROCESS_REQUEST);
-              }
-              flag = false;
-            }
+        if( m_conn->m_inStart == m_conn->m_inEnd) {
+          int nb = clientRead( m_conn->m_in, sizeof( m_conn->m_in));
+          m_conn->m_inStart = 0;
+          m_conn->m_inEnd = nb > 0 ? nb : 0;
+          if( nb > 0) {
+            // The request has to keep coming
+            m_conn->m_timer.setInterval( 100);
+          } else if( !m_conn->m_client.connected()) {
+            changeState( STATE_DISCONNECTING);
+          }
+        }
+        if( m_conn->m_inStart < m_conn->m_inEnd) {
+          bool started = m_conn->m_parser.isStarted();
+          m_conn->m_inStart += m_conn->m_parser.parse( &m_conn->m_in[ m_conn->m_inStart], m_conn->m_inEnd - m_conn->m_inStart);
+          if( !started && m_conn->m_parser.isStarted()) {
+            m_conn->m_requestStart = HW_getMicros();
+          }
+          if( m_conn->m_parser.isComplete()) {
+            changeState( STATE_PROCESS_REQUEST);
+          } else if( m_conn->m_parser.getError() != 0) {
+            // The rest of the stream can not be trusted to start a request
+            m_conn->m_keepAlive = false;
+            sendError( m_conn->m_parser.getError());
           }
         }
       }
     break;
   }
-  unsigned et =  HW_getMicros() - start;
-  if( et > 900) {
-    ESP_LOGD(TAG, "Slow slice, startState: %lu, state %lu, time %lu", startState, m_state, et);
-  }
 }
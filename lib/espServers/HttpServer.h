@@ -2,40 +2,178 @@
 #define HttpServer_h
 
 #include <LittleFS.h>
+#include <NetworkClient.h>
 
 #include <core/Sliceable.h>
 #include <core/IntervalTimer.h>
 
+#include "HttpParser.h"
+#include "HttpAssetBundle.h"
+
+#ifndef HTTP_SERVER_CONNECTIONS
+#define HTTP_SERVER_CONNECTIONS 4 // requests served at once, each slot holds a url buffer and an open file
+#endif
+#ifndef HTTP_SERVER_INPUT
+#define HTTP_SERVER_INPUT 256 // bytes read ahead per slot, a pipelined request waits here for the one before
+#endif
+#ifndef HTTP_SERVER_SEND_CHUNK
+#define HTTP_SERVER_SEND_CHUNK 1436 // bytes of a file read and sent at a time, one TCP segment
+#endif
+#ifndef HTTP_SERVER_ASSETS
+#define HTTP_SERVER_ASSETS 16 // files of /assets.txt given an ETag and sent gzipped
+#endif
+#define HTTP_SERVER_ASSET_PATH 32
+#define HTTP_SERVER_ASSET_MANIFEST "/assets.txt"
+#ifndef HTTP_SERVER_KEEP_ALIVE_MS
+#define HTTP_SERVER_KEEP_ALIVE_MS 5000 // an idle keep-alive connection is closed after this
+#endif
+#ifndef HTTP_SERVER_KEEP_ALIVE_MIN_MS
+#define HTTP_SERVER_KEEP_ALIVE_MIN_MS 50 // an idle keep-alive connection is closed at once for a new one after this
+#endif
+#ifndef HTTP_SERVER_KEEP_ALIVE_REQUESTS
+#define HTTP_SERVER_KEEP_ALIVE_REQUESTS 100 // requests on one connection before it is closed
+#endif
+
 class NetworkServer;
-class NetworkClient;
 
-class HttpServer : public Sliceable {
-protected:
-  int m_port;
+/** \brief A file listed in /assets.txt, with the size and CRC-32 of it and of its .gz, 0 without one.
+ */
+class HttpAsset {
+public:
+  char m_path[ HTTP_SERVER_ASSET_PATH];
+  uint32_t m_size;
+  uint32_t m_crc;
+  uint32_t m_gzipSize;
+  uint32_t m_gzipCrc;
+};
+
+/** \brief One client slot of an HttpServer, with the state of the request it is serving.
+ */
+class HttpConnection {
+public:
   uint8_t m_state;
   uint16_t m_responseCode;
   uint32_t m_requestStart;
   char m_url[ 512];
-  char m_buf[ 128];
-  uint8_t m_urlIndex;
-
+  uint16_t m_statsIndex;
+  uint32_t m_fileOffset;
+  const char* m_sendData;
+  uint32_t m_sendSize;
+  HttpParser m_parser;
+  char m_in[ HTTP_SERVER_INPUT];
+  uint16_t m_inStart;
+  uint16_t m_inEnd;
+  uint16_t m_requests;
+  uint32_t m_idleSince;
+  bool m_keepAlive;
+  bool m_closeNext;  // a new connection waits for this slot, the next response closes it
+  uint8_t m_bodyMode;
+#ifdef YRSHELL_TRACE
+  uint32_t m_traceCursor;
+  uint32_t m_traceEnd;
+  bool m_traceFirstEvent;
+#endif
   IntervalTimer m_timer;
   File m_sendFile;
+  NetworkClient m_client;
+};
+
+/** \brief A small HTTP/1.1 server with HTTP_SERVER_CONNECTIONS preallocated client slots.
+
+ Each slice accepts at most one connection into an idle slot and advances every busy slot by one step,
+ starting with a different slot each time. The request handlers and the exec hooks work on the slot being
+ served, m_conn, whose index is m_connIndex. The server allocates nothing per connection once the
+ listening socket is created, but on the board NetworkClient allocates a socket handle and receive buffer
+ for each connection accepted and LittleFS allocates for each file it opens.
+
+ Connections are kept alive unless the client asks otherwise, and requests sent before the previous
+ response is finished are answered in turn. A response of unknown length is sent chunked on a kept alive
+ connection. When a new connection waits and no slot is free, a kept alive connection idle for
+ HTTP_SERVER_KEEP_ALIVE_MIN_MS is closed, otherwise the busy one that has served the most requests answers
+ its next request with Connection: close, so clients sending back to back can not hold every slot.
+
+ Files are sent HTTP_SERVER_SEND_CHUNK bytes at a time, only when the socket can take them, so a slow
+ client holds up nothing but its own slot. No more of a file is read than the socket takes at once.
+
+ The web files are looked up first in the asset bundle of the HTTP_BUNDLE_PARTITION flash partition and
+ sent from where it is mapped, then on LittleFS. Those of the bundle and those listed in /assets.txt,
+ both written by tools/webAssets, are sent with their CRC as a strong ETag and from their .gz to a client
+ that accepts gzip. A request whose If-None-Match holds the ETag is answered 304 without reading the
+ file. The bundle and the list are loaded on the first request for a file. An entry of the list whose
+ size or CRC does not match the file is left out, so a file changed without running the tool again is
+ sent as is.
+ */
+class HttpServer : public Sliceable {
+protected:
+  int m_port;
+  char m_buf[ HTTP_SERVER_SEND_CHUNK];
+  HttpConnection m_connections[ HTTP_SERVER_CONNECTIONS];
+  HttpConnection* m_conn;
+  uint8_t m_connIndex;
+  uint8_t m_nextConnection;
+  bool m_acceptTried;
+
   NetworkServer* m_server;
-  NetworkClient* m_client;
+  HttpAssetBundle m_bundle;
+  HttpAsset m_assets[ HTTP_SERVER_ASSETS];
+  uint8_t m_assetCount;
+  bool m_assetsLoaded;
 
-  void sendExec( uint8_t offset);
+  /** \brief Decodes the command of the URL and starts it, false when no shell session is free.
+   */
+  bool sendExec( uint8_t offset);
   void sendFile( const char* type);
+  void sendBundle( const HttpBundleEntry* e);
+  void assetHeaders( char* extra, unsigned size, uint32_t crc, bool gzip, bool vary);
+  /** \brief Answers 304 and returns true if If-None-Match holds the ETag made from crc.
+   */
+  bool sendNotModified( uint32_t crc, const char* extra);
+  void loadAssets( void);
+  void addAsset( char* line);
+  /** \brief True if the file at path has size bytes and the CRC-32 crc.
+   */
+  bool assetMatches( const char* path, uint32_t size, uint32_t crc);
+  const HttpAsset* findAsset( const char* path);
 
   virtual void startExec( void) { }
   virtual void endExec( void) { }
   virtual bool sendExecReply( void) { return true; }
 
   unsigned readFile( char* P, unsigned len);
+  void sendStats( void);
+  void sendTrace( void);
   void send404( void );
+  /** \brief Answers 503 with Retry-After when every shell session is busy.
+   */
+  void sendBusy( void);
+  /** \brief Answers code with a short HTML body, extra holds further header lines.
+   */
+  void sendError( uint16_t code, const char* extra = "");
+  /** \brief Writes the status line and headers, length -1 when the length of the body is not known.
+
+   extra holds further header lines, each ending in CR LF, type may be NULL. Afterwards clientWrite() writes
+   the body, in chunks or not at all as the request needs. A 304 has no body. Without a length an HTTP/1.0
+   connection is closed after the body, even if it asked to be kept alive.
+   */
+  void sendHeader( uint16_t code, const char* type, const char* extra, int32_t length);
+  /** \brief Ends the body, then waits for the next request or closes the connection.
+   */
+  void endResponse( void);
+  void logRequest( void);
   void changeState( uint8_t newState);
-  virtual void exec( const char *p) {}
+  void sliceConnection( void);
+  /** \brief Starts the command p on a shell session, false when none is free.
+   */
+  virtual bool exec( const char *p) { return true; }
   int clientRead( char* P, unsigned len);
+  void clientSend( const char* P, unsigned len);
+  bool clientWritable( void);
+  /** \brief Bytes the send buffer of the socket takes now without waiting, 0 when it is not writable.
+   */
+  unsigned clientSendSpace( void);
+  /** \brief Writes what the send buffer of the socket takes without waiting, -1 once the connection is gone.
+   */
+  int clientSendSome( const char* P, unsigned len);
   void clientWrite( const char* P, unsigned len);
   void clientWrite( const char* P);
 
@@ -43,9 +181,12 @@ public:
   HttpServer(void);
   virtual ~HttpServer( );
   virtual const char* sliceName( ) { return "HttpServer"; }
+  /** \brief Returns the number of slots serving a request.
+   */
+  virtual uint16_t getSliceState( );
   virtual void init( unsigned port);
   virtual void slice( void);
   static char hexToAscii( const char* h);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -69,8 +69,6 @@ void TelnetServer::changeState( uint8_t newState) {
 
 void TelnetServer::slice() {
   if( m_timer.isNextInterval()) {
-    uint32_t start = HW_getMicros();
-    uint8_t startState = m_state;
     uint8_t data;
 
     if( m_lastConnected && m_client && !m_client->connected()) {
@@ -175,10 +173,5 @@ void TelnetServer::slice() {
         break;
       }
     }
-
-    unsigned et =  HW_getMicros() - start;
-    if( et > 900) {
-      ESP_LOGD(TAG, "Slow slice: startState=%u, m_state=%u, time=%lu", startState, m_state, et);
-    }
   }
 }
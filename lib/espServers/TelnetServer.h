@@ -27,18 +27,19 @@ public:
   TelnetServer(void);
   virtual ~TelnetServer();
   virtual const char* sliceName( ) { return "TelnetServer"; }
+  virtual uint16_t getSliceState( ) { return (uint16_t) m_state; }
   void init( unsigned port, CircularQBase<char> *in, CircularQBase<char>* out);
   void slice( void);
 };
 
-class CQ1 : public CircularQ<char, 32> {
+class CQ1 : public CircularQSpsc<char, 32> {
 public:
   CQ1() {}
   virtual ~CQ1() {}
   virtual const char* sliceName( void) { return "CQ1"; } 
   virtual void slice( void) { }
 };
-class CQ2 : public CircularQ<char, 1024> {
+class CQ2 : public CircularQSpsc<char, 1024> {
 public:
   CQ2() {}
   virtual ~CQ2() {}
@@ -58,8 +59,10 @@ public:
   virtual const char* sliceName( ) { return "TelnetLogServer"; }
   void init( unsigned port);
   void enable( bool enable) { m_enabled = enable; }
+  bool isEnabled( void) { return m_enabled; }
   void put( char c ) { if(m_enabled) { m_tq.put( c); } }
-  bool spaceAvailable( uint16_t n = 1) { return m_enabled ? m_toTelnetQ->spaceAvailable( n) : false; }
+  void putN( const char* p, uint32_t n ) { if(m_enabled) { m_tq.putN( p, n); } }
+  bool spaceAvailable( uint32_t n = 1) { return m_enabled ? m_toTelnetQ->spaceAvailable( n) : false; }
 };
 
 #endif
\ No newline at end of file
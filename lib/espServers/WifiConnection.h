@@ -52,6 +52,7 @@ public:
   WifiConnection( LedDriver* led, uint32_t connectTimeout = 5000); 
   virtual ~WifiConnection() { }
   virtual const char* sliceName( void) { return "WifiConnection"; }
+  virtual uint16_t getSliceState( void) { return (uint16_t) m_state; }
   virtual void slice( void);
   int getConnectedNetworkIndex( void);
   bool isNetworkConnected( void);
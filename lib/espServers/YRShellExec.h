@@ -3,14 +3,17 @@
 
 #include <YRShell.h>
 
+/** \brief Runs command lines for a server, each in its own execution context of the shell.
+
+ execString() returns a handle, or -1 when every context is busy. The output is read with getExecOutq()
+ until isExec() is false, then endExec() releases the handle.
+ */
 class YRShellExec {
 public:
-  virtual inline bool isAuxQueueInUse( void) = 0;
-  virtual CircularQBase<char>& getAuxOutq(void) = 0;
-  virtual void startExec( void) = 0;
-  virtual void endExec( void) = 0;
-  virtual void execString( const char* p) = 0;
-  virtual bool isExec( void) = 0;
+  virtual int8_t execString( const char* p) = 0;
+  virtual CircularQBase<char>* getExecOutq( int8_t handle) = 0;
+  virtual bool isExec( int8_t handle) = 0;
+  virtual void endExec( int8_t handle) = 0;
 };
 
-#endif
\ No newline at end of file
+#endif
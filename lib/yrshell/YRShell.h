@@ -18,9 +18,9 @@ class YRShellBase : public virtual YRShellInterpreter{
 protected:
     CurrentDictionary<DICTIONARY_SIZE> m_dictionaryCurrent;
     
-    CircularQ<char, INQ_SIZE>       m_inq;
+    CircularQSpsc<char, INQ_SIZE>   m_inq;
     CircularQ<char, AUX_INQ_SIZE>   m_auxInq;
-    CircularQ<char, OUTQ_SIZE>      m_outq;
+    CircularQSpsc<char, OUTQ_SIZE>  m_outq;
     CircularQ<char, AUX_OUTQ_SIZE>  m_auxOutq;
     
     char        m_pad[ PAD_SIZE];
@@ -65,6 +65,40 @@ public:
 };
 
 
+/** \brief Storage for a YRShellContext, see YRShellInterpreter::addContext().
+
+ The aux queues are the same as the main ones, INQ_SIZE and OUTQ_SIZE must be powers of 2. Starts with the
+ prompt and command echo off.
+ */
+template< unsigned PAD_SIZE, unsigned PARAMETER_STACK_SIZE, unsigned RETURN_STACK_SIZE, unsigned COMPILE_STACK_SIZE,
+    unsigned INQ_SIZE, unsigned OUTQ_SIZE >
+class YRShellSession : public YRShellContext {
+protected:
+    CircularQSpsc<char, INQ_SIZE>   m_inq;
+    CircularQSpsc<char, OUTQ_SIZE>  m_outq;
+
+    char        m_pad[ PAD_SIZE];
+    uint32_t    m_parameterStack[ PARAMETER_STACK_SIZE];
+    uint32_t    m_returnStack[ RETURN_STACK_SIZE];
+    uint32_t    m_compileStack[ COMPILE_STACK_SIZE];
+
+public:
+    YRShellSession( ) {
+        m_Inq = m_AuxInq = &m_inq;
+        m_Outq = m_AuxOutq = &m_outq;
+        m_Pad = m_pad;
+        m_Pad[ 0] = '\0';
+        m_padSize = sizeof( m_pad);
+        m_ParameterStack = m_parameterStack;
+        m_parameterStackSize = sizeof(m_parameterStack)/sizeof(m_parameterStack[0]);
+        m_ReturnStack = m_returnStack;
+        m_returnStackSize = sizeof(m_returnStack)/sizeof(m_returnStack[0]);
+        m_CompileStack = m_compileStack;
+        m_compileStackSize = sizeof(m_compileStack)/sizeof(m_compileStack[0]);
+    }
+    virtual ~YRShellSession( ) { }
+};
+
 /** \brief YRShell - interactive
  
  Details on whatYRShell is
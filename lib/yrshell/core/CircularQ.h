@@ -36,26 +36,93 @@ public:
     }
 
     virtual void reset(void) {};
-    virtual const uint16_t size(void) {return 0;};
-    virtual const uint16_t used(void) {return 0;};
-    virtual const uint16_t free(void) {return 0;};
-    virtual const bool valueAvailable(uint16_t n = 1) {return false;};
-    virtual const bool spaceAvailable(uint16_t n = 1) {return false;};
+    virtual const uint32_t size(void) {return 0;};
+    virtual const uint32_t used(void) {return 0;};
+    virtual const uint32_t free(void) {return 0;};
+    virtual const bool valueAvailable(uint32_t n = 1) {return false;};
+    virtual const bool spaceAvailable(uint32_t n = 1) {return false;};
     virtual TYPE get(void) {return TYPE(0);};
     virtual bool put(TYPE v) {return false;};
     virtual TYPE* getBuffer(void) {return 0;};
     virtual TYPE* getLinearReadBuffer(void) {return 0;};
-    virtual uint16_t getLinearReadBufferSize(void) {return 0;};
-    virtual void drop(uint16_t n) {};
+    virtual uint32_t getLinearReadBufferSize(void) {return 0;};
+    virtual void drop(uint32_t n) {};
+    /** \brief Drops the oldest n values, all of them by default, from the writer side.
+
+     The writer may call it while the reader runs. A queue shared between tasks leaves the dropping to the
+     reader, this one drops them at once.
+     */
+    virtual void discard(uint32_t n = 0xFFFFFFFF) { drop( n); };
     virtual TYPE* getLinearWriteBuffer(void) {return 0;};
-    virtual uint16_t getLinearWriteBufferSize(void) {return 0;};
-    virtual void append(uint16_t n) {};
-    virtual void setHead(uint16_t h) {};
+    virtual uint32_t getLinearWriteBufferSize(void) {return 0;};
+    virtual void append(uint32_t n) {};
+    virtual void setHead(uint32_t h) {};
     virtual void setNextQ( CircularQBase<TYPE>& q) {};
     virtual void setPreviousQ( CircularQBase<TYPE>& q) {};
     virtual void setNextQ( CircularQBase<TYPE>* q) {};
     virtual void setPreviousQ( CircularQBase<TYPE>* q) {};
     virtual void slice( void) {};
+    virtual uint32_t peekN( TYPE* dst, uint32_t n) {return 0;};
+
+    /** \brief Put up to n values in the queue.
+
+     Copies contiguous runs with memcpy, wrapping as needed. Returns the number of values written.
+     */
+    uint32_t putN( const TYPE* src, uint32_t n) {
+        uint32_t rc = 0;
+        for( uint8_t i = 0; i < 2 && rc < n; i++) {
+            uint32_t len = getLinearWriteBufferSize();
+            if( len > n - rc) {
+                len = n - rc;
+            }
+            if( len == 0) {
+                break;
+            }
+            memcpy( getLinearWriteBuffer(), src + rc, len * sizeof(TYPE));
+            append( len);
+            rc += len;
+        }
+        return rc;
+    }
+    /** \brief Get up to n values from the queue.
+
+     Copies contiguous runs with memcpy, wrapping as needed. Returns the number of values read.
+     */
+    uint32_t getN( TYPE* dst, uint32_t n) {
+        uint32_t rc = 0;
+        for( uint8_t i = 0; i < 2 && rc < n; i++) {
+            uint32_t len = getLinearReadBufferSize();
+            if( len > n - rc) {
+                len = n - rc;
+            }
+            if( len == 0) {
+                break;
+            }
+            memcpy( dst + rc, getLinearReadBuffer(), len * sizeof(TYPE));
+            drop( len);
+            rc += len;
+        }
+        return rc;
+    }
+    /** \brief Reserves a contiguous region for writing.
+
+     Returns a pointer to the write region and sets n to the number of values which may be written there,
+     at most the requested n. The values become visible to the reader after commit().
+     */
+    TYPE* reserve( uint32_t& n) {
+        uint32_t len = getLinearWriteBufferSize();
+        if( n > len) {
+            n = len;
+        }
+        return getLinearWriteBuffer();
+    }
+    /** \brief Publishes n values written to the region returned by reserve().
+
+     Publishes n values written to the region returned by reserve().
+     */
+    void commit( uint32_t n) {
+        append( n);
+    }
 };
 
 /** \brief CircularQ - a FIFO Queue meant to be used by one reader and one writer
@@ -99,6 +166,7 @@ public:
      */
     CircularQ() {
         m_nextQ = NULL;
+        m_previousQ = NULL;
         Sliceable::m_sliceEnabled = true;
         reset();
     }
@@ -153,7 +221,7 @@ public:
      Pulls input from the queue Q, pushes output to the next queue.
      */
     void slice( ) {
-        uint16_t s1, s2;
+        uint32_t s1, s2;
         if( m_nextQ != NULL) {
             s1 = getLinearReadBufferSize();
             s2 = m_nextQ->getLinearWriteBufferSize();
@@ -181,8 +249,8 @@ public:
 
      Drops the next n items in the Q.
      */
-    void drop(uint16_t n) {
-        uint16_t sz = used();
+    void drop(uint32_t n) {
+        uint32_t sz = used();
         if (n > sz) {
             n = sz;
         }
@@ -198,8 +266,8 @@ public:
 
      Appends the next n items in the Q.
      */
-    void append(uint16_t n) {
-        uint16_t sz = free();
+    void append(uint32_t n) {
+        uint32_t sz = free();
         if (n > sz) {
             n = sz;
         }
@@ -215,7 +283,7 @@ public:
 
      Sets the pointer to the next item for a put.
      */
-    void setHead(uint16_t h) {
+    void setHead(uint32_t h) {
         if (h < SIZE) {
             m_head = h;
         } else {
@@ -233,8 +301,8 @@ public:
 
      Returns the size of the linear buffer.
      */
-    uint16_t getLinearReadBufferSize() {
-        uint16_t rc = 0;
+    uint32_t getLinearReadBufferSize() {
+        uint32_t rc = 0;
         if (m_tail < m_head) {
             rc = m_head - m_tail;
         } else if (m_tail > m_head) {
@@ -253,8 +321,8 @@ public:
 
      Returns the size of the linear buffer.
      */
-    uint16_t getLinearWriteBufferSize() {
-        uint16_t rc = 0;
+    uint32_t getLinearWriteBufferSize() {
+        uint32_t rc = 0;
         if( m_head < m_tail) {
             rc = m_tail - 1 - m_head;
         } else if( m_head >= m_tail) {
@@ -276,15 +344,15 @@ public:
 
      Returns the number of items + 1 which can be stored in the queue.
      */
-    const uint16_t size() {
+    const uint32_t size() {
         return SIZE;
     }
     /** \brief Returns the number of items in the queue.
 
      Returns the number of items in the queue.
      */
-    const uint16_t used() {
-        uint16_t rc;
+    const uint32_t used() {
+        uint32_t rc;
         if (m_head >= m_tail) {
             rc = m_head - m_tail;
         } else {
@@ -296,23 +364,43 @@ public:
 
      Returns the number of items which the queue can accept.
      */
-    const uint16_t free() {
+    const uint32_t free() {
         return SIZE - used() - 1;
     }
     /** \brief Check for values in the queue.
 
      Returns true if an item (or if a n is specified, n items) are available.
      */
-    const bool valueAvailable(uint16_t n = 1) {
+    const bool valueAvailable(uint32_t n = 1) {
         return used() >= n;
     }
     /** \brief Checks for space in the queue.
 
      Returns true if an item (or if a n is specified, n items) can be written to the queue.
      */
-    const bool spaceAvailable(uint16_t n = 1) {
+    const bool spaceAvailable(uint32_t n = 1) {
         return free() >= n;
     }
+    /** \brief Copies up to n values from the queue without removing them.
+
+     Returns the number of values copied.
+     */
+    uint32_t peekN( TYPE* dst, uint32_t n) {
+        uint32_t u = used();
+        uint32_t t = m_tail;
+        if( n > u) {
+            n = u;
+        }
+        uint32_t len = SIZE - t;
+        if( len > n) {
+            len = n;
+        }
+        memcpy( dst, &m_buf[t], len * sizeof(TYPE));
+        if( n > len) {
+            memcpy( dst + len, m_buf, (n - len) * sizeof(TYPE));
+        }
+        return n;
+    }
     /** \brief Get a value from the queue.
 
      Returns the next item in the queue. valueAvailable() should always be called first.
@@ -353,5 +441,321 @@ public:
     }
 };
 
+#ifndef CIRCULARQ_CACHE_LINE_SIZE
+#define CIRCULARQ_CACHE_LINE_SIZE 64
 #endif
 
+/** \brief CircularQSpsc - a lock free FIFO Queue for one reader and one writer running on different tasks or cores
+
+ CircularQSpsc provides the same interface as CircularQ, but the head and tail indexes are atomics with
+ acquire / release ordering, so the writer and reader may run concurrently on different cores without a lock.
+ The writer only stores m_head and the reader only stores m_tail. Each index lives on its own cache line
+ to avoid false sharing between the producer and the consumer.
+
+ The indexes are free running 32 bit counters, the buffer index is formed by masking, so SIZE must be a power of 2.
+ All SIZE entries are usable, used() is m_head - m_tail. Queues larger than 64K entries are supported.
+
+ reset() drops the content from the reader side, discard() from the writer side. The writer never stores m_tail,
+ discard() stores the count the reader should drop up to next to m_head. The reader moves m_tail there on its
+ next get(), drop(), peekN() or valueAvailable(), so the values it is reading are never overwritten, and the
+ space comes free then. setHead() is not thread safe, it should only be called while neither side is active.
+
+ Examples:
+ CircularQSpsc<char, 8192>   logQ;
+ */
+template<class TYPE, uint32_t SIZE>
+class CircularQSpsc: public CircularQBase<TYPE> {
+    static_assert( SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "CircularQSpsc SIZE must be a power of 2");
+protected:
+    static const uint32_t MASK = SIZE - 1;
+    CircularQBase<TYPE>* m_nextQ; /**< Pointer to a queue which receives the output of this queue. */
+    CircularQBase<TYPE>* m_previousQ; /**< Pointer to a queue which provides the input to this queue. */
+    alignas(CIRCULARQ_CACHE_LINE_SIZE) std::atomic<uint32_t> m_head; /**< Count of values written, only stored by the writer. */
+    std::atomic<uint32_t> m_discard; /**< Count the reader drops up to, only stored by the writer. */
+    std::atomic<uint32_t> m_discards; /**< Number of discard() calls, only stored by the writer. */
+    alignas(CIRCULARQ_CACHE_LINE_SIZE) std::atomic<uint32_t> m_tail; /**< Count of values read, only stored by the reader. */
+    uint32_t m_discardsSeen; /**< m_discards when the reader last looked, only used by the reader. */
+    alignas(CIRCULARQ_CACHE_LINE_SIZE) TYPE m_buf[SIZE]; /**< Storage for the items in the queue. */
+
+    /** \brief Returns m_tail after moving it past a discard() not seen yet. Reader side.
+
+     A discard point the reader has already read past is ignored.
+     */
+    uint32_t readerTail( void) {
+        uint32_t t = m_tail.load( std::memory_order_relaxed);
+        uint32_t n = m_discards.load( std::memory_order_acquire);
+        if( n != m_discardsSeen) {
+            uint32_t d = m_discard.load( std::memory_order_acquire);
+            m_discardsSeen = n;
+            if( d != t && d - t <= m_head.load( std::memory_order_acquire) - t) {
+                t = d;
+                m_tail.store( t, std::memory_order_release);
+            }
+        }
+        return t;
+    }
+public:
+    virtual const char* sliceName( ) { return "CircularQSpsc"; }
+
+    /** \brief Constructor.
+
+     Default constructor, no parameters are required.
+     */
+    CircularQSpsc() {
+        m_nextQ = NULL;
+        m_previousQ = NULL;
+        Sliceable::m_sliceEnabled = true;
+        m_head.store( 0, std::memory_order_relaxed);
+        m_discard.store( 0, std::memory_order_relaxed);
+        m_discards.store( 0, std::memory_order_relaxed);
+        m_discardsSeen = 0;
+        m_tail.store( 0, std::memory_order_release);
+    }
+    /** \brief Destructor.
+
+     Default destructor, no parameters are required.
+     */
+    virtual ~CircularQSpsc( ) {
+
+    }
+    /** \brief Clears Q.
+
+     Drops everything in the Q. Safe on the reader side, the writer keeps its position.
+     */
+    void reset() {
+        readerTail();
+        m_tail.store( m_head.load( std::memory_order_acquire), std::memory_order_release);
+    }
+    /** \brief Drops the oldest n values, all of them by default. Writer side.
+
+     The reader drops them on its next read, the values it is reading at the moment are not torn from under it.
+     */
+    void discard(uint32_t n = 0xFFFFFFFF) {
+        uint32_t h = m_head.load( std::memory_order_relaxed);
+        uint32_t t = m_tail.load( std::memory_order_acquire);
+        uint32_t u = h - t;
+        m_discard.store( t + (n < u ? n : u), std::memory_order_release);
+        m_discards.store( m_discards.load( std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    /** \brief Sets the queue which receives the output of this Q.
+
+     Sets the queue which receives the output of this Q.
+     */
+    void setNextQ( CircularQBase<TYPE>& q) {
+        setNextQ( &q);
+    }
+    void setNextQ( CircularQBase<TYPE>* q) {
+        m_nextQ = q;
+        if( m_nextQ != NULL) {
+            Sliceable::m_sliceEnabled = true;
+        }
+    }
+    /** \brief Sets the queue which provides the input to this Q.
+
+     Sets the queue which provides the input to this Q.
+     */
+    void setPreviousQ( CircularQBase<TYPE>& q) {
+        setPreviousQ( &q);
+    }
+    void setPreviousQ( CircularQBase<TYPE>* q) {
+        m_previousQ = q;
+        if( m_previousQ != NULL) {
+            Sliceable::m_sliceEnabled = true;
+        }
+    }
+    /** \brief Pulls input from the queue Q, pushes output to the next queue.
+
+     Pulls input from the queue Q, pushes output to the next queue.
+     */
+    void slice( ) {
+        uint32_t s1, s2;
+        if( m_nextQ != NULL) {
+            s1 = getLinearReadBufferSize();
+            s2 = m_nextQ->getLinearWriteBufferSize();
+            s1 = s1 <= s2 ? s1 : s2;
+            if( s1 > 0) {
+                memcpy(m_nextQ->getLinearWriteBuffer(), getLinearReadBuffer(), s1 * sizeof(TYPE));
+                m_nextQ->append( s1);
+                drop( s1);
+            }
+        }
+        if( m_previousQ != NULL) {
+            s1 = getLinearWriteBufferSize();
+            s2 = m_previousQ->getLinearReadBufferSize();
+            s1 = s1 <= s2 ? s1 : s2;
+            if( s1 > 0) {
+                memcpy(getLinearWriteBuffer(), m_previousQ->getLinearReadBuffer(), s1 * sizeof(TYPE));
+                append( s1);
+                m_previousQ->drop( s1);
+            }
+        }
+    }
+    /** \brief Drops the next n items in the Q
+
+     Drops the next n items in the Q, then moves past a pending discard(). Reader side.
+     */
+    void drop(uint32_t n) {
+        uint32_t t = m_tail.load( std::memory_order_relaxed);
+        uint32_t u = m_head.load( std::memory_order_acquire) - t;
+        if (n > u) {
+            n = u;
+        }
+        if (n > 0) {
+            m_tail.store( t + n, std::memory_order_release);
+        }
+        readerTail();
+    }
+    /** \brief Appends the next n items in the Q
+
+     Publishes n items written through getLinearWriteBuffer(). Writer side.
+     */
+    void append(uint32_t n) {
+        uint32_t h = m_head.load( std::memory_order_relaxed);
+        uint32_t f = SIZE - (h - m_tail.load( std::memory_order_acquire));
+        if (n > f) {
+            n = f;
+        }
+        if (n > 0) {
+            m_head.store( h + n, std::memory_order_release);
+        }
+    }
+    /** \brief Sets the pointer to the next item for a put
+
+     Sets the pointer to the next item for a put. Not thread safe.
+     */
+    void setHead(uint32_t h) {
+        uint32_t t = m_tail.load( std::memory_order_relaxed);
+        uint32_t ti = t & MASK;
+        h &= MASK;
+        m_head.store( t + (h >= ti ? h - ti : SIZE - ti + h), std::memory_order_release);
+    }
+    /** \brief Returns a pointer to the buffer used by the queue for the next get operation
+
+     Returns a pointer to the buffer used by the queue for the next get operation.
+     */
+    TYPE* getLinearReadBuffer() {
+        return &m_buf[m_tail.load( std::memory_order_relaxed) & MASK];
+    }
+    /** \brief Returns the size of the linear buffer
+
+     Returns the size of the linear buffer.
+     */
+    uint32_t getLinearReadBufferSize() {
+        uint32_t t = m_tail.load( std::memory_order_relaxed);
+        uint32_t rc = m_head.load( std::memory_order_acquire) - t;
+        uint32_t l = SIZE - (t & MASK);
+        return rc < l ? rc : l;
+    }
+    /** \brief Returns a pointer to the buffer used by the queue for the next put operation
+
+     Returns a pointer to the buffer used by the queue for the next put operation.
+     */
+    TYPE* getLinearWriteBuffer() {
+        return &m_buf[m_head.load( std::memory_order_relaxed) & MASK];
+    }
+    /** \brief Returns the size of the linear buffer
+
+     Returns the size of the linear buffer.
+     */
+    uint32_t getLinearWriteBufferSize() {
+        uint32_t h = m_head.load( std::memory_order_relaxed);
+        uint32_t rc = SIZE - (h - m_tail.load( std::memory_order_acquire));
+        uint32_t l = SIZE - (h & MASK);
+        return rc < l ? rc : l;
+    }
+    /** \brief Returns a pointer to the buffer used by the queue
+
+     Returns a pointer to the buffer used by the queue.
+     */
+    TYPE* getBuffer() {
+        return m_buf;
+    }
+    /** \brief Returns number of items which can be stored in the queue
+
+     Returns the number of items which can be stored in the queue.
+     */
+    const uint32_t size() {
+        return SIZE;
+    }
+    /** \brief Returns the number of items in the queue.
+
+     Returns the number of items in the queue.
+     */
+    const uint32_t used() {
+        uint32_t t = m_tail.load( std::memory_order_acquire);
+        uint32_t rc = m_head.load( std::memory_order_acquire) - t;
+        return rc < SIZE ? rc : SIZE;
+    }
+    /** \brief Returns the number of items which the queue can accept.
+
+     Returns the number of items which the queue can accept.
+     */
+    const uint32_t free() {
+        return SIZE - used();
+    }
+    /** \brief Check for values in the queue.
+
+     Returns true if an item (or if a n is specified, n items) are available. Reader side.
+     */
+    const bool valueAvailable(uint32_t n = 1) {
+        readerTail();
+        return used() >= n;
+    }
+    /** \brief Checks for space in the queue.
+
+     Returns true if an item (or if a n is specified, n items) can be written to the queue.
+     */
+    const bool spaceAvailable(uint32_t n = 1) {
+        return free() >= n;
+    }
+    /** \brief Copies up to n values from the queue without removing them.
+
+     Returns the number of values copied. Reader side.
+     */
+    uint32_t peekN( TYPE* dst, uint32_t n) {
+        uint32_t t = readerTail();
+        uint32_t u = m_head.load( std::memory_order_acquire) - t;
+        if( n > u) {
+            n = u;
+        }
+        uint32_t ti = t & MASK;
+        uint32_t len = SIZE - ti;
+        if( len > n) {
+            len = n;
+        }
+        memcpy( dst, &m_buf[ti], len * sizeof(TYPE));
+        if( n > len) {
+            memcpy( dst + len, m_buf, (n - len) * sizeof(TYPE));
+        }
+        return n;
+    }
+    /** \brief Get a value from the queue.
+
+     Returns the next item in the queue. valueAvailable() should always be called first.
+     */
+    TYPE get(void) {
+        TYPE rc = TYPE(0);
+        uint32_t t = readerTail();
+        if( m_head.load( std::memory_order_acquire) != t) {
+            rc = m_buf[t & MASK];
+            m_tail.store( t + 1, std::memory_order_release);
+        }
+        return rc;
+    }
+    /** \brief Put a value in the queue.
+
+     Adds a value to the queue. Returns true if successful, false if there is no space in the queue.
+     */
+    bool put(TYPE v) {
+        bool rc = false;
+        uint32_t h = m_head.load( std::memory_order_relaxed);
+        if( (h - m_tail.load( std::memory_order_acquire)) < SIZE) {
+            m_buf[h & MASK] = v;
+            m_head.store( h + 1, std::memory_order_release);
+            rc = true;
+        }
+        return rc;
+    }
+};
+
+#endif
@@ -0,0 +1,310 @@
+#include "DeferredLog.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define DEFERRED_LOG_MAX_SPEC 24
+
+typedef enum {
+    ARG_NONE,
+    ARG_INT,
+    ARG_LONG,
+    ARG_LONG_LONG,
+    ARG_SIZE,
+    ARG_INTMAX,
+    ARG_PTRDIFF,
+    ARG_DOUBLE,
+    ARG_LONG_DOUBLE,
+    ARG_STRING,
+    ARG_POINTER,
+    ARG_COUNT,
+    ARG_INVALID,
+} deferredArgType_t;
+
+/** \brief Parses one conversion specification.
+
+ p points just past the '%'. Returns the type of the argument, sets end to the conversion character and
+ stars to the number of '*' width / precision arguments which come first.
+ */
+static deferredArgType_t parseSpec( const char* p, const char** end, uint8_t* stars) {
+    deferredArgType_t rc = ARG_INVALID;
+    uint8_t lng = 0;
+    char size = '\0';
+    *stars = 0;
+    while( *p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+        p++;
+    }
+    if( *p == '*') {
+        (*stars)++;
+        p++;
+    } else {
+        while( *p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    if( *p == '.') {
+        p++;
+        if( *p == '*') {
+            (*stars)++;
+            p++;
+        } else {
+            while( *p >= '0' && *p <= '9') {
+                p++;
+            }
+        }
+    }
+    for( ;; p++) {
+        if( *p == 'l') {
+            lng++;
+        } else if( *p == 'h') {
+        } else if( *p == 'z' || *p == 'j' || *p == 't' || *p == 'L') {
+            size = *p;
+        } else {
+            break;
+        }
+    }
+    *end = p;
+    switch( *p) {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            if( size == 'z') {
+                rc = ARG_SIZE;
+            } else if( size == 'j') {
+                rc = ARG_INTMAX;
+            } else if( size == 't') {
+                rc = ARG_PTRDIFF;
+            } else if( lng >= 2) {
+                rc = ARG_LONG_LONG;
+            } else if( lng == 1) {
+                rc = ARG_LONG;
+            } else {
+                rc = ARG_INT;
+            }
+        break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            rc = size == 'L' ? ARG_LONG_DOUBLE : ARG_DOUBLE;
+        break;
+        case 's':
+            rc = lng == 0 ? ARG_STRING : ARG_INVALID;
+        break;
+        case 'p':
+            rc = ARG_POINTER;
+        break;
+        case 'n':
+            rc = ARG_COUNT;
+        break;
+        case '%':
+            rc = ARG_NONE;
+        break;
+    }
+    return rc;
+}
+
+template<class T>
+static bool putValue( uint8_t* rec, uint32_t max, uint32_t& n, T v) {
+    bool rc = false;
+    if( n + sizeof(T) <= max) {
+        memcpy( rec + n, &v, sizeof(T));
+        n += sizeof(T);
+        rc = true;
+    }
+    return rc;
+}
+
+template<class T>
+static bool getValue( const uint8_t* rec, uint32_t len, uint32_t& n, T& v) {
+    bool rc = false;
+    if( n + sizeof(T) <= len) {
+        memcpy( &v, rec + n, sizeof(T));
+        n += sizeof(T);
+        rc = true;
+    }
+    return rc;
+}
+
+uint32_t DeferredLog::encode( uint8_t* rec, uint32_t max, const char* fmt, va_list args) {
+    uint32_t n = 0;
+    bool ok = max > sizeof(fmt);
+    if( ok) {
+        rec[n++] = DEFERRED_LOG_MARK;
+        ok = putValue( rec, max, n, fmt);
+    }
+    for( const char* p = fmt; ok && *p != '\0'; p++) {
+        if( *p != '%') {
+            continue;
+        }
+        const char* end;
+        uint8_t stars;
+        deferredArgType_t type = parseSpec( p + 1, &end, &stars);
+        for( uint8_t i = 0; ok && i < stars; i++) {
+            ok = putValue( rec, max, n, va_arg( args, int));
+        }
+        switch( type) {
+            case ARG_NONE:
+            break;
+            case ARG_INT:
+                ok = ok && putValue( rec, max, n, va_arg( args, int));
+            break;
+            case ARG_LONG:
+                ok = ok && putValue( rec, max, n, va_arg( args, long));
+            break;
+            case ARG_LONG_LONG:
+                ok = ok && putValue( rec, max, n, va_arg( args, long long));
+            break;
+            case ARG_SIZE:
+                ok = ok && putValue( rec, max, n, va_arg( args, size_t));
+            break;
+            case ARG_INTMAX:
+                ok = ok && putValue( rec, max, n, va_arg( args, intmax_t));
+            break;
+            case ARG_PTRDIFF:
+                ok = ok && putValue( rec, max, n, va_arg( args, ptrdiff_t));
+            break;
+            case ARG_DOUBLE:
+                ok = ok && putValue( rec, max, n, va_arg( args, double));
+            break;
+            case ARG_LONG_DOUBLE:
+                ok = ok && putValue( rec, max, n, va_arg( args, long double));
+            break;
+            case ARG_POINTER:
+                ok = ok && putValue( rec, max, n, va_arg( args, void*));
+            break;
+            case ARG_STRING: {
+                const char* s = va_arg( args, const char*);
+                uint16_t len = s == NULL ? 0 : (uint16_t) strnlen( s, max);
+                ok = ok && putValue( rec, max, n, len) && n + len <= max;
+                if( ok) {
+                    memcpy( rec + n, s, len);
+                    n += len;
+                }
+            }
+            break;
+            case ARG_COUNT:
+                va_arg( args, int*);
+            break;
+            default:
+                ok = false;
+            break;
+        }
+        if( *end == '\0') {
+            break;
+        }
+        p = end;
+    }
+    return ok ? n : 0;
+}
+
+template<class T>
+static int emitValue( char* out, size_t max, const char* spec, const int* star, uint8_t stars, T v) {
+    int rc;
+    if( stars == 0) {
+        rc = snprintf( out, max, spec, v);
+    } else if( stars == 1) {
+        rc = snprintf( out, max, spec, star[0], v);
+    } else {
+        rc = snprintf( out, max, spec, star[0], star[1], v);
+    }
+    return rc;
+}
+
+template<class T>
+static bool emitRecordValue( char* out, uint32_t max, uint32_t& o, const char* spec, const int* star, uint8_t stars,
+        const uint8_t* rec, uint32_t len, uint32_t& n) {
+    T v;
+    bool rc = getValue( rec, len, n, v);
+    if( rc) {
+        int w = emitValue( out + o, max - o, spec, star, stars, v);
+        if( w > 0) {
+            o += (uint32_t) w;
+        }
+    }
+    return rc;
+}
+
+uint32_t DeferredLog::format( char* out, uint32_t max, const uint8_t* rec, uint32_t len) {
+    uint32_t o = 0;
+    uint32_t n = 1;
+    const char* fmt = NULL;
+    if( max == 0) {
+        return 0;
+    }
+    bool ok = isDeferred( rec, len) && getValue( rec, len, n, fmt);
+    for( const char* p = fmt; ok && *p != '\0' && o < max - 1; p++) {
+        if( *p != '%') {
+            out[o++] = *p;
+            continue;
+        }
+        const char* end;
+        uint8_t stars;
+        char spec[ DEFERRED_LOG_MAX_SPEC];
+        int star[2] = { 0, 0};
+        deferredArgType_t type = parseSpec( p + 1, &end, &stars);
+        uint32_t specLen = (uint32_t) (end - p) + 1;
+        if( *end == '\0' || specLen >= sizeof(spec)) {
+            break;
+        }
+        memcpy( spec, p, specLen);
+        spec[ specLen] = '\0';
+        for( uint8_t i = 0; ok && i < stars; i++) {
+            ok = getValue( rec, len, n, star[i]);
+        }
+        switch( type) {
+            case ARG_NONE:
+                out[o++] = '%';
+            break;
+            case ARG_INT:
+                ok = ok && emitRecordValue<int>( out, max, o, spec, star, stars, rec, len, n);
+            break;
+            case ARG_LONG:
+                ok = ok && emitRecordValue<long>( out, max, o, spec, star, stars, rec, len, n);
+            break;
+            case ARG_LONG_LONG:
+                ok = ok && emitRecordValue<long long>( out, max, o, spec, star, stars, rec, len, n);
+            break;
+            case ARG_SIZE:
+                ok = ok && emitRecordValue<size_t>( out, max, o, spec, star, stars, rec, len, n);
+            break;
+            case ARG_INTMAX:
+                ok = ok && emitRecordValue<intmax_t>( out, max, o, spec, star, stars, rec, len, n);
+            break;
+            case ARG_PTRDIFF:
+                ok = ok && emitRecordValue<ptrdiff_t>( out, max, o, spec, star, stars, rec, len, n);
+            break;
+            case ARG_DOUBLE:
+                ok = ok && emitRecordValue<double>( out, max, o, spec, star, stars, rec, len, n);
+            break;
+            case ARG_LONG_DOUBLE:
+                ok = ok && emitRecordValue<long double>( out, max, o, spec, star, stars, rec, len, n);
+            break;
+            case ARG_POINTER:
+                ok = ok && emitRecordValue<void*>( out, max, o, spec, star, stars, rec, len, n);
+            break;
+            case ARG_STRING: {
+                uint16_t sl = 0;
+                ok = ok && getValue( rec, len, n, sl) && n + sl <= len;
+                if( ok) {
+                    char s[ 128];
+                    uint16_t cl = sl < sizeof(s) ? sl : sizeof(s) - 1;
+                    memcpy( s, rec + n, cl);
+                    s[ cl] = '\0';
+                    n += sl;
+                    int w = emitValue( out + o, max - o, spec, star, stars, (const char*) s);
+                    if( w > 0) {
+                        o += (uint32_t) w;
+                    }
+                }
+            }
+            break;
+            case ARG_COUNT:
+            break;
+            default:
+                ok = false;
+            break;
+        }
+        if( o > max - 1) {
+            o = max - 1;
+        }
+        p = end;
+    }
+    out[o] = '\0';
+    return o;
+}
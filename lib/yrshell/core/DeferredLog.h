@@ -0,0 +1,37 @@
+#ifndef DeferredLog_h
+#define DeferredLog_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+#define DEFERRED_LOG_MARK 0x00
+
+/** \brief DeferredLog - stores printf style log calls unformatted
+
+ encode() walks the format string once and copies the raw argument values into a binary record, together
+ with the format string pointer. format() renders the record to text later, when a sink drains it.
+
+ The format string must stay valid until the record is formatted, so only string literals should be deferred.
+ %s arguments are copied into the record since they often point at stack or reused buffers.
+ Records start with DEFERRED_LOG_MARK so they can share a ring with plain text records.
+ */
+class DeferredLog {
+public:
+    /** \brief Encodes a log call into rec.
+
+     Returns the record length, or 0 if the call does not fit in max bytes or uses an unsupported conversion.
+     args is consumed, the caller should pass a copy if it needs a fallback.
+     */
+    static uint32_t encode( uint8_t* rec, uint32_t max, const char* fmt, va_list args);
+    /** \brief Formats a record produced by encode().
+
+     Writes at most max - 1 characters and a terminating null to out. Returns the number of characters written.
+     */
+    static uint32_t format( char* out, uint32_t max, const uint8_t* rec, uint32_t len);
+    /** \brief Returns true if the record was produced by encode().
+     */
+    static bool isDeferred( const uint8_t* rec, uint32_t len) { return len > 0 && rec[0] == DEFERRED_LOG_MARK; }
+};
+
+#endif
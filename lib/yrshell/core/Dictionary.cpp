@@ -1,6 +1,8 @@
 #include "YRShellInterpreter.h"
 #include "Dictionary.h"
 
+#include <new>
+
 DictionaryError::DictionaryError( ) {
 }
 DictionaryError::~DictionaryError( ) {
@@ -55,20 +57,131 @@ void Dictionary::shellERROR( const char* name, unsigned line) {
         t->shellERROR(name, line);
     }
 }
+static const uint32_t s_crc32Nibble[ 16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+uint32_t Dictionary::crc32( uint32_t crc, const void* data, uint32_t len) {
+    const uint8_t* p = (const uint8_t*) data;
+    crc = ~crc;
+    while( len-- > 0) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ s_crc32Nibble[ crc & 0x0F];
+        crc = (crc >> 4) ^ s_crc32Nibble[ crc & 0x0F];
+    }
+    return ~crc;
+}
+
+DictionaryIndex::DictionaryIndex( ) {
+    m_values = NULL;
+    m_tags = NULL;
+    m_slots = 0;
+    m_count = 0;
+}
+void DictionaryIndex::init( uint16_t* values, uint8_t* tags, uint16_t slots) {
+    m_values = values;
+    m_tags = tags;
+    m_slots = slots;
+    clear();
+}
+void DictionaryIndex::attach( const uint16_t* values, const uint8_t* tags, uint16_t slots, uint16_t count) {
+    m_values = (uint16_t*) values;
+    m_tags = (uint8_t*) tags;
+    m_slots = slots;
+    m_count = count;
+}
+bool DictionaryIndex::allocate( uint16_t entries) {
+    uint16_t slots = 16;
+    while( slots < 0x8000 && slots < entries * 2) {
+        slots *= 2;
+    }
+    uint16_t* values = new (std::nothrow) uint16_t[ slots];
+    uint8_t* tags = new (std::nothrow) uint8_t[ slots];
+    if( values != NULL && tags != NULL) {
+        init( values, tags, slots);
+    } else {
+        delete[] values;
+        delete[] tags;
+    }
+    return isValid();
+}
+void DictionaryIndex::clear( ) {
+    for( uint16_t i = 0; i < m_slots; i++) {
+        m_values[ i] = YRSHELL_DICTIONARY_INVALID;
+    }
+    m_count = 0;
+}
+uint32_t DictionaryIndex::hash( const char* name) {
+    uint32_t h = 2166136261UL;
+    while( *name != '\0') {
+        h ^= (uint8_t) *name++;
+        h *= 16777619UL;
+    }
+    return h;
+}
+uint16_t DictionaryIndex::find( Dictionary* d, const char* name, uint32_t h) {
+    uint16_t rc = YRSHELL_DICTIONARY_INVALID;
+    uint16_t mask = m_slots - 1;
+    uint8_t tag = (uint8_t) (h >> 24);
+    for( uint16_t i = (uint16_t) h & mask; m_values[ i] != YRSHELL_DICTIONARY_INVALID; i = (i + 1) & mask) {
+        if( m_tags[ i] == tag && !strcmp( d->getAddress( m_values[ i]), name)) {
+            rc = m_values[ i];
+            break;
+        }
+    }
+    return rc;
+}
+bool DictionaryIndex::insert( Dictionary* d, const char* name, uint32_t h, uint16_t value, bool replace) {
+    bool rc = false;
+    uint16_t mask = m_slots - 1;
+    uint8_t tag = (uint8_t) (h >> 24);
+    uint16_t i;
+    for( i = (uint16_t) h & mask; m_values[ i] != YRSHELL_DICTIONARY_INVALID; i = (i + 1) & mask) {
+        if( m_tags[ i] == tag && !strcmp( d->getAddress( m_values[ i]), name)) {
+            break;
+        }
+    }
+    if( m_values[ i] != YRSHELL_DICTIONARY_INVALID) {
+        if( replace) {
+            m_values[ i] = value;
+        }
+        rc = true;
+    } else if( m_count < m_slots - m_slots / 4) {
+        m_values[ i] = value;
+        m_tags[ i] = tag;
+        m_count++;
+        rc = true;
+    }
+    return rc;
+}
 
 FunctionDictionary::FunctionDictionary( const FunctionEntry* dict, uint16_t mask) {
     M_dictionary = dict;
     m_mask = mask;
     for(  m_size = 0; dict->isValid() && m_size <= ((uint16_t) YRSHELL_DICTIONARY_MAX_ADDRESS); dict++, m_size++) {
     }
+    if( m_index.allocate( m_size)) {
+        // Later entries win, as with the reverse linear search
+        for( uint16_t i = 0; i < m_size; i++) {
+            const char* name = M_dictionary[ i].getName();
+            m_index.insert( this, name, DictionaryIndex::hash( name), i, true);
+        }
+    }
 }
 uint16_t FunctionDictionary::findEntry( const char* name) {
     uint16_t rc = YRSHELL_DICTIONARY_INVALID;
-    for( const FunctionEntry *S = &M_dictionary[ m_size-1]; S >= M_dictionary; S-- ) {
-        if( S->isMatch(name)) {
-            rc = S->getFunctionNumber();
-            rc |= m_mask;
-            break;
+    if( m_index.isValid()) {
+        uint16_t i = m_index.find( this, name, DictionaryIndex::hash( name));
+        if( i != YRSHELL_DICTIONARY_INVALID) {
+            rc = M_dictionary[ i].getFunctionNumber() | m_mask;
+        }
+    } else {
+        for( const FunctionEntry *S = &M_dictionary[ m_size-1]; S >= M_dictionary; S-- ) {
+            if( S->isMatch(name)) {
+                rc = S->getFunctionNumber();
+                rc |= m_mask;
+                break;
+            }
         }
     }
     return rc;
@@ -100,12 +213,51 @@ CompiledDictionary::CompiledDictionary( ) {
     m_lastWord = YRSHELL_DICTIONARY_INVALID;
     m_size = 0;
     m_mask = 0;
+    m_indexBuilt = false;
 }
 CompiledDictionary::CompiledDictionary( const uint16_t* dict, uint16_t lastWord, uint16_t size, uint16_t mask) {
     m_dictionary = (uint16_t*) dict;
     m_lastWord = lastWord;
     m_size = size;
     m_mask = mask;
+    m_indexBuilt = false;
+}
+void CompiledDictionary::setDictionary( const uint16_t* dict, uint16_t lastWord, uint16_t size) {
+    m_dictionary = (uint16_t*) dict;
+    m_lastWord = lastWord;
+    m_size = size;
+    m_indexBuilt = false;
+}
+void CompiledDictionary::setIndex( const uint16_t* values, const uint8_t* tags, uint16_t slots, uint16_t count) {
+    m_index.attach( values, tags, slots, count);
+    m_indexBuilt = true;
+}
+DictionaryIndex& CompiledDictionary::getIndex( ) {
+    if( !m_indexBuilt && m_lastWord != YRSHELL_DICTIONARY_INVALID) {
+        buildIndex();
+    }
+    return m_index;
+}
+void CompiledDictionary::buildIndex( ) {
+    m_indexBuilt = true;
+    uint16_t count = 0;
+    for( uint16_t link = m_lastWord; link != YRSHELL_DICTIONARY_INVALID && count < m_size; link = m_dictionary[ link]) {
+        count++;
+    }
+    if( count > 0 && m_index.allocate( count)) {
+        // Walk from the newest entry, so a redefinition hides the older one
+        for( uint16_t link = m_lastWord; link != YRSHELL_DICTIONARY_INVALID && count-- > 0; link = m_dictionary[ link]) {
+            const char* name = (const char*) &m_dictionary[ link + 1];
+            m_index.insert( this, name, DictionaryIndex::hash( name), link + 1, false);
+        }
+    }
+}
+uint16_t CompiledDictionary::findIndexedEntry( const char* name) {
+    uint16_t rc = m_index.find( this, name, DictionaryIndex::hash( name));
+    if( rc != YRSHELL_DICTIONARY_INVALID) {
+        rc |= m_mask;
+    }
+    return rc;
 }
 
 uint16_t CompiledDictionary::findInternalEntry( const char* name, uint16_t link) {
@@ -130,18 +282,24 @@ uint16_t CompiledDictionary::findInternal( const char* name, uint16_t link) {
     return rc;
 }
 uint16_t CompiledDictionary::find( const char* name) {
-    uint16_t rc = YRSHELL_DICTIONARY_INVALID;
-    if( m_lastWord != YRSHELL_DICTIONARY_INVALID) {
-        uint16_t link =  m_lastWord;
-        rc = findInternal( name, link);
+    uint16_t rc = findEntry( name);
+    if( rc != YRSHELL_DICTIONARY_INVALID) {
+        rc += Dictionary::nameLength(name);
     }
     return rc;
 }
 uint16_t CompiledDictionary::findEntry( const char* name) {
     uint16_t rc = YRSHELL_DICTIONARY_INVALID;
     if( m_lastWord != YRSHELL_DICTIONARY_INVALID) {
-        uint16_t link =  m_lastWord;
-        rc = findInternalEntry( name, link);
+        if( !m_indexBuilt) {
+            buildIndex();
+        }
+        if( m_index.isValid()) {
+            rc = findIndexedEntry( name);
+        } else {
+            uint16_t link =  m_lastWord;
+            rc = findInternalEntry( name, link);
+        }
     }
     return rc;
 }
@@ -178,22 +336,85 @@ uint16_t CompiledDictionary::getWordEnd( void) {
  uint16_t m_code[xxx]        this is the interpreter code for the word
  */
 CurrentVariableDictionary::CurrentVariableDictionary() {
+#ifdef YRSHELL_THREADED_CODE
+    m_optimize = true;
+#else
+    m_optimize = false;
+#endif
     m_mask = 0;
     m_size = 0;
     m_dictionary = NULL;
+    m_generation = 0;
+    m_wordLimit = 0;
+    m_lineLimit = 0;
     reset( );
 }
 CurrentVariableDictionary::CurrentVariableDictionary( uint16_t* dict, uint16_t size)  {
+#ifdef YRSHELL_THREADED_CODE
+    m_optimize = true;
+#else
+    m_optimize = false;
+#endif
     m_mask = YRSHELL_DICTIONARY_CURRENT;
     m_size = size;
     m_dictionary = dict;
+    m_generation = 0;
+    m_wordLimit = 0;
+    m_lineLimit = 0;
     reset( );
 }
 void CurrentVariableDictionary::reset() {
+    // Line regions reserved at the top survive a reset
+    if( m_wordLimit == 0 || m_wordLimit > m_size) {
+        m_wordLimit = m_size;
+    }
+    m_lineLimit = 0;
     m_dictionaryBackupWordEnd = 0;
-    m_dictionaryBackupLastWord = 0;
+    m_dictionaryBackupLastWord = YRSHELL_DICTIONARY_INVALID;
     m_dictionaryCurrentWordEnd = 0;
     m_lastWord = YRSHELL_DICTIONARY_INVALID;
+    m_indexBuilt = true;
+    m_indexFull = false;
+    m_generation++;
+    if( !m_index.isValid() && m_size > 0) {
+        m_index.allocate( m_size / 8);
+    }
+    if( m_index.isValid()) {
+        m_index.clear();
+    }
+}
+void CurrentVariableDictionary::indexEntry( uint16_t link) {
+    if( !m_indexFull && m_index.isValid() && link != YRSHELL_DICTIONARY_INVALID) {
+        const char* name = (const char*) &m_dictionary[ link + 1];
+        m_indexFull = !m_index.insert( this, name, DictionaryIndex::hash( name), link + 1, true);
+    }
+}
+void CurrentVariableDictionary::rebuildIndex() {
+    m_indexFull = false;
+    if( m_index.isValid()) {
+        m_index.clear();
+        uint16_t link = m_dictionaryBackupLastWord;
+        // Walk from the newest committed entry, so a redefinition hides the older one
+        for( uint16_t count = 0; !m_indexFull && link < m_dictionaryBackupWordEnd && count < m_size; count++) {
+            const char* name = (const char*) &m_dictionary[ link + 1];
+            m_indexFull = !m_index.insert( this, name, DictionaryIndex::hash( name), link + 1, false);
+            link = m_dictionary[ link];
+        }
+    }
+}
+bool CurrentVariableDictionary::restore( const uint16_t* code, uint16_t end, uint16_t lastWord) {
+    bool rc = false;
+    if( end < m_wordLimit && (lastWord == YRSHELL_DICTIONARY_INVALID ? end == 0 : lastWord < end)) {
+        memcpy( m_dictionary, code, end * sizeof( uint16_t));
+        m_dictionary[ end] = YRShellInterpreter::SI_CC_return;
+        m_dictionaryBackupWordEnd = m_dictionaryCurrentWordEnd = end;
+        m_dictionaryBackupLastWord = m_lastWord = lastWord;
+        m_lineLimit = 0;
+        m_generation++;
+        rebuildIndex();
+        rc = true;
+    }
+    return rc;
 }
 
 bool CurrentVariableDictionary::setToken( uint16_t address, uint16_t token){
@@ -206,7 +427,7 @@ bool CurrentVariableDictionary::setToken( uint16_t address, uint16_t token){
 }
 bool CurrentVariableDictionary::addToken( uint16_t token) {
     bool rc = false;
-    if( m_dictionaryCurrentWordEnd < (m_size - 2)) {
+    if( m_dictionaryCurrentWordEnd < ((m_lineLimit != 0 ? m_lineLimit : m_wordLimit) - 2)) {
         m_dictionary[ m_dictionaryCurrentWordEnd++] = token;
         m_dictionary[ m_dictionaryCurrentWordEnd] = YRShellInterpreter::SI_CC_return;
         rc = true;
@@ -216,7 +437,16 @@ bool CurrentVariableDictionary::addToken( uint16_t token) {
 bool CurrentVariableDictionary::newCompile( const char* name) {
     uint16_t len = Dictionary::nameLength(name);
     bool rc = false;
-    if( m_dictionaryCurrentWordEnd < (m_size - 1 - len - 2) ) {
+    if( m_lineLimit != 0) {
+        // A line region has no entry to keep
+        rollBack();
+    }
+    if( m_dictionaryCurrentWordEnd < (m_wordLimit - 1 - len - 2) ) {
+        if( m_lastWord != m_dictionaryBackupLastWord) {
+            // The previous entry was neither finished nor rolled back, it stays in the chain
+            indexEntry( m_lastWord);
+            m_generation++;
+        }
         m_dictionaryBackupWordEnd = m_dictionaryCurrentWordEnd;
         m_dictionaryBackupLastWord = m_lastWord;
         m_dictionary[ m_dictionaryCurrentWordEnd] = m_lastWord;
@@ -231,19 +461,274 @@ bool CurrentVariableDictionary::newCompile( const char* name) {
     return rc;
 }
 
+bool CurrentVariableDictionary::newLine( uint16_t base, uint16_t limit) {
+    bool rc = false;
+    if( base >= m_wordLimit && limit <= m_size && base + 2 < limit) {
+        rollBack();
+        m_dictionaryCurrentWordEnd = base;
+        m_lineLimit = limit;
+        m_dictionary[ base] = YRShellInterpreter::SI_CC_return;
+        rc = true;
+    }
+    return rc;
+}
+uint16_t CurrentVariableDictionary::reserve( uint16_t words) {
+    uint16_t rc = YRSHELL_DICTIONARY_INVALID;
+    if( m_lineLimit == 0 && words < m_wordLimit && m_dictionaryCurrentWordEnd + 2 < m_wordLimit - words) {
+        m_wordLimit -= words;
+        rc = m_wordLimit;
+    }
+    return rc;
+}
 void CurrentVariableDictionary::rollBack() {
     m_dictionaryCurrentWordEnd = m_dictionaryBackupWordEnd;
     m_lastWord = m_dictionaryBackupLastWord;
+    m_lineLimit = 0;
 }
 void CurrentVariableDictionary::newCompileDone() {
+    if( m_lastWord != m_dictionaryBackupLastWord) {
+        if( m_optimize) {
+            optimizeWord();
+        }
+        indexEntry( m_lastWord);
+        m_generation++;
+    }
     m_dictionaryBackupWordEnd = m_dictionaryCurrentWordEnd;
     m_dictionaryBackupLastWord = m_lastWord;
 }
+
+typedef struct {
+    uint16_t    fused;          /**< The superinstruction. */
+    uint8_t     length;         /**< Words replaced. */
+    uint8_t     fusedLength;    /**< Words written. */
+    int8_t      literal;        /**< Offset of the uint16 value, -1 for none. */
+    int8_t      target;         /**< Offset of the jump target, -1 for none. */
+} PeepholePattern;
+
+// Longer patterns first, matchPeephole() returns the first match
+static const PeepholePattern s_peephole[] = {
+    { YRShellInterpreter::SI_CC_x_dupLitEqualJmpz,  6, 3,  2,  5 },
+    { YRShellInterpreter::SI_CC_x_litPlus,          3, 2,  1, -1 },
+    { YRShellInterpreter::SI_CC_x_litMinus,         3, 2,  1, -1 },
+    { YRShellInterpreter::SI_CC_x_litEqual,         3, 2,  1, -1 },
+    { YRShellInterpreter::SI_CC_x_equalJmpz,        3, 2, -1,  2 },
+    { YRShellInterpreter::SI_CC_x_notEqualJmpz,     3, 2, -1,  2 },
+    { YRShellInterpreter::SI_CC_x_zeroEqualJmpz,    3, 2, -1,  2 },
+    { YRShellInterpreter::SI_CC_x_overPlus,         2, 1, -1, -1 },
+};
+static const uint8_t PEEPHOLE_NONE = 0xFF;
+
+static bool isJmpz( uint16_t token) {
+    return token == YRShellInterpreter::SI_CC_jmpz || token == YRShellInterpreter::SI_CC_x_if || token == YRShellInterpreter::SI_CC_x_until;
+}
+/** \brief Returns the length in words of the instruction at address, 0 if it runs past end.
+ */
+static uint16_t instructionLength( const uint16_t* code, uint16_t address, uint16_t end) {
+    uint16_t len = 1;
+    switch( code[ address]) {
+        case YRShellInterpreter::SI_CC_uint16:
+        case YRShellInterpreter::SI_CC_nint16:
+        case YRShellInterpreter::SI_CC_jmp:
+        case YRShellInterpreter::SI_CC_jmpz:
+        case YRShellInterpreter::SI_CC_x_if:
+        case YRShellInterpreter::SI_CC_x_else:
+        case YRShellInterpreter::SI_CC_x_until:
+        case YRShellInterpreter::SI_CC_x_litPlus:
+        case YRShellInterpreter::SI_CC_x_litMinus:
+        case YRShellInterpreter::SI_CC_x_litEqual:
+        case YRShellInterpreter::SI_CC_x_equalJmpz:
+        case YRShellInterpreter::SI_CC_x_notEqualJmpz:
+        case YRShellInterpreter::SI_CC_x_zeroEqualJmpz:
+            len = 2;
+            break;
+        case YRShellInterpreter::SI_CC_uint32:
+        case YRShellInterpreter::SI_CC_x_dupLitEqualJmpz:
+            len = 3;
+            break;
+        case YRShellInterpreter::SI_CC_string:
+            if( address + 1 < end) {
+                len = 1 + Dictionary::nameLength( (const char*) &code[ address + 1]);
+            } else {
+                len = 2;
+            }
+            break;
+        default:
+            break;
+    }
+    return (uint16_t) (address + len) <= end ? len : 0;
+}
+/** \brief Returns the offset of the jump target in the instruction at address, 0 if it is not a jump.
+ */
+static uint16_t jumpTargetOffset( uint16_t token) {
+    uint16_t rc = 0;
+    switch( token) {
+        case YRShellInterpreter::SI_CC_jmp:
+        case YRShellInterpreter::SI_CC_jmpz:
+        case YRShellInterpreter::SI_CC_x_if:
+        case YRShellInterpreter::SI_CC_x_else:
+        case YRShellInterpreter::SI_CC_x_until:
+        case YRShellInterpreter::SI_CC_x_equalJmpz:
+        case YRShellInterpreter::SI_CC_x_notEqualJmpz:
+        case YRShellInterpreter::SI_CC_x_zeroEqualJmpz:
+            rc = 1;
+            break;
+        case YRShellInterpreter::SI_CC_x_dupLitEqualJmpz:
+            rc = 2;
+            break;
+        default:
+            break;
+    }
+    return rc;
+}
+static uint8_t matchPeephole( const uint16_t* code, uint16_t address, uint16_t end) {
+    uint8_t rc = PEEPHOLE_NONE;
+    const uint16_t* c = &code[ address];
+    uint16_t left = end - address;
+    if( left >= 6 && c[ 0] == YRShellInterpreter::SI_CC_dup && c[ 1] == YRShellInterpreter::SI_CC_uint16 &&
+            c[ 3] == YRShellInterpreter::SI_CC_equal && isJmpz( c[ 4])) {
+        rc = 0;
+    } else if( left >= 3 && c[ 0] == YRShellInterpreter::SI_CC_uint16) {
+        if( c[ 2] == YRShellInterpreter::SI_CC_plus) {
+            rc = 1;
+        } else if( c[ 2] == YRShellInterpreter::SI_CC_minus) {
+            rc = 2;
+        } else if( c[ 2] == YRShellInterpreter::SI_CC_equal) {
+            rc = 3;
+        }
+    } else if( left >= 3 && isJmpz( c[ 1])) {
+        if( c[ 0] == YRShellInterpreter::SI_CC_equal) {
+            rc = 4;
+        } else if( c[ 0] == YRShellInterpreter::SI_CC_notEqual) {
+            rc = 5;
+        } else if( c[ 0] == YRShellInterpreter::SI_CC_zeroEqual) {
+            rc = 6;
+        }
+    } else if( left >= 2 && c[ 0] == YRShellInterpreter::SI_CC_over && c[ 1] == YRShellInterpreter::SI_CC_plus) {
+        rc = 7;
+    }
+    return rc;
+}
+/** \brief Returns true if a jump in start..end lands strictly between from and to.
+ */
+static bool hasTargetInside( const uint16_t* code, uint16_t start, uint16_t end, uint16_t from, uint16_t to) {
+    bool rc = false;
+    for( uint16_t a = start; !rc && a < end; ) {
+        uint16_t len = instructionLength( code, a, end);
+        uint16_t offset = jumpTargetOffset( code[ a]);
+        if( len == 0) {
+            rc = true;
+        } else {
+            if( offset != 0) {
+                uint16_t target = code[ a + offset] & YRSHELL_DICTIONARY_ADDRESS_MASK;
+                rc = target > from && target < to;
+            }
+            a += len;
+        }
+    }
+    return rc;
+}
+void CurrentVariableDictionary::optimizeWord( ) {
+    uint16_t* code = m_dictionary;
+    uint16_t start = m_lastWord + 1 + Dictionary::nameLength( (const char*) &code[ m_lastWord + 1]);
+    uint16_t end = m_dictionaryCurrentWordEnd;
+    uint16_t fusedAt[ YRSHELL_PEEPHOLE_MAX];
+    uint8_t fusedAs[ YRSHELL_PEEPHOLE_MAX];
+    uint16_t numFused = 0;
+    bool valid = true;
+
+    // Find the sequences to fuse, positions are in the original word
+    for( uint16_t a = start; valid && a < end && numFused < YRSHELL_PEEPHOLE_MAX; ) {
+        uint16_t len = instructionLength( code, a, end);
+        uint8_t p = matchPeephole( code, a, end);
+        if( len == 0) {
+            valid = false;
+        } else if( p != PEEPHOLE_NONE && !hasTargetInside( code, start, end, a, a + s_peephole[ p].length)) {
+            fusedAt[ numFused] = a;
+            fusedAs[ numFused++] = p;
+            a += s_peephole[ p].length;
+        } else {
+            a += len;
+        }
+    }
+    if( !valid || numFused == 0) {
+        return;
+    }
+    // Compact in place, the write index never passes the read index
+    uint16_t r = start, w = start, k = 0;
+    while( r < end) {
+        uint16_t len, targetAt;
+        if( k < numFused && r == fusedAt[ k]) {
+            const PeepholePattern& p = s_peephole[ fusedAs[ k++]];
+            uint16_t literal = p.literal < 0 ? 0 : code[ r + p.literal];
+            uint16_t target = p.target < 0 ? 0 : code[ r + p.target];
+            code[ w] = p.fused;
+            targetAt = 0;
+            if( p.literal >= 0) {
+                code[ w + 1] = literal;
+            }
+            if( p.target >= 0) {
+                targetAt = w + p.fusedLength - 1;
+                code[ targetAt] = target;
+            }
+            len = p.fusedLength;
+            r += p.length;
+        } else {
+            len = instructionLength( code, r, end);
+            uint16_t offset = jumpTargetOffset( code[ r]);
+            for( uint16_t i = 0; i < len; i++) {
+                code[ w + i] = code[ r + i];
+            }
+            targetAt = offset == 0 ? 0 : w + offset;
+            r += len;
+        }
+        if( targetAt != 0) {
+            uint16_t target = code[ targetAt] & YRSHELL_DICTIONARY_ADDRESS_MASK;
+            if( target >= start && target <= end) {
+                uint16_t removed = 0;
+                for( uint16_t i = 0; i < numFused && fusedAt[ i] < target; i++) {
+                    removed += s_peephole[ fusedAs[ i]].length - s_peephole[ fusedAs[ i]].fusedLength;
+                }
+                code[ targetAt] = (code[ targetAt] & ~YRSHELL_DICTIONARY_ADDRESS_MASK) | (target - removed);
+            }
+        }
+        w += len;
+    }
+    code[ w] = YRShellInterpreter::SI_CC_return;
+    m_dictionaryCurrentWordEnd = w;
+}
+/*
+ The index holds the committed entries, those reachable from m_dictionaryBackupLastWord. find() skips the entry
+ being compiled, it searches from the link of m_lastWord while there is one, and from m_lastWord otherwise.
+ */
 uint16_t CurrentVariableDictionary::find( const char* name) {
     uint16_t rc = YRSHELL_DICTIONARY_INVALID;
     if( m_lastWord != YRSHELL_DICTIONARY_INVALID) {
-        uint16_t link = m_dictionary[ m_lastWord];
-        rc = findInternal( name, link);
+        // The entry being compiled is not visible, a line compiled into a line region has none
+        bool hide = m_lastWord != m_dictionaryBackupLastWord;
+        uint16_t link = hide ? m_dictionary[ m_lastWord] : m_lastWord;
+        if( m_indexFull || !m_index.isValid()) {
+            rc = findInternal( name, link);
+        } else {
+            rc = findIndexedEntry( name);
+            if( hide && rc != YRSHELL_DICTIONARY_INVALID && (uint16_t) ((rc & ~m_mask) - 1) == m_lastWord) {
+                rc = findInternal( name, link);
+            } else if( rc != YRSHELL_DICTIONARY_INVALID) {
+                rc += Dictionary::nameLength(name);
+            }
+        }
+    }
+    return rc;
+}
+uint16_t CurrentVariableDictionary::findEntry( const char* name) {
+    uint16_t rc = YRSHELL_DICTIONARY_INVALID;
+    if( m_lastWord != YRSHELL_DICTIONARY_INVALID) {
+        if( m_indexFull || !m_index.isValid()) {
+            rc = findInternalEntry( name, m_lastWord);
+        } else if( m_lastWord != m_dictionaryBackupLastWord && !strcmp( (const char*) &m_dictionary[ m_lastWord + 1], name)) {
+            rc = m_mask | (m_lastWord + 1);
+        } else {
+            rc = findIndexedEntry( name);
+        }
     }
     return rc;
 }
@@ -251,9 +736,9 @@ uint16_t CurrentVariableDictionary::getFirstEntry( ) {
     return m_dictionaryBackupLastWord;
 }
 uint16_t CurrentVariableDictionary::getWord( uint16_t index) {
-    return index < m_dictionaryCurrentWordEnd ? m_dictionary[ index] : YRSHELL_DICTIONARY_INVALID;
+    return isReadable( index) ? m_dictionary[ index] : YRSHELL_DICTIONARY_INVALID;
 }
 const char* CurrentVariableDictionary::getAddress( uint16_t index) {
-    return index < m_dictionaryCurrentWordEnd ? (const char*) &m_dictionary[ index] : NULL;
+    return isReadable( index) ? (const char*) &m_dictionary[ index] : NULL;
 }
 
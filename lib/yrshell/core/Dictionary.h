@@ -10,6 +10,7 @@
 #include "YRShellDefines.h"
 
 class YRShellInterpreter;
+class Dictionary;
 
 class DictionaryError {
 public:
@@ -84,6 +85,11 @@ public:
      Will be handled by subclasses as applicable.
      */
     virtual uint16_t findEntry( const char* name) {return 0;}
+    /** \brief Returns the code array and sets end to the first index that is not valid.
+
+     Returns NULL for dictionaries that hold functions rather than code.
+     */
+    virtual const uint16_t* getCode( uint16_t* end) { return NULL; }
     /** \brief Error routine for dictionaries
      
      Error routine for dictionaries.
@@ -94,6 +100,57 @@ public:
      All strings (includes trminating 0) in the dictionaries are stored as a sequence uint16_t words. This returns the number of words necessary to store the string.
      */
     static uint16_t nameLength( const char* name) { size_t len = strlen( name) + 1; return (uint16_t) (len/2 + (len & 1)); }
+    /** \brief CRC-32 (IEEE) of len bytes, continuing from crc.
+
+     Start with a crc of 0. Used to check that stored dictionary images still match their source.
+     */
+    static uint32_t crc32( uint32_t crc, const void* data, uint32_t len);
+};
+
+/** \brief Hash index from names to dictionary entries.
+
+Open addressing with linear probing. Each slot holds an entry value and 8 more bits of the hash, so a probe
+only compares strings when the bits match. The names are not copied, the owning dictionary's getAddress( value)
+returns the name of an entry. Inserts fail once the table is 3/4 full, the dictionary then falls back to a
+linear search.
+*/
+class DictionaryIndex {
+protected:
+    uint16_t*   m_values;   /**< Entry per slot, YRSHELL_DICTIONARY_INVALID when empty. */
+    uint8_t*    m_tags;     /**< Upper hash bits per slot. */
+    uint16_t    m_slots;    /**< Number of slots, a power of 2. */
+    uint16_t    m_count;    /**< Number of used slots. */
+public:
+    DictionaryIndex( void);
+    /** \brief Uses caller provided storage of slots entries, slots must be a power of 2.
+     */
+    void init( uint16_t* values, uint8_t* tags, uint16_t slots);
+    /** \brief Uses a prebuilt table of slots entries, count of them used. The table is not cleared or written.
+     */
+    void attach( const uint16_t* values, const uint8_t* tags, uint16_t slots, uint16_t count);
+    /** \brief Allocates storage for at least entries entries. Returns false if there is no memory.
+     */
+    bool allocate( uint16_t entries);
+    void clear( void);
+    inline bool isValid( void) { return m_values != NULL; }
+    inline uint16_t getCount( void) { return m_count; }
+    inline uint16_t getSlots( void) { return m_slots; }
+    inline const uint16_t* getValues( void) { return m_values; }
+    inline const uint8_t* getTags( void) { return m_tags; }
+    /** \brief Returns the value of the entry named name, YRSHELL_DICTIONARY_INVALID if there is none.
+     */
+    uint16_t find( Dictionary* d, const char* name, uint32_t h);
+    /** \brief Adds an entry. An existing entry of the same name is kept unless replace is set.
+
+    Returns false if the table is too full.
+    */
+    bool insert( Dictionary* d, const char* name, uint32_t h, uint16_t value, bool replace);
+    /** \brief FNV-1a hash of a name.
+     */
+    static uint32_t hash( const char* name);
+    /** \brief Returns the number of slots used for a dictionary of size words, at least 16 and a power of 2.
+     */
+    static constexpr uint16_t slotsFor( unsigned size, uint16_t slots = 16) { return slots >= size / 4 ? slots : slotsFor( size, (uint16_t) (slots * 2)); }
 };
 
 /** \brief Maps from text to a function number.
@@ -118,6 +175,7 @@ class FunctionDictionary : public Dictionary  {
 protected:
     const       FunctionEntry* M_dictionary;    /**< Pointer to the array of FunctionEntry */
     uint16_t    m_size;                         /**< The size of the FunctionEntry array. */
+    DictionaryIndex m_index;                    /**< Name index, built by the constructor. */
 public:
     FunctionDictionary( const FunctionEntry* dict, uint16_t mask);   
     /** \brief Returns an index pointing to the first dictionary entry.
@@ -166,6 +224,15 @@ protected:
     uint16_t*   m_dictionary;       /**< Pointer to the array of uint16_t which is the compiled dictionary. */
     uint16_t    m_lastWord;         /**< Index of the last entry in the dictionary*/
     uint16_t    m_size;             /**< The size of the dictionary. */
+    mutable DictionaryIndex m_index;    /**< Name index, values are name addresses ( link + 1). */
+    mutable bool m_indexBuilt;          /**< The index has been built or is not used. */
+
+    /** \brief Builds the index of a read only dictionary on the first lookup.
+     */
+    void buildIndex( void);
+    /** \brief Looks name up in the index. Returns the name address token or YRSHELL_DICTIONARY_INVALID.
+     */
+    uint16_t findIndexedEntry( const char* name);
     
     /** \brief Given a name, returns an execution token for the corresponding entry.
      
@@ -181,6 +248,15 @@ public:
     CompiledDictionary( void);
     CompiledDictionary( const uint16_t* dict, uint16_t lastWord, uint16_t size, uint16_t mask);
     uint16_t getSize( void) { return m_size; }
+    /** \brief Replaces the contents with a dictionary image, the index is rebuilt on the next lookup.
+     */
+    void setDictionary( const uint16_t* dict, uint16_t lastWord, uint16_t size);
+    /** \brief Uses a prebuilt index for the current contents, see DictionaryIndex::attach().
+     */
+    void setIndex( const uint16_t* values, const uint8_t* tags, uint16_t slots, uint16_t count);
+    /** \brief Returns the name index, building it if needed.
+     */
+    DictionaryIndex& getIndex( void);
     
     /** \brief Returns an index pointing to the first dictionary entry.
 
@@ -229,6 +305,7 @@ public:
     Returns an index past the last entry in the dictionary.
     */
     uint16_t getWordEnd( void);
+    const uint16_t* getCode( uint16_t* end) { *end = m_size; return m_dictionary; }
 };
 
 
@@ -241,6 +318,23 @@ protected:
     uint16_t    m_dictionaryBackupLastWord;
     uint16_t    m_dictionaryBackupWordEnd;
     uint16_t    m_dictionaryCurrentWordEnd;
+    bool        m_indexFull;        /**< The index overflowed, lookups walk the chain until reset. */
+    bool        m_optimize;         /**< Fuse superinstructions when a word is finished. */
+    uint32_t    m_generation;       /**< Changes whenever the committed entries do. */
+    uint16_t    m_wordLimit;        /**< End of the space for entries, line regions are reserved above it. */
+    uint16_t    m_lineLimit;        /**< End of the line region being compiled into, 0 when compiling at the end. */
+
+    inline bool isReadable( uint16_t index) { return index < m_dictionaryCurrentWordEnd || (index >= m_wordLimit && index < m_size); }
+
+    /** \brief Adds the entry at link to the index, it hides older entries of the same name.
+     */
+    void indexEntry( uint16_t link);
+    /** \brief Peephole pass over the word being finished.
+
+     Replaces common token sequences with YRShellInterpreter superinstructions, compacts the word and
+     relocates the jumps inside it. Sequences that contain a jump target are left alone.
+     */
+    void optimizeWord( void);
     
 public:
     CurrentVariableDictionary( void);
@@ -259,8 +353,21 @@ public:
     Given a name, returns a token for the corresponding entry. Returns YRSHELL_DICTIONARY_INVALID if a corresponding entry is not found.
     */
     uint16_t find( const char* name);
+    /** \brief Given a name, returns a name token for the corresponding entry, including the one being compiled.
+     */
+    uint16_t findEntry( const char* name);
     
     bool newCompile( const char* name);
+    /** \brief Starts compiling a command line into the region from base to limit, reserved with reserve().
+
+    The line gets no entry, rollBack() ends it. Used when several execution contexts have lines running at once.
+    */
+    bool newLine( uint16_t base, uint16_t limit);
+    /** \brief Takes words off the top of the dictionary for a line region, returns its base.
+
+    Returns YRSHELL_DICTIONARY_INVALID if the entries already reach that far. The region stays reserved across reset().
+    */
+    uint16_t reserve( uint16_t words);
     bool addToken( uint16_t token);
     bool setToken( uint16_t address, uint16_t token);
     void rollBack( void);
@@ -269,15 +376,35 @@ public:
     inline uint16_t getWordEnd( void) { return m_dictionaryCurrentWordEnd; }
     inline uint16_t getBackupLastWord( void) { return m_dictionaryBackupLastWord; }
     inline uint16_t getBackupWordEnd( void) { return m_dictionaryBackupWordEnd; }
+    /** \brief Returns the code, end is past the last readable word, which includes the line regions.
+     */
+    const uint16_t* getCode( uint16_t* end) { *end = m_wordLimit < m_size ? m_size : m_dictionaryCurrentWordEnd; return m_dictionary; }
+    inline void setOptimize( bool s) { m_optimize = s; }
+    inline bool getOptimize( void) { return m_optimize; }
+    /** \brief Returns a value that changes whenever a word is added, the dictionary is reset or restored.
+     */
+    inline uint32_t getGeneration( void) { return m_generation; }
     
     virtual void reset( void);
+    /** \brief Rebuilds the name index from the committed entries.
+
+    Needed when the dictionary contents are replaced without going through newCompile().
+    */
+    void rebuildIndex( void);
+    /** \brief Replaces the contents with end words of code whose newest entry is lastWord.
+
+    Returns false, leaving the dictionary alone, if the code does not fit or lastWord is not inside it.
+    */
+    bool restore( const uint16_t* code, uint16_t end, uint16_t lastWord);
 
 };
 
-template<unsigned SHELL_DICTIONARY_SIZE>
+template<unsigned SHELL_DICTIONARY_SIZE, uint16_t INDEX_SLOTS = DictionaryIndex::slotsFor( SHELL_DICTIONARY_SIZE)>
 class CurrentDictionary  : public CurrentVariableDictionary  {
 protected:
     uint16_t    m_dictionaryBuffer[ SHELL_DICTIONARY_SIZE];
+    uint16_t    m_indexValues[ INDEX_SLOTS];
+    uint8_t     m_indexTags[ INDEX_SLOTS];
 public:
     CurrentDictionary( void) {
         reset();
@@ -286,6 +413,7 @@ public:
         m_mask = YRSHELL_DICTIONARY_CURRENT;
         m_size = SHELL_DICTIONARY_SIZE;
         m_dictionary = m_dictionaryBuffer;
+        m_index.init( m_indexValues, m_indexTags, INDEX_SLOTS);
         CurrentVariableDictionary::reset( );
     }
     
@@ -1,5 +1,10 @@
 #include "HardwareSpecific.h"
+
+#if defined( ESP32)
+
 #include <esp32-hal.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 uint32_t HW_getSysticks() {
     return (uint32_t)(esp_timer_get_time()); 
@@ -13,5 +18,48 @@ uint32_t HW_getMillis() {
 uint32_t HW_getSysTicksPerSecond( ) {
 	return 1000000;
 }
+bool HW_startTask( const char* name, HW_taskFunction fn, void* arg, uint8_t core, uint32_t stackSize, uint8_t priority) {
+    return xTaskCreatePinnedToCore( fn, name, stackSize, arg, priority, NULL, core) == pdPASS;
+}
+void HW_yield( ) {
+    // Lets the idle task on this core run so the task watchdog is fed
+    vTaskDelay( 1);
+}
+uint8_t HW_getCore( ) {
+    return (uint8_t) xPortGetCoreID();
+}
 
+#else
+
+#include <chrono>
+#include <thread>
+
+static uint64_t HW_getNanos() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start).count();
+}
+uint32_t HW_getSysticks() {
+    return (uint32_t)(HW_getNanos() / 1000ULL);
+}
+uint32_t HW_getMicros() {
+    return (uint32_t)(HW_getNanos() / 1000ULL);
+}
+uint32_t HW_getMillis() {
+    return (uint32_t)(HW_getNanos() / 1000000ULL);
+}
+uint32_t HW_getSysTicksPerSecond( ) {
+	return 1000000;
+}
+bool HW_startTask( const char* name, HW_taskFunction fn, void* arg, uint8_t core, uint32_t stackSize, uint8_t priority) {
+    // Core affinity, stack size and priority are left to the host scheduler
+    std::thread( fn, arg).detach();
+    return true;
+}
+void HW_yield( ) {
+    std::this_thread::yield();
+}
+uint8_t HW_getCore( ) {
+    return 0;
+}
 
+#endif
@@ -11,4 +11,10 @@ uint32_t HW_getMillis( void);
 
 uint32_t HW_getSysTicksPerSecond( void);
 
+typedef void (*HW_taskFunction)( void* arg);
+
+bool HW_startTask( const char* name, HW_taskFunction fn, void* arg, uint8_t core, uint32_t stackSize, uint8_t priority);
+void HW_yield( void);
+uint8_t HW_getCore( void);
+
 #endif
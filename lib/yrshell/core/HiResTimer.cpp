@@ -9,6 +9,9 @@ void HiResTimer::reset( ){
     m_max = 0;
     m_count = 0;
     m_timerValid = false;
+    for( uint8_t i = 0; i < HIRES_TIMER_BUCKETS; i++) {
+        m_buckets[ i] = 0;
+    }
 }
 void HiResTimer::start( ){
     if( !m_timerValid) {
@@ -16,10 +19,15 @@ void HiResTimer::start( ){
         m_timerValid = true;
     }
 }
-void HiResTimer::stop( ){
+/** \brief Stops the timer and records the elapsed time.
+
+ Returns the elapsed systicks, 0 if the timer was not started.
+ */
+uint32_t HiResTimer::stop( ){
+    uint32_t elapsed = 0;
     if( m_timerValid) {
         m_count++;
-        uint32_t elapsed =  getSysticks() - m_timer;
+        elapsed =  getSysticks() - m_timer;
         if( elapsed < m_min) {
             m_min = elapsed;
         }
@@ -27,20 +35,50 @@ void HiResTimer::stop( ){
             m_max = elapsed;
         }
         m_accumulator += (uint64_t) elapsed;
+        m_buckets[ bucketIndex( elapsed)]++;
         m_timerValid = false;
     }
+    return elapsed;
 }
 uint32_t HiResTimer::getCount( ) {
     return m_count;
 }
 uint32_t HiResTimer::getMin( ) {
-    return m_min;
+    return m_count == 0 ? 0 : m_min;
 }
 uint32_t HiResTimer::getMax( ) {
     return m_max;
 }
 uint32_t HiResTimer::getAverage( ) {
-    return (uint32_t) (m_accumulator / ((uint64_t) m_count));
+    return m_count == 0 ? 0 : (uint32_t) (m_accumulator / ((uint64_t) m_count));
+}
+/** \brief Returns the time below which percent of the measurements fall.
+
+ Returns the upper edge of the histogram bucket holding the percentile, limited to the maximum time seen.
+ Returns 0 if nothing was measured.
+ */
+uint32_t HiResTimer::getPercentile( uint8_t percent) {
+    uint32_t rc = 0;
+    if( m_count > 0) {
+        uint64_t target = ((uint64_t) m_count * (percent > 100 ? 100 : percent) + 99) / 100;
+        uint64_t seen = 0;
+        uint8_t i;
+        for( i = 0; i < HIRES_TIMER_BUCKETS - 1; i++) {
+            seen += m_buckets[ i];
+            if( seen >= target) {
+                break;
+            }
+        }
+        rc = i == 0 ? 0 : (i == HIRES_TIMER_BUCKETS - 1 ? m_max : (uint32_t) ((1ULL << i) - 1));
+        if( rc > m_max) {
+            rc = m_max;
+        }
+    }
+    return rc;
+}
+uint8_t HiResTimer::bucketIndex( uint32_t elapsed) {
+    uint8_t rc = elapsed == 0 ? 0 : (uint8_t) (32 - __builtin_clz( elapsed));
+    return rc < HIRES_TIMER_BUCKETS ? rc : HIRES_TIMER_BUCKETS - 1;
 }
 
 uint32_t HiResTimer::getSysticks() {
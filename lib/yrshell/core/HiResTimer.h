@@ -5,8 +5,19 @@
 
 #include <stdint.h>
 #include <stddef.h>
+
+#ifndef HIRES_TIMER_BUCKETS
+#define HIRES_TIMER_BUCKETS 20  /**< Number of log2 histogram buckets, the last one holds everything longer. */
+#endif
+
+/** \brief HiResTimer - times an operation in systicks
+
+ Keeps count, min, max and average of the measured times and a log2 bucketed histogram. Bucket 0 counts
+ times of 0, bucket n counts times from 2^(n-1) to 2^n - 1, so percentiles are accurate to a factor of 2.
+ */
 class HiResTimer {
 protected:
+    uint32_t m_buckets[ HIRES_TIMER_BUCKETS];
     uint64_t m_accumulator;
     uint32_t m_timer;
     uint32_t m_min;
@@ -17,12 +28,16 @@ public:
     HiResTimer( void);
     void reset( void);
     void start( void);
-    void stop( void);
- 
+    uint32_t stop( void);
+
     uint32_t getCount( void);
     uint32_t getMin( void);
     uint32_t getMax( void);
     uint32_t getAverage( void);
+    uint32_t getPercentile( uint8_t percent);
+    uint32_t getBucket( uint8_t n) { return n < HIRES_TIMER_BUCKETS ? m_buckets[ n] : 0; }
+
+    static uint8_t bucketIndex( uint32_t elapsed);
 
     static uint32_t getSysticks( void);
     static uint32_t getMicros( void);
@@ -20,3 +20,7 @@ void IntervalTimer::setInterval( unsigned intervalInMilliSeconds) {
 bool IntervalTimer::hasIntervalElapsed( void) {
     return (HiResTimer::getMillis() - m_start) >= m_interval;
 }
+unsigned IntervalTimer::getRemaining( void) {
+    unsigned elapsed = HiResTimer::getMillis() - m_start;
+    return elapsed >= m_interval ? 0 : m_interval - elapsed;
+}
@@ -11,6 +11,7 @@ public:
     void setInterval( unsigned intervalInMilliSeconds);
     bool hasIntervalElapsed( void);
     bool isNextInterval(void);
+    unsigned getRemaining(void);
 };
 
 #endif
@@ -0,0 +1,77 @@
+#include "LineCache.h"
+#include "Dictionary.h"
+
+#define LINE_CACHE_NONE 0xFF
+
+LineCacheBase::LineCacheBase( ) {
+    m_entries = NULL;
+    m_slots = NULL;
+    m_numEntries = 0;
+    m_slotWords = 0;
+    m_pending = LINE_CACHE_NONE;
+    m_clock = 0;
+    m_hits = 0;
+    m_misses = 0;
+}
+LineCacheBase::~LineCacheBase( ) {
+}
+void LineCacheBase::clear( ) {
+    for( uint8_t i = 0; i < m_numEntries; i++) {
+        m_entries[ i].m_codeSize = 0;
+        m_entries[ i].m_lastUse = 0;
+    }
+    m_pending = LINE_CACHE_NONE;
+}
+const uint16_t* LineCacheBase::find( const char* line, uint32_t generation, uint16_t start, uint16_t* size) {
+    const uint16_t* rc = NULL;
+    uint32_t h = DictionaryIndex::hash( line);
+    uint16_t textWords = (uint16_t) (strlen( line) / 2 + 1);
+    uint8_t victim = LINE_CACHE_NONE;
+    m_pending = LINE_CACHE_NONE;
+    for( uint8_t i = 0; i < m_numEntries; i++) {
+        LineCacheEntry* e = &m_entries[ i];
+        if( e->m_codeSize != 0 && e->m_hash == h && e->m_textWords == textWords && !strcmp( (const char*) slot( i), line)) {
+            if( e->m_generation == generation && e->m_start == start) {
+                e->m_lastUse = ++m_clock;
+                *size = e->m_codeSize;
+                rc = slot( i) + textWords;
+            } else {
+                // Compiled against another dictionary, recompile in place
+                victim = i;
+            }
+            break;
+        }
+        // An empty entry, otherwise the least recently used
+        if( victim == LINE_CACHE_NONE || (m_entries[ victim].m_codeSize != 0 && (e->m_codeSize == 0 || e->m_lastUse < m_entries[ victim].m_lastUse))) {
+            victim = i;
+        }
+    }
+    if( rc != NULL) {
+        m_hits++;
+    } else {
+        m_misses++;
+        if( victim != LINE_CACHE_NONE && textWords < m_slotWords && textWords <= 0xFF) {
+            LineCacheEntry* e = &m_entries[ victim];
+            slot( victim)[ textWords - 1] = 0;
+            strcpy( (char*) slot( victim), line);
+            e->m_hash = h;
+            e->m_textWords = (uint8_t) textWords;
+            e->m_codeSize = 0;
+            e->m_generation = generation;
+            e->m_start = start;
+            e->m_lastUse = ++m_clock;
+            m_pending = victim;
+        }
+    }
+    return rc;
+}
+void LineCacheBase::add( const uint16_t* code, uint16_t size) {
+    if( m_pending != LINE_CACHE_NONE) {
+        LineCacheEntry* e = &m_entries[ m_pending];
+        if( size > 0 && e->m_textWords + size <= m_slotWords) {
+            memcpy( slot( m_pending) + e->m_textWords, code, size * sizeof( uint16_t));
+            e->m_codeSize = size;
+        }
+        m_pending = LINE_CACHE_NONE;
+    }
+}
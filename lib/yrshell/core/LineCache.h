@@ -0,0 +1,77 @@
+#ifndef LineCache_h
+#define LineCache_h
+
+#include "HardwareSpecific.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/** \brief One line in a LineCacheBase.
+ */
+typedef struct {
+    uint32_t    m_hash;         /**< DictionaryIndex::hash() of the line. */
+    uint32_t    m_lastUse;      /**< LineCacheBase clock when last found, the oldest entry is replaced. */
+    uint32_t    m_generation;   /**< CurrentVariableDictionary::getGeneration() when compiled. */
+    uint16_t    m_start;        /**< Current dictionary address the code was compiled at. */
+    uint16_t    m_codeSize;     /**< Words of code after the text, 0 while the line is being compiled. */
+    uint8_t     m_textWords;    /**< Words used by the text, including the terminator. */
+} LineCacheEntry;
+
+/** \brief LRU cache of the code compiled for command lines.
+
+The interpreter compiles every command line into the current dictionary, runs it and rolls it back. With a
+cache set, a line seen before is copied in as compiled code instead of being tokenized and looked up again.
+The code refers to the current dictionary by absolute address, so an entry is only used at the same address
+and with the same dictionary generation it was compiled with.
+
+Each entry has a slot of the same size holding the text followed by the code, a line that does not fit is
+not cached. Not meant to be instantiated, see LineCache.
+*/
+class LineCacheBase {
+protected:
+    LineCacheEntry* m_entries;
+    uint16_t*       m_slots;
+    uint8_t         m_numEntries;
+    uint16_t        m_slotWords;
+    uint8_t         m_pending;      /**< Entry reserved by find() for the line being compiled. */
+    uint32_t        m_clock;
+    uint32_t        m_hits;
+    uint32_t        m_misses;
+
+    inline uint16_t* slot( uint8_t i) { return m_slots + i * m_slotWords; }
+
+public:
+    LineCacheBase( void);
+    virtual ~LineCacheBase( void);
+    /** \brief Looks up line, returns its code and sets size, or NULL.
+
+    On a miss the least recently used entry is reserved for the line, call add() once it has compiled.
+    */
+    const uint16_t* find( const char* line, uint32_t generation, uint16_t start, uint16_t* size);
+    /** \brief Stores the code for the line passed to the last find() that missed.
+     */
+    void add( const uint16_t* code, uint16_t size);
+    /** \brief Drops every entry.
+     */
+    void clear( void);
+    inline uint32_t getHits( void) { return m_hits; }
+    inline uint32_t getMisses( void) { return m_misses; }
+};
+
+template<uint8_t ENTRIES, uint16_t SLOT_WORDS>
+class LineCache : public LineCacheBase {
+protected:
+    LineCacheEntry  m_entryBuffer[ ENTRIES];
+    uint16_t        m_slotBuffer[ ENTRIES * SLOT_WORDS];
+public:
+    LineCache( void) {
+        m_entries = m_entryBuffer;
+        m_slots = m_slotBuffer;
+        m_numEntries = ENTRIES;
+        m_slotWords = SLOT_WORDS;
+        clear();
+    }
+    virtual ~LineCache( void) { }
+};
+
+#endif
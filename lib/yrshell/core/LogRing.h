@@ -0,0 +1,198 @@
+#ifndef LogRing_h
+#define LogRing_h
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+/** \brief LogRing - a record oriented ring for many writers and one reader
+
+ LogRing stores length framed records. Any number of tasks may call write() concurrently, space for each record
+ is reserved with a compare and swap on the head counter, so no lock is taken. One reader drains whole records
+ with read(), a record is never returned partially written or torn.
+
+ When a record does not fit, the oldest committed records are evicted to make room and counted in getDropped().
+ If the oldest record is still being written by another task the new record is dropped instead.
+
+ Storage is in 32 bit words, SIZE is in bytes and must be a power of 2. Each record has a 2 word header, the
+ position tag and the length, and the payload is padded to 8 bytes so a header never wraps. A record is visible
+ once its tag word is stored with release ordering and matches the position it was reserved at.
+
+ Examples:
+ LogRing<8192>   logRing;
+ */
+template<uint32_t SIZE>
+class LogRing {
+    static_assert( SIZE >= 64 && (SIZE & (SIZE - 1)) == 0, "LogRing SIZE must be a power of 2");
+public:
+    static const uint32_t MAX_RECORD = SIZE / 2 < 0xFFFF ? SIZE / 2 : 0xFFFF; /**< Largest payload in bytes. */
+protected:
+    static const uint32_t WORDS = SIZE / 4;
+    static const uint32_t MASK = WORDS - 1;
+    static const uint32_t HEADER_WORDS = 2;
+    static const uint32_t EMPTY_TAG = 0xFFFFFFFF;
+
+    std::atomic<uint32_t> m_head; /**< Word count reserved by writers. */
+    std::atomic<uint32_t> m_tail; /**< Word count consumed by the reader or evicted by writers. */
+    std::atomic<uint32_t> m_dropped; /**< Records evicted or rejected. */
+    uint32_t m_buf[WORDS]; /**< Record storage. */
+
+    static uint32_t recordWords( uint32_t len) {
+        return HEADER_WORDS + ((len + 7) / 8) * 2;
+    }
+    static uint32_t lengthWord( uint32_t pos, uint32_t len) {
+        return len | ((len ^ pos ^ 0xA55A) << 16);
+    }
+    uint32_t loadTag( uint32_t pos) {
+        return __atomic_load_n( &m_buf[pos & MASK], __ATOMIC_ACQUIRE);
+    }
+    /** \brief Returns the payload length of the committed record at pos, 0 if there is none.
+     */
+    uint32_t committedLength( uint32_t pos) {
+        uint32_t rc = 0;
+        if( loadTag( pos) == pos) {
+            uint32_t w = m_buf[(pos + 1) & MASK];
+            uint32_t len = w & 0xFFFF;
+            if( w == lengthWord( pos, len) && len > 0 && len <= MAX_RECORD) {
+                rc = len;
+            }
+        }
+        return rc;
+    }
+    void copyIn( uint32_t pos, const char* src, uint32_t len) {
+        uint32_t i = (pos & MASK) * 4;
+        uint32_t l = SIZE - i;
+        if( l > len) {
+            l = len;
+        }
+        memcpy( ((char*) m_buf) + i, src, l);
+        if( len > l) {
+            memcpy( m_buf, src + l, len - l);
+        }
+    }
+    void copyOut( uint32_t pos, char* dst, uint32_t len) {
+        uint32_t i = (pos & MASK) * 4;
+        uint32_t l = SIZE - i;
+        if( l > len) {
+            l = len;
+        }
+        memcpy( dst, ((char*) m_buf) + i, l);
+        if( len > l) {
+            memcpy( dst + l, m_buf, len - l);
+        }
+    }
+    /** \brief Evicts the oldest record at t. Returns false if it is still being written.
+     */
+    bool evict( uint32_t t) {
+        bool rc = false;
+        uint32_t len = committedLength( t);
+        if( len > 0) {
+            rc = true;
+            if( m_tail.compare_exchange_strong( t, t + recordWords( len), std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                m_dropped.fetch_add( 1, std::memory_order_relaxed);
+            }
+        } else if( m_tail.load( std::memory_order_acquire) != t) {
+            // Somebody else freed the record in the meantime
+            rc = true;
+        }
+        return rc;
+    }
+
+public:
+    /** \brief Constructor.
+
+     Default constructor, no parameters are required.
+     */
+    LogRing() {
+        reset();
+    }
+    /** \brief Clears the ring.
+
+     Clears the ring and the dropped counter. Not thread safe.
+     */
+    void reset() {
+        for( uint32_t i = 0; i < WORDS; i++) {
+            m_buf[i] = EMPTY_TAG;
+        }
+        m_head.store( 0, std::memory_order_relaxed);
+        m_dropped.store( 0, std::memory_order_relaxed);
+        m_tail.store( 0, std::memory_order_release);
+    }
+    /** \brief Writes a record.
+
+     Writes len bytes as one record, evicting the oldest records if needed. Safe to call from several tasks.
+     Returns false if the record was dropped.
+     */
+    bool write( const char* p, uint32_t len) {
+        if( len == 0 || len > MAX_RECORD) {
+            m_dropped.fetch_add( 1, std::memory_order_relaxed);
+            return false;
+        }
+        uint32_t need = recordWords( len);
+        uint32_t h = m_head.load( std::memory_order_relaxed);
+        for( ;;) {
+            uint32_t t = m_tail.load( std::memory_order_acquire);
+            if( h + need - t <= WORDS) {
+                if( m_head.compare_exchange_weak( h, h + need, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else {
+                if( !evict( t)) {
+                    m_dropped.fetch_add( 1, std::memory_order_relaxed);
+                    return false;
+                }
+                h = m_head.load( std::memory_order_relaxed);
+            }
+        }
+        copyIn( h + HEADER_WORDS, p, len);
+        m_buf[(h + 1) & MASK] = lengthWord( h, len);
+        __atomic_store_n( &m_buf[h & MASK], h, __ATOMIC_RELEASE);
+        return true;
+    }
+    /** \brief Returns the length of the next record, 0 if there is no complete record.
+
+     Reader side.
+     */
+    uint32_t peekLength() {
+        uint32_t t = m_tail.load( std::memory_order_acquire);
+        uint32_t rc = 0;
+        if( m_head.load( std::memory_order_acquire) != t) {
+            rc = committedLength( t);
+        }
+        return rc;
+    }
+    /** \brief Reads the next record.
+
+     Copies the next record into dst and removes it. A record longer than max is truncated.
+     Returns the number of bytes copied, 0 if no complete record is available. Reader side.
+     */
+    uint32_t read( char* dst, uint32_t max) {
+        uint32_t t = m_tail.load( std::memory_order_acquire);
+        uint32_t len = 0;
+        if( m_head.load( std::memory_order_acquire) != t) {
+            len = committedLength( t);
+        }
+        if( len > 0) {
+            copyOut( t + HEADER_WORDS, dst, len < max ? len : max);
+            // If a writer evicted the record while it was copied the data may be torn, discard it
+            if( !m_tail.compare_exchange_strong( t, t + recordWords( len), std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                len = 0;
+            } else if( len > max) {
+                len = max;
+            }
+        }
+        return len;
+    }
+    /** \brief Returns true if no records are waiting.
+     */
+    bool empty() {
+        return m_head.load( std::memory_order_acquire) == m_tail.load( std::memory_order_acquire);
+    }
+    /** \brief Returns the number of records evicted or rejected since reset.
+     */
+    uint32_t getDropped() {
+        return m_dropped.load( std::memory_order_relaxed);
+    }
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "Profiler.h"
+
+ProfilerBase::ProfilerBase( ) {
+    m_entries = NULL;
+    m_order = NULL;
+    m_numEntries = 0;
+    m_used = 0;
+    m_sorted = 0;
+    m_enabled = false;
+    m_dropped = 0;
+    memset( m_topOfFrames, 0, sizeof( m_topOfFrames));
+}
+ProfilerBase::~ProfilerBase( ) {
+}
+void ProfilerBase::clear( ) {
+    for( uint16_t i = 0; i < m_numEntries; i++) {
+        m_entries[ i].m_token = YRSHELL_DICTIONARY_INVALID;
+    }
+    m_used = 0;
+    m_sorted = 0;
+    m_dropped = 0;
+    memset( m_topOfFrames, 0, sizeof( m_topOfFrames));
+}
+uint16_t ProfilerBase::entry( uint16_t token) {
+    uint16_t rc = YRSHELL_DICTIONARY_INVALID;
+    uint16_t i = (uint16_t) ((token * 40503u) % m_numEntries);
+    for( uint16_t n = 0; rc == YRSHELL_DICTIONARY_INVALID && n < m_numEntries; n++) {
+        ProfileEntry* e = &m_entries[ i];
+        if( e->m_token == token) {
+            rc = i;
+        } else if( e->m_token == YRSHELL_DICTIONARY_INVALID) {
+            e->m_token = token;
+            e->m_calls = 0;
+            e->m_inclusive = 0;
+            e->m_exclusive = 0;
+            m_used++;
+            rc = i;
+        } else if( ++i >= m_numEntries) {
+            i = 0;
+        }
+    }
+    if( rc == YRSHELL_DICTIONARY_INVALID) {
+        m_dropped++;
+    }
+    return rc;
+}
+void ProfilerBase::pop( uint8_t context, uint32_t now) {
+    ProfileFrame* f = &m_frames[ context][ --m_topOfFrames[ context]];
+    uint32_t t = now - f->m_start;
+    if( f->m_entry != YRSHELL_DICTIONARY_INVALID) {
+        ProfileEntry* e = &m_entries[ f->m_entry];
+        e->m_inclusive += t;
+        e->m_exclusive += t - f->m_children;
+    }
+    if( m_topOfFrames[ context] > 0) {
+        f[ -1].m_children += t;
+    }
+}
+void ProfilerBase::enter( uint8_t context, uint16_t token, uint8_t depth) {
+    uint32_t now = HW_getMicros();
+    if( context <= YRSHELL_MAX_CONTEXTS) {
+        while( m_topOfFrames[ context] > 0 && m_frames[ context][ m_topOfFrames[ context] - 1].m_depth >= depth) {
+            pop( context, now);
+        }
+        uint16_t i = entry( token);
+        if( i != YRSHELL_DICTIONARY_INVALID) {
+            m_entries[ i].m_calls++;
+        }
+        if( m_topOfFrames[ context] < YRSHELL_PROFILE_DEPTH) {
+            ProfileFrame* f = &m_frames[ context][ m_topOfFrames[ context]++];
+            f->m_entry = i;
+            f->m_depth = depth;
+            f->m_children = 0;
+            f->m_start = HW_getMicros();
+        } else {
+            m_dropped++;
+        }
+    }
+}
+void ProfilerBase::leave( uint8_t context, uint8_t depth) {
+    if( context <= YRSHELL_MAX_CONTEXTS && m_topOfFrames[ context] > 0 && m_frames[ context][ m_topOfFrames[ context] - 1].m_depth > depth) {
+        uint32_t now = HW_getMicros();
+        while( m_topOfFrames[ context] > 0 && m_frames[ context][ m_topOfFrames[ context] - 1].m_depth > depth) {
+            pop( context, now);
+        }
+    }
+}
+void ProfilerBase::function( uint8_t context, uint16_t token, uint32_t start) {
+    uint32_t t = HW_getMicros() - start;
+    uint16_t i = entry( token);
+    if( i != YRSHELL_DICTIONARY_INVALID) {
+        ProfileEntry* e = &m_entries[ i];
+        e->m_calls++;
+        e->m_inclusive += t;
+        e->m_exclusive += t;
+    }
+    if( context <= YRSHELL_MAX_CONTEXTS && m_topOfFrames[ context] > 0) {
+        m_frames[ context][ m_topOfFrames[ context] - 1].m_children += t;
+    }
+}
+void ProfilerBase::sort( ) {
+    m_sorted = 0;
+    for( uint16_t i = 0; i < m_numEntries; i++) {
+        if( m_entries[ i].m_token != YRSHELL_DICTIONARY_INVALID) {
+            uint16_t j = m_sorted++;
+            for( ; j > 0 && m_entries[ m_order[ j - 1]].m_exclusive < m_entries[ i].m_exclusive; j--) {
+                m_order[ j] = m_order[ j - 1];
+            }
+            m_order[ j] = i;
+        }
+    }
+}
+const ProfileEntry* ProfilerBase::getRanked( uint16_t n) {
+    // Ranked once per listing, a listing starts at 0
+    if( n == 0 || m_sorted == 0) {
+        sort();
+    }
+    return n < m_sorted ? &m_entries[ m_order[ n]] : NULL;
+}
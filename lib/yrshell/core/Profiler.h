@@ -0,0 +1,92 @@
+#ifndef Profiler_h
+#define Profiler_h
+
+#include "HardwareSpecific.h"
+#include "YRShellDefines.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/** \brief Time spent in one word, see ProfilerBase.
+ */
+typedef struct {
+    uint16_t    m_token;        /**< Absolute token of the word, YRSHELL_DICTIONARY_INVALID while the entry is free. */
+    uint32_t    m_calls;
+    uint32_t    m_inclusive;    /**< Microseconds from the call to the return, including the words it called. */
+    uint32_t    m_exclusive;    /**< Inclusive less the inclusive time of the words it called. */
+} ProfileEntry;
+
+/** \brief A compiled word that has been called and has not returned yet.
+ */
+typedef struct {
+    uint16_t    m_entry;        /**< Index of its ProfileEntry. */
+    uint8_t     m_depth;        /**< Return stack depth right after the call. */
+    uint32_t    m_start;
+    uint32_t    m_children;     /**< Inclusive microseconds of the words it called so far. */
+} ProfileFrame;
+
+/** \brief Call counts and microsecond times per word, collected by YRShellInterpreter::executeToken().
+
+Native functions are timed around the call, compiled words from the call to the return that brings the
+return stack back below the depth of the call, so words left by an error or a reset are closed by the next
+call or return. Times are wall clock, a word waiting in a delay or for output space counts the wait, and
+so does a context that another one interrupted. Each execution context has its own frames.
+
+Words are kept in a fixed table hashed on the token, calls that find it full are counted in getDropped().
+Not meant to be instantiated, see Profiler.
+*/
+class ProfilerBase {
+protected:
+    ProfileEntry*   m_entries;
+    uint16_t*       m_order;        /**< Entry indexes by exclusive time, built by sort(). */
+    uint16_t        m_numEntries;
+    uint16_t        m_used;
+    uint16_t        m_sorted;       /**< Entries in m_order. */
+    bool            m_enabled;
+    uint32_t        m_dropped;
+    ProfileFrame    m_frames[ YRSHELL_MAX_CONTEXTS + 1][ YRSHELL_PROFILE_DEPTH];
+    uint8_t         m_topOfFrames[ YRSHELL_MAX_CONTEXTS + 1];
+
+    uint16_t entry( uint16_t token);
+    void pop( uint8_t context, uint32_t now);
+    void sort( void);
+
+public:
+    ProfilerBase( void);
+    virtual ~ProfilerBase( void);
+    /** \brief Called with the return stack depth after a compiled word was called.
+     */
+    void enter( uint8_t context, uint16_t token, uint8_t depth);
+    /** \brief Closes the compiled words of context deeper than the return stack depth.
+     */
+    void leave( uint8_t context, uint8_t depth);
+    /** \brief Records a native function that started at start.
+     */
+    void function( uint8_t context, uint16_t token, uint32_t start);
+    /** \brief Returns the entry with the n-th most exclusive time, or NULL.
+     */
+    const ProfileEntry* getRanked( uint16_t n);
+    /** \brief Drops every entry and open call.
+     */
+    void clear( void);
+    void enable( bool s) { m_enabled = s; }
+    inline bool isEnabled( void) { return m_enabled; }
+    inline uint32_t getDropped( void) { return m_dropped; }
+};
+
+template<uint16_t ENTRIES>
+class Profiler : public ProfilerBase {
+protected:
+    ProfileEntry    m_entryBuffer[ ENTRIES];
+    uint16_t        m_orderBuffer[ ENTRIES];
+public:
+    Profiler( void) {
+        m_entries = m_entryBuffer;
+        m_order = m_orderBuffer;
+        m_numEntries = ENTRIES;
+        clear();
+    }
+    virtual ~Profiler( void) { }
+};
+
+#endif
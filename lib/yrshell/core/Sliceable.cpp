@@ -1,13 +1,23 @@
 #include "Sliceable.h"
+#include "Trace.h"
+
+#include <stdio.h>
 
 static SliceAllTimer sliceAllTimer;
 
 Sliceable* Sliceable::s_First = NULL;
-Sliceable* Sliceable::s_Current = NULL;
+Sliceable* Sliceable::s_Current[ SLICE_MAX_GROUPS];
 Sliceable* Sliceable::s_Last = NULL;
 Sliceable* Sliceable::s_Priority = NULL;
 SliceAllTimer* Sliceable::s_SliceAllTimer = &sliceAllTimer;
 uint32_t Sliceable::s_slowCounter = SLICE_SLOW_LIMIT;
+Sliceable* Sliceable::s_Wheel[ SLICE_MAX_GROUPS][ SLICE_WHEEL_SLOTS];
+uint32_t Sliceable::s_wheelTime[ SLICE_MAX_GROUPS];
+Sliceable* Sliceable::s_Ready[ SLICE_MAX_GROUPS];
+Sliceable* Sliceable::s_ReadyLast[ SLICE_MAX_GROUPS];
+std::atomic<Sliceable*> Sliceable::s_Woken[ SLICE_MAX_GROUPS];
+
+#define SLICE_WHEEL_NONE 0xFFFF
 
 Sliceable::Sliceable() {
     m_Next = NULL;
@@ -19,8 +29,24 @@ Sliceable::Sliceable() {
     }
     m_timeSlice = true;
     m_sliceEnabled = true;
+    m_sliceSleeping = false;
+    m_sliceWakeRequest = false;
+    m_sliceWakeQueued = false;
+    m_sliceEvents = 0;
+    m_sliceWaitMask = 0;
+    m_wakeTime = 0;
+    m_WheelNext = m_WheelPrev = NULL;
+    m_wheelSlot = SLICE_WHEEL_NONE;
+    m_ReadyNext = m_ReadyPrev = m_WakeNext = NULL;
+    m_sliceReady = false;
+    m_sliceGroup = 0;
+    m_timedState = SLICE_NO_STATE;
+    m_stateStats = NULL;
+    readyInsert();
 }
 Sliceable::~Sliceable() {
+    wheelRemove();
+    readyRemove();
 }
 void Sliceable::setPriority( ) {
     s_Priority = this;
@@ -28,42 +54,76 @@ void Sliceable::setPriority( ) {
 void Sliceable::resetPriority( ) {
     s_Priority = NULL;
 }
-void Sliceable::sliceOne() {
-    if( s_Current == NULL) {
-        s_Current = s_First;
+/** \brief Slices the next object of the group's ready list.
+
+ Only objects which are not sleeping are on the ready list, so a pass costs nothing for the sleepers. The wheel
+ and the wake requests of notify() and sliceWake() put them back on it.
+ */
+void Sliceable::sliceOne( uint8_t group) {
+    Sliceable*& current = s_Current[ group];
+    if( s_Woken[ group].load() != NULL) {
+        wakeQueued( group);
     }
-    if( s_Current != NULL) {
-        if( s_Current->m_sliceEnabled) {
-            if( s_Current->m_timeSlice) {
-                s_Current->startTimer();
+    if( current == NULL) {
+        wheelAdvance( group);
+        current = s_Ready[ group];
+    }
+    if( current != NULL) {
+        // Step past it first, slice() may take it off the ready list
+        Sliceable* p = current;
+        current = p->m_ReadyNext;
+        if( p->m_sliceEnabled) {
+            if( p->m_timeSlice) {
+                p->startTimer();
+            }
+            {
+                TRACE_SCOPE( p->sliceName());
+                p->slice();
             }
-            s_Current->slice();
-            if( s_Current->m_timeSlice) {
-                s_Current->stopTimer();
+            if( p->m_timeSlice) {
+                p->stopTimer();
             }
         }
-        s_Current = s_Current->m_Next;
     }
 }
-void Sliceable::slicePriority() {
-    if( s_Priority != NULL && s_Priority->m_sliceEnabled) {
-        if( s_Priority->m_timeSlice) {
-            s_Priority->startTimer();
+void Sliceable::slicePriority( uint8_t group) {
+    Sliceable* p = s_Priority;
+    if( p != NULL && p->m_sliceGroup == group && p->m_sliceEnabled && !p->m_sliceSleeping) {
+        if( p->m_timeSlice) {
+            p->startTimer();
         }
-        s_Priority->slice();
-        if( s_Priority->m_timeSlice) {
-            s_Priority->stopTimer();
+        {
+            TRACE_SCOPE( p->sliceName());
+            p->slice();
+        }
+        if( p->m_timeSlice) {
+            p->stopTimer();
         }
     }
 }
-void Sliceable::sliceAll() {
-    s_SliceAllTimer->startTimer();
-    sliceOne( );
-    for( uint16_t i = 0; i < 0x200 && s_Current != NULL; i++) {
-        sliceOne();
-        slicePriority();
+void Sliceable::sliceAll( uint8_t group) {
+    if( group == 0) {
+        s_SliceAllTimer->startTimer();
+    }
+    sliceOne( group);
+    for( uint16_t i = 0; i < 0x200 && s_Current[ group] != NULL; i++) {
+        sliceOne( group);
+        slicePriority( group);
+    }
+    if( group == 0) {
+        s_SliceAllTimer->stopTimer();
+    }
+}
+/** \brief Moves this object to another run group.
+
+ Should be called before the group runners are started, an object must not move while it is sleeping.
+ */
+void Sliceable::setSliceGroup( uint8_t group) {
+    if( group < SLICE_MAX_GROUPS && !m_sliceSleeping) {
+        readyRemove();
+        m_sliceGroup = group;
+        readyInsert();
     }
-    s_SliceAllTimer->stopTimer();
 }
 void Sliceable::sliceSlow() {
     if( --s_slowCounter == 0) {
@@ -71,6 +131,171 @@ void Sliceable::sliceSlow() {
         sliceOne();
     }
 }
+/** \brief Stops slicing this object for ms milliseconds.
+
+ Meant to be called from slice(). The object is parked in the timer wheel, off the ready list, until the
+ time has passed or sliceWake() is called. Objects which never call it keep the plain round robin behavior.
+ */
+void Sliceable::sliceSleep( uint32_t ms) {
+    wheelRemove();
+    m_sliceWaitMask = 0;
+    m_sliceWakeRequest = false;
+    if( ms > 0) {
+        m_wakeTime = HW_getMillis() + ms;
+        m_sliceSleeping = true;
+        wheelInsert();
+        readyRemove();
+    }
+}
+/** \brief Stops slicing this object until one of the events is notified or the timeout passes.
+
+ Meant to be called from slice(). Returns right away, the object is simply skipped until then. If one of the
+ events is already pending the object is not put to sleep.
+ */
+void Sliceable::sliceWaitFor( uint32_t events, uint32_t timeoutMs) {
+    wheelRemove();
+    m_sliceWakeRequest = false;
+    m_sliceWaitMask = events;
+    m_sliceSleeping = true;
+    readyRemove();
+    if( timeoutMs != SLICE_WAIT_FOREVER) {
+        m_wakeTime = HW_getMillis() + timeoutMs;
+        wheelInsert();
+    }
+    // A notify() racing with the code above either sees the wait mask or left its event pending
+    if( (m_sliceEvents & events) != 0) {
+        wake();
+    }
+}
+/** \brief Posts events to this object.
+
+ Safe to call from other tasks and from interrupts. Wakes the object if it waits for any of the events.
+ */
+void Sliceable::notify( uint32_t events) {
+    m_sliceEvents.fetch_or( events);
+    if( (m_sliceWaitMask & events) != 0) {
+        sliceWake();
+    }
+}
+/** \brief Asks for this object to be sliced again.
+
+ Safe to call from other tasks and from interrupts. The object is pushed on the wake stack of its group, once,
+ and the group's sliceOne() puts it back on the ready list.
+ */
+void Sliceable::sliceWake( ) {
+    m_sliceWakeRequest = true;
+    if( !m_sliceWakeQueued.exchange( true)) {
+        std::atomic<Sliceable*>& woken = s_Woken[ m_sliceGroup];
+        Sliceable* head = woken.load();
+        do {
+            m_WakeNext = head;
+        } while( !woken.compare_exchange_weak( head, this));
+    }
+}
+/** \brief Returns and clears the pending events in the mask.
+ */
+uint32_t Sliceable::takeEvents( uint32_t events) {
+    return m_sliceEvents.fetch_and( ~events) & events;
+}
+void Sliceable::wheelInsert( ) {
+    m_wheelSlot = m_wakeTime & (SLICE_WHEEL_SLOTS - 1);
+    m_WheelPrev = NULL;
+    m_WheelNext = s_Wheel[ m_sliceGroup][ m_wheelSlot];
+    if( m_WheelNext != NULL) {
+        m_WheelNext->m_WheelPrev = this;
+    }
+    s_Wheel[ m_sliceGroup][ m_wheelSlot] = this;
+}
+void Sliceable::wheelRemove( ) {
+    if( m_wheelSlot != SLICE_WHEEL_NONE) {
+        if( m_WheelPrev != NULL) {
+            m_WheelPrev->m_WheelNext = m_WheelNext;
+        } else {
+            s_Wheel[ m_sliceGroup][ m_wheelSlot] = m_WheelNext;
+        }
+        if( m_WheelNext != NULL) {
+            m_WheelNext->m_WheelPrev = m_WheelPrev;
+        }
+        m_WheelNext = m_WheelPrev = NULL;
+        m_wheelSlot = SLICE_WHEEL_NONE;
+    }
+    m_sliceSleeping = false;
+    m_sliceWaitMask = 0;
+}
+/** \brief Wakes the sleepers of the group's wake stack which still sleep and asked to be woken.
+ */
+void Sliceable::wakeQueued( uint8_t group) {
+    Sliceable* p = s_Woken[ group].exchange( NULL);
+    while( p != NULL) {
+        Sliceable* next = p->m_WakeNext;
+        // A wake request made after this is queued again
+        p->m_sliceWakeQueued = false;
+        if( p->m_sliceSleeping && p->m_sliceWakeRequest) {
+            p->wake();
+        }
+        p = next;
+    }
+}
+void Sliceable::readyInsert( ) {
+    if( !m_sliceReady) {
+        m_ReadyNext = NULL;
+        m_ReadyPrev = s_ReadyLast[ m_sliceGroup];
+        if( m_ReadyPrev != NULL) {
+            m_ReadyPrev->m_ReadyNext = this;
+        } else {
+            s_Ready[ m_sliceGroup] = this;
+        }
+        s_ReadyLast[ m_sliceGroup] = this;
+        m_sliceReady = true;
+    }
+}
+void Sliceable::readyRemove( ) {
+    if( m_sliceReady) {
+        if( s_Current[ m_sliceGroup] == this) {
+            s_Current[ m_sliceGroup] = m_ReadyNext;
+        }
+        if( m_ReadyPrev != NULL) {
+            m_ReadyPrev->m_ReadyNext = m_ReadyNext;
+        } else {
+            s_Ready[ m_sliceGroup] = m_ReadyNext;
+        }
+        if( m_ReadyNext != NULL) {
+            m_ReadyNext->m_ReadyPrev = m_ReadyPrev;
+        } else {
+            s_ReadyLast[ m_sliceGroup] = m_ReadyPrev;
+        }
+        m_ReadyNext = m_ReadyPrev = NULL;
+        m_sliceReady = false;
+    }
+}
+void Sliceable::wake( ) {
+    wheelRemove();
+    readyInsert();
+}
+/** \brief Wakes the sleepers whose time has come.
+
+ Visits each 1 ms slot passed since the last call, at most one full turn. Sleepers more than a turn away stay
+ in their slot until a later visit.
+ */
+void Sliceable::wheelAdvance( uint8_t group) {
+    uint32_t now = HW_getMillis();
+    uint32_t& wheelTime = s_wheelTime[ group];
+    uint32_t steps = now - wheelTime + 1;
+    if( steps > SLICE_WHEEL_SLOTS) {
+        steps = SLICE_WHEEL_SLOTS;
+        wheelTime = now - SLICE_WHEEL_SLOTS + 1;
+    }
+    for( ; steps > 0; steps--, wheelTime++) {
+        Sliceable* p = s_Wheel[ group][ wheelTime & (SLICE_WHEEL_SLOTS - 1)];
+        while( p != NULL) {
+            Sliceable* next = p->m_WheelNext;
+            if( (int32_t) (now - p->m_wakeTime) >= 0) {
+                p->wake();
+            }
+            p = next;
+        }
+    }
+}
 void Sliceable::slice( ) {
 }
 const char* Sliceable::sliceName( ) {
@@ -78,12 +303,92 @@ const char* Sliceable::sliceName( ) {
 }
 void Sliceable::resetTimer( ) {
     m_timer.reset();
+    if( m_stateStats != NULL) {
+        for( uint16_t i = 0; i < SLICE_MAX_STATES; i++) {
+            m_stateStats[ i].state = SLICE_NO_STATE;
+        }
+    }
 }
 void Sliceable::startTimer( ) {
+    m_timedState = getSliceState();
     m_timer.start();
 }
 void Sliceable::stopTimer( ) {
-    m_timer.stop();
+    uint32_t elapsed = m_timer.stop();
+    if( m_timedState != SLICE_NO_STATE) {
+        recordState( m_timedState, elapsed);
+    }
+}
+/** \brief Adds a slice time to the statistics of a state.
+
+ The table is allocated the first time a state machine reports a state. States beyond SLICE_MAX_STATES are not tracked.
+ */
+void Sliceable::recordState( uint16_t state, uint32_t elapsed) {
+    if( m_stateStats == NULL) {
+        SliceStateStats* p = new SliceStateStats[ SLICE_MAX_STATES];
+        for( uint16_t i = 0; i < SLICE_MAX_STATES; i++) {
+            p[ i].state = SLICE_NO_STATE;
+        }
+        m_stateStats = p;
+    }
+    for( uint16_t i = 0; i < SLICE_MAX_STATES; i++) {
+        SliceStateStats* s = &m_stateStats[ i];
+        if( s->state == SLICE_NO_STATE) {
+            s->state = state;
+            s->count = 0;
+            s->max = 0;
+            s->total = 0;
+        }
+        if( s->state == state) {
+            s->count++;
+            s->total += elapsed;
+            if( elapsed > s->max) {
+                s->max = elapsed;
+            }
+            break;
+        }
+    }
+}
+/** \brief Returns the statistics of the n'th state seen, NULL past the last one.
+ */
+const SliceStateStats* Sliceable::getStateStats( uint16_t n) {
+    const SliceStateStats* rc = NULL;
+    if( m_stateStats != NULL && n < SLICE_MAX_STATES && m_stateStats[ n].state != SLICE_NO_STATE) {
+        rc = &m_stateStats[ n];
+    }
+    return rc;
+}
+/** \brief Writes the slice statistics as a JSON object.
+
+ Times are in systicks. States which do not fit in max are left out. Returns the length written, 0 if max is too small.
+ The counters are read without locking, so an object sliced by another group may show a slightly inconsistent snapshot.
+
+ Example:
+ {"name":"HttpServer","group":0,"count":10,"min":1,"avg":3,"p50":3,"p99":15,"max":20,"states":[{"state":1,"count":8,"avg":2,"max":4}]}
+ */
+uint32_t Sliceable::statsJson( char* buf, uint32_t max) {
+    int n = snprintf( buf, max, "{\"name\":\"%s\",\"group\":%u,\"count\":%lu,\"min\":%lu,\"avg\":%lu,\"p50\":%lu,\"p99\":%lu,\"max\":%lu,\"states\":[",
+        sliceName(), (unsigned) m_sliceGroup, (unsigned long) m_timer.getCount(), (unsigned long) m_timer.getMin(),
+        (unsigned long) m_timer.getAverage(), (unsigned long) m_timer.getPercentile( 50), (unsigned long) m_timer.getPercentile( 99),
+        (unsigned long) m_timer.getMax());
+    uint32_t rc = 0;
+    if( n > 0 && (uint32_t) n + 3 <= max) {
+        rc = (uint32_t) n;
+        const SliceStateStats* s;
+        for( uint16_t i = 0; (s = getStateStats( i)) != NULL; i++) {
+            n = snprintf( buf + rc, max - rc, "%s{\"state\":%u,\"count\":%lu,\"avg\":%lu,\"max\":%lu}", i == 0 ? "" : ",",
+                (unsigned) s->state, (unsigned long) s->count, (unsigned long) (s->count == 0 ? 0 : s->total / s->count),
+                (unsigned long) s->max);
+            if( n < 0 || rc + (uint32_t) n + 3 > max) {
+                break;
+            }
+            rc += (uint32_t) n;
+        }
+        buf[ rc++] = ']';
+        buf[ rc++] = '}';
+        buf[ rc] = '\0';
+    }
+    return rc;
 }
 uint32_t Sliceable::getTimerCount( ) {
     return m_timer.getCount();
@@ -109,3 +414,25 @@ Sliceable* Sliceable::getSlicePointer( uint16_t n) {
     return rc;
 }
 
+SliceGroup::SliceGroup( const char* name, uint8_t group, uint8_t core) {
+    m_name = name;
+    m_group = group < SLICE_MAX_GROUPS ? group : SLICE_MAX_GROUPS - 1;
+    m_core = core;
+    m_running = false;
+}
+bool SliceGroup::start( uint32_t stackSize, uint8_t priority) {
+    bool rc = false;
+    if( !m_running && m_group != 0) {
+        m_running = true;
+        rc = HW_startTask( m_name, run, this, m_core, stackSize, priority);
+        m_running = rc;
+    }
+    return rc;
+}
+void SliceGroup::run( void* arg) {
+    SliceGroup* g = (SliceGroup*) arg;
+    while( g->m_running) {
+        Sliceable::sliceAll( g->m_group);
+        HW_yield();
+    }
+}
@@ -2,35 +2,91 @@
 #define Sliceable_h
 #include <stdint.h>
 #include <stddef.h>
+#include <atomic>
 
 #include "HardwareSpecific.h"
 #include "HiResTimer.h"
 
 #define SLICE_SLOW_LIMIT 100
 
+#ifndef SLICE_WHEEL_SLOTS
+#define SLICE_WHEEL_SLOTS 256   /**< Number of 1 ms slots in the sleep timer wheel, must be a power of 2. */
+#endif
+
+#define SLICE_WAIT_FOREVER 0xFFFFFFFF
+
+#ifndef SLICE_MAX_STATES
+#define SLICE_MAX_STATES 12     /**< Number of states tracked per sliceable in the per state statistics. */
+#endif
+#define SLICE_NO_STATE 0xFFFF
+
+#ifndef SLICE_MAX_GROUPS
+#define SLICE_MAX_GROUPS 2      /**< Number of run groups, group 0 is sliced by the caller of sliceAll(). */
+#endif
+
 
 class Sliceable;
 class SliceAllTimer;
+
+/** \brief Timing of the slices which started in one state.
+ */
+typedef struct {
+    uint16_t    state;
+    uint32_t    count;
+    uint32_t    max;
+    uint64_t    total;
+} SliceStateStats;
+
 class Sliceable {
 protected:
     Sliceable*  m_Next;
     HiResTimer  m_timer;
     bool        m_timeSlice;
     bool        m_sliceEnabled;
+    bool        m_sliceSleeping;
+    std::atomic<bool> m_sliceWakeRequest;
+    std::atomic<bool> m_sliceWakeQueued;
+    std::atomic<uint32_t> m_sliceEvents;
+    std::atomic<uint32_t> m_sliceWaitMask;
+    uint32_t    m_wakeTime;
+    Sliceable*  m_WheelNext;
+    Sliceable*  m_WheelPrev;
+    uint16_t    m_wheelSlot;
+    Sliceable*  m_ReadyNext;
+    Sliceable*  m_ReadyPrev;
+    Sliceable*  m_WakeNext;
+    bool        m_sliceReady;
+    uint8_t     m_sliceGroup;
+    uint16_t    m_timedState;
+    SliceStateStats* m_stateStats;
 
     static Sliceable* s_First;
-    static Sliceable* s_Current;
+    static Sliceable* s_Current[ SLICE_MAX_GROUPS];
     static Sliceable* s_Last;
     static Sliceable* s_Priority;
     static SliceAllTimer* s_SliceAllTimer;
     static uint32_t s_slowCounter;
+    static Sliceable* s_Wheel[ SLICE_MAX_GROUPS][ SLICE_WHEEL_SLOTS];
+    static uint32_t s_wheelTime[ SLICE_MAX_GROUPS];
+    static Sliceable* s_Ready[ SLICE_MAX_GROUPS];
+    static Sliceable* s_ReadyLast[ SLICE_MAX_GROUPS];
+    static std::atomic<Sliceable*> s_Woken[ SLICE_MAX_GROUPS];
+
+    static void wheelAdvance( uint8_t group);
+    static void wakeQueued( uint8_t group);
+    void wheelInsert( void);
+    void wheelRemove( void);
+    void readyInsert( void);
+    void readyRemove( void);
+    void wake( void);
+    void recordState( uint16_t state, uint32_t elapsed);
 
 public:
     void setPriority( void);
     void resetPriority( void);
-    static void slicePriority( void);
-    static void sliceOne( void);
-    static void sliceAll( void);
+    static void slicePriority( uint8_t group = 0);
+    static void sliceOne( uint8_t group = 0);
+    static void sliceAll( uint8_t group = 0);
     static void sliceSlow( void);
     static Sliceable* getSlicePointer( uint16_t n);
     Sliceable( void);
@@ -44,8 +100,25 @@ public:
     uint32_t getTimerMin( void);
     uint32_t getTimerMax( void);
     uint32_t getTimerAverage( void);
+    uint32_t getTimerPercentile( uint8_t percent) { return m_timer.getPercentile( percent); }
+    HiResTimer& getTimer( void) { return m_timer; }
+    const SliceStateStats* getStateStats( uint16_t n);
+    uint32_t statsJson( char* buf, uint32_t max);
+    /** \brief Returns the current state of a state machine, SLICE_NO_STATE if there is none.
+
+     Slice times are also accumulated per the state the slice started in.
+     */
+    virtual uint16_t getSliceState( void) { return SLICE_NO_STATE; }
     void sliceEnable( void) { m_sliceEnabled = true; }
     void sliceDisable( void) { m_sliceEnabled = false; }
+    void sliceSleep( uint32_t ms);
+    void sliceWake( void);
+    void sliceWaitFor( uint32_t events, uint32_t timeoutMs = SLICE_WAIT_FOREVER);
+    void notify( uint32_t events);
+    uint32_t takeEvents( uint32_t events = 0xFFFFFFFF);
+    bool isSliceSleeping( void) { return m_sliceSleeping; }
+    void setSliceGroup( uint8_t group);
+    uint8_t getSliceGroup( void) { return m_sliceGroup; }
 
 };
 
@@ -57,4 +130,32 @@ public:
     virtual void slice( void) {  }
  };
 
+/** \brief SliceGroup - runs the sliceables of one group on its own task
+
+ Group 0 is sliced by loop(). Other groups get a SliceGroup which calls Sliceable::sliceAll( group) from a task
+ pinned to a core, or from a std::thread on the host. Sliceables in different groups run concurrently, so they
+ should only exchange data through CircularQSpsc queues, LogRing or notify().
+
+ Examples:
+ SliceGroup networkGroup( "network", 1, 0);
+ telnetServer.setSliceGroup( 1);
+ networkGroup.start();
+ */
+class SliceGroup {
+protected:
+    const char*     m_name;
+    uint8_t         m_group;
+    uint8_t         m_core;
+    volatile bool   m_running;
+
+    static void run( void* arg);
+public:
+    SliceGroup( const char* name, uint8_t group, uint8_t core);
+    bool start( uint32_t stackSize = 8192, uint8_t priority = 1);
+    void stop( void) { m_running = false; }
+    const char* getName( void) { return m_name; }
+    uint8_t getGroup( void) { return m_group; }
+    bool isRunning( void) { return m_running; }
+};
+
 #endif
@@ -0,0 +1,187 @@
+#include "TimerService.h"
+
+static TimerService defaultTimerService;
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+
+ServiceTimer::ServiceTimer( ) {
+    m_next = m_prev = NULL;
+    m_slot = NULL;
+    m_service = NULL;
+    m_expires = 0;
+    m_period = 0;
+    m_callback = NULL;
+    m_arg = NULL;
+    m_target = NULL;
+    m_events = 0;
+}
+ServiceTimer::~ServiceTimer( ) {
+    stop();
+}
+/** \brief Starts the timer, restarting it if it is running.
+
+ The timer expires after delayMs, and then every periodMs if periodMs is not 0. service defaults to
+ TimerService::getDefault().
+ */
+void ServiceTimer::start( uint32_t delayMs, uint32_t periodMs, TimerService* service) {
+    if( service == NULL) {
+        service = m_service != NULL ? m_service : TimerService::getDefault();
+    }
+    service->start( this, delayMs, periodMs);
+}
+void ServiceTimer::stop( ) {
+    if( m_service != NULL) {
+        m_service->stop( this);
+    }
+}
+uint32_t ServiceTimer::getRemaining( ) {
+    uint32_t rc = 0;
+    if( m_service != NULL) {
+        int32_t d = (int32_t) (m_expires - m_service->getNow());
+        rc = d > 0 ? (uint32_t) d : 0;
+    }
+    return rc;
+}
+
+TimerService::TimerService( bool virtualTime, uint32_t startTime) {
+    for( uint8_t l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        for( uint16_t s = 0; s < TIMER_WHEEL_SLOTS; s++) {
+            m_wheel[ l][ s] = NULL;
+        }
+    }
+    m_virtualTime = virtualTime;
+    m_now = virtualTime ? startTime : HW_getMillis();
+    m_count = 0;
+    m_timeSlice = !virtualTime;
+    if( virtualTime) {
+        sliceDisable();
+    }
+}
+TimerService* TimerService::getDefault( ) {
+    return &defaultTimerService;
+}
+void TimerService::slice( ) {
+    if( !m_virtualTime) {
+        advance( HW_getMillis());
+    }
+}
+/** \brief Links a timer into the slot matching its expiry time.
+ */
+void TimerService::insert( ServiceTimer* t) {
+    uint32_t delta = t->m_expires - m_now;
+    uint32_t at = t->m_expires;
+    uint8_t level = 0;
+    if( (int32_t) delta < 0) {
+        // Already due, run it on the next tick
+        at = m_now;
+    } else if( delta >= TIMER_WHEEL_RANGE) {
+        // Park it in the furthest slot, it is placed again when that slot cascades
+        at = m_now + TIMER_WHEEL_RANGE - 1;
+        delta = TIMER_WHEEL_RANGE - 1;
+    }
+    while( level < TIMER_WHEEL_LEVELS - 1 && delta >= (1UL << (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    ServiceTimer** head = &m_wheel[ level][ (at >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK];
+    t->m_slot = head;
+    t->m_prev = NULL;
+    t->m_next = *head;
+    if( *head != NULL) {
+        (*head)->m_prev = t;
+    }
+    *head = t;
+}
+/** \brief Unlinks a timer from its slot.
+ */
+void TimerService::remove( ServiceTimer* t) {
+    if( t->m_prev != NULL) {
+        t->m_prev->m_next = t->m_next;
+    } else {
+        *t->m_slot = t->m_next;
+    }
+    if( t->m_next != NULL) {
+        t->m_next->m_prev = t->m_prev;
+    }
+    t->m_next = t->m_prev = NULL;
+    t->m_slot = NULL;
+}
+void TimerService::start( ServiceTimer* t, uint32_t delayMs, uint32_t periodMs) {
+    if( t->m_service != NULL) {
+        t->m_service->stop( t);
+    }
+    t->m_service = this;
+    t->m_period = periodMs;
+    t->m_expires = m_now + delayMs;
+    insert( t);
+    m_count++;
+}
+void TimerService::stop( ServiceTimer* t) {
+    if( t->m_service == this) {
+        remove( t);
+        t->m_service = NULL;
+        m_count--;
+    }
+}
+/** \brief Moves the timers of the current slot of level down to the levels below.
+ */
+void TimerService::cascade( uint8_t level) {
+    ServiceTimer** head = &m_wheel[ level][ (m_now >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK];
+    ServiceTimer* t = *head;
+    *head = NULL;
+    while( t != NULL) {
+        ServiceTimer* next = t->m_next;
+        insert( t);
+        t = next;
+    }
+}
+/** \brief Runs the timers in a list taken off level 0.
+
+ Timers are taken off the list one at a time, so a callback may start or stop any timer.
+ */
+void TimerService::expire( ServiceTimer** head) {
+    while( *head != NULL) {
+        ServiceTimer* t = *head;
+        remove( t);
+        if( t->m_period != 0) {
+            t->m_expires += t->m_period;
+            if( (int32_t) (t->m_expires - m_now) < 0) {
+                // Fell more than a period behind, skip the missed expiries
+                t->m_expires = m_now + t->m_period;
+            }
+            insert( t);
+        } else {
+            t->m_service = NULL;
+            m_count--;
+        }
+        if( t->m_target != NULL) {
+            t->m_target->notify( t->m_events);
+        }
+        if( t->m_callback != NULL) {
+            t->m_callback( t->m_arg);
+        }
+    }
+}
+/** \brief Runs all timers which expire up to now.
+
+ Steps one millisecond at a time from the last call, cascading the higher levels as their slots come due.
+ The due slot is taken off the wheel before the time moves on, so timers started by a callback land in
+ future slots.
+ */
+void TimerService::advance( uint32_t now) {
+    while( (int32_t) (now - m_now) >= 0) {
+        for( uint8_t l = 1; l < TIMER_WHEEL_LEVELS; l++) {
+            if( ((m_now >> (TIMER_WHEEL_BITS * (l - 1))) & TIMER_WHEEL_MASK) != 0) {
+                break;
+            }
+            cascade( l);
+        }
+        ServiceTimer** slot = &m_wheel[ 0][ m_now & TIMER_WHEEL_MASK];
+        ServiceTimer* due = *slot;
+        *slot = NULL;
+        for( ServiceTimer* t = due; t != NULL; t = t->m_next) {
+            t->m_slot = &due;
+        }
+        m_now++;
+        expire( &due);
+    }
+}
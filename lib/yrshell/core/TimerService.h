@@ -0,0 +1,89 @@
+#ifndef TimerService_h
+#define TimerService_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Sliceable.h"
+
+#define TIMER_WHEEL_BITS    6                                   /**< log2 of the slots per level. */
+#define TIMER_WHEEL_SLOTS   (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS  4                                   /**< 4 levels of 64 slots cover 2^24 ms, about 4.6 hours. */
+#define TIMER_WHEEL_RANGE   (1UL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+class TimerService;
+
+typedef void (*ServiceTimerCallback)( void* arg);
+
+/** \brief ServiceTimer - a one shot or periodic timer run by a TimerService
+
+ On expiry the timer calls its callback, notifies a Sliceable with events, or both. The callback runs from
+ TimerService::advance(), it may start or stop any timer including its own.
+
+ Examples:
+ m_timer.setNotify( this, EVENT_TIMER);
+ m_timer.start( 1000);           // once, in 1 s
+ m_timer.start( 100, 100);       // every 100 ms
+ */
+class ServiceTimer {
+    friend class TimerService;
+protected:
+    ServiceTimer*           m_next;
+    ServiceTimer*           m_prev;
+    ServiceTimer**          m_slot;
+    TimerService*           m_service;
+    uint32_t                m_expires;
+    uint32_t                m_period;
+    ServiceTimerCallback    m_callback;
+    void*                   m_arg;
+    Sliceable*              m_target;
+    uint32_t                m_events;
+public:
+    ServiceTimer( void);
+    ~ServiceTimer( void);
+    void setCallback( ServiceTimerCallback callback, void* arg) { m_callback = callback; m_arg = arg; }
+    void setNotify( Sliceable* target, uint32_t events) { m_target = target; m_events = events; }
+    void start( uint32_t delayMs, uint32_t periodMs = 0, TimerService* service = NULL);
+    void stop( void);
+    bool isRunning( void) { return m_service != NULL; }
+    uint32_t getRemaining( void);
+};
+
+/** \brief TimerService - a hierarchical timer wheel
+
+ Level 0 has a 1 ms slot per tick, each higher level has slots TIMER_WHEEL_SLOTS times as long. Timers are
+ kept in doubly linked slot lists, so starting and stopping a timer is O(1). When the lower bits of the time
+ roll over, the slot of the next level is cascaded down, so the work per tick is constant apart from the
+ timers which expire. Timers further away than TIMER_WHEEL_RANGE wait in the top level and are placed again
+ when it cascades. Times are compared as differences, so the millisecond counter may wrap.
+
+ The default service is a Sliceable which advances to HW_getMillis() each slice. A service created with
+ virtualTime set is only moved by calls to advance(), for tests and simulation. Timers should only be started
+ and stopped from the group which slices the service, notify() may target any group.
+ */
+class TimerService : public Sliceable {
+protected:
+    ServiceTimer*   m_wheel[ TIMER_WHEEL_LEVELS][ TIMER_WHEEL_SLOTS];
+    uint32_t        m_now;
+    uint32_t        m_count;
+    bool            m_virtualTime;
+
+    void insert( ServiceTimer* t);
+    void remove( ServiceTimer* t);
+    void cascade( uint8_t level);
+    void expire( ServiceTimer** head);
+
+public:
+    TimerService( bool virtualTime = false, uint32_t startTime = 0);
+    virtual ~TimerService( void) { }
+    virtual const char* sliceName( void) { return "TimerService"; }
+    virtual void slice( void);
+    void advance( uint32_t now);
+    void start( ServiceTimer* t, uint32_t delayMs, uint32_t periodMs);
+    void stop( ServiceTimer* t);
+    uint32_t getNow( void) { return m_now; }
+    uint32_t getCount( void) { return m_count; }
+    static TimerService* getDefault( void);
+};
+
+#endif
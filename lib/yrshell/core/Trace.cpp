@@ -0,0 +1,107 @@
+#include "Trace.h"
+
+#ifdef YRSHELL_TRACE
+
+#include <stdio.h>
+
+static_assert( (TRACE_EVENTS & (TRACE_EVENTS - 1)) == 0, "TRACE_EVENTS must be a power of 2");
+
+TraceEvent Trace::s_events[ TRACE_EVENTS];
+std::atomic<uint32_t> Trace::s_next( 0);
+uint32_t Trace::s_threshold = 0;
+volatile bool Trace::s_enabled = true;
+
+void Trace::record( const char* name, uint8_t phase, uint32_t start, uint32_t duration) {
+    uint32_t seq = s_next.fetch_add( 1, std::memory_order_relaxed);
+    TraceEvent* e = &s_events[ seq & (TRACE_EVENTS - 1)];
+    e->seq.store( 0, std::memory_order_relaxed);
+    std::atomic_thread_fence( std::memory_order_release);
+    e->name = name;
+    e->start = start;
+    e->duration = duration;
+    e->phase = phase;
+    e->tid = HW_getCore();
+    e->seq.store( seq + 1, std::memory_order_release);
+}
+void Trace::complete( const char* name, uint32_t start, uint32_t duration) {
+    if( s_enabled && duration >= s_threshold) {
+        record( name, 'X', start, duration);
+    }
+}
+/** \brief Forgets all events. Events recorded concurrently may survive.
+ */
+void Trace::clear( ) {
+    for( uint32_t i = 0; i < TRACE_EVENTS; i++) {
+        s_events[ i].seq.store( 0, std::memory_order_relaxed);
+    }
+}
+/** \brief Returns the sequence number of the oldest event still in the ring.
+ */
+uint32_t Trace::first( ) {
+    uint32_t n = last();
+    return n > TRACE_EVENTS ? n - TRACE_EVENTS : 0;
+}
+/** \brief Writes the event with sequence number seq as a JSON object.
+
+ Returns the length written, 0 if the event was overwritten or is still being written, -1 if it does not fit.
+ */
+int32_t Trace::eventJson( char* buf, uint32_t max, uint32_t seq) {
+    TraceEvent* e = &s_events[ seq & (TRACE_EVENTS - 1)];
+    int32_t rc = 0;
+    if( e->seq.load( std::memory_order_acquire) == seq + 1) {
+        const char* name = e->name;
+        uint32_t start = e->start;
+        uint32_t duration = e->duration;
+        uint8_t phase = e->phase;
+        uint8_t tid = e->tid;
+        std::atomic_thread_fence( std::memory_order_acquire);
+        if( e->seq.load( std::memory_order_relaxed) == seq + 1) {
+            int n;
+            if( phase == 'X') {
+                n = snprintf( buf, max, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":0,\"tid\":%u}",
+                    name, (unsigned long) start, (unsigned long) duration, (unsigned) tid);
+            } else {
+                n = snprintf( buf, max, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%lu,\"pid\":0,\"tid\":%u}",
+                    name, (unsigned long) start, (unsigned) tid);
+            }
+            rc = n > 0 && (uint32_t) n < max ? n : -1;
+        }
+    }
+    return rc;
+}
+/** \brief Writes events from cursor up to end as Chrome trace-event JSON.
+
+ Writes as many events as fit in max, separated by commas, and advances cursor past them. firstEvent should be
+ true for the first call of an export, it is cleared once an event is written. The caller writes the enclosing
+ {"traceEvents":[ and ]}. Returns the length written, the export is done when cursor reaches end.
+
+ Example:
+ uint32_t cursor = Trace::first(), end = Trace::last();
+ bool firstEvent = true;
+ while( cursor != end) {
+     len = Trace::json( buf, sizeof( buf), cursor, end, firstEvent);
+     ...
+ }
+ */
+uint32_t Trace::json( char* buf, uint32_t max, uint32_t& cursor, uint32_t end, bool& firstEvent) {
+    uint32_t rc = 0;
+    while( cursor != end && rc + 2 < max) {
+        uint32_t o = firstEvent ? 0 : 1;
+        int32_t n = eventJson( buf + rc + o, max - rc - o, cursor);
+        if( n < 0 && rc > 0) {
+            break;
+        }
+        // Events overwritten since the export started, or too long for an empty buffer, are skipped
+        if( n > 0) {
+            if( !firstEvent) {
+                buf[ rc] = ',';
+            }
+            rc += (uint32_t) n + o;
+            firstEvent = false;
+        }
+        cursor++;
+    }
+    return rc;
+}
+
+#endif
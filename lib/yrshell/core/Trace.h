@@ -0,0 +1,89 @@
+#ifndef Trace_h
+#define Trace_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "HardwareSpecific.h"
+
+/** \brief Trace - a fixed ring of timeline events
+
+ Tracing is compiled in only when YRSHELL_TRACE is defined, e.g. with -D YRSHELL_TRACE in build_flags.
+ Without it the TRACE_ macros expand to nothing and no storage is used.
+
+ TRACE_SCOPE( name) records a span from the macro to the end of the enclosing block, TRACE_INSTANT( name)
+ records a single point in time. Timestamps are HW_getSysticks() and the thread id is the core the event
+ was recorded on. Names are stored as pointers, so they must be string literals or otherwise live forever.
+
+ The newest TRACE_EVENTS events are kept. Any task may record, an event overwritten while it is exported is
+ skipped. json() renders the ring as Chrome trace-event JSON which chrome://tracing or Perfetto can load.
+
+ Examples:
+ void Foo::bar( ) {
+     TRACE_SCOPE( "Foo::bar");
+     ...
+ }
+ */
+#ifdef YRSHELL_TRACE
+
+#include <atomic>
+
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS 512    /**< Number of events kept, must be a power of 2. */
+#endif
+
+typedef struct {
+    const char*             name;
+    uint32_t                start;
+    uint32_t                duration;
+    uint8_t                 phase;
+    uint8_t                 tid;
+    std::atomic<uint32_t>   seq;    /**< Sequence number + 1 of the event in the slot, 0 while it is written. */
+} TraceEvent;
+
+class Trace {
+protected:
+    static TraceEvent               s_events[ TRACE_EVENTS];
+    static std::atomic<uint32_t>    s_next;
+    static uint32_t                 s_threshold;
+    static volatile bool            s_enabled;
+
+    static void record( const char* name, uint8_t phase, uint32_t start, uint32_t duration);
+    static int32_t eventJson( char* buf, uint32_t max, uint32_t seq);
+public:
+    static void instant( const char* name) { if( s_enabled) record( name, 'i', HW_getSysticks(), 0); }
+    static void complete( const char* name, uint32_t start, uint32_t duration);
+    static void enable( bool flag) { s_enabled = flag; }
+    static bool isEnabled( void) { return s_enabled; }
+    static void setThreshold( uint32_t systicks) { s_threshold = systicks; }
+    static uint32_t getThreshold( void) { return s_threshold; }
+    static void clear( void);
+    static uint32_t first( void);
+    static uint32_t last( void) { return s_next.load( std::memory_order_acquire); }
+    static uint32_t json( char* buf, uint32_t max, uint32_t& cursor, uint32_t end, bool& firstEvent);
+};
+
+/** \brief TraceScope - records a span from construction to destruction.
+ */
+class TraceScope {
+protected:
+    const char* m_name;
+    uint32_t    m_start;
+public:
+    TraceScope( const char* name) { m_name = name; m_start = HW_getSysticks(); }
+    ~TraceScope( ) { Trace::complete( m_name, m_start, HW_getSysticks() - m_start); }
+};
+
+#define TRACE_CONCAT2( a, b) a##b
+#define TRACE_CONCAT( a, b) TRACE_CONCAT2( a, b)
+#define TRACE_SCOPE( name) TraceScope TRACE_CONCAT( traceScope, __LINE__)( name)
+#define TRACE_INSTANT( name) Trace::instant( name)
+
+#else
+
+#define TRACE_SCOPE( name)
+#define TRACE_INSTANT( name)
+
+#endif
+
+#endif
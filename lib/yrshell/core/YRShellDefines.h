@@ -3,11 +3,32 @@
 
 // #define INPUT_BUFFER_EDITING
 #define YRSHELL_INTERPRETER_FLOATING_POINT
+#define YRSHELL_THREADED_CODE // fast inner loop for pure primitives and superinstructions in compiled words
 
 #ifndef YRSHELL_VERSION
 #define YRSHELL_VERSION "\rYRShell Version 0.2 " // make sure this string length is less than YRShell outq size
 #endif
 
+#ifndef YRSHELL_SLICE_TOKEN_BUDGET
+#define YRSHELL_SLICE_TOKEN_BUDGET 64 // interpreter steps run per slice, 1 restores one token per slice
+#endif
+
+#ifndef YRSHELL_PEEPHOLE_MAX
+#define YRSHELL_PEEPHOLE_MAX 32 // superinstructions fused per compiled word
+#endif
+
+#ifndef YRSHELL_SLICE_TIME_BUDGET
+#define YRSHELL_SLICE_TIME_BUDGET 1000 // microseconds an interpreter slice may run before yielding
+#endif
+
+#ifndef YRSHELL_MAX_CONTEXTS
+#define YRSHELL_MAX_CONTEXTS 4 // execution contexts an interpreter can run besides its own
+#endif
+
+#ifndef YRSHELL_PROFILE_DEPTH
+#define YRSHELL_PROFILE_DEPTH 16 // nested compiled words the profiler times per context
+#endif
+
 typedef enum {
 	YRSHELL_INVALID_STATE = 0,
     YRSHELL_NOT_INITIALIZED = 1,
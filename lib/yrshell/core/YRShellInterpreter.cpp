@@ -4,6 +4,8 @@
 
 uint8_t	YRShellInterpreter::s_shellNumber = 0;
 
+#define TEXT_LENGTH_UNKNOWN 0xFFFF
+
 /*
 static uint16_t compiledDictionaryData[] = {
 };
@@ -187,6 +189,14 @@ static const FunctionEntry interpreterFunctions[] = {
     { (uint16_t)YRShellInterpreter::SI_CC_intToFloat,                             "i>f" },
  
 #endif
+    { (uint16_t)YRShellInterpreter::SI_CC_slicePercentile,                        "slicePercentile" },
+    { (uint16_t)YRShellInterpreter::SI_CC_sliceBudget,                            "sliceBudget" },
+    { (uint16_t)YRShellInterpreter::SI_CC_setOptimize,                            "setOptimize" },
+    { (uint16_t)YRShellInterpreter::SI_CC_setProfile,                             "setProfile" },
+    { (uint16_t)YRShellInterpreter::SI_CC_resetProfile,                           "resetProfile" },
+    { (uint16_t)YRShellInterpreter::SI_CC_profileStats,                           "profileStats" },
+    { (uint16_t)YRShellInterpreter::SI_CC_printProfileName,                       "printProfileName" },
+    { (uint16_t)YRShellInterpreter::SI_CC_dcFused,                                "dcFused" },
     { (uint16_t)0, NULL}
 };
 
@@ -404,6 +414,22 @@ const char *SIDebugStrings[] = {
     "SI_CC_floatToInt",
     "SI_CC_intToFloat",
 #endif
+    "SI_CC_slicePercentile",
+    "SI_CC_sliceBudget",
+    "SI_CC_setOptimize",
+    "SI_CC_x_litPlus",
+    "SI_CC_x_litMinus",
+    "SI_CC_x_litEqual",
+    "SI_CC_x_equalJmpz",
+    "SI_CC_x_notEqualJmpz",
+    "SI_CC_x_zeroEqualJmpz",
+    "SI_CC_x_dupLitEqualJmpz",
+    "SI_CC_x_overPlus",
+    "SI_CC_setProfile",
+    "SI_CC_resetProfile",
+    "SI_CC_profileStats",
+    "SI_CC_printProfileName",
+    "SI_CC_dcFused",
     
     "SI_CC_last"
 };
@@ -439,12 +465,22 @@ bool YRShellInterpreter::stringToUnsignedX( const char* P, uint32_t* V) {
     return rc;
     
 }
+static const char s_digitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869"
+    "707172737475767778798081828384858687888990919293949596979899";
+static const char s_hexDigits[] = "0123456789ABCDEF";
+
+// Two digits per division, numDigits are always written
 static void unsignedToStringZero(uint32_t num, uint8_t numDigits, char *s) {
     char *P = s + numDigits;
-    *P-- = '\0';
-    while( P >= s) {
-        *P-- = '0' + (num % 10);
-        num /= 10;
+    *P = '\0';
+    while( P - s >= 2) {
+        P -= 2;
+        memcpy( P, &s_digitPairs[ (num % 100) * 2], 2);
+        num /= 100;
+    }
+    if( P > s) {
+        *--P = '0' + (num % 10);
     }
 }
 static void unsignedToString(uint32_t num, uint8_t numDigits, char *s) {
@@ -457,16 +493,9 @@ static void unsignedToStringX(uint32_t num, uint8_t numDigits, char *s){
     *s++ = '0';
     *s++ = 'x';
     char *P = s + numDigits;
-    char c;
     *P-- = '\0';
     while( P >= s) {
-        c = num & 0xF;
-        if( c > 9) {
-            c += '7';
-        } else {
-            c += '0';
-        }
-        *P-- =  c;
+        *P-- = s_hexDigits[ num & 0xF];
         num >>= 4;
     }
 }
@@ -516,6 +545,46 @@ bool YRShellInterpreter::stringToUnsigned( const char* P, uint32_t* V) {
     }
     return rc;
 }
+#ifdef YRSHELL_INTERPRETER_FLOATING_POINT
+#define POWER_OF_10_MIN -45
+#define POWER_OF_10_MAX 38
+static const float s_powersOf10[] = {
+    1e-45f, 1e-44f, 1e-43f, 1e-42f, 1e-41f, 1e-40f, 1e-39f, 1e-38f, 1e-37f, 1e-36f, 1e-35f, 1e-34f, 1e-33f, 1e-32f, 1e-31f, 1e-30f,
+    1e-29f, 1e-28f, 1e-27f, 1e-26f, 1e-25f, 1e-24f, 1e-23f, 1e-22f, 1e-21f, 1e-20f, 1e-19f, 1e-18f, 1e-17f, 1e-16f, 1e-15f, 1e-14f,
+    1e-13f, 1e-12f, 1e-11f, 1e-10f, 1e-9f, 1e-8f, 1e-7f, 1e-6f, 1e-5f, 1e-4f, 1e-3f, 1e-2f, 1e-1f, 1e0f, 1e1f, 1e2f,
+    1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f, 1e11f, 1e12f, 1e13f, 1e14f, 1e15f, 1e16f, 1e17f, 1e18f,
+    1e19f, 1e20f, 1e21f, 1e22f, 1e23f, 1e24f, 1e25f, 1e26f, 1e27f, 1e28f, 1e29f, 1e30f, 1e31f, 1e32f, 1e33f, 1e34f,
+    1e35f, 1e36f, 1e37f, 1e38f
+};
+// The correctly rounded powf( 10.0f, ex)
+static float powerOf10( int32_t ex) {
+    return ex >= POWER_OF_10_MIN && ex <= POWER_OF_10_MAX ? s_powersOf10[ ex - POWER_OF_10_MIN] : powf( 10.0f, (float) ex);
+}
+// The digits after the '.' of a float with whole part bd, and an optional exponent
+static bool stringToFloatFraction( int32_t bd, const char* P, uint32_t* V) {
+    bool rc = false;
+    float fv = 0.0f;
+    int32_t nd = 0, ad = 0, exp = 0;
+    const char *ep;
+    ep = stringToUnsignedInternal(P, (uint32_t*) &ad);
+    nd = (uint32_t) (ep - P);
+    if( *ep == '\0') {
+        rc = true;
+    } else if( *ep == 'e' || *ep == 'E') {
+        ep++;
+        ep = stringToUnsignedInternal( ep, (uint32_t*) &exp);
+        if( *ep == '\0') {
+            rc = -1;
+        }
+    }
+    if( rc) {
+        fv = (powerOf10( nd) * ((float) bd) + ((float) ad)) * powerOf10( exp - nd);
+    }
+    uint32_t* tp = ((uint32_t*) &fv);
+    *V = *tp;
+    return rc;
+}
+#endif
 CompiledDictionary emptyDictionary;
 
 void YRShellInterpreter::init( ) {
@@ -529,8 +598,52 @@ void YRShellInterpreter::init( ) {
     m_dictionaryList[ YRSHELL_DICTIONARY_COMMON_FUNCTION_INDEX] = NULL;
     m_dictionaryList[ YRSHELL_DICTIONARY_INTERPRETER_FUNCTION_INDEX] =  &dictionaryInterpreterFunction;
 }
+YRShellContext::YRShellContext( ) {
+    m_state = YRSHELL_BEGIN_IDLE;
+    m_stateTopOfStack = 0;
+    m_Inq = m_AuxInq = m_Outq = m_AuxOutq = NULL;
+    m_commandEcho = false;
+    m_hexMode = false;
+    m_requestUseAuxQueues = false;
+    m_requestUseMainQueues = false;
+    m_lastUseAuxQueues = false;
+    m_useAuxQueues = false;
+    m_useTextOutput = false;
+    m_promptEnable = false;
+    m_prompt = "\r>";
+    m_Pad = NULL;
+    m_padCount = 0;
+    m_padSize = 0;
+    m_ParameterStack = m_ReturnStack = m_CompileStack = NULL;
+    m_parameterStackSize = m_returnStackSize = m_compileStackSize = 0;
+    m_topOfStack = 0;
+    m_returnTopOfStack = 0;
+    m_compileTopOfStack = 0;
+    m_token = NULL;
+    m_saveptr = NULL;
+    m_PC = 0;
+    m_outputStrPtr = NULL;
+    m_outputStr0 = NULL;
+    m_outputStr1 = NULL;
+    m_outputStr2 = NULL;
+    m_outputStr3 = NULL;
+    m_outputUint = 0;
+    m_outputUintValid = false;
+    m_lineBase = YRSHELL_DICTIONARY_INVALID;
+    m_lineLimit = 0;
+}
+YRShellContext::~YRShellContext( ) {
+}
 YRShellInterpreter::YRShellInterpreter() {
     m_DictionaryCurrent = NULL;
+    m_lineCache = NULL;
+    m_profiler = NULL;
+    m_textLength = TEXT_LENGTH_UNKNOWN;
+    m_numContexts = 0;
+    m_contextTurn = 0;
+    m_activeContext = NULL;
+    m_lineBase = YRSHELL_DICTIONARY_INVALID;
+    m_lineLimit = 0;
     m_Inq = m_AuxInq = m_Outq = m_AuxOutq = NULL;
     m_ParameterStack = m_ReturnStack = m_CompileStack = NULL;
     m_parameterStackSize = m_returnStackSize = m_compileStackSize = 0;
@@ -545,6 +658,10 @@ YRShellInterpreter::YRShellInterpreter() {
 #endif
 	m_hexMode = false;
 	m_outputTimeoutInMilliseconds = 1000;
+    m_sliceTokenBudget = YRSHELL_SLICE_TOKEN_BUDGET;
+    m_sliceTimeBudget = YRSHELL_SLICE_TIME_BUDGET;
+    m_stepLimit = 1;
+    m_stepTokens = 1;
 	m_padCount = 0;
     m_padSize = 0;
 	m_PC = YRSHELL_DICTIONARY_INVALID;
@@ -602,6 +719,95 @@ uint16_t YRShellInterpreter::findEntry( const char* name) {
     }
     return rc;
 }
+uint32_t YRShellInterpreter::getDictionaryFingerprint( ) {
+    uint16_t v = SI_CC_last;
+    uint32_t crc = Dictionary::crc32( 0, &v, sizeof( v));
+    for( uint8_t i = YRSHELL_DICTIONARY_EXTENSION_FUNCTION_INDEX; i < YRSHELL_DICTIONARY_LAST_INDEX; i++) {
+        Dictionary* D = m_dictionaryList[ i];
+        if( D != NULL) {
+            const uint16_t* code = D->getCode( &v);
+            if( code != NULL) {
+                crc = Dictionary::crc32( crc, code, v * sizeof( uint16_t));
+            } else {
+                for( uint16_t e = D->getFirstEntry(); e != YRSHELL_DICTIONARY_INVALID; e = D->getNextEntry( e)) {
+                    const char* name = D->getAddress( e);
+                    v = D->getToken( e);
+                    crc = Dictionary::crc32( crc, &v, sizeof( v));
+                    crc = Dictionary::crc32( crc, name, strlen( name) + 1);
+                }
+            }
+        }
+    }
+    return crc;
+}
+static uint32_t snapshotCrc( const YRShellSnapshotHeader* h, const uint8_t* data, uint32_t len) {
+    uint32_t crc = Dictionary::crc32( 0, h, offsetof( YRShellSnapshotHeader, m_crc));
+    return Dictionary::crc32( crc, data, len);
+}
+static uint32_t extensionCompiledCrc( Dictionary* D) {
+    uint32_t crc = 0;
+    uint16_t end = 0;
+    const uint16_t* code = D != NULL ? D->getCode( &end) : NULL;
+    if( code != NULL && end > 0) {
+        crc = Dictionary::crc32( 0, code, end * sizeof( uint16_t));
+    }
+    return crc;
+}
+uint32_t YRShellInterpreter::getSnapshotSize( ) {
+    return sizeof( YRShellSnapshotHeader) + m_DictionaryCurrent->getBackupWordEnd() * sizeof( uint16_t) + m_numRegisters * sizeof( uint32_t);
+}
+uint32_t YRShellInterpreter::saveSnapshot( uint8_t* buf, uint32_t size, uint32_t buildId, uint32_t userFlags) {
+    uint32_t rc = getSnapshotSize();
+    if( buf == NULL || size < rc) {
+        rc = 0;
+    } else {
+        YRShellSnapshotHeader h;
+        uint16_t end;
+        const uint16_t* code = m_DictionaryCurrent->getCode( &end);
+        memset( &h, 0, sizeof( h));
+        h.m_magic = YRSHELL_SNAPSHOT_MAGIC;
+        h.m_buildId = buildId;
+        h.m_fingerprint = getDictionaryFingerprint();
+        h.m_extensionCrc = extensionCompiledCrc( m_dictionaryList[ YRSHELL_DICTIONARY_EXTENSION_COMPILED_INDEX]);
+        h.m_userFlags = userFlags;
+        h.m_wordEnd = m_DictionaryCurrent->getBackupWordEnd();
+        h.m_lastWord = m_DictionaryCurrent->getBackupLastWord();
+        h.m_numRegisters = m_numRegisters;
+        h.m_flags = (m_hexMode ? YRSHELL_SNAPSHOT_HEX_MODE : 0) | (m_promptEnable ? YRSHELL_SNAPSHOT_PROMPT_ENABLE : 0) |
+            (m_commandEcho ? YRSHELL_SNAPSHOT_COMMAND_ECHO : 0);
+        uint8_t* data = buf + sizeof( h);
+        memcpy( data, code, h.m_wordEnd * sizeof( uint16_t));
+        memcpy( data + h.m_wordEnd * sizeof( uint16_t), m_Registers, m_numRegisters * sizeof( uint32_t));
+        h.m_crc = snapshotCrc( &h, data, rc - sizeof( h));
+        memcpy( buf, &h, sizeof( h));
+    }
+    return rc;
+}
+bool YRShellInterpreter::restoreSnapshot( const uint8_t* buf, uint32_t size, uint32_t buildId, uint32_t* userFlags) {
+    bool rc = false;
+    YRShellSnapshotHeader h;
+    if( buf != NULL && size >= sizeof( h)) {
+        memcpy( &h, buf, sizeof( h));
+        const uint8_t* data = buf + sizeof( h);
+        uint32_t len = h.m_wordEnd * sizeof( uint16_t) + h.m_numRegisters * sizeof( uint32_t);
+        if( h.m_magic == YRSHELL_SNAPSHOT_MAGIC && h.m_buildId == buildId && h.m_numRegisters == m_numRegisters &&
+                size >= sizeof( h) + len && h.m_crc == snapshotCrc( &h, data, len) &&
+                h.m_fingerprint == getDictionaryFingerprint() &&
+                h.m_extensionCrc == extensionCompiledCrc( m_dictionaryList[ YRSHELL_DICTIONARY_EXTENSION_COMPILED_INDEX])) {
+            if( m_DictionaryCurrent->restore( (const uint16_t*) data, h.m_wordEnd, h.m_lastWord)) {
+                memcpy( m_Registers, data + h.m_wordEnd * sizeof( uint16_t), m_numRegisters * sizeof( uint32_t));
+                m_hexMode = (h.m_flags & YRSHELL_SNAPSHOT_HEX_MODE) != 0;
+                m_promptEnable = (h.m_flags & YRSHELL_SNAPSHOT_PROMPT_ENABLE) != 0;
+                m_commandEcho = (h.m_flags & YRSHELL_SNAPSHOT_COMMAND_ECHO) != 0;
+                if( userFlags != NULL) {
+                    *userFlags = h.m_userFlags;
+                }
+                rc = true;
+            }
+        }
+    }
+    return rc;
+}
 const char* YRShellInterpreter::getFileName( const char* P) {
     const char* R = P;
     while( *P++ != '\0') {
@@ -663,6 +869,7 @@ void YRShellInterpreter::executeFunction( uint16_t n) {
     float f1, f2;
     const char *P, *M;
     Sliceable *S;
+    const ProfileEntry* E;
 
 #ifdef YRSHELL_DEBUG
     if( m_debugFlags & YRSHELL_DEBUG_EXECUTE) {
@@ -1215,6 +1422,119 @@ void YRShellInterpreter::executeFunction( uint16_t n) {
         		pushParameterStack( 0);
         	}
             break;
+        case SI_CC_slicePercentile:
+        	v2 = popParameterStack();
+        	v1 = popParameterStack();
+        	S = Sliceable::getSlicePointer( v1);
+        	if( S != NULL) {
+        		pushParameterStack( S->getTimerPercentile( (uint8_t) v2));
+        		pushParameterStack( -1);
+        	} else {
+        		pushParameterStack( 0);
+        	}
+            break;
+        case SI_CC_sliceBudget:
+        	v2 = popParameterStack();
+        	v1 = popParameterStack();
+        	setSliceBudget( (uint16_t) v1, v2);
+            break;
+        case SI_CC_setOptimize:
+            m_DictionaryCurrent->setOptimize( popParameterStack() != 0);
+            break;
+        case SI_CC_setProfile:
+            b = popParameterStack() != 0;
+            if( m_profiler != NULL) {
+                m_profiler->enable( b);
+            }
+            break;
+        case SI_CC_resetProfile:
+            if( m_profiler != NULL) {
+                m_profiler->clear();
+            }
+            break;
+        case SI_CC_profileStats:
+            v1 = popParameterStack();
+            E = m_profiler != NULL ? m_profiler->getRanked( (uint16_t) v1) : NULL;
+            if( E != NULL) {
+                pushParameterStack( E->m_token);
+                pushParameterStack( E->m_exclusive);
+                pushParameterStack( E->m_inclusive);
+                pushParameterStack( E->m_calls);
+                pushParameterStack( -1);
+            } else {
+                pushParameterStack( 0);
+            }
+            break;
+        case SI_CC_printProfileName:
+            v1 = popParameterStack();
+            P = getTokenName( (uint16_t) v1);
+            if( P != NULL) {
+                m_outputStrPtr = P;
+                pushState( YRSHELL_OUTPUT_STR);
+            } else {
+                // Superinstructions and command lines have no entry
+                outUint16X( (uint16_t) v1);
+            }
+            break;
+        case SI_CC_x_litPlus:
+            v1 = fetchCurrentValueToken();
+            v2 = popParameterStack();
+            pushParameterStack( v2 + v1);
+            break;
+        case SI_CC_x_litMinus:
+            v1 = fetchCurrentValueToken();
+            v2 = popParameterStack();
+            pushParameterStack( v2 - v1);
+            break;
+        case SI_CC_x_litEqual:
+            v1 = fetchCurrentValueToken();
+            v2 = popParameterStack();
+            pushParameterStack( v2 == v1);
+            break;
+        case SI_CC_x_equalJmpz:
+        case SI_CC_x_notEqualJmpz:
+        case SI_CC_x_zeroEqualJmpz:
+        case SI_CC_x_dupLitEqualJmpz:
+            if( n == SI_CC_x_dupLitEqualJmpz) {
+                v1 = fetchCurrentValueToken();
+                v2 = popParameterStack();
+                pushParameterStack( v2);
+                b = v2 == v1;
+            } else if( n == SI_CC_x_zeroEqualJmpz) {
+                b = popParameterStack() == 0;
+            } else {
+                v1 = popParameterStack();
+                v2 = popParameterStack();
+                b = (n == SI_CC_x_equalJmpz) ? v2 == v1 : v2 != v1;
+            }
+            if( !b) {
+                v1 = fetchCurrentToken();
+                m_PC &= YRSHELL_DICTIONARY_RELATIVE_ALL_MASK;
+                m_PC |= v1 & ~YRSHELL_DICTIONARY_RELATIVE_ALL_MASK;
+            } else {
+                m_PC++;
+            }
+            break;
+        case SI_CC_x_overPlus:
+            v1 = popParameterStack();
+            v2 = popParameterStack();
+            pushParameterStack( v2);
+            pushParameterStack( v1 + v2);
+            break;
+        case SI_CC_dcFused:
+            // ( token_addr token -- token_addr token -1 | token_addr 0 ), token_addr left on the last operand
+            v2 = popParameterStack();
+            v1 = popParameterStack();
+            v3 = decompileFused( v1, v2);
+            if( (int8_t) v3 < 0) {
+                pushParameterStack( v1);
+                pushParameterStack( v2);
+                pushParameterStack( -1);
+            } else {
+                pushParameterStack( v1 + v3);
+                pushParameterStack( 0);
+            }
+            break;
         case SI_CC_printSliceName:
         	v1 = popParameterStack();
         	S = Sliceable::getSlicePointer( v1);
@@ -1354,6 +1674,7 @@ void YRShellInterpreter::executeFunction( uint16_t n) {
             if( m_textBufferSize > 0 && v3 > 1) {
                 strncpy( &m_TextBuffer[ v1], getAddressFromToken(v2), v3);
                 m_TextBuffer[ m_textBufferSize - 1] = '\0';
+                m_textLength = TEXT_LENGTH_UNKNOWN;
             }
             break;
         case SI_CC_charBang:
@@ -1362,6 +1683,7 @@ void YRShellInterpreter::executeFunction( uint16_t n) {
             if( v1 < m_textBufferSize) {
                 m_TextBuffer[ v1 ] = v2;
                 m_TextBuffer[ m_textBufferSize - 1] = '\0';
+                m_textLength = TEXT_LENGTH_UNKNOWN;
             }
             break;
         case SI_CC_charAt:
@@ -1374,6 +1696,7 @@ void YRShellInterpreter::executeFunction( uint16_t n) {
             break;
         case SI_CC_textIO:
              m_useTextOutput = true;
+             m_textLength = TEXT_LENGTH_UNKNOWN;
             break;
 
 #ifdef YRSHELL_INTERPRETER_FLOATING_POINT
@@ -1597,6 +1920,14 @@ void YRShellInterpreter::CC_until( ) {
         m_DictionaryCurrent->addToken(YRSHELL_DICTIONARY_RELATIVE | (v & YRSHELL_DICTIONARY_ADDRESS_MASK));
     }
 }
+// Drops the oldest output until half of the queue is free, from the writer side. The space comes free when the reader reads.
+static void discardToHalf( CircularQBase<char>* q) {
+    uint32_t half = q->size() / 2;
+    uint32_t f = q->free();
+    if( f < half) {
+        q->discard( half - f);
+    }
+}
 void YRShellInterpreter::interpretReset( ) {
     nextState( YRSHELL_INRESET);
     m_padCount = 0;
@@ -1608,8 +1939,9 @@ void YRShellInterpreter::reset( ) {
     if( m_state != YRSHELL_INRESET) {
         m_Inq->reset();
         m_AuxInq->reset();
-        m_Outq->reset();
-        m_AuxOutq->reset();
+        // The interpreter writes the output queues, their readers may be running on another task
+        m_Outq->discard();
+        m_AuxOutq->discard();
     
 #ifdef YRSHELL_DEBUG
         //m_debugFlags = YRSHELL_DEBUG_STATE | YRSHELL_DEBUG_INPUT | YRSHELL_DEBUG_TOKEN;
@@ -1776,42 +2108,75 @@ void YRShellInterpreter::debugToken() {
     }
 }
 #endif
-void YRShellInterpreter::beginParsing(void) {
-    m_saveptr = NULL;
-    m_token = strtok_r(m_Pad, "\t ", &m_saveptr);
-    if( m_token == NULL) {
-        nextState( YRSHELL_BEGIN_IDLE  );
-    } else {
-        if( strcmp( m_token, ":")) {
-            if( !m_DictionaryCurrent->newCompile("_")) {
-                shellERROR( __FILE__, __LINE__);
+uint16_t YRShellInterpreter::lineStart( ) {
+    // newCompile( "_") puts the code after the link word and the name
+    return m_lineLimit != 0 ? m_lineBase : m_DictionaryCurrent->getWordEnd() + 1 + Dictionary::nameLength( "_");
+}
+bool YRShellInterpreter::newLine( ) {
+    return m_lineLimit != 0 ? m_DictionaryCurrent->newLine( m_lineBase, m_lineLimit) : m_DictionaryCurrent->newCompile( "_");
+}
+bool YRShellInterpreter::beginCachedLine( ) {
+    bool rc = false;
+    const char* P = m_Pad + strspn( m_Pad, "\t ");
+    // Definitions stay compiled, only command lines are worth caching
+    if( *P != '\0' && !(P[ 0] == ':' && (P[ 1] == '\0' || P[ 1] == ' ' || P[ 1] == '\t'))) {
+        uint16_t size = 0;
+        uint16_t start = lineStart();
+        const uint16_t* code = m_lineCache->find( m_Pad, m_DictionaryCurrent->getGeneration(), start, &size);
+        if( code != NULL && m_compileTopOfStack == 0 && newLine()) {
+            rc = true;
+            for( uint16_t i = 0; rc && i < size; i++) {
+                rc = m_DictionaryCurrent->addToken( code[ i]);
             }
-            if( m_compileTopOfStack) {
-                shellERROR(__FILE__, __LINE__);
+            if( rc) {
+                pushReturnStack( 0);
+                m_PC = YRSHELL_DICTIONARY_CURRENT_RELATIVE | YRSHELL_DICTIONARY_CURRENT | start;
+                nextState( YRSHELL_EXECUTING);
+            } else {
+                m_DictionaryCurrent->rollBack();
             }
-            pushReturnStack( 0);
-            m_PC = YRSHELL_DICTIONARY_CURRENT_RELATIVE | YRSHELL_DICTIONARY_CURRENT | m_DictionaryCurrent->getWordEnd();
+        }
+    }
+    return rc;
+}
+void YRShellInterpreter::beginParsing(void) {
+    if( m_lineCache == NULL || !beginCachedLine()) {
+        m_saveptr = NULL;
+        m_token = strtok_r(m_Pad, "\t ", &m_saveptr);
+        if( m_token == NULL) {
+            nextState( YRSHELL_BEGIN_IDLE  );
+        } else {
+            if( strcmp( m_token, ":")) {
+                if( !newLine()) {
+                    shellERROR( __FILE__, __LINE__);
+                }
+                if( m_compileTopOfStack) {
+                    shellERROR(__FILE__, __LINE__);
+                }
+                pushReturnStack( 0);
+                m_PC = YRSHELL_DICTIONARY_CURRENT_RELATIVE | YRSHELL_DICTIONARY_CURRENT | m_DictionaryCurrent->getWordEnd();
 #ifdef YRSHELL_DEBUG
-            debugToken();
+                debugToken();
 #endif
-            if( processToken()) {
-            	nextState( YRSHELL_PARSING);
-            }
-        } else {
-            m_token = strtok_r( NULL, "\t ", &m_saveptr);
-            if( m_token == NULL) {
-                shellERROR( __FILE__, __LINE__, "NULL DEFINITION");
+                if( processToken() && m_state == YRSHELL_BEGIN_PARSING) {
+                	nextState( YRSHELL_PARSING);
+                }
             } else {
-                if( !m_DictionaryCurrent->newCompile(m_token)) {
-                    shellERROR( __FILE__, __LINE__, "DICTIONARY FULL");
+                m_token = strtok_r( NULL, "\t ", &m_saveptr);
+                if( m_token == NULL) {
+                    shellERROR( __FILE__, __LINE__, "NULL DEFINITION");
                 } else {
+                    if( !m_DictionaryCurrent->newCompile(m_token)) {
+                        shellERROR( __FILE__, __LINE__, "DICTIONARY FULL");
+                    } else {
 #ifdef YRSHELL_DEBUG
-                    if( m_debugFlags & YRSHELL_DEBUG_TOKEN) {
-                        outString("\r\nCOMPILING ");
-                    }
-                    debugToken();
+                        if( m_debugFlags & YRSHELL_DEBUG_TOKEN) {
+                            outString("\r\nCOMPILING ");
+                        }
+                        debugToken();
 #endif
-                    nextState( YRSHELL_COMPILING);
+                        nextState( YRSHELL_COMPILING);
+                    }
                 }
             }
         }
@@ -1821,14 +2186,168 @@ void YRShellInterpreter::setOutputTimeout( uint32_t t) {
     m_outputTimeoutInMilliseconds = t;
 }
 
+void YRShellInterpreter::setSliceBudget( uint16_t tokens, uint32_t micros) {
+    m_sliceTokenBudget = tokens == 0 ? 1 : tokens;
+    m_sliceTimeBudget = micros;
+}
+
 uint16_t YRShellInterpreter::outputSpace( ) {
-    return  m_useTextOutput ? m_textBufferSize - strlen(m_TextBuffer): (m_useAuxQueues ? m_AuxOutq->free() : m_Outq->free());
+    return  m_useTextOutput ? m_textBufferSize - textLength(): (m_useAuxQueues ? m_AuxOutq->free() : m_Outq->free());
 }
 bool YRShellInterpreter::isIdle( ) {
     return m_state == YRSHELL_IDLE;
 }
- 
+bool YRShellInterpreter::isBatchState( ) {
+    bool rc = false;
+    switch( m_state) {
+        case YRSHELL_FILLING_PAD:
+            rc = m_Inq->valueAvailable();
+            break;
+        case YRSHELL_FILLING_AUXPAD:
+            rc = m_AuxInq->valueAvailable();
+            break;
+        case YRSHELL_BEGIN_PARSING:
+        case YRSHELL_PARSING:
+        case YRSHELL_COMPILING:
+        case YRSHELL_EXECUTING:
+            rc = true;
+            break;
+        default:
+            break;
+    }
+    return rc;
+}
+template<class T> static inline void exchange( T& a, T& b) {
+    T t = a;
+    a = b;
+    b = t;
+}
+void YRShellInterpreter::exchangeContext( YRShellContext* c) {
+    for( uint8_t i = 0; i < sizeof( m_stateStack) / sizeof( m_stateStack[ 0]); i++) {
+        exchange( m_stateStack[ i], c->m_stateStack[ i]);
+    }
+    exchange( m_state, c->m_state);
+    exchange( m_stateTopOfStack, c->m_stateTopOfStack);
+    exchange( m_Inq, c->m_Inq);
+    exchange( m_AuxInq, c->m_AuxInq);
+    exchange( m_Outq, c->m_Outq);
+    exchange( m_AuxOutq, c->m_AuxOutq);
+    exchange( m_commandEcho, c->m_commandEcho);
+    exchange( m_hexMode, c->m_hexMode);
+    exchange( m_requestUseAuxQueues, c->m_requestUseAuxQueues);
+    exchange( m_requestUseMainQueues, c->m_requestUseMainQueues);
+    exchange( m_lastUseAuxQueues, c->m_lastUseAuxQueues);
+    exchange( m_useAuxQueues, c->m_useAuxQueues);
+    exchange( m_useTextOutput, c->m_useTextOutput);
+    exchange( m_promptEnable, c->m_promptEnable);
+    exchange( m_prompt, c->m_prompt);
+    exchange( m_outputTimeout, c->m_outputTimeout);
+    exchange( m_delayTimer, c->m_delayTimer);
+    exchange( m_Pad, c->m_Pad);
+    exchange( m_padCount, c->m_padCount);
+    exchange( m_padSize, c->m_padSize);
+    exchange( m_ParameterStack, c->m_ParameterStack);
+    exchange( m_ReturnStack, c->m_ReturnStack);
+    exchange( m_CompileStack, c->m_CompileStack);
+    exchange( m_parameterStackSize, c->m_parameterStackSize);
+    exchange( m_returnStackSize, c->m_returnStackSize);
+    exchange( m_compileStackSize, c->m_compileStackSize);
+    exchange( m_topOfStack, c->m_topOfStack);
+    exchange( m_returnTopOfStack, c->m_returnTopOfStack);
+    exchange( m_compileTopOfStack, c->m_compileTopOfStack);
+    exchange( m_token, c->m_token);
+    exchange( m_saveptr, c->m_saveptr);
+    exchange( m_PC, c->m_PC);
+    exchange( m_outputStrPtr, c->m_outputStrPtr);
+    exchange( m_outputStr0, c->m_outputStr0);
+    exchange( m_outputStr1, c->m_outputStr1);
+    exchange( m_outputStr2, c->m_outputStr2);
+    exchange( m_outputStr3, c->m_outputStr3);
+    exchange( m_outputUint, c->m_outputUint);
+    exchange( m_outputUintValid, c->m_outputUintValid);
+    exchange( m_lineBase, c->m_lineBase);
+    exchange( m_lineLimit, c->m_lineLimit);
+}
+static bool isCompilingLine( YRShellState state, const YRShellState* stack, uint8_t top) {
+    bool rc = state == YRSHELL_PARSING || state == YRSHELL_COMPILING;
+    for( uint8_t i = 0; !rc && i < top; i++) {
+        rc = stack[ i] == YRSHELL_PARSING || stack[ i] == YRSHELL_COMPILING;
+    }
+    return rc;
+}
+YRShellContext* YRShellInterpreter::nextContext( ) {
+    uint8_t turn = m_numContexts;
+    if( m_state == YRSHELL_NOT_INITIALIZED) {
+        turn = m_numContexts;
+    } else if( m_contextTurn < m_numContexts ? isCompilingLine( m_contexts[ m_contextTurn]->m_state, m_contexts[ m_contextTurn]->m_stateStack,
+            m_contexts[ m_contextTurn]->m_stateTopOfStack) : isCompilingLine( m_state, m_stateStack, m_stateTopOfStack)) {
+        // The current dictionary holds the line or definition being compiled, it has to finish first
+        turn = m_contextTurn;
+    } else {
+        // Round robin over the contexts with something to do, the interpreter's own always gets its turn
+        bool found = false;
+        for( uint8_t i = 1; !found && i <= m_numContexts; i++) {
+            turn = (m_contextTurn + i) % (m_numContexts + 1);
+            found = turn == m_numContexts || !m_contexts[ turn]->isIdle();
+        }
+        if( !found) {
+            turn = m_numContexts;
+        }
+    }
+    m_contextTurn = turn;
+    return turn < m_numContexts ? m_contexts[ turn] : NULL;
+}
+bool YRShellInterpreter::addContext( YRShellContext* c) {
+    bool rc = false;
+    if( c != NULL && m_numContexts < YRSHELL_MAX_CONTEXTS && m_DictionaryCurrent != NULL && m_activeContext == NULL) {
+        if( m_lineLimit == 0) {
+            m_lineBase = m_DictionaryCurrent->reserve( m_padSize + 2);
+            if( m_lineBase != YRSHELL_DICTIONARY_INVALID) {
+                m_lineLimit = m_lineBase + m_padSize + 2;
+            }
+        }
+        if( m_lineLimit != 0) {
+            c->m_lineBase = m_DictionaryCurrent->reserve( c->m_padSize + 2);
+            if( c->m_lineBase != YRSHELL_DICTIONARY_INVALID) {
+                c->m_lineLimit = c->m_lineBase + c->m_padSize + 2;
+                m_contexts[ m_numContexts++] = c;
+                m_contextTurn = m_numContexts;
+                rc = true;
+            }
+        }
+    }
+    return rc;
+}
 void YRShellInterpreter::slice(void) {
+    YRShellContext* c = m_numContexts > 0 ? nextContext() : NULL;
+    if( c != NULL) {
+        exchangeContext( c);
+        m_activeContext = c;
+    }
+    sliceContext();
+    if( c != NULL) {
+        m_activeContext = NULL;
+        exchangeContext( c);
+    }
+}
+void YRShellInterpreter::sliceContext(void) {
+    uint32_t start = HW_getMicros();
+    uint16_t steps = 0;
+    uint16_t passes = 0;
+    bool more;
+    do {
+        m_stepLimit = m_sliceTokenBudget - steps;
+        m_stepTokens = 1;
+        sliceStep();
+        steps += m_stepTokens;
+        more = steps < m_sliceTokenBudget && isBatchState();
+        // reading the clock costs about as much as a token, only check it every 16 steps
+        if( more && (++passes & 0x0F) == 0 && (HW_getMicros() - start) >= m_sliceTimeBudget) {
+            more = false;
+        }
+    } while( more);
+}
+void YRShellInterpreter::sliceStep(void) {
     char c;
     if( m_lastUseAuxQueues != m_useAuxQueues) {
         m_lastUseAuxQueues = m_useAuxQueues;
@@ -1883,21 +2402,26 @@ void YRShellInterpreter::slice(void) {
             break;
         case YRSHELL_PARSING:
             m_token = strtok_r(NULL, "\t ", &m_saveptr);
-            processToken();
 #ifdef YRSHELL_DEBUG
             debugToken();
 #endif
-            if( m_token == NULL) {
+            // an undefined token or an error has already reset the interpreter and queued its message
+            if( processToken() && m_state == YRSHELL_PARSING && m_token == NULL) {
+                if( m_lineCache != NULL) {
+                    uint16_t end;
+                    uint16_t start = m_PC & YRSHELL_DICTIONARY_ADDRESS_MASK;
+                    const uint16_t* code = m_DictionaryCurrent->getCode( &end);
+                    m_lineCache->add( code + start, m_DictionaryCurrent->getWordEnd() - start);
+                }
                 nextState( YRSHELL_EXECUTING);
             }
             break;
         case YRSHELL_COMPILING:
             m_token = strtok_r(NULL, "\t ", &m_saveptr);
-            processToken();
 #ifdef YRSHELL_DEBUG
             debugToken();
 #endif
-            if( m_token == NULL) {
+            if( processToken() && m_state == YRSHELL_COMPILING && m_token == NULL) {
                 if( m_compileTopOfStack) {
                     m_DictionaryCurrent->rollBack();
                     shellERROR(__FILE__, __LINE__, "INCOMPLETE CONTROL STRUCTURE");
@@ -1920,8 +2444,8 @@ void YRShellInterpreter::slice(void) {
                 if( m_outputTimeoutInMilliseconds != 0) {
                     shellERROR( __FILE__, __LINE__, "OUTPUT WAIT FOR SPACE TIMEOUT");
                 } else {
-                    m_Outq->drop(  m_Outq->size()/2 - m_Outq->free() );
-                    m_AuxOutq->drop( m_Outq->size()/2 - m_AuxOutq->free());
+                    discardToHalf( m_Outq);
+                    discardToHalf( m_AuxOutq);
                 }
             }
             break;
@@ -1933,8 +2457,8 @@ void YRShellInterpreter::slice(void) {
         case YRSHELL_OUTPUT_STR:
             if( outputSpace() < 6) {
                 if( m_outputTimeoutInMilliseconds == 0) {
-                    m_Outq->drop(  m_Outq->size()/2 - m_Outq->free() );
-                    m_AuxOutq->drop( m_Outq->size()/2 - m_AuxOutq->free());
+                    discardToHalf( m_Outq);
+                    discardToHalf( m_AuxOutq);
                 }
             } else {
                 while( m_outputStrPtr != NULL && outputSpace() >= 4 ) {
@@ -1989,14 +2513,30 @@ void YRShellInterpreter::slice(void) {
         pushState( YRSHELL_OUTPUT);
     }
 }
-bool YRShellInterpreter::processLiteralToken( ){
+bool YRShellInterpreter::stringToNumber( const char* P, uint32_t* V) {
     bool rc = false;
-    uint32_t value;
-    if( stringToUnsigned( m_token, &value) || stringToUnsignedX( m_token, &value)
+    uint32_t whole;
+    const char* E;
+    if( *P == '0' && *(P+1) == 'x') {
+        rc = stringToUnsignedX( P, V);
+    } else if( *P != '\0') {
+        // The digits are read once, for an integer or the whole part of a float
+        E = stringToUnsignedInternal( P, &whole);
+        if( *E == '\0') {
+            *V = whole;
+            rc = true;
 #ifdef YRSHELL_INTERPRETER_FLOATING_POINT
-                || stringToFloat( m_token, &value)
+        } else if( *E == '.') {
+            rc = stringToFloatFraction( (int32_t) whole, E + 1, V);
 #endif
-            ) {
+        }
+    }
+    return rc;
+}
+bool YRShellInterpreter::processLiteralToken( ){
+    bool rc = false;
+    uint32_t value;
+    if( stringToNumber( m_token, &value)) {
         rc = true;
         if( (value & 0xFFFF0000) == 0xFFFF0000) {
             if( !m_DictionaryCurrent->addToken( SI_CC_nint16)) {
@@ -2062,6 +2602,19 @@ bool YRShellInterpreter::processToken( ){
     return ret;
 }
 void YRShellInterpreter::executing( ) {
+#ifdef YRSHELL_THREADED_CODE
+    uint16_t count = 0;
+#ifdef YRSHELL_DEBUG
+    if( (m_debugFlags & YRSHELL_DEBUG_EXECUTE) == 0)
+#endif
+    // The profiler times each token, they take the general path
+    if( !isProfiling()) {
+        count = executeThreaded( m_stepLimit);
+    }
+    if( count != 0) {
+        m_stepTokens = count;
+    } else
+#endif
     if( (m_PC & YRSHELL_DICTIONARY_ADDRESS_MASK) == 0) {
         m_DictionaryCurrent->rollBack();
         nextState( YRSHELL_BEGIN_IDLE);
@@ -2083,6 +2636,301 @@ void YRShellInterpreter::executing( ) {
         executeToken( token);
     }
 }
+#ifdef YRSHELL_THREADED_CODE
+/*
+ The inner loop keeps the code array of the dictionary the PC is in and dispatches on the raw token. Compiled
+ word calls, returns, literals, jumps, stack and arithmetic primitives and the superinstructions run here. Each
+ case checks its stack and code bounds first and leaves the token to the general path when a check would
+ fail, so errors are reported exactly as before.
+ */
+uint16_t YRShellInterpreter::executeThreaded( uint16_t limit) {
+    uint32_t* ps = m_ParameterStack;
+    const uint16_t* code = NULL;
+    uint16_t codeIndex = YRSHELL_DICTIONARY_LAST_INDEX;
+    uint16_t codeEnd = 0;
+    uint16_t count = 0;
+    bool run = true;
+
+    while( run && count < limit) {
+        uint16_t address = m_PC & YRSHELL_DICTIONARY_ADDRESS_MASK;
+        uint16_t index = (m_PC & YRSHELL_DICTIONARY_MASK) >> YRSHELL_DICTIONARY_NUMBER_ADDRESS_BITS;
+        if( index == YRSHELL_DICTIONARY_LAST_INDEX) {
+            index = (m_PC >> YRSHELL_DICTIONARY_NUMBER_TOKEN_BITS) & YRSHELL_DICTIONARY_LAST_INDEX;
+        }
+        if( index != codeIndex) {
+            codeIndex = index;
+            code = (index < YRSHELL_DICTIONARY_LAST_INDEX && m_dictionaryList[ index] != NULL) ? m_dictionaryList[ index]->getCode( &codeEnd) : NULL;
+        }
+        if( address == 0 || code == NULL || address >= codeEnd) {
+            break;
+        }
+        uint16_t token = code[ address];
+        uint16_t top = m_topOfStack;
+        uint16_t operands = codeEnd - address - 1;
+        uint16_t target = 0;
+        uint32_t v1, v2;
+        run = token != YRSHELL_DICTIONARY_INVALID;
+
+        switch( run ? token & YRSHELL_DICTIONARY_MASK : 0) {
+            case YRSHELL_DICTIONARY_INTERPRETER_COMPILED:
+            case YRSHELL_DICTIONARY_EXTENSION_COMPILED:
+            case YRSHELL_DICTIONARY_CURRENT:
+            case YRSHELL_DICTIONARY_RELATIVE:
+                run = m_returnTopOfStack < m_returnStackSize;
+                if( run) {
+                    m_PC++;
+                    executeToken( token);
+                }
+                break;
+            case YRSHELL_DICTIONARY_INTERPRETER_FUNCTION:
+                switch( token) {
+                    case SI_CC_return:
+                        run = m_returnTopOfStack > 0;
+                        if( run) {
+                            m_PC = m_ReturnStack[ --m_returnTopOfStack];
+                        }
+                        break;
+                    case SI_CC_uint16:
+                    case SI_CC_nint16:
+                        run = operands >= 1 && top < m_parameterStackSize;
+                        if( run) {
+                            v1 = code[ address + 1];
+                            ps[ m_topOfStack++] = token == SI_CC_nint16 ? v1 | 0xFFFF0000 : v1;
+                            m_PC += 2;
+                        }
+                        break;
+                    case SI_CC_uint32:
+                        run = operands >= 2 && top < m_parameterStackSize;
+                        if( run) {
+                            ps[ m_topOfStack++] = code[ address + 1] | (((uint32_t) code[ address + 2]) << 16);
+                            m_PC += 3;
+                        }
+                        break;
+                    case SI_CC_x_else:
+                    case SI_CC_jmp:
+                        run = operands >= 1 && code[ address + 1] != YRSHELL_DICTIONARY_INVALID;
+                        target = 1;
+                        break;
+                    case SI_CC_x_if:
+                    case SI_CC_x_until:
+                    case SI_CC_jmpz:
+                        run = operands >= 1 && top >= 1 && code[ address + 1] != YRSHELL_DICTIONARY_INVALID;
+                        if( run) {
+                            target = ps[ --m_topOfStack] == 0 ? 1 : 0;
+                            if( target == 0) {
+                                m_PC += 2;
+                            }
+                        }
+                        break;
+                    case SI_CC_x_equalJmpz:
+                    case SI_CC_x_notEqualJmpz:
+                        run = operands >= 1 && top >= 2 && code[ address + 1] != YRSHELL_DICTIONARY_INVALID;
+                        if( run) {
+                            m_topOfStack -= 2;
+                            target = ((ps[ top - 2] == ps[ top - 1]) != (token == SI_CC_x_equalJmpz)) ? 1 : 0;
+                            if( target == 0) {
+                                m_PC += 2;
+                            }
+                        }
+                        break;
+                    case SI_CC_x_zeroEqualJmpz:
+                        run = operands >= 1 && top >= 1 && code[ address + 1] != YRSHELL_DICTIONARY_INVALID;
+                        if( run) {
+                            target = ps[ --m_topOfStack] != 0 ? 1 : 0;
+                            if( target == 0) {
+                                m_PC += 2;
+                            }
+                        }
+                        break;
+                    case SI_CC_x_dupLitEqualJmpz:
+                        run = operands >= 2 && top >= 1 && code[ address + 2] != YRSHELL_DICTIONARY_INVALID;
+                        if( run) {
+                            target = ps[ top - 1] != code[ address + 1] ? 2 : 0;
+                            if( target == 0) {
+                                m_PC += 3;
+                            }
+                        }
+                        break;
+                    case SI_CC_x_litPlus:
+                    case SI_CC_x_litMinus:
+                    case SI_CC_x_litEqual:
+                        run = operands >= 1 && top >= 1;
+                        if( run) {
+                            v1 = code[ address + 1];
+                            v2 = ps[ top - 1];
+                            ps[ top - 1] = token == SI_CC_x_litPlus ? v2 + v1 : (token == SI_CC_x_litMinus ? v2 - v1 : v2 == v1);
+                            m_PC += 2;
+                        }
+                        break;
+                    case SI_CC_x_begin:
+                    case SI_CC_x_then:
+                    case SI_CC_noop:
+                        m_PC++;
+                        break;
+                    case SI_CC_dup:
+                        run = top >= 1 && top < m_parameterStackSize;
+                        if( run) {
+                            ps[ top] = ps[ top - 1];
+                            m_topOfStack++;
+                            m_PC++;
+                        }
+                        break;
+                    case SI_CC_over:
+                        run = top >= 2 && top < m_parameterStackSize;
+                        if( run) {
+                            ps[ top] = ps[ top - 2];
+                            m_topOfStack++;
+                            m_PC++;
+                        }
+                        break;
+                    case SI_CC_2dup:
+                        run = top >= 2 && top + 1 < m_parameterStackSize;
+                        if( run) {
+                            ps[ top] = ps[ top - 2];
+                            ps[ top + 1] = ps[ top - 1];
+                            m_topOfStack += 2;
+                            m_PC++;
+                        }
+                        break;
+                    case SI_CC_drop:
+                        run = top >= 1;
+                        if( run) {
+                            m_topOfStack--;
+                            m_PC++;
+                        }
+                        break;
+                    case SI_CC_2drop:
+                        run = top >= 2;
+                        if( run) {
+                            m_topOfStack -= 2;
+                            m_PC++;
+                        }
+                        break;
+                    case SI_CC_swap:
+                        run = top >= 2;
+                        if( run) {
+                            v1 = ps[ top - 1];
+                            ps[ top - 1] = ps[ top - 2];
+                            ps[ top - 2] = v1;
+                            m_PC++;
+                        }
+                        break;
+                    case SI_CC_nip:
+                        run = top >= 2;
+                        if( run) {
+                            ps[ top - 2] = ps[ top - 1];
+                            m_topOfStack--;
+                            m_PC++;
+                        }
+                        break;
+                    case SI_CC_rot:
+                        run = top >= 3;
+                        if( run) {
+                            v1 = ps[ top - 3];
+                            ps[ top - 3] = ps[ top - 2];
+                            ps[ top - 2] = ps[ top - 1];
+                            ps[ top - 1] = v1;
+                            m_PC++;
+                        }
+                        break;
+                    case SI_CC_toR:
+                        run = top >= 1 && m_returnTopOfStack < m_returnStackSize;
+                        if( run) {
+                            m_ReturnStack[ m_returnTopOfStack++] = ps[ --m_topOfStack];
+                            m_PC++;
+                        }
+                        break;
+                    case SI_CC_fromR:
+                        run = m_returnTopOfStack > 0 && top < m_parameterStackSize;
+                        if( run) {
+                            ps[ m_topOfStack++] = m_ReturnStack[ --m_returnTopOfStack];
+                            m_PC++;
+                        }
+                        break;
+                    case SI_CC_negate:
+                    case SI_CC_zeroEqual:
+                    case SI_CC_zeroNotEqual:
+                        run = top >= 1;
+                        if( run) {
+                            v1 = ps[ top - 1];
+                            ps[ top - 1] = token == SI_CC_negate ? 0 - v1 : (token == SI_CC_zeroEqual ? v1 == 0 : v1 != 0);
+                            m_PC++;
+                        }
+                        break;
+                    case SI_CC_plus:
+                    case SI_CC_minus:
+                    case SI_CC_multiply:
+                    case SI_CC_and:
+                    case SI_CC_or:
+                    case SI_CC_xor:
+                    case SI_CC_lessThan:
+                    case SI_CC_lessEqual:
+                    case SI_CC_equal:
+                    case SI_CC_notEqual:
+                    case SI_CC_greaterThan:
+                    case SI_CC_greaterThanEqual:
+                    case SI_CC_x_overPlus:
+                        run = top >= 2;
+                        if( run) {
+                            v1 = ps[ top - 1];
+                            v2 = ps[ top - 2];
+                            switch( token) {
+                                case SI_CC_plus:                v2 = v2 + v1; break;
+                                case SI_CC_minus:               v2 = v2 - v1; break;
+                                case SI_CC_multiply:            v2 = v2 * v1; break;
+                                case SI_CC_and:                 v2 = v2 & v1; break;
+                                case SI_CC_or:                  v2 = v2 | v1; break;
+                                case SI_CC_xor:                 v2 = v2 ^ v1; break;
+                                case SI_CC_lessThan:            v2 = ((int32_t) v2) < ((int32_t) v1); break;
+                                case SI_CC_lessEqual:           v2 = ((int32_t) v2) <= ((int32_t) v1); break;
+                                case SI_CC_equal:               v2 = v2 == v1; break;
+                                case SI_CC_notEqual:            v2 = v2 != v1; break;
+                                case SI_CC_greaterThan:         v2 = ((int32_t) v2) > ((int32_t) v1); break;
+                                case SI_CC_greaterThanEqual:    v2 = ((int32_t) v2) >= ((int32_t) v1); break;
+                                default:                        break;
+                            }
+                            if( token == SI_CC_x_overPlus) {
+                                ps[ top - 1] = v1 + v2;
+                            } else {
+                                ps[ top - 2] = v2;
+                                m_topOfStack--;
+                            }
+                            m_PC++;
+                        }
+                        break;
+                    default:
+                        run = false;
+                        break;
+                }
+                break;
+            default:
+                run = false;
+                break;
+        }
+        if( run) {
+            if( target != 0) {
+                // as in the general path, the target keeps the relative bits of the PC
+                m_PC &= YRSHELL_DICTIONARY_RELATIVE_ALL_MASK;
+                m_PC |= code[ address + target] & ~YRSHELL_DICTIONARY_RELATIVE_ALL_MASK;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+#endif
+const char* YRShellInterpreter::getTokenName( uint16_t token) {
+    const char* rc = NULL;
+    for( uint8_t i = YRSHELL_DICTIONARY_CURRENT_INDEX; rc == NULL && i < YRSHELL_DICTIONARY_LAST_INDEX; i++) {
+        Dictionary* D = m_dictionaryList[ i];
+        for( uint16_t e = D != NULL ? D->getFirstEntry() : YRSHELL_DICTIONARY_INVALID; rc == NULL && e != YRSHELL_DICTIONARY_INVALID; e = D->getNextEntry( e)) {
+            if( D->getToken( e) == token) {
+                rc = getAddressFromToken( D->getNameAddressToken( e));
+            }
+        }
+    }
+    return rc;
+}
 const char* YRShellInterpreter::getAddressFromToken( uint16_t token) {
     const char *rc = NULL;
     uint16_t address = YRSHELL_DICTIONARY_ADDRESS_MASK & token;
@@ -2123,6 +2971,67 @@ uint16_t YRShellInterpreter::fetchCurrentValueToken( ) {
     return token;
 }
 
+int8_t YRShellInterpreter::decompileFused( uint16_t address, uint16_t token) {
+    int8_t rc = 1;
+    const char* before = NULL;
+    const char* after = NULL;
+    bool jump = true;
+    switch( token) {
+        case SI_CC_x_litPlus:
+            after = " +";
+            jump = false;
+            break;
+        case SI_CC_x_litMinus:
+            after = " -";
+            jump = false;
+            break;
+        case SI_CC_x_litEqual:
+            after = " ==";
+            jump = false;
+            break;
+        case SI_CC_x_equalJmpz:
+            before = " ==";
+            break;
+        case SI_CC_x_notEqualJmpz:
+            before = " !=";
+            break;
+        case SI_CC_x_zeroEqualJmpz:
+            before = " 0==";
+            break;
+        case SI_CC_x_dupLitEqualJmpz:
+            before = " dup";
+            after = " ==";
+            rc = 2;
+            break;
+        case SI_CC_x_overPlus:
+            before = " over +";
+            jump = false;
+            rc = 0;
+            break;
+        default:
+            rc = -1;
+            break;
+    }
+    if( before != NULL) {
+        outString( before);
+    }
+    if( after != NULL) {
+        uint16_t literal = fetchValueToken( address + 1);
+        outChar( ' ');
+        if( m_hexMode) {
+            outUint32Xn( literal);
+        } else {
+            outInt32n( literal);
+        }
+        outString( after);
+    }
+    if( rc > 0 && jump) {
+        // The jmpz of an if jumps forward, the one of an until back to its begin
+        uint16_t target = fetchValueToken( address + rc);
+        outString( (target & YRSHELL_DICTIONARY_ADDRESS_MASK) > (address & YRSHELL_DICTIONARY_ADDRESS_MASK) ? " [" : " }");
+    }
+    return rc;
+}
 uint16_t YRShellInterpreter::fetchCurrentToken( ) {
     uint16_t token = fetchCurrentValueToken();
     if( token == YRSHELL_DICTIONARY_INVALID) {
@@ -2133,6 +3042,9 @@ uint16_t YRShellInterpreter::fetchCurrentToken( ) {
 
 void YRShellInterpreter::executeToken( uint16_t token ) {
     uint16_t mask = YRSHELL_DICTIONARY_MASK & token;
+    bool profile = isProfiling();
+    uint8_t depth = m_returnTopOfStack;
+    uint32_t start = profile ? HW_getMicros() : 0;
     switch( mask) {
         case YRSHELL_DICTIONARY_INTERPRETER_COMPILED:
             pushReturnStack( m_PC);
@@ -2172,11 +3084,25 @@ void YRShellInterpreter::executeToken( uint16_t token ) {
             break;
         case YRSHELL_DICTIONARY_EXTENSION_FUNCTION:
             executeFunction(token);
+            // Extensions copy into the text buffer directly
+            m_textLength = TEXT_LENGTH_UNKNOWN;
             break;
         default:
             shellERROR( __FILE__, __LINE__);
             break;
     }
+    if( profile) {
+        if( mask == YRSHELL_DICTIONARY_INTERPRETER_FUNCTION || mask == YRSHELL_DICTIONARY_COMMON_FUNCTION || mask == YRSHELL_DICTIONARY_EXTENSION_FUNCTION) {
+            if( token != SI_CC_return) {
+                m_profiler->function( m_contextTurn, token, start);
+            }
+            m_profiler->leave( m_contextTurn, m_returnTopOfStack);
+        } else if( m_returnTopOfStack > depth) {
+            // Relative calls are counted under the absolute token of the word
+            uint16_t dictionary = (uint16_t) ((m_PC & YRSHELL_DICTIONARY_RELATIVE_MASK) >> (YRSHELL_DICTIONARY_NUMBER_TOKEN_BITS - YRSHELL_DICTIONARY_NUMBER_ADDRESS_BITS));
+            m_profiler->enter( m_contextTurn, dictionary | (uint16_t) (m_PC & YRSHELL_DICTIONARY_ADDRESS_MASK), m_returnTopOfStack);
+        }
+    }
 }
 CircularQBase<char>& YRShellInterpreter::getInq() {
     return *m_Inq;
@@ -2191,12 +3117,19 @@ CircularQBase<char>& YRShellInterpreter::getAuxOutq() {
     return *m_AuxOutq;
 }
 
+uint16_t YRShellInterpreter::textLength( ) {
+    if( m_textLength == TEXT_LENGTH_UNKNOWN) {
+        m_textLength = m_textBufferSize > 0 ? (uint16_t) strlen( m_TextBuffer) : 0;
+    }
+    return m_textLength;
+}
 void YRShellInterpreter::outCharRaw( const char c) {
     if( m_useTextOutput) {
-        uint32_t s = (uint32_t) strlen( m_TextBuffer);
+        uint32_t s = textLength();
         if( s < ((uint32_t) (m_textBufferSize - 1)) ) {
             m_TextBuffer[ s++] = c;
             m_TextBuffer[ s] = '\0';
+            m_textLength = (uint16_t) s;
         } else {
             if(  m_state != YRSHELL_INRESET) {
                 shellERROR( __FILE__, __LINE__, "TEXT OUTPUT BUFFER OVERFLOW");
@@ -2220,8 +3153,30 @@ void YRShellInterpreter::outChar( const char c) {
         outCharRaw( '\n');
     }
 }
+bool YRShellInterpreter::outBlock( const char* P, uint32_t n) {
+    bool rc = false;
+    if( !m_expandCR || memchr( P, '\r', n) == NULL) {
+        if( m_useTextOutput) {
+            uint32_t s = textLength();
+            if( s + n < (uint32_t) m_textBufferSize) {
+                memcpy( &m_TextBuffer[ s], P, n);
+                m_TextBuffer[ s + n] = '\0';
+                m_textLength = (uint16_t) (s + n);
+                rc = true;
+            }
+        } else {
+            CircularQBase<char>* Q = m_useAuxQueues ? m_AuxOutq : m_Outq;
+            if( Q->spaceAvailable( n)) {
+                Q->putN( P, n);
+                rc = true;
+            }
+        }
+    }
+    return rc;
+}
 void YRShellInterpreter::outString( const char* P) {
-    if( P != NULL) {
+    // Whole strings are copied in one go, a string that does not fit goes a character at a time to report the overflow
+    if( P != NULL && !outBlock( P, (uint32_t) strlen( P))) {
         while( *P != '\0') {
             outChar( *P++);
         }
@@ -2260,30 +3215,14 @@ void  YRShellInterpreter::pushFloat( float f) {
 }
 bool YRShellInterpreter::stringToFloat( const char* P, uint32_t* V) {
     bool rc = false;
-    float fv = 0.0f;
-    int32_t bd = 0, nd = 0, ad = 0, exp = 0;
-    const char *ep;
+    int32_t bd = 0;
+    *V = 0;
     if( *P != '\0') {
         P = stringToUnsignedInternal(P, (uint32_t*) &bd);
         if( *P++ == '.') {
-            ep = stringToUnsignedInternal(P, (uint32_t*) &ad);
-            nd = (uint32_t) (ep - P);
-            if( *ep == '\0') {
-                rc = true;
-            } else if( *ep == 'e' || *ep == 'E') {
-                ep++;
-                ep = stringToUnsignedInternal( ep, (uint32_t*) &exp);
-                if( *ep == '\0') {
-                    rc = -1;
-                }
-            }
+            rc = stringToFloatFraction( bd, P, V);
         }
     }
-    if( rc) {
-        fv = (powf(10.0f, nd) * ((float) bd) + ((float) ad)) * powf( 10.0f, exp - nd);
-    }
-    uint32_t* tp = ((uint32_t*) &fv);
-    *V = *tp;
     return rc;
 }
 void YRShellInterpreter::floatToString( float num, char *s) {
@@ -2300,7 +3239,7 @@ void YRShellInterpreter::floatToString( float num, char *s) {
     }
     fex =log10f( num);
     ex = (int) fex;
-    d = powf(10.f, (float) ex);
+    d = powerOf10( ex);
     num /= d;
     if( num < 1.0f) {
         num *= 10.0f;
@@ -2342,13 +3281,18 @@ void YRShellInterpreter::floatEngToString( float num, char *s) {
     if( eex < 0){
         ex -= 3;
     }
-    d = powf(10.f, (float) ex);
+    d = powerOf10( ex);
+    num /= d;
+    // log10f() of an exact power of ten below 1 leaves 4 digits before the point, with no room for the sign
+    if( num >= 1000.0f) {
+        num /= 1000.0f;
+        ex += 3;
+    }
     dc = eex - ex;
     if(eex < 0 ) {
         dc--;
     }
     
-    num /= d;
     unsignedToStringZero((uint32_t) num , 4, P);
     P1 = P;
     while( *P1 =='0') {
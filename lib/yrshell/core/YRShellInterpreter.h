@@ -7,11 +7,98 @@
 #include "CircularQ.h"
 #include "IntervalTimer.h"
 #include "Dictionary.h"
+#include "LineCache.h"
+#include "Profiler.h"
 
 #ifdef YRSHELL_INTERPRETER_FLOATING_POINT
 #include "math.h"
 #endif
 
+/** \brief Header of a snapshot of the interpreter state, see YRShellInterpreter::saveSnapshot().
+
+The header is followed by the committed current dictionary and the registers.
+*/
+typedef struct {
+    uint32_t    m_magic;            /**< YRSHELL_SNAPSHOT_MAGIC, changes with the layout. */
+    uint32_t    m_buildId;          /**< Supplied by the application, a snapshot only restores into the same build. */
+    uint32_t    m_fingerprint;      /**< YRShellInterpreter::getDictionaryFingerprint() when saved. */
+    uint32_t    m_extensionCrc;     /**< CRC of the extension compiled dictionary the saved words may call. */
+    uint32_t    m_userFlags;        /**< Application settings saved along with the interpreter. */
+    uint16_t    m_wordEnd;          /**< Words of current dictionary that follow the header. */
+    uint16_t    m_lastWord;         /**< Newest entry in the current dictionary. */
+    uint16_t    m_numRegisters;     /**< Registers that follow the dictionary. */
+    uint8_t     m_flags;            /**< YRSHELL_SNAPSHOT_ flags. */
+    uint8_t     m_reserved;
+    uint32_t    m_crc;              /**< CRC of the header up to here and everything after it. */
+} YRShellSnapshotHeader;
+
+#define YRSHELL_SNAPSHOT_MAGIC          0x31535259  // "YRS1"
+#define YRSHELL_SNAPSHOT_HEX_MODE       0x01
+#define YRSHELL_SNAPSHOT_PROMPT_ENABLE  0x02
+#define YRSHELL_SNAPSHOT_COMMAND_ECHO   0x04
+
+/** \brief Execution state of one client of a YRShellInterpreter, see YRShellInterpreter::addContext().
+
+A context has its own queues, pad, stacks, PC, state and output settings. It shares the dictionaries,
+registers and text buffer with the interpreter and its other contexts. Not meant to be instantiated, see
+YRShellSession.
+*/
+class YRShellContext {
+    friend class YRShellInterpreter;
+protected:
+    YRShellState                            m_stateStack[ 8], m_state;
+    uint8_t                                 m_stateTopOfStack;
+    CircularQBase<char>                     *m_Inq, *m_AuxInq, *m_Outq, *m_AuxOutq;
+
+    bool        m_commandEcho;
+    bool        m_hexMode;
+    bool        m_requestUseAuxQueues;
+    bool        m_requestUseMainQueues;
+    bool        m_lastUseAuxQueues;
+    bool        m_useAuxQueues;
+    bool        m_useTextOutput;
+    bool        m_promptEnable;
+    const char* m_prompt;
+
+    IntervalTimer m_outputTimeout;
+    IntervalTimer m_delayTimer;
+
+    char        *m_Pad;
+    uint16_t    m_padCount;
+    uint16_t    m_padSize;
+
+    uint32_t    *m_ParameterStack, *m_ReturnStack, *m_CompileStack;
+    uint8_t     m_parameterStackSize, m_returnStackSize, m_compileStackSize;
+    uint8_t     m_topOfStack;
+    uint8_t     m_returnTopOfStack;
+    uint8_t     m_compileTopOfStack;
+
+    char *m_token, *m_saveptr;
+    uint32_t m_PC;
+
+    const char* m_outputStrPtr;
+    const char* m_outputStr0;
+    const char* m_outputStr1;
+    const char* m_outputStr2;
+    const char* m_outputStr3;
+    unsigned m_outputUint;
+    bool m_outputUintValid;
+
+    uint16_t    m_lineBase;     /**< Current dictionary region lines are compiled into. */
+    uint16_t    m_lineLimit;
+
+public:
+    YRShellContext( void);
+    virtual ~YRShellContext( void);
+    CircularQBase<char>& getInq( void) { return *m_Inq; }
+    CircularQBase<char>& getOutq( void) { return *m_Outq; }
+    /** \brief True when the context waits for a line and none is queued.
+     */
+    bool isIdle( void) { return (m_state == YRSHELL_IDLE || m_state == YRSHELL_BEGIN_IDLE) && !m_Inq->valueAvailable(); }
+    void setCommandEcho( bool s) { m_commandEcho = s; }
+    void setPromptEnable( bool s) { m_promptEnable = s; }
+};
+
 /** \brief YRShellInterpreter - interactive
  
  Details on what YRShellInterpreter is
@@ -219,6 +306,24 @@ enum SI_CC_functions {
     SI_CC_floatToInt,
     SI_CC_intToFloat,
 #endif
+    SI_CC_slicePercentile,
+    SI_CC_sliceBudget,
+    SI_CC_setOptimize,
+
+    SI_CC_x_litPlus,            /**< uint16 N + */
+    SI_CC_x_litMinus,           /**< uint16 N - */
+    SI_CC_x_litEqual,           /**< uint16 N == */
+    SI_CC_x_equalJmpz,          /**< == jmpz A */
+    SI_CC_x_notEqualJmpz,       /**< != jmpz A */
+    SI_CC_x_zeroEqualJmpz,      /**< 0== jmpz A */
+    SI_CC_x_dupLitEqualJmpz,    /**< dup uint16 N == jmpz A */
+    SI_CC_x_overPlus,           /**< over + */
+
+    SI_CC_setProfile,
+    SI_CC_resetProfile,
+    SI_CC_profileStats,
+    SI_CC_printProfileName,
+    SI_CC_dcFused,
     SI_CC_last
 };
 
@@ -253,6 +358,10 @@ protected:
     uint32_t    m_outputTimeoutInMilliseconds;
     IntervalTimer m_outputTimeout;
     IntervalTimer m_delayTimer;
+    uint16_t    m_sliceTokenBudget;
+    uint32_t    m_sliceTimeBudget;
+    uint16_t    m_stepLimit;        /**< Tokens the current step may execute. */
+    uint16_t    m_stepTokens;       /**< Tokens the current step executed. */
     
     char        *m_Pad;
     uint16_t    m_padCount;
@@ -260,6 +369,7 @@ protected:
 
     char        *m_TextBuffer;
     uint16_t    m_textBufferSize;
+    uint16_t    m_textLength;       /**< strlen( m_TextBuffer) while text output appends to it, see textLength(). */
 
     uint32_t*   m_Registers;
     uint16_t    m_numRegisters;
@@ -285,6 +395,15 @@ protected:
     bool m_outputUintValid;
     
     CurrentVariableDictionary* m_DictionaryCurrent;
+    LineCacheBase* m_lineCache;
+    ProfilerBase* m_profiler;
+
+    YRShellContext* m_contexts[ YRSHELL_MAX_CONTEXTS];
+    uint8_t     m_numContexts;
+    uint8_t     m_contextTurn;      /**< Last context sliced, m_numContexts for the interpreter's own. */
+    YRShellContext* m_activeContext; /**< Context swapped in by slice(), NULL outside it or for the interpreter's own. */
+    uint16_t    m_lineBase;         /**< Region of the current dictionary lines are compiled into, once there are contexts. */
+    uint16_t    m_lineLimit;
     
 #ifdef YRSHELL_DEBUG
     void debugToken( void);
@@ -298,11 +417,18 @@ protected:
     virtual uint32_t shellSize( void) { return sizeof( *this); }
     virtual const char* shellClass( void) { return "YRShellInterpreter"; }
     virtual const char* sliceName( ) { return shellClass(); }
+    virtual uint16_t getSliceState( ) { return (uint16_t) m_state; }
     virtual const char* mainFileName( ) { return shellClass(); }
     virtual void init( void);
     
     void prompt( void);
     uint16_t outputSpace( void);
+    /** \brief Returns the length of the text buffer, counted again after a word wrote into it directly.
+     */
+    uint16_t textLength( void);
+    /** \brief Appends n characters to the output if they all fit without expanding a CR, returns false otherwise.
+     */
+    bool outBlock( const char* P, uint32_t n);
     void nextState( YRShellState n);
     void popState( void);
     void pushState( YRShellState n);
@@ -329,13 +455,54 @@ protected:
     uint16_t getAbsoluteAddressToken( void);
     uint16_t fetchValueToken( uint16_t tok);
     uint16_t fetchCurrentValueToken( void);
+    /** \brief Prints the superinstruction token at address as the words it was fused from, for dc.
+
+     Returns the number of operand words following the token, -1 if token is not a superinstruction.
+     */
+    int8_t decompileFused( uint16_t address, uint16_t token);
     const char* getAddressFromToken( uint16_t token);
+    /** \brief Returns the name of the entry with token, or NULL.
+     */
+    const char* getTokenName( uint16_t token);
+    inline bool isProfiling( void) { return m_profiler != NULL && m_profiler->isEnabled(); }
     uint16_t fetchCurrentToken( void);
     void executeToken( uint16_t token);
+    /** \brief Swaps the execution state with c.
+     */
+    void exchangeContext( YRShellContext* c);
+    /** \brief Picks the context to slice, NULL for the interpreter's own.
+     */
+    YRShellContext* nextContext( void);
+    inline YRShellContext* getActiveContext( void) { return m_activeContext; }
+    /** \brief Current dictionary address the code of the next line starts at.
+     */
+    uint16_t lineStart( void);
+    /** \brief Starts compiling a command line, in the line region once there are contexts.
+     */
+    bool newLine( void);
     void beginParsing( void);
+    /** \brief Starts executing the pad from the line cache, returns false if it has to be parsed.
+     */
+    bool beginCachedLine( void);
     bool processToken( void);
     bool processLiteralToken( void);
+    /** \brief Parses a decimal, 0x hex or float literal in one pass over the digits.
+     */
+    bool stringToNumber( const char* P, uint32_t* V);
     void executing( void);
+#ifdef YRSHELL_THREADED_CODE
+    /** \brief Executes up to limit tokens that only touch the stacks and the PC.
+
+     Returns the number of tokens executed. Stops without consuming the token at the first one that needs
+     the general path, an output, a state change or a stack check that would fail, so executeToken() handles it.
+     */
+    uint16_t executeThreaded( uint16_t limit);
+#endif
+    /** \brief Runs the active context for one slice budget.
+     */
+    void sliceContext( void);
+    void sliceStep( void);
+    bool isBatchState( void);
     
     
     void CC_clearPad( void);
@@ -364,7 +531,50 @@ public:
      
      */
     void setOutputTimeout( uint32_t t);
+    /** \brief Sets how much work one slice may do.
+
+     slice() keeps fetching and executing tokens, tokenizing the pad or filling it from the input queue
+     until it has run tokens steps, micros microseconds have passed, or the interpreter has to wait for
+     output space, a delay or more input. A token budget of 1 runs one step per slice.
+
+     */
+    void setSliceBudget( uint16_t tokens, uint32_t micros);
     void setPrompt( const char* prompt );
+    /** \brief Sets the cache of compiled command lines, NULL to parse every line.
+     */
+    void setLineCache( LineCacheBase* cache) { m_lineCache = cache; }
+    /** \brief Sets the table setProfile collects word times into, NULL to disable the profiler words.
+     */
+    void setProfiler( ProfilerBase* profiler) { m_profiler = profiler; }
+    /** \brief Adds an execution context that slice() runs interleaved with the interpreter's own.
+
+    Contexts switch between lines or while one waits or executes, never while a line or definition is being
+    compiled. Each context, and the interpreter once there is one, compiles its lines into a region reserved
+    at the top of the current dictionary. Call it while idle. Returns false if YRSHELL_MAX_CONTEXTS are in
+    use or the dictionary has no room for the region.
+    */
+    bool addContext( YRShellContext* c);
+    /** \brief Returns a CRC of every token a compiled word outside the current and extension compiled dictionaries can refer to.
+
+     Covers the native function tables and the interpreter compiled dictionary. A dictionary image built
+     by another firmware is only valid if the fingerprints match.
+     */
+    uint32_t getDictionaryFingerprint( void);
+    /** \brief Returns the number of bytes saveSnapshot() needs.
+     */
+    uint32_t getSnapshotSize( void);
+    /** \brief Saves the committed current dictionary, the registers and the output settings into buf.
+
+     Returns the number of bytes written, 0 if buf is too small. A word being compiled or the line being
+     executed is not included, so it can be called at any time.
+     */
+    uint32_t saveSnapshot( uint8_t* buf, uint32_t size, uint32_t buildId, uint32_t userFlags = 0);
+    /** \brief Restores a snapshot made by saveSnapshot().
+
+     Fails, changing nothing, unless the CRC, buildId, dictionary fingerprint, extension compiled dictionary,
+     dictionary size and number of registers all match. Only call it while the interpreter is idle.
+     */
+    bool restoreSnapshot( const uint8_t* buf, uint32_t size, uint32_t buildId, uint32_t* userFlags = NULL);
     
     virtual void slice( void);
     CircularQBase<char>& getInq( void);
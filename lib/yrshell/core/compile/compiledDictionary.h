@@ -91,41 +91,47 @@ static const uint16_t compiledDictionaryData[] = {
 0xC001 , 0x0525 , 0x645F , 0x3263 , 0x0000 , 0xC048 , 0xC041 , 0xC04A , 0xC001 , 0x0531 , 0x6364 , 0x4E77 , 0x6D61 , 0x0065 , 0xE4EF , 0xC035 , // 0x0530  ..%._dc2..H.A.J...1.dcwName...5.
 0xC009 , 0x0000 , 0xE24E , 0xC076 , 0xE535 , 0xC036 , 0xC01E , 0xC035 , 0xC031 , 0xC073 , 0xE54E , 0xE529 , 0xC074 , 0xE550 , 0xE515 , 0xC075 , // 0x0540  ....N.v.5.6...5.1.s.N.).t.P...u.
 0xC077 , 0xE544 , 0xC036 , 0xC01F , 0xC03E , 0xC073 , 0xE55A , 0xE504 , 0xC074 , 0xE55C , 0xC022 , 0xC075 , 0xC001 , 0x0539 , 0x6364 , 0x6177 , // 0x0550  w.D.6...>.s.Z...t.\.".u...9.dcwa
-0x0000 , 0xC01E , 0xC07D , 0xC03D , 0xC073 , 0xE56A , 0xC00B , 0xFFFF , 0xC074 , 0xE581 , 0xC022 , 0xC009 , 0x0001 , 0xC027 , 0xC01E , 0xC016 , // 0x0560  ....}.=.s.j.....t...".....'.....
-0x7320 , 0x2027 , 0x0000 , 0xC012 , 0xC082 , 0xC009 , 0x0027 , 0xC04F , 0xC01E , 0xC043 , 0xC009 , 0x0002 , 0xC02A , 0xC027 , 0xC009 , 0x0000 , // 0x0570   s' ........'.O...C.....*.'.....
-0xC075 , 0xC001 , 0x055D , 0x6364 , 0x3877 , 0x0000 , 0xC01E , 0xC079 , 0xC03D , 0xC073 , 0xE59D , 0xC01E , 0xC07A , 0xC03D , 0xC073 , 0xE593 , // 0x0580  u...].dcw8....y.=.s.....z.=.s...
-0xE561 , 0xC074 , 0xE59B , 0xC022 , 0xC016 , 0x5D20 , 0x0000 , 0xC012 , 0xC009 , 0x0000 , 0xC075 , 0xC074 , 0xE5A8 , 0xC022 , 0xC009 , 0x0001 , // 0x0590  a.t..."... ]........u.t...".....
-0xC027 , 0xC016 , 0x5D20 , 0x005B , 0xC012 , 0xC009 , 0x0000 , 0xC075 , 0xC001 , 0x0582 , 0x6364 , 0x3677 , 0x0000 , 0xC01E , 0xC07C , 0xC03D , // 0x05A0  '... ][.......u.....dcw6....|.=.
-0xC073 , 0xE5C7 , 0xC01E , 0xC078 , 0xC03D , 0xC073 , 0xE5BA , 0xE586 , 0xC074 , 0xE5C5 , 0xC022 , 0xC009 , 0x0001 , 0xC027 , 0xC016 , 0x5B20 , // 0x05B0  s.....x.=.s.....t...".....'... [
-0x0000 , 0xC012 , 0xC009 , 0x0000 , 0xC075 , 0xC074 , 0xE5D2 , 0xC022 , 0xC009 , 0x0001 , 0xC027 , 0xC016 , 0x7D20 , 0x0000 , 0xC012 , 0xC009 , // 0x05C0  ........u.t...".....'... }......
-0x0000 , 0xC075 , 0xC001 , 0x05A9 , 0x6364 , 0x3477 , 0x0000 , 0xC01E , 0xC071 , 0xC03D , 0xC073 , 0xE5EE , 0xC01E , 0xC07B , 0xC03D , 0xC073 , // 0x05D0  ..u.....dcw4....q.=.s.....{.=.s.
-0xE5E4 , 0xE5AD , 0xC074 , 0xE5EC , 0xC022 , 0xC016 , 0x7B20 , 0x0000 , 0xC012 , 0xC009 , 0x0000 , 0xC075 , 0xC074 , 0xE5FC , 0xC022 , 0xC009 , // 0x05E0  ....t..."... {........u.t..."...
-0x0001 , 0xC027 , 0xC01E , 0xC06A , 0xC00B , 0x0000 , 0xC027 , 0xC002 , 0xC083 , 0xC009 , 0x0000 , 0xC075 , 0xC001 , 0x05D3 , 0x6364 , 0x3377 , // 0x05F0  ..'...j.....'.........u.....dcw3
-0x0000 , 0xC01E , 0xC070 , 0xC03D , 0xC073 , 0xE609 , 0xE5D7 , 0xC074 , 0xE61E , 0xC022 , 0xC009 , 0x0001 , 0xC027 , 0xC01E , 0xC06A , 0xC01F , // 0x0600  ....p.=.s.....t...".....'...j...
-0xC009 , 0x0001 , 0xC027 , 0xC021 , 0xC06A , 0xC009 , 0x0010 , 0xC06B , 0xC027 , 0xC002 , 0xC083 , 0xC009 , 0x0000 , 0xC075 , 0xC001 , 0x05FD , // 0x0610  ....'.!.j.....k.'.........u.....
-0x6364 , 0x3177 , 0x0000 , 0xC01E , 0xC06E , 0xC03D , 0xC073 , 0xE63D , 0xC01E , 0xC06F , 0xC03D , 0xC073 , 0xE630 , 0xE601 , 0xC074 , 0xE63B , // 0x0620  dcw1....n.=.s.=...o.=.s.0...t.;.
-0xC022 , 0xC009 , 0x0001 , 0xC027 , 0xC01E , 0xC06A , 0xC002 , 0xC083 , 0xC009 , 0x0000 , 0xC075 , 0xC074 , 0xE640 , 0xC009 , 0x0000 , 0xC075 , // 0x0630  ".....'...j.........u.t.@.....u.
-0xC001 , 0x061F , 0x6364 , 0x0077 , 0xC01E , 0xC06A , 0xE623 , 0xC073 , 0xE64B , 0xE53E , 0xC075 , 0xC001 , 0x0641 , 0x645F , 0x3063 , 0x0000 , // 0x0640  ....dcw...j.#.s.K.>.u...A._dc0..
-0xC076 , 0xC01E , 0xC06A , 0xC06E , 0xC031 , 0xC073 , 0xE65C , 0xC022 , 0xC00B , 0xFFFF , 0xC074 , 0xE663 , 0xE644 , 0xC009 , 0x0001 , 0xC027 , // 0x0650  v...j.n.1.s.\.".....t.c.D.....'.
-0xC009 , 0x0000 , 0xC075 , 0xC077 , 0xE651 , 0xC001 , 0x064C , 0x6364 , 0x0000 , 0xC016 , 0x203A , 0x0000 , 0xC012 , 0xC01E , 0xC012 , 0xC068 , // 0x0660  ....u.w.Q...L.dc....: ........h.
-0xC01E , 0xC009 , 0xFFFF , 0xC03D , 0xC073 , 0xE679 , 0xE650 , 0xC074 , 0xE67B , 0xE504 , 0xC075 , 0xC003 , 0xC001 , 0x0666 , 0x7564 , 0x3277 , // 0x0670  ......=.s.y.P.t.{...u.....f.duw2
-0x0000 , 0xC01E , 0xC06A , 0xC01E , 0xC011 , 0xC06E , 0xC031 , 0xC024 , 0xC009 , 0x0001 , 0xC027 , 0xC041 , 0xC030 , 0xC025 , 0xC02D , 0xC001 , // 0x0680  ....j.....n.1.$.....'.A.0.%.-...
-0x067D , 0x7564 , 0x3177 , 0x0000 , 0xC01E , 0xC07E , 0xC073 , 0xE6A1 , 0xC016 , 0x4669 , 0x4E55 , 0x5443 , 0x4F49 , 0x004E , 0xC012 , 0xC074 , // 0x0690  }.duw1....~.s.....iFUNCTION...t.
-0xE6A6 , 0xC076 , 0xE681 , 0xC077 , 0xE6A2 , 0xC075 , 0xC001 , 0x0690 , 0x7564 , 0x0077 , 0xC068 , 0xC01E , 0xC009 , 0xFFFF , 0xC03D , 0xC073 , // 0x06A0  ..v...w...u.....duw.h.......=.s.
-0xE6C0 , 0xC01E , 0xC011 , 0xC016 , 0x203A , 0x0000 , 0xC012 , 0xC01E , 0xC009 , 0x0100 , 0xC027 , 0xC01F , 0xE694 , 0xC042 , 0xC074 , 0xE6C2 , // 0x06B0  ........: ..........'.....B.t...
-0xC022 , 0xC075 , 0xC003 , 0xC001 , 0x06A7 , 0x645F , 0x6163 , 0x0000 , 0xC01E , 0xC07E , 0xC073 , 0xE6D7 , 0xC016 , 0x2F2F , 0x0020 , 0xC012 , // 0x06C0  ".u......._dca....~.s.....// ...
-0xC022 , 0xC041 , 0xC049 , 0xC022 , 0xC003 , 0xC074 , 0xE6E3 , 0xC016 , 0x203A , 0x0000 , 0xC012 , 0xC035 , 0xC041 , 0xC049 , 0xC022 , 0xC036 , // 0x06D0  ".A.I."...t.....: ....5.A.I.".6.
-0xE650 , 0xC003 , 0xC075 , 0xC001 , 0x06C4 , 0x4164 , 0x3154 , 0x0000 , 0xC023 , 0xC009 , 0x0001 , 0xC027 , 0xC01E , 0xC035 , 0xC023 , 0xC023 , // 0x06E0  P...u.....dAT1..#.....'...5.#.#.
-0xC036 , 0xC036 , 0xC01E , 0xC035 , 0xC031 , 0xC001 , 0x06E4 , 0x4164 , 0x0054 , 0xC035 , 0xC009 , 0x0000 , 0xC009 , 0x0000 , 0xE24E , 0xC076 , // 0x06F0  6.6...5.1.....dAT.5.........N.v.
-0xC048 , 0xC01E , 0xE24E , 0xC031 , 0xC073 , 0xE70A , 0xC00B , 0xFFFF , 0xC074 , 0xE70C , 0xE6E8 , 0xC075 , 0xC077 , 0xE700 , 0xC036 , 0xC022 , // 0x0700  H...N.1.s.......t.....u.w...6.".
-0xC023 , 0xC022 , 0xC001 , 0x06F6 , 0x6364 , 0x6F43 , 0x6E75 , 0x0074 , 0xC009 , 0x0000 , 0xC009 , 0x0000 , 0xE24E , 0xC076 , 0xC048 , 0xC01E , // 0x0710  #.".....dcCount.........N.v.H...
-0xE24E , 0xC031 , 0xC073 , 0xE728 , 0xC00B , 0xFFFF , 0xC074 , 0xE731 , 0xC023 , 0xC009 , 0x0001 , 0xC027 , 0xC023 , 0xC023 , 0xC009 , 0x0000 , // 0x0720  N.1.s.(.....t.1.#.....'.#.#.....
-0xC075 , 0xC077 , 0xE71E , 0xC042 , 0xC001 , 0x0713 , 0x6364 , 0x6C41 , 0x006C , 0xE718 , 0xC076 , 0xC01E , 0xE6F9 , 0xC041 , 0xC04A , 0xE6C8 , // 0x0730  u.w...B.....dcAll...v.....A.J...
-0xC042 , 0xC009 , 0x0001 , 0xC028 , 0xC01E , 0xC009 , 0x0000 , 0xC031 , 0xC077 , 0xE73B , 0xC001 , 0x0735 , 0x656B , 0x0079 , 0xC076 , 0xC04B , // 0x0740  B.....(.......1.w.;...5.key.v.K.
-0xC073 , 0xE755 , 0xC00B , 0xFFFF , 0xC075 , 0xC077 , 0xE74F , 0xC001 , 0x074B , 0x7365 , 0x3F63 , 0x0000 , 0xC04B , 0xC073 , 0xE763 , 0xC009 , // 0x0750  s.U.....u.w.O...K.esc?..K.s.c...
-0x001B , 0xC031 , 0xC075 , 0xC001 , 
+0x0000 , 0xC01E , 0xC07D , 0xC03D , 0xC073 , 0xE569 , 0xC0B7 , 0xC074 , 0xE580 , 0xC022 , 0xC009 , 0x0001 , 0xC027 , 0xC01E , 0xC016 , 0x7320 , // 0x0560  ....}.=.s.i...t...".....'..... s
+0x2027 , 0x0000 , 0xC012 , 0xC082 , 0xC009 , 0x0027 , 0xC04F , 0xC01E , 0xC043 , 0xC009 , 0x0002 , 0xC02A , 0xC027 , 0xC009 , 0x0000 , 0xC075 , // 0x0570  ' ........'.O...C.....*.'.....u.
+0xC001 , 0x055D , 0x6364 , 0x3877 , 0x0000 , 0xC01E , 0xC079 , 0xC03D , 0xC073 , 0xE59C , 0xC01E , 0xC07A , 0xC03D , 0xC073 , 0xE592 , 0xE561 , // 0x0580  ..].dcw8....y.=.s.....z.=.s...a.
+0xC074 , 0xE59A , 0xC022 , 0xC016 , 0x5D20 , 0x0000 , 0xC012 , 0xC009 , 0x0000 , 0xC075 , 0xC074 , 0xE5A7 , 0xC022 , 0xC009 , 0x0001 , 0xC027 , // 0x0590  t..."... ]........u.t...".....'.
+0xC016 , 0x5D20 , 0x005B , 0xC012 , 0xC009 , 0x0000 , 0xC075 , 0xC001 , 0x0581 , 0x6364 , 0x3677 , 0x0000 , 0xC01E , 0xC07C , 0xC03D , 0xC073 , // 0x05A0  .. ][.......u.....dcw6....|.=.s.
+0xE5C6 , 0xC01E , 0xC078 , 0xC03D , 0xC073 , 0xE5B9 , 0xE585 , 0xC074 , 0xE5C4 , 0xC022 , 0xC009 , 0x0001 , 0xC027 , 0xC016 , 0x5B20 , 0x0000 , // 0x05B0  ....x.=.s.....t...".....'... [..
+0xC012 , 0xC009 , 0x0000 , 0xC075 , 0xC074 , 0xE5D1 , 0xC022 , 0xC009 , 0x0001 , 0xC027 , 0xC016 , 0x7D20 , 0x0000 , 0xC012 , 0xC009 , 0x0000 , // 0x05C0  ......u.t...".....'... }........
+0xC075 , 0xC001 , 0x05A8 , 0x6364 , 0x3477 , 0x0000 , 0xC01E , 0xC071 , 0xC03D , 0xC073 , 0xE5ED , 0xC01E , 0xC07B , 0xC03D , 0xC073 , 0xE5E3 , // 0x05D0  u.....dcw4....q.=.s.....{.=.s...
+0xE5AC , 0xC074 , 0xE5EB , 0xC022 , 0xC016 , 0x7B20 , 0x0000 , 0xC012 , 0xC009 , 0x0000 , 0xC075 , 0xC074 , 0xE5FB , 0xC022 , 0xC009 , 0x0001 , // 0x05E0  ..t..."... {........u.t...".....
+0xC027 , 0xC01E , 0xC06A , 0xC00B , 0x0000 , 0xC027 , 0xC002 , 0xC083 , 0xC009 , 0x0000 , 0xC075 , 0xC001 , 0x05D2 , 0x6364 , 0x3377 , 0x0000 , // 0x05F0  '...j.....'.........u.....dcw3..
+0xC01E , 0xC070 , 0xC03D , 0xC073 , 0xE608 , 0xE5D6 , 0xC074 , 0xE61D , 0xC022 , 0xC009 , 0x0001 , 0xC027 , 0xC01E , 0xC06A , 0xC01F , 0xC009 , // 0x0600  ..p.=.s.....t...".....'...j.....
+0x0001 , 0xC027 , 0xC021 , 0xC06A , 0xC009 , 0x0010 , 0xC06B , 0xC027 , 0xC002 , 0xC083 , 0xC009 , 0x0000 , 0xC075 , 0xC001 , 0x05FC , 0x6364 , // 0x0610  ..'.!.j.....k.'.........u.....dc
+0x3177 , 0x0000 , 0xC01E , 0xC06E , 0xC03D , 0xC073 , 0xE63C , 0xC01E , 0xC06F , 0xC03D , 0xC073 , 0xE62F , 0xE600 , 0xC074 , 0xE63A , 0xC022 , // 0x0620  w1....n.=.s.<...o.=.s./...t.:.".
+0xC009 , 0x0001 , 0xC027 , 0xC01E , 0xC06A , 0xC002 , 0xC083 , 0xC009 , 0x0000 , 0xC075 , 0xC074 , 0xE63F , 0xC009 , 0x0000 , 0xC075 , 0xC001 , // 0x0630  ....'...j.........u.t.?.....u...
+0x061E , 0x6364 , 0x0077 , 0xC01E , 0xC06A , 0xE622 , 0xC073 , 0xE64A , 0xE53E , 0xC075 , 0xC001 , 0x0640 , 0x645F , 0x3063 , 0x0000 , 0xC076 , // 0x0640  ..dcw...j.".s.J.>.u...@._dc0..v.
+0xC01E , 0xC06A , 0xC06E , 0xC031 , 0xC073 , 0xE65B , 0xC022 , 0xC00B , 0xFFFF , 0xC074 , 0xE662 , 0xE643 , 0xC009 , 0x0001 , 0xC027 , 0xC009 , // 0x0650  ..j.n.1.s.[.".....t.b.C.....'...
+0x0000 , 0xC075 , 0xC077 , 0xE650 , 0xC001 , 0x064B , 0x6364 , 0x0000 , 0xC016 , 0x203A , 0x0000 , 0xC012 , 0xC01E , 0xC012 , 0xC068 , 0xC01E , // 0x0660  ..u.w.P...K.dc....: ........h...
+0xC009 , 0xFFFF , 0xC03D , 0xC073 , 0xE678 , 0xE64F , 0xC074 , 0xE67A , 0xE504 , 0xC075 , 0xC003 , 0xC001 , 0x0665 , 0x7564 , 0x3277 , 0x0000 , // 0x0670  ....=.s.x.O.t.z...u.....e.duw2..
+0xC01E , 0xC06A , 0xC01E , 0xC011 , 0xC06E , 0xC031 , 0xC024 , 0xC009 , 0x0001 , 0xC027 , 0xC041 , 0xC030 , 0xC025 , 0xC02D , 0xC001 , 0x067C , // 0x0680  ..j.....n.1.$.....'.A.0.%.-...|.
+0x7564 , 0x3177 , 0x0000 , 0xC01E , 0xC07E , 0xC073 , 0xE6A0 , 0xC016 , 0x4669 , 0x4E55 , 0x5443 , 0x4F49 , 0x004E , 0xC012 , 0xC074 , 0xE6A5 , // 0x0690  duw1....~.s.....iFUNCTION...t...
+0xC076 , 0xE680 , 0xC077 , 0xE6A1 , 0xC075 , 0xC001 , 0x068F , 0x7564 , 0x0077 , 0xC068 , 0xC01E , 0xC009 , 0xFFFF , 0xC03D , 0xC073 , 0xE6BF , // 0x06A0  v...w...u.....duw.h.......=.s...
+0xC01E , 0xC011 , 0xC016 , 0x203A , 0x0000 , 0xC012 , 0xC01E , 0xC009 , 0x0100 , 0xC027 , 0xC01F , 0xE693 , 0xC042 , 0xC074 , 0xE6C1 , 0xC022 , // 0x06B0  ......: ..........'.....B.t...".
+0xC075 , 0xC003 , 0xC001 , 0x06A6 , 0x645F , 0x6163 , 0x0000 , 0xC01E , 0xC07E , 0xC073 , 0xE6D6 , 0xC016 , 0x2F2F , 0x0020 , 0xC012 , 0xC022 , // 0x06C0  u......._dca....~.s.....// ...".
+0xC041 , 0xC049 , 0xC022 , 0xC003 , 0xC074 , 0xE6E2 , 0xC016 , 0x203A , 0x0000 , 0xC012 , 0xC035 , 0xC041 , 0xC049 , 0xC022 , 0xC036 , 0xE64F , // 0x06D0  A.I."...t.....: ....5.A.I.".6.O.
+0xC003 , 0xC075 , 0xC001 , 0x06C3 , 0x4164 , 0x3154 , 0x0000 , 0xC023 , 0xC009 , 0x0001 , 0xC027 , 0xC01E , 0xC035 , 0xC023 , 0xC023 , 0xC036 , // 0x06E0  ..u.....dAT1..#.....'...5.#.#.6.
+0xC036 , 0xC01E , 0xC035 , 0xC031 , 0xC001 , 0x06E3 , 0x4164 , 0x0054 , 0xC035 , 0xC009 , 0x0000 , 0xC009 , 0x0000 , 0xE24E , 0xC076 , 0xC048 , // 0x06F0  6...5.1.....dAT.5.........N.v.H.
+0xC01E , 0xE24E , 0xC031 , 0xC073 , 0xE709 , 0xC00B , 0xFFFF , 0xC074 , 0xE70B , 0xE6E7 , 0xC075 , 0xC077 , 0xE6FF , 0xC036 , 0xC022 , 0xC023 , // 0x0700  ..N.1.s.......t.....u.w...6.".#.
+0xC022 , 0xC001 , 0x06F5 , 0x6364 , 0x6F43 , 0x6E75 , 0x0074 , 0xC009 , 0x0000 , 0xC009 , 0x0000 , 0xE24E , 0xC076 , 0xC048 , 0xC01E , 0xE24E , // 0x0710  ".....dcCount.........N.v.H...N.
+0xC031 , 0xC073 , 0xE727 , 0xC00B , 0xFFFF , 0xC074 , 0xE730 , 0xC023 , 0xC009 , 0x0001 , 0xC027 , 0xC023 , 0xC023 , 0xC009 , 0x0000 , 0xC075 , // 0x0720  1.s.'.....t.0.#.....'.#.#.....u.
+0xC077 , 0xE71D , 0xC042 , 0xC001 , 0x0712 , 0x6364 , 0x6C41 , 0x006C , 0xE717 , 0xC076 , 0xC01E , 0xE6F8 , 0xC041 , 0xC04A , 0xE6C7 , 0xC042 , // 0x0730  w...B.....dcAll...v.....A.J...B.
+0xC009 , 0x0001 , 0xC028 , 0xC01E , 0xC009 , 0x0000 , 0xC031 , 0xC077 , 0xE73A , 0xC001 , 0x0734 , 0x656B , 0x0079 , 0xC076 , 0xC04B , 0xC073 , // 0x0740  ....(.......1.w.:...4.key.v.K.s.
+0xE754 , 0xC00B , 0xFFFF , 0xC075 , 0xC077 , 0xE74E , 0xC001 , 0x074A , 0x7365 , 0x3F63 , 0x0000 , 0xC04B , 0xC073 , 0xE762 , 0xC009 , 0x001B , // 0x0750  T.....u.w.N...J.esc?..K.s.b.....
+0xC031 , 0xC075 , 0xC001 , 0x0757 , 0x705F , 0x3072 , 0x0000 , 0xC016 , 0x2020 , 0x2020 , 0x2020 , 0x4143 , 0x4C4C , 0x0053 , 0xC012 , 0xC016 , // 0x0760  1.u...W._pr0....      CALLS.....
+0x2020 , 0x4E49 , 0x4C43 , 0x5355 , 0x5649 , 0x0045 , 0xC012 , 0xC016 , 0x2020 , 0x5845 , 0x4C43 , 0x5355 , 0x5649 , 0x0045 , 0xC012 , 0xC016 , // 0x0770    INCLUSIVE.....  EXCLUSIVE.....
+0x2020 , 0x4E20 , 0x4D41 , 0x0045 , 0xC012 , 0xC003 , 0xC003 , 0xC001 , 0x0763 , 0x705F , 0x3172 , 0x0000 , 0xC01E , 0xC0B5 , 0xC01E , 0xC024 , // 0x0780     NAME.........c._pr1........$.
+0xC073 , 0xE79A , 0xC00C , 0xC00C , 0xC00C , 0xC002 , 0xC002 , 0xC0B6 , 0xC003 , 0xC075 , 0xC025 , 0xC001 , 0x0788 , 0x705F , 0x3272 , 0x0000 , // 0x0790  s.................u.%....._pr2..
+0xC040 , 0xC040 , 0xC032 , 0xC073 , 0xE7A8 , 0xE78C , 0xC074 , 0xE7AB , 0xC009 , 0x0000 , 0xC075 , 0xC001 , 0x079C , 0x7572 , 0x506E , 0x6F72 , // 0x07A0  @.@.2.s.....t.......u.....runPro
+0x6966 , 0x656C , 0x0000 , 0xE767 , 0xC009 , 0x0000 , 0xC076 , 0xE7A0 , 0xC073 , 0xE7C1 , 0xC009 , 0x0001 , 0xC027 , 0xC009 , 0x0000 , 0xC074 , // 0x07B0  file..g.....v...s.......'.....t.
+0xE7C4 , 0xC00B , 0xFFFF , 0xC075 , 0xC077 , 0xE7B7 , 0xC022 , 0xC022 , 0xC001 , 
 
 };
-static const CompiledDictionary interpreterCompiledDictionary( compiledDictionaryData, 0x0758 , 0x0764 , YRSHELL_DICTIONARY_INTERPRETER_COMPILED);
+static const CompiledDictionary interpreterCompiledDictionary( compiledDictionaryData, 0x07AC , 0x07C9 , YRSHELL_DICTIONARY_INTERPRETER_COMPILED);
 
 #endif
\ No newline at end of file
@@ -26,6 +26,7 @@ const char AppManager::s_PREF_NAMESPACE[] = "sys";
 const uint32_t AppManager::s_DEFAULT_RUN_TIME_MS = 0;
 const uint32_t AppManager::s_DEFAULT_SLEEP_TIME_MS = 0;
 const uint32_t AppManager::s_STATUS_INTERVAL_MS = 30000;
+const uint32_t AppManager::s_RUNNING_CHECK_MS = 100;
 
 RTC_DATA_ATTR static int m_bootCount = 0;
 
@@ -90,6 +91,9 @@ void AppManager::slice( void) {
                     preSleep_cb();
                 }
                 m_state = STATE_SLEEP_REQ;
+            } else {
+                // Nothing to do until the status timer or the run time expires
+                sliceSleep(m_timer.getRemaining() < s_RUNNING_CHECK_MS ? m_timer.getRemaining() : s_RUNNING_CHECK_MS);
             }
         break;
         case STATE_SLEEP_REQ:
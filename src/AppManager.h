@@ -17,6 +17,7 @@ private:
     static const uint32_t s_DEFAULT_RUN_TIME_MS;
     static const uint32_t s_DEFAULT_SLEEP_TIME_MS;
     static const uint32_t s_STATUS_INTERVAL_MS;
+    static const uint32_t s_RUNNING_CHECK_MS;
 
     const char* m_appName;
     const char* m_appVersion;
@@ -37,6 +38,7 @@ public:
     AppManager(const char* appName, const char* appVersion);
     virtual ~AppManager();
     virtual const char* sliceName( void) { return "AppManager"; }
+    virtual uint16_t getSliceState( void) { return (uint16_t) m_state; }
     void init(Preferences &pref);
     void save(Preferences &pref);
     virtual void slice( void);
@@ -5,7 +5,7 @@
 void LedBlink::setLedOnOffMs( uint32_t on, uint32_t off) {
   m_ledOnMs = on;
   m_ledOffMs = off;
-  m_ledTimer.setInterval( m_ledOffMs);
+  m_ledTimer.start( m_ledOffMs);
   gpio_set_level( (gpio_num_t) m_ledPin, 1);
   m_ledState = false;
 }
@@ -16,29 +16,35 @@ LedBlink::LedBlink( ) {
   m_ledOnMs = 1;
   m_ledOffMs = 10000;
   m_tos = 0;
+  m_ledTimer.setCallback( onLedTimer, this);
+  // The LED is driven from the timer callback, there is nothing to do per slice
+  sliceDisable();
 }
 
 void LedBlink::setLedPin( int8_t ledPin) {
   if( ledPin > 0) {
     m_ledPin = ledPin;
     gpio_set_direction( (gpio_num_t) m_ledPin, GPIO_MODE_OUTPUT);
+    if( !m_ledTimer.isRunning()) {
+      m_ledTimer.start( m_ledState ? m_ledOnMs : m_ledOffMs);
+    }
   }
 }
 
-void LedBlink::slice() {
+void LedBlink::onLedTimer( void* arg) {
+  ((LedBlink*) arg)->toggle();
+}
+
+void LedBlink::toggle() {
   if( m_ledPin > 0) {
     if( m_ledState) {
-      if( m_ledTimer.hasIntervalElapsed()) {
-        m_ledState = false;
-        m_ledTimer.setInterval( m_ledOffMs);
-        gpio_set_level( (gpio_num_t) m_ledPin, 1);
-      }
+      m_ledState = false;
+      m_ledTimer.start( m_ledOffMs);
+      gpio_set_level( (gpio_num_t) m_ledPin, 1);
     } else {
-      if( m_ledTimer.hasIntervalElapsed()) {
-        m_ledState = true;
-        m_ledTimer.setInterval( m_ledOnMs);
-        gpio_set_level( (gpio_num_t) m_ledPin, 0);
-      }
+      m_ledState = true;
+      m_ledTimer.start( m_ledOnMs);
+      gpio_set_level( (gpio_num_t) m_ledPin, 0);
     }
   }
 }
@@ -2,7 +2,7 @@
 #define LedBlink_h
 
 #include <core/Sliceable.h>
-#include <core/IntervalTimer.h>
+#include <core/TimerService.h>
 #include <LedDriver.h>
 
 class LedBlink : public Sliceable, public LedDriver {
@@ -11,13 +11,15 @@ protected:
 
   uint32_t m_stack[ 16], m_ledOnMs, m_ledOffMs;
   bool m_ledState;
-  IntervalTimer m_ledTimer;
+  ServiceTimer m_ledTimer;
+
+  static void onLedTimer( void* arg);
+  void toggle( void);
 
 public:
   LedBlink();
   virtual ~LedBlink( ) { }
   virtual const char* sliceName( ) { return "LedBlink"; }
-  virtual void slice( void);
   void setLedPin( int8_t p);
   void setLedOnOffMs( uint32_t on, uint32_t off);
   void blink( uint32_t timeMs) { setLedOnOffMs( timeMs, timeMs); }
@@ -4,6 +4,7 @@
 #include <SD.h>
 #include <cstring>
 #include <cstdlib>
+#include <core/Trace.h>
 
 #include "esp_log_custom.h"
 
@@ -145,6 +146,7 @@ void SdLogger::testFileIO(const char * path) {
 }
 
 void SdLogger::log(const char *filePrefix, const char *record, bool createNew) {
+    TRACE_SCOPE("SdLogger::log");
     char filename[128];
     File file;
 
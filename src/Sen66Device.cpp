@@ -29,10 +29,13 @@ typedef enum {
 
 static const char* TAG = "Sen66  ";
 
+static const uint32_t EVENT_UPLOAD_IDLE = 0x0001;
+
 const char Sen66Device::s_PREF_NAMESPACE[] = "sen66";
 const unsigned int Sen66Device::s_SAMPLE_TIME_MS = 10000;
 //const unsigned int Sen66Device::s_UPLOAD_TIME_MS = 120000;
 const unsigned int Sen66Device::s_UPLOAD_TIME_MS = 60000;
+const unsigned int Sen66Device::s_UPLOAD_WAIT_MS = 1000;
 const unsigned int Sen66Device::s_STARTUP_OFFSET_MS = 0;
 char Sen66Device::s_ROUTE[] = "/sen66";
 
@@ -95,6 +98,12 @@ void Sen66Device::writeReadings() {
     m_sdLogger->log(TAG, m_logBuf, firstRun);
     firstRun = false;
 }
+void Sen66Device::setUploadClient(UploadDataClient *client) {
+    m_uploadClient = client;
+    if(m_uploadClient) {
+        m_uploadClient->addListener(this, EVENT_UPLOAD_IDLE);
+    }
+}
 void Sen66Device::slice( void) {
     int16_t error;
     switch(m_state) {
@@ -162,6 +171,10 @@ void Sen66Device::slice( void) {
                 m_state = STATE_UPLOAD;
             } else if(!m_enabled) {
                 m_state = STATE_OFF;
+            } else {
+                unsigned sampleMs = m_timer.getRemaining();
+                unsigned uploadMs = m_uploadTimer.getRemaining();
+                sliceSleep(sampleMs < uploadMs ? sampleMs : uploadMs);
             }
         break;
         case STATE_READ:
@@ -186,6 +199,7 @@ void Sen66Device::slice( void) {
             }
         break;
         case STATE_UPLOAD_WAIT:
+            takeEvents(EVENT_UPLOAD_IDLE);
             if(!m_uploadClient) {
                 m_dataUploadReady = false;
                 m_state = STATE_WRITE_LOG;
@@ -193,12 +207,17 @@ void Sen66Device::slice( void) {
                 uploadReadings();
                 m_dataUploadReady = false;
                 m_state = STATE_SEND_WAIT;
+            } else {
+                sliceWaitFor(EVENT_UPLOAD_IDLE, s_UPLOAD_WAIT_MS);
             }
         break;
         case STATE_SEND_WAIT:
+            takeEvents(EVENT_UPLOAD_IDLE);
             if(!m_uploadClient->busy()) {
                 ESP_LOGD(TAG, "upload complete");
                 m_state = STATE_WRITE_LOG;
+            } else {
+                sliceWaitFor(EVENT_UPLOAD_IDLE, s_UPLOAD_WAIT_MS);
             }
         break;
         case STATE_ERROR:
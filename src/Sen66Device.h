@@ -19,6 +19,7 @@ private:
     static const char s_PREF_NAMESPACE[];
     static const unsigned int s_SAMPLE_TIME_MS;
     static const unsigned int s_UPLOAD_TIME_MS;
+    static const unsigned int s_UPLOAD_WAIT_MS;
     static const unsigned int s_STARTUP_OFFSET_MS;
     static char s_ROUTE[];
     
@@ -62,15 +63,16 @@ public:
     Sen66Device(SensirionI2cSen66 &sensor);
     virtual ~Sen66Device() { }
     virtual const char* sliceName( ) { return "Sen66Device"; }
+    virtual uint16_t getSliceState( ) { return (uint16_t) m_state; }
 
     void setup(Preferences &pref);
     void save(Preferences &pref);
 
-    void setUploadClient(UploadDataClient *client) { m_uploadClient = client; }
+    void setUploadClient(UploadDataClient *client);
     void setSdLogger(SdLogger *sdLogger) {m_sdLogger = sdLogger; }
     virtual void slice( void);
 
-    void setEnabled(bool enable) { m_enabled = enable; }
+    void setEnabled(bool enable) { m_enabled = enable; sliceWake(); }
 
 };
 
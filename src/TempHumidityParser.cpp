@@ -18,7 +18,10 @@ typedef enum {
 
 static const char* TAG = "THParse";
 
+static const uint32_t EVENT_UPLOAD_IDLE = 0x0001;
+
 const unsigned int TempHumidityParser::s_UPLOAD_TIME_MS = 120000;
+const unsigned int TempHumidityParser::s_UPLOAD_WAIT_MS = 1000;
 char TempHumidityParser::s_ROUTE[] = "/sensor";
 
 TempHumidityParser::TempHumidityParser() :
@@ -198,9 +201,16 @@ void TempHumidityParser::addData(tempHumidityData_t &data) {
 
 void TempHumidityParser::scanComplete() {
     m_uploadRequest = true;
+    sliceWake();
     ESP_LOGI(TAG, "ScanComplete: m_numDuplicates=%u", m_numDuplicates);
     m_numDuplicates = 0;
 }
+void TempHumidityParser::setUploadClient(UploadDataClient *client) {
+    m_uploadClient = client;
+    if(m_uploadClient) {
+        m_uploadClient->addListener(this, EVENT_UPLOAD_IDLE);
+    }
+}
 void TempHumidityParser::slice( void) {
     static bool firstRun = true;
     switch(m_state) {
@@ -214,6 +224,9 @@ void TempHumidityParser::slice( void) {
                 m_uploadIndex = 0;
                 ESP_LOGD(TAG, "uploading data");
                 m_state = STATE_UPLOAD;
+            } else {
+                // Sleep until the upload timer expires, scanComplete() wakes us early
+                sliceSleep(m_timer.getRemaining());
             }
         break;
         case STATE_UPLOAD:
@@ -228,6 +241,7 @@ void TempHumidityParser::slice( void) {
             }
         break;
         case STATE_UPLOAD_WAIT:
+            takeEvents(EVENT_UPLOAD_IDLE);
             if(!m_uploadClient) {
                 m_dataUploadReady[m_uploadIndex] = false;
                 m_uploadIndex++;
@@ -240,12 +254,17 @@ void TempHumidityParser::slice( void) {
                 m_uploadClient->sendFile(s_ROUTE, m_sendBuf, strlen(m_sendBuf));
                 m_dataUploadReady[m_uploadIndex] = false;
                 m_state = STATE_SEND_WAIT;
+            } else {
+                sliceWaitFor(EVENT_UPLOAD_IDLE, s_UPLOAD_WAIT_MS);
             }
         break;
         case STATE_SEND_WAIT:
+            takeEvents(EVENT_UPLOAD_IDLE);
             if(!m_uploadClient->busy()) {
                 m_uploadIndex++;
                 m_state = STATE_UPLOAD;
+            } else {
+                sliceWaitFor(EVENT_UPLOAD_IDLE, s_UPLOAD_WAIT_MS);
             }
         break;
         case STATE_WRITE_LOG:
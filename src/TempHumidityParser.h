@@ -25,6 +25,7 @@ typedef struct {
 class TempHumidityParser : public Sliceable, public BleParser {
 private:
     static const unsigned int s_UPLOAD_TIME_MS;
+    static const unsigned int s_UPLOAD_WAIT_MS;
     static char s_ROUTE[];
 
     IntervalTimer m_timer;
@@ -54,8 +55,9 @@ public:
     TempHumidityParser();
     virtual ~TempHumidityParser() { }
     virtual const char* sliceName( ) { return "TempHumidityParser"; }
+    virtual uint16_t getSliceState( ) { return (uint16_t) m_state; }
 
-    void setUploadClient(UploadDataClient *client) { m_uploadClient = client; }
+    void setUploadClient(UploadDataClient *client);
     void setSdLogger(SdLogger *sdLogger) {m_sdLogger = sdLogger; }
     virtual void slice( void);
     void enableAdditionalLogging(bool enable) { m_additionalLogging = enable; }
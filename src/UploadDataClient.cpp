@@ -8,6 +8,7 @@
 #endif
 
 #include <NetworkClient.h>
+#include <core/Trace.h>
 #include "esp_log_custom.h"
 
 static const char* TAG = "Upload ";
@@ -33,6 +34,8 @@ UploadDataClient::UploadDataClient() {
     m_port = 0;
     m_state = STATE_STARTUP;
     m_client = &s_client;
+    m_sendRequest = false;
+    m_numListeners = 0;
 }
 
 UploadDataClient::~UploadDataClient( void) {
@@ -62,6 +65,18 @@ void UploadDataClient::setHostPort(unsigned port) {
 bool UploadDataClient::busy() {
     return m_state != STATE_IDLE || m_sendRequest;
 }
+void UploadDataClient::addListener(Sliceable* listener, uint32_t event) {
+    if(listener != nullptr && m_numListeners < MAX_UPLOAD_LISTENERS) {
+        m_listeners[m_numListeners] = listener;
+        m_listenerEvents[m_numListeners] = event;
+        m_numListeners++;
+    }
+}
+void UploadDataClient::notifyListeners() {
+    for(uint8_t i=0; i < m_numListeners; i++) {
+        m_listeners[i]->notify(m_listenerEvents[i]);
+    }
+}
 void UploadDataClient::changeState( uint8_t newState) {
     ESP_LOGI(TAG, "change state from %u to %u", m_state, newState);
     m_state = newState;
@@ -80,6 +95,7 @@ void UploadDataClient::sendFile(char *route, char *file, unsigned len) {
         m_fileToSend = file;
         m_fileLength = len;
         m_sendRequest = true;
+        notify(UPLOAD_EVENT_REQUEST);
     }
 }
 void UploadDataClient::slice() {
@@ -92,11 +108,15 @@ void UploadDataClient::slice() {
         case STATE_IDLE:
             if(m_sendRequest) {
                 m_sendRequest = false;
+                takeEvents(UPLOAD_EVENT_REQUEST);
                 changeState( STATE_CONNECTING);
+            } else {
+                sliceWaitFor(UPLOAD_EVENT_REQUEST);
             }
         break;
         case STATE_CONNECTING:
         {
+            TRACE_SCOPE("UploadDataClient::connect");
             int ret = m_client->connect(m_ip, m_port, 100);
             if(ret != 1) {
                 ESP_LOGI(TAG, "Connect failed: %d", ret);
@@ -113,14 +133,20 @@ void UploadDataClient::slice() {
             changeState( STATE_SEND_FILE);
         break;
         case STATE_SEND_FILE:
+        {
+            TRACE_SCOPE("UploadDataClient::send");
             m_client->write(m_fileToSend, m_fileLength);
             m_client->write("\r\n", 2);
             changeState( STATE_DISCONNECTING);
+        }
         break;
         case STATE_DISCONNECTING:
             m_client->stop();
             ESP_LOGD(TAG, "Done");
             changeState( STATE_IDLE);
+            if(!m_sendRequest) {
+                notifyListeners();
+            }
         break;
     }
 }
\ No newline at end of file
@@ -8,6 +8,9 @@ class NetworkClient;
 
 #define MAX_HEADER_BUF_SIZE 128
 #define UDC_IP_LEN 16
+#define MAX_UPLOAD_LISTENERS 4
+
+#define UPLOAD_EVENT_REQUEST 0x0001
 
 class UploadDataClient : public Sliceable {
 private:
@@ -24,13 +27,18 @@ private:
     unsigned m_fileLength;
 
     NetworkClient* m_client;
+    Sliceable* m_listeners[MAX_UPLOAD_LISTENERS];
+    uint32_t m_listenerEvents[MAX_UPLOAD_LISTENERS];
+    uint8_t m_numListeners;
 
   void changeState( uint8_t newState);
   void sendHeader();
+  void notifyListeners();
 public:
     UploadDataClient();
     virtual ~UploadDataClient();
     virtual const char* sliceName( ) { return "UploadDataClient"; }
+    virtual uint16_t getSliceState( ) { return (uint16_t) m_state; }
     void init();
     virtual void slice( void);
     void setup(Preferences &pref);
@@ -39,6 +47,7 @@ public:
     void setHostPort(unsigned port);
     void sendFile(char *route, char *file, unsigned len);
     bool busy();
+    void addListener(Sliceable* listener, uint32_t event);
 };
 
 #endif // #ifndef UPLOAD_DATA_CLIENT_H_
\ No newline at end of file
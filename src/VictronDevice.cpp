@@ -4,6 +4,7 @@
 #include "Utilities.h"
 
 #include <aes/esp_aes.h>
+#include <core/Trace.h>
 #include "esp_log_custom.h"
 
 typedef enum {
@@ -18,8 +19,11 @@ typedef enum {
 
 static const char* TAG = "Victron";
 
+static const uint32_t EVENT_UPLOAD_IDLE = 0x0001;
+
 const char VictronDevice::s_PREF_NAMESPACE[] = "vic";
 const unsigned int VictronDevice::s_UPLOAD_TIME_MS = 120000;
+const unsigned int VictronDevice::s_UPLOAD_WAIT_MS = 1000;
 const unsigned int VictronDevice::s_STARTUP_OFFSET_MS = 5000;
 char VictronDevice::s_ROUTE[] = "/victron";
 
@@ -121,6 +125,7 @@ void VictronDevice::parse() {
     }
 }
 void VictronDevice::decrypt() {
+    TRACE_SCOPE("VictronDevice::decrypt");
     size_t nonce_offset = 0;
     uint8_t nonce_counter[32] = {0};
     uint8_t stream_block[32] = {0};
@@ -193,9 +198,16 @@ void VictronDevice::decrypt() {
 }
 void VictronDevice::scanComplete() {
     m_uploadRequest = true;
+    sliceWake();
     ESP_LOGI(TAG, "ScanComplete: m_numDuplicates=%u", m_numDuplicates);
     m_numDuplicates = 0;
 }
+void VictronDevice::setUploadClient(UploadDataClient *client) {
+    m_uploadClient = client;
+    if(m_uploadClient) {
+        m_uploadClient->addListener(this, EVENT_UPLOAD_IDLE);
+    }
+}
 void VictronDevice::slice( void) {
     static bool firstRun = true;
     switch(m_state) {
@@ -203,6 +215,8 @@ void VictronDevice::slice( void) {
             if(m_timer.hasIntervalElapsed()) {
                 m_timer.setInterval(s_UPLOAD_TIME_MS);
                 m_state = STATE_IDLE;
+            } else {
+                sliceSleep(m_timer.getRemaining());
             }
         break;
         case STATE_IDLE:
@@ -211,6 +225,9 @@ void VictronDevice::slice( void) {
                 m_uploadRequest = false;
                 ESP_LOGD(TAG, "uploading data");
                 m_state = STATE_UPLOAD;
+            } else {
+                // Sleep until the upload timer expires, scanComplete() wakes us early
+                sliceSleep(m_timer.getRemaining());
             }
         break;
         case STATE_UPLOAD:
@@ -222,6 +239,7 @@ void VictronDevice::slice( void) {
             }
         break;
         case STATE_UPLOAD_WAIT:
+            takeEvents(EVENT_UPLOAD_IDLE);
             if(!m_uploadClient) {
                 m_dataUploadReady = false;
                 m_state = STATE_WRITE_LOG;
@@ -231,12 +249,17 @@ void VictronDevice::slice( void) {
                 m_uploadClient->sendFile(s_ROUTE, m_sendBuf, strlen(m_sendBuf));
                 m_dataUploadReady = false;
                 m_state = STATE_SEND_WAIT;
+            } else {
+                sliceWaitFor(EVENT_UPLOAD_IDLE, s_UPLOAD_WAIT_MS);
             }
         break;
         case STATE_SEND_WAIT:
+            takeEvents(EVENT_UPLOAD_IDLE);
             if(!m_uploadClient->busy()) {
                 ESP_LOGD(TAG, "upload complete");
                 m_state = STATE_WRITE_LOG;
+            } else {
+                sliceWaitFor(EVENT_UPLOAD_IDLE, s_UPLOAD_WAIT_MS);
             }
         break;
         case STATE_WRITE_LOG:
@@ -25,6 +25,7 @@ class VictronDevice : public Sliceable, public BleParser {
 private:
     static const char s_PREF_NAMESPACE[];
     static const unsigned int s_UPLOAD_TIME_MS;
+    static const unsigned int s_UPLOAD_WAIT_MS;
     static const unsigned int s_STARTUP_OFFSET_MS;
     static char s_ROUTE[];
     
@@ -48,11 +49,12 @@ public:
     VictronDevice();
     virtual ~VictronDevice() { }
     virtual const char* sliceName( ) { return "VictronDevice"; }
+    virtual uint16_t getSliceState( ) { return (uint16_t) m_state; }
 
     void setup(Preferences &pref);
     void save(Preferences &pref);
 
-    void setUploadClient(UploadDataClient *client) { m_uploadClient = client; }
+    void setUploadClient(UploadDataClient *client);
     void setSdLogger(SdLogger *sdLogger) {m_sdLogger = sdLogger; }
     virtual void slice( void);
 
@@ -8,6 +8,7 @@
 #include "VictronDevice.h"
 #include "UploadDataClient.h"
 #include "Utilities.h"
+#include "startImage.h"
 
 #ifdef ESP32
 #include <BleConnection.h>
@@ -15,124 +16,27 @@
 #include <time.h>
 #include <esp_chip_info.h>
 #include <esp_idf_version.h>
+#include <esp_app_desc.h>
 #include "esp_log_custom.h"
 #endif
 
 static const char* TAG = "YRShell";
 
 #define INITIAL_LOAD_FILE "/start.yr"
+#define SNAPSHOT_FILE "/snapshot.yrs"
 
-static char s_testRoute[] = "/yrshell";
-
-static const FunctionEntry yr8266ShellExtensionFunctions[] = {
-    { SE_CC_setPinIn,             "setPinIn" },
-    { SE_CC_setPinIn,             "spi" },
-    { SE_CC_setPinInPullup,       "setPinInPullup" },
-    { SE_CC_setPinInPullup,       "spip" },
-    { SE_CC_setPinOut,            "setPinOut" },
-    { SE_CC_setPinOut,            "spo" },
-    { SE_CC_setDigitalPin,        "setDigitalPin" },
-    { SE_CC_setDigitalPin,        "sdp" },
-    { SE_CC_setAnalogPin,         "setAnalogPin" },
-    { SE_CC_setAnalogPin,         "sap" },
-    { SE_CC_getDigitalPin,        "getDigitalPin" },
-    { SE_CC_getAnalogPin,         "getAnalogPin" },
-    { SE_CC_ledPush,              "ledPush" },
-    { SE_CC_ledPop,               "ledPop" },
-    { SE_CC_setLedOnOffMs,        "setLedOnOffMs" },
-    { SE_CC_setLogMask,           "setLogMask" },   
-    { SE_CC_execDone,             "execDone"},
-    { SE_CC_hexModeQ,             "hexMode?"},
-    { SE_CC_wifiConnected,        "wifiConnected"},
-    { SE_CC_setTelnetLogEnable,   "setTelnetLogEnable"},
-    { SE_CC_deepSleep,            "deepSleep"},
-    { SE_CC_eLogLevel,            "eLogLevel"},
-
-    { SE_CC_setRunTimeMs,         "setRunTime"},
-    { SE_CC_setSleepTimeMs,       "setSleepTime"},
-    { SE_CC_setSleepEnable,       "setSleepEnable"},
-
-    { SE_CC_attemptReconnect,     "wifiReconnect" },
-    { SE_CC_getHostName,          "getHostName" },
-    { SE_CC_getHostPassword,      "getHostPassword" },
-    { SE_CC_getHostIp,            "getHostIp" },
-    { SE_CC_getHostGateway,       "getHostGateway" },
-    { SE_CC_getHostMask,          "getHostMask" },
-    { SE_CC_getHostMac,           "getHostMac" },
-    { SE_CC_isHostActive,         "isHostActive" },
-
-    { SE_CC_getNumberOfNetworks,  "getNumberOfNetworks" },
-    { SE_CC_getConnectedNetwork,  "getConnectedNetwork" },
-    { SE_CC_getNetworkIp,         "getNetworkIp" },
-    { SE_CC_getNetworkMac,        "getNetworkMac" },
-    { SE_CC_getNetworkName,       "getNetworkName" },
-    { SE_CC_getNetworkPassword,   "getNetworkPassword" },
-
-    { SE_CC_setHostName,          "setHostName" },
-    { SE_CC_setHostPassword,      "setHostPassword" },
-    { SE_CC_setHostIp,            "setHostIp" },
-    { SE_CC_setHostGateway,       "setHostGateway" },
-    { SE_CC_setHostMask,          "setHostMask" },
-    { SE_CC_setNetworkName,       "setNetworkName" },
-    { SE_CC_setNetworkPassword,   "setNetworkPassword" },
-
-    { SE_CC_saveNetworkParameters,"saveNetworkParameters" },
-
-    { SE_CC_loadFile,              "loadFile" },
-
-    { SE_CC_dbgM,                  "logM" },
-    { SE_CC_dbgDM,                 "logDM" }, 
-    { SE_CC_dbgDDM,                "logDDM" }, 
-    { SE_CC_dbgXM,                 "logXM" }, 
-    { SE_CC_dbgXXM,                "logXXM" },  
-
-    { SE_CC_hardReset,             "hardReset" },  
-
-    { SE_CC_dotUb,                ".ub" },
-    { SE_CC_strToInt,             "strToInt"},
-
-    { SE_CC_checkPreferences,     "checkPref"},
-    { SE_CC_storePreferences,     "storePref"},
-
-    { SE_CC_bleScan,                 "bscan"},
-    { SE_CC_setBleLogState,          "sbls"},
-    { SE_CC_setBleScanInterval,      "setBleScanInterval"},
-    { SE_CC_setBleScanWindow,        "setBleScanWindow"},
-    { SE_CC_setBleDuration,          "setBleDuration"},
-    { SE_CC_setBleScanActively,      "setBleScanActively"},
-    { SE_CC_setBleScanStartInterval, "setBleScanStartInterval"},
-    { SE_CC_setBleScanBoot,          "setBleScanBoot"},
-    { SE_CC_setBleAddr,              "setBleAddr"},
-    { SE_CC_setBleParser,            "setBleParser"},
-    { SE_CC_setBleEnable,            "setBleEnable"},
-    { SE_CC_logBleParsers,           "logBleParsers"},
-
-    { SE_CC_setVicKey,               "svk"},
-    { SE_CC_setTempHumidityLogging,  "setTHLogging"},
-    { SE_CC_setSen66Enable,          "setSen66Enable"},
-
-    { SE_CC_setUploadIp,            "setUploadIp"},
-    { SE_CC_setUploadPort,          "setUploadPort"},
-
-    { SE_CC_flashSize,            "flashSize"},
-    { SE_CC_chipInfo,             "chipInfo"},
-    { SE_CC_sdkVersion,           "sdkVersion"},
-    { SE_CC_numTasks,             "numTasks"},
-    { SE_CC_cpuPerf,              "cpuPerf"},
-    { SE_CC_heapPerf,             "heapPerf"},
-    { SE_CC_curTime,              "curTime"},
-		{ SE_CC_setTime,              "setTime"},
-
-    { SE_CC_upload,               "upload"},
-    { SE_CC_setLedStrip,          "setLedStrip"},
-
-    { 0, NULL}
-};
+// Application settings kept in the snapshot user flags
+#define SNAPSHOT_TELNET_LOG 0x0001
 
+static char s_testRoute[] = "/yrshell";
 
 static FunctionDictionary dictionaryExtensionFunction( yr8266ShellExtensionFunctions, YRSHELL_DICTIONARY_EXTENSION_FUNCTION );
 
 CompiledDictionary compiledExtensionDictionary( NULL, 0xFFFF , 0x0000 , YRSHELL_DICTIONARY_EXTENSION_COMPILED);
+// Repeated /exec and /cmd requests run from here instead of being parsed again
+static LineCache<16, 128> s_lineCache;
+// Filled by 1 setProfile, listed by runProfile
+static Profiler<64> s_profiler;
 
 static char s_uploadData[] = "{\"data\":32}";
 
@@ -263,8 +167,14 @@ YRShellEsp32::YRShellEsp32() {
   m_telnetLogServer = NULL;
   m_fileOpen = false;
   m_initialFileLoaded = false;
+  m_startReady = false;
+  m_startCrc = 0;
   m_initialized = false;
   m_auxBufIndex = 0;
+  for( uint8_t i = 0; i < YRSHELL_EXEC_SESSIONS; i++) {
+    m_execBusy[ i] = false;
+    m_execRunning[ i] = false;
+  }
 }
 
 YRShellEsp32::~YRShellEsp32() {
@@ -274,35 +184,45 @@ void YRShellEsp32::init() {
   YRShellBase::init();
   m_dictionaryList[ YRSHELL_DICTIONARY_EXTENSION_COMPILED_INDEX] = &compiledExtensionDictionary;
   m_dictionaryList[ YRSHELL_DICTIONARY_EXTENSION_FUNCTION_INDEX] = &dictionaryExtensionFunction;
-  m_exec = false;
+  setLineCache( &s_lineCache);
+  setProfiler( &s_profiler);
+  for( uint8_t i = 0; i < YRSHELL_EXEC_SESSIONS; i++) {
+    if( !addContext( &m_execSession[ i])) {
+      ESP_LOGI(TAG, "No room for exec session %u", i);
+      m_execBusy[ i] = true;
+    }
+  }
   m_initialized = true;
 }
 
-void YRShellEsp32::startExec( void) {
-  m_lastPromptEnable = getPromptEnable();
-  m_lastCommandEcho = getCommandEcho();
-  setPromptEnable( false);
-  setCommandEcho( false);
-}
-void YRShellEsp32::endExec( void) {
-  setPromptEnable( m_lastPromptEnable);
-  setCommandEcho( m_lastCommandEcho);
-  requestUseMainQueues();
-}
-void YRShellEsp32::execString( const char* p) {
-  if( m_exec) {
-      ESP_LOGI(TAG, "ExecString Failed");
-  } else {
-    requestUseAuxQueues();
-    for( ; *p != '\0'; p++ ) {
-      m_AuxInq->put( *p);
+int8_t YRShellEsp32::execString( const char* p) {
+  static const char execDone[] = " cr execDone\r";
+  int8_t rc = -1;
+  uint32_t len = strlen( p);
+  for( int8_t i = 0; rc < 0 && i < YRSHELL_EXEC_SESSIONS; i++) {
+    CircularQBase<char>& q = m_execSession[ i].getInq();
+    if( !m_execBusy[ i] && m_execSession[ i].isIdle() && q.spaceAvailable( len + sizeof( execDone))) {
+      m_execSession[ i].getOutq().reset();
+      q.putN( p, len);
+      q.putN( execDone, sizeof(execDone) - 1);
+      m_execBusy[ i] = true;
+      m_execRunning[ i] = true;
+      m_execTimer[ i].setInterval( 5000);
+      rc = i;
     }
-    for( const char* p = " cr execDone\r"; *p != '\0'; p++ ) {
-      m_AuxInq->put( *p);
-    }
-    m_exec = true;
-    m_execTimer.setInterval( 5000);
   }
+  if( rc < 0) {
+    ESP_LOGI(TAG, "ExecString Failed");
+  }
+  return rc;
+}
+bool YRShellEsp32::isExec( int8_t handle) {
+  // An error resets the session, dropping execDone with the rest of its input
+  return m_execRunning[ handle] && !m_execTimer[ handle].hasIntervalElapsed() && !m_execSession[ handle].isIdle();
+}
+void YRShellEsp32::endExec( int8_t handle) {
+  m_execRunning[ handle] = false;
+  m_execBusy[ handle] = false;
 }
 
 void YRShellEsp32::loadFile( const char* fname, bool exec) {
@@ -326,12 +246,99 @@ void YRShellEsp32::loadFile( const char* fname, bool exec) {
   }
 }
 
+uint32_t YRShellEsp32::startFileCrc( ) {
+  uint32_t crc = 0;
+  File f = LittleFS.open( INITIAL_LOAD_FILE, "r");
+  if( f) {
+    uint8_t buf[ 128];
+    int c;
+    while( (c = f.read( buf, sizeof( buf))) > 0) {
+      crc = Dictionary::crc32( crc, buf, c);
+    }
+    f.close();
+  }
+  return crc;
+}
+bool YRShellEsp32::mapStartImage( ) {
+  bool rc = false;
+  if( m_startCrc != startImageSourceCrc) {
+    ESP_LOGI(TAG, "Start image stale: crc=0x%08X image=0x%08X", m_startCrc, startImageSourceCrc);
+  } else if( getDictionaryFingerprint() != startImageFingerprint) {
+    ESP_LOGI(TAG, "Start image built for other dictionaries");
+  } else if( !m_auxInq.spaceAvailable( sizeof( startImageCommands))) {
+    ESP_LOGI(TAG, "Start image commands don't fit");
+  } else {
+    compiledExtensionDictionary.setDictionary( startImageData, startImageLastWord, startImageSize);
+    compiledExtensionDictionary.setIndex( startImageIndexValues, startImageIndexTags, startImageIndexSlots, startImageIndexCount);
+    s_lineCache.clear();
+    rc = true;
+  }
+  return rc;
+}
+uint32_t YRShellEsp32::getBuildId( ) {
+  // A new firmware or start file invalidates the snapshot
+  return Dictionary::crc32( m_startCrc, esp_app_get_description()->app_elf_sha256, 32);
+}
+uint32_t YRShellEsp32::saveSnapshot( ) {
+  uint32_t rc = 0;
+  uint32_t size = YRShellBase::getSnapshotSize();
+  uint8_t* buf = (uint8_t*) malloc( size);
+  if( buf == NULL) {
+    ESP_LOGI(TAG, "Snapshot: no memory for %u bytes", size);
+  } else {
+    uint32_t flags = (m_telnetLogServer != NULL && m_telnetLogServer->isEnabled()) ? SNAPSHOT_TELNET_LOG : 0;
+    size = YRShellBase::saveSnapshot( buf, size, getBuildId(), flags);
+    File f = LittleFS.open( SNAPSHOT_FILE, "w");
+    if( !f) {
+      ESP_LOGI(TAG, "Snapshot: failed to open %s", SNAPSHOT_FILE);
+    } else {
+      if( f.write( buf, size) == size) {
+        rc = size;
+      }
+      f.close();
+      if( rc == 0) {
+        LittleFS.remove( SNAPSHOT_FILE);
+      }
+    }
+    free( buf);
+    ESP_LOGI(TAG, "Snapshot saved: %u bytes", rc);
+  }
+  return rc;
+}
+bool YRShellEsp32::restoreSnapshot( ) {
+  bool rc = false;
+  File f = LittleFS.open( SNAPSHOT_FILE, "r");
+  if( f) {
+    uint32_t size = f.size();
+    uint8_t* buf = (uint8_t*) malloc( size);
+    if( buf != NULL) {
+      uint32_t flags = 0;
+      if( f.read( buf, size) == size && YRShellBase::restoreSnapshot( buf, size, getBuildId(), &flags)) {
+        if( m_telnetLogServer != NULL) {
+          m_telnetLogServer->enable( (flags & SNAPSHOT_TELNET_LOG) != 0);
+        }
+        rc = true;
+      }
+      free( buf);
+    }
+    f.close();
+    if( !rc) {
+      // Stale or damaged, the next save replaces it
+      ESP_LOGI(TAG, "Snapshot not restored");
+      LittleFS.remove( SNAPSHOT_FILE);
+    }
+  }
+  return rc;
+}
+
 void YRShellEsp32::slice() {
   YRShellBase::slice();
   if( m_fileOpen && m_auxInq.spaceAvailable(10)) {
-    int c = m_file.read();
-    if( c != -1) {
-      m_auxInq.put( c);   
+    uint32_t len = m_auxInq.free() - 9;
+    char* p = m_auxInq.reserve( len);
+    int c = m_file.read( (uint8_t*) p, len);
+    if( c > 0) {
+      m_auxInq.commit( c);
     } else {
       m_file.close();
       m_fileOpen = false;
@@ -339,28 +346,35 @@ void YRShellEsp32::slice() {
     } 
   }
 
-  if( m_exec && m_execTimer.hasIntervalElapsed()) {
-    m_exec = false;
+  for( uint8_t i = 0; i < YRSHELL_EXEC_SESSIONS; i++) {
+    if( !m_execBusy[ i]) {
+      // Output of a request that timed out or was abandoned
+      m_execSession[ i].getOutq().reset();
+    }
   }
-  
-  if( m_useAuxQueues && !m_exec ) {
-    while( m_AuxOutq->valueAvailable()) {
-      char c = m_AuxOutq->get();
-      if( c != '\r' && c != '\n' ) {
-        m_auxBuf[ m_auxBufIndex++] = c;    
-      }
-      if( c == '\r' || c == '\n' ||  m_auxBufIndex > (sizeof(m_auxBuf) - 2 ) ) {
-        m_auxBuf[ m_auxBufIndex] = '\0';
-        bool flag = true;
-        for( const char* p = m_auxBuf; flag && *p != '\0'; p++) {
-          if( *p != ' ' && *p != '\r' && *p != '\n' && *p != '\t') {
-            flag = false;
-          }
+
+  if( m_useAuxQueues) {
+    char buf[32];
+    uint32_t len;
+    while( (len = m_AuxOutq->getN( buf, sizeof(buf))) > 0) {
+      for( uint32_t i = 0; i < len; i++) {
+        char c = buf[i];
+        if( c != '\r' && c != '\n' ) {
+          m_auxBuf[ m_auxBufIndex++] = c;    
         }
-        if( !flag ) {
-          ESP_LOGV(TAG, "AuxBuf: %s", m_auxBuf);
+        if( c == '\r' || c == '\n' ||  m_auxBufIndex > (sizeof(m_auxBuf) - 2 ) ) {
+          m_auxBuf[ m_auxBufIndex] = '\0';
+          bool flag = true;
+          for( const char* p = m_auxBuf; flag && *p != '\0'; p++) {
+            if( *p != ' ' && *p != '\r' && *p != '\n' && *p != '\t') {
+              flag = false;
+            }
+          }
+          if( !flag ) {
+            ESP_LOGV(TAG, "AuxBuf: %s", m_auxBuf);
+          }
+          m_auxBufIndex = 0;
         }
-        m_auxBufIndex = 0;
       }
     }
   } else if( m_auxBufIndex > 0) {
@@ -370,7 +384,20 @@ void YRShellEsp32::slice() {
 
   if( !m_initialFileLoaded && m_initialized && isIdle() ) {
       m_initialFileLoaded = true;
-      loadFile( INITIAL_LOAD_FILE);
+      m_startCrc = startFileCrc();
+      bool image = mapStartImage();
+      if( restoreSnapshot()) {
+        ESP_LOGI(TAG, "Snapshot restored: %u words", m_DictionaryCurrent->getWordEnd());
+      } else if( image) {
+        requestUseAuxQueues();
+        m_auxInq.putN( startImageCommands, sizeof( startImageCommands) - 1);
+        ESP_LOGI(TAG, "Start image: %u words", startImageSize);
+      } else {
+        loadFile( INITIAL_LOAD_FILE);
+      }
+  } else if( m_initialFileLoaded && !m_startReady && !m_fileOpen && isIdle() && !m_auxInq.valueAvailable()) {
+      m_startReady = true;
+      ESP_LOGI(TAG, "Start ready: %u ms after boot", (unsigned) millis());
   }
 } 
 
@@ -429,7 +456,11 @@ void YRShellEsp32::executeFunction( uint16_t n) {
               }
               break;
           case SE_CC_execDone:
-              m_exec = false;
+              for( uint8_t i = 0; i < YRSHELL_EXEC_SESSIONS; i++) {
+                if( getActiveContext() == &m_execSession[ i]) {
+                  m_execRunning[ i] = false;
+                }
+              }
               break;
           case SE_CC_setLogMask:
               t1 = popParameterStack();
@@ -871,6 +902,12 @@ void YRShellEsp32::executeFunction( uint16_t n) {
                   m_ledStrip->setLed(t1);
               }
             break;
+          case SE_CC_snapSave:
+              pushParameterStack( saveSnapshot());
+              break;
+          case SE_CC_snapClear:
+              LittleFS.remove( SNAPSHOT_FILE);
+              break;
           default:
               shellERROR(__FILE__, __LINE__);
               break;
@@ -5,6 +5,7 @@
 #include <LittleFS.h>
 
 #include "YRShellExec.h"
+#include "YRShellEsp32Functions.h"
 
 class DebugLog;
 class Preferences;
@@ -19,111 +20,11 @@ class VictronDevice;
 class TempHumidityParser;
 class Sen66Device;
 
-typedef enum {
-    SE_CC_first = YRSHELL_DICTIONARY_EXTENSION_FUNCTION,
-    SE_CC_setPinIn,
-    SE_CC_setPinInPullup,
-    SE_CC_setPinOut,
-    SE_CC_setDigitalPin,
-    SE_CC_setAnalogPin,
-    SE_CC_getDigitalPin,
-    SE_CC_getAnalogPin,
-    SE_CC_ledPush,
-    SE_CC_ledPop,
-    SE_CC_setLedOnOffMs,
-    SE_CC_setLogMask,
-    SE_CC_execDone,
-    SE_CC_hexModeQ,
-    SE_CC_wifiConnected,
-    SE_CC_setTelnetLogEnable,
-    SE_CC_deepSleep,
-
-    SE_CC_eLogLevel,
-
-    SE_CC_setRunTimeMs,
-    SE_CC_setSleepTimeMs,
-    SE_CC_setSleepEnable,
-
-    SE_CC_attemptReconnect,
-    SE_CC_getHostName,
-    SE_CC_getHostPassword,
-    SE_CC_getHostIp,
-    SE_CC_getHostGateway,
-    SE_CC_getHostMask,
-    SE_CC_getHostMac,
-    SE_CC_isHostActive,
-
-    SE_CC_getNumberOfNetworks,
-    SE_CC_getConnectedNetwork,
-    SE_CC_getNetworkIp,
-    SE_CC_getNetworkMac,
-
-    SE_CC_getNetworkName,
-    SE_CC_getNetworkPassword,
-
-    SE_CC_setHostName,
-    SE_CC_setHostPassword,
-    SE_CC_setHostIp,
-    SE_CC_setHostGateway,
-    SE_CC_setHostMask,
-    SE_CC_setNetworkName,
-    SE_CC_setNetworkPassword,
-
-    SE_CC_saveNetworkParameters,
-
-    SE_CC_loadFile,
-
-    SE_CC_dbgM,
-    SE_CC_dbgDM,
-    SE_CC_dbgDDM,
-    SE_CC_dbgXM,
-    SE_CC_dbgXXM,
-
-    SE_CC_hardReset,
-
-    SE_CC_dotUb,
-    SE_CC_strToInt,
-
-    SE_CC_checkPreferences,
-    SE_CC_storePreferences,
-
-    SE_CC_bleScan,
-    SE_CC_setBleLogState,
-    SE_CC_setBleScanInterval,
-    SE_CC_setBleScanWindow,
-    SE_CC_setBleDuration,
-    SE_CC_setBleScanActively,
-    SE_CC_setBleScanStartInterval,
-    SE_CC_setBleScanBoot,
-    SE_CC_setBleAddr,
-    SE_CC_setBleParser,
-    SE_CC_setBleEnable,
-    SE_CC_logBleParsers,
-    SE_CC_setVicKey,
-    SE_CC_setTempHumidityLogging,
-    SE_CC_setSen66Enable,
-
-    SE_CC_setUploadIp,
-    SE_CC_setUploadPort,
-
-    SE_CC_flashSize,
-    SE_CC_chipInfo,
-    SE_CC_sdkVersion,
-    SE_CC_numTasks,
-    SE_CC_cpuPerf,
-    SE_CC_heapPerf,
-    SE_CC_curTime,
-    SE_CC_setTime,
-
-    SE_CC_upload,
-    SE_CC_setLedStrip,
-    
-    SE_CC_last
-} SE_CC_functions;
+#define YRSHELL_EXEC_SESSIONS 2 // /exec requests run at once, each in its own execution context
 
 class YRShellEsp32 : public YRShellExec, public virtual YRShellBase<2048, 128, 128, 16, 16, 16, 8, 256, 512, 256, 512, 128> {
 protected:
-  bool m_exec, m_initialized;
+  bool m_initialized;
   char m_auxBuf[ 128];
   uint8_t m_auxBufIndex;
 
@@ -138,8 +39,11 @@ protected:
   TempHumidityParser *m_tempHumParser;
   Sen66Device *m_sen66Device;
   UploadDataClient* m_uploadClient;
-  IntervalTimer m_execTimer;
-  bool m_fileOpen, m_initialFileLoaded, m_lastPromptEnable, m_lastCommandEcho;
+  YRShellSession<128, 16, 16, 8, 256, 512> m_execSession[ YRSHELL_EXEC_SESSIONS];
+  IntervalTimer m_execTimer[ YRSHELL_EXEC_SESSIONS];
+  bool m_execBusy[ YRSHELL_EXEC_SESSIONS];     /**< Handed out by execString(), until endExec(). */
+  bool m_execRunning[ YRSHELL_EXEC_SESSIONS];  /**< Until execDone runs in the session. */
+  bool m_fileOpen, m_initialFileLoaded, m_startReady;
   File m_file;
 
   virtual void executeFunction( uint16_t n);
@@ -148,6 +52,20 @@ protected:
   void outUInt8( int8_t v);
 
   void logTime();
+  uint32_t m_startCrc;
+
+  uint32_t startFileCrc( void);
+  /** \brief Maps src/startImage.h into the extension compiled dictionary.
+
+   Returns false, leaving the dictionary alone, if /start.yr or the dictionaries no longer match the image.
+   */
+  bool mapStartImage( void);
+  /** \brief Identifies the firmware and start file a snapshot belongs to.
+   */
+  uint32_t getBuildId( void);
+  /** \brief Restores /snapshot.yrs, removing it if it does not match this build.
+   */
+  bool restoreSnapshot( void);
 
 public:
   YRShellEsp32( );
@@ -169,13 +87,16 @@ public:
 
   virtual void slice( void);
   void loadFile( const char* fname, bool exec = true);
+  /** \brief Saves the current dictionary, registers and settings to /snapshot.yrs, returns the bytes written.
+
+   At boot a snapshot that matches the firmware and /start.yr is restored instead of loading start.yr.
+   */
+  uint32_t saveSnapshot( void);
 
-  inline bool isAuxQueueInUse( void) { return m_useAuxQueues; }
-  CircularQBase<char>& getAuxOutq(void) { return *m_AuxOutq; };
-  void startExec( void);
-  void endExec( void);
-  void execString( const char* p);
-  bool isExec( void) { return m_exec; }
+  int8_t execString( const char* p);
+  CircularQBase<char>* getExecOutq( int8_t handle) { return &m_execSession[ handle].getOutq(); }
+  bool isExec( int8_t handle);
+  void endExec( int8_t handle);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "YRShellEsp32Functions.h"
+
+const FunctionEntry yr8266ShellExtensionFunctions[] = {
+    { SE_CC_setPinIn,             "setPinIn" },
+    { SE_CC_setPinIn,             "spi" },
+    { SE_CC_setPinInPullup,       "setPinInPullup" },
+    { SE_CC_setPinInPullup,       "spip" },
+    { SE_CC_setPinOut,            "setPinOut" },
+    { SE_CC_setPinOut,            "spo" },
+    { SE_CC_setDigitalPin,        "setDigitalPin" },
+    { SE_CC_setDigitalPin,        "sdp" },
+    { SE_CC_setAnalogPin,         "setAnalogPin" },
+    { SE_CC_setAnalogPin,         "sap" },
+    { SE_CC_getDigitalPin,        "getDigitalPin" },
+    { SE_CC_getAnalogPin,         "getAnalogPin" },
+    { SE_CC_ledPush,              "ledPush" },
+    { SE_CC_ledPop,               "ledPop" },
+    { SE_CC_setLedOnOffMs,        "setLedOnOffMs" },
+    { SE_CC_setLogMask,           "setLogMask" },   
+    { SE_CC_execDone,             "execDone"},
+    { SE_CC_hexModeQ,             "hexMode?"},
+    { SE_CC_wifiConnected,        "wifiConnected"},
+    { SE_CC_setTelnetLogEnable,   "setTelnetLogEnable"},
+    { SE_CC_deepSleep,            "deepSleep"},
+    { SE_CC_eLogLevel,            "eLogLevel"},
+
+    { SE_CC_setRunTimeMs,         "setRunTime"},
+    { SE_CC_setSleepTimeMs,       "setSleepTime"},
+    { SE_CC_setSleepEnable,       "setSleepEnable"},
+
+    { SE_CC_attemptReconnect,     "wifiReconnect" },
+    { SE_CC_getHostName,          "getHostName" },
+    { SE_CC_getHostPassword,      "getHostPassword" },
+    { SE_CC_getHostIp,            "getHostIp" },
+    { SE_CC_getHostGateway,       "getHostGateway" },
+    { SE_CC_getHostMask,          "getHostMask" },
+    { SE_CC_getHostMac,           "getHostMac" },
+    { SE_CC_isHostActive,         "isHostActive" },
+
+    { SE_CC_getNumberOfNetworks,  "getNumberOfNetworks" },
+    { SE_CC_getConnectedNetwork,  "getConnectedNetwork" },
+    { SE_CC_getNetworkIp,         "getNetworkIp" },
+    { SE_CC_getNetworkMac,        "getNetworkMac" },
+    { SE_CC_getNetworkName,       "getNetworkName" },
+    { SE_CC_getNetworkPassword,   "getNetworkPassword" },
+
+    { SE_CC_setHostName,          "setHostName" },
+    { SE_CC_setHostPassword,      "setHostPassword" },
+    { SE_CC_setHostIp,            "setHostIp" },
+    { SE_CC_setHostGateway,       "setHostGateway" },
+    { SE_CC_setHostMask,          "setHostMask" },
+    { SE_CC_setNetworkName,       "setNetworkName" },
+    { SE_CC_setNetworkPassword,   "setNetworkPassword" },
+
+    { SE_CC_saveNetworkParameters,"saveNetworkParameters" },
+
+    { SE_CC_loadFile,              "loadFile" },
+
+    { SE_CC_dbgM,                  "logM" },
+    { SE_CC_dbgDM,                 "logDM" }, 
+    { SE_CC_dbgDDM,                "logDDM" }, 
+    { SE_CC_dbgXM,                 "logXM" }, 
+    { SE_CC_dbgXXM,                "logXXM" },  
+
+    { SE_CC_hardReset,             "hardReset" },  
+
+    { SE_CC_dotUb,                ".ub" },
+    { SE_CC_strToInt,             "strToInt"},
+
+    { SE_CC_checkPreferences,     "checkPref"},
+    { SE_CC_storePreferences,     "storePref"},
+
+    { SE_CC_bleScan,                 "bscan"},
+    { SE_CC_setBleLogState,          "sbls"},
+    { SE_CC_setBleScanInterval,      "setBleScanInterval"},
+    { SE_CC_setBleScanWindow,        "setBleScanWindow"},
+    { SE_CC_setBleDuration,          "setBleDuration"},
+    { SE_CC_setBleScanActively,      "setBleScanActively"},
+    { SE_CC_setBleScanStartInterval, "setBleScanStartInterval"},
+    { SE_CC_setBleScanBoot,          "setBleScanBoot"},
+    { SE_CC_setBleAddr,              "setBleAddr"},
+    { SE_CC_setBleParser,            "setBleParser"},
+    { SE_CC_setBleEnable,            "setBleEnable"},
+    { SE_CC_logBleParsers,           "logBleParsers"},
+
+    { SE_CC_setVicKey,               "svk"},
+    { SE_CC_setTempHumidityLogging,  "setTHLogging"},
+    { SE_CC_setSen66Enable,          "setSen66Enable"},
+
+    { SE_CC_setUploadIp,            "setUploadIp"},
+    { SE_CC_setUploadPort,          "setUploadPort"},
+
+    { SE_CC_flashSize,            "flashSize"},
+    { SE_CC_chipInfo,             "chipInfo"},
+    { SE_CC_sdkVersion,           "sdkVersion"},
+    { SE_CC_numTasks,             "numTasks"},
+    { SE_CC_cpuPerf,              "cpuPerf"},
+    { SE_CC_heapPerf,             "heapPerf"},
+    { SE_CC_curTime,              "curTime"},
+		{ SE_CC_setTime,              "setTime"},
+
+    { SE_CC_upload,               "upload"},
+    { SE_CC_setLedStrip,          "setLedStrip"},
+
+    { SE_CC_snapSave,             "snapSave"},
+    { SE_CC_snapClear,            "snapClear"},
+
+    { 0, NULL}
+};
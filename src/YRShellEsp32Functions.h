@@ -0,0 +1,115 @@
+#ifndef YRSHELL_ESP32_FUNCTIONS_H_
+#define YRSHELL_ESP32_FUNCTIONS_H_
+
+#include <core/Dictionary.h>
+
+// Kept free of Arduino headers so host tools can resolve the extension words, see tools/startImage
+
+typedef enum {
+    SE_CC_first = YRSHELL_DICTIONARY_EXTENSION_FUNCTION,
+    SE_CC_setPinIn,
+    SE_CC_setPinInPullup,
+    SE_CC_setPinOut,
+    SE_CC_setDigitalPin,
+    SE_CC_setAnalogPin,
+    SE_CC_getDigitalPin,
+    SE_CC_getAnalogPin,
+    SE_CC_ledPush,
+    SE_CC_ledPop,
+    SE_CC_setLedOnOffMs,
+    SE_CC_setLogMask,
+    SE_CC_execDone,
+    SE_CC_hexModeQ,
+    SE_CC_wifiConnected,
+    SE_CC_setTelnetLogEnable,
+    SE_CC_deepSleep,
+
+    SE_CC_eLogLevel,
+
+    SE_CC_setRunTimeMs,
+    SE_CC_setSleepTimeMs,
+    SE_CC_setSleepEnable,
+
+    SE_CC_attemptReconnect,
+    SE_CC_getHostName,
+    SE_CC_getHostPassword,
+    SE_CC_getHostIp,
+    SE_CC_getHostGateway,
+    SE_CC_getHostMask,
+    SE_CC_getHostMac,
+    SE_CC_isHostActive,
+
+    SE_CC_getNumberOfNetworks,
+    SE_CC_getConnectedNetwork,
+    SE_CC_getNetworkIp,
+    SE_CC_getNetworkMac,
+
+    SE_CC_getNetworkName,
+    SE_CC_getNetworkPassword,
+
+    SE_CC_setHostName,
+    SE_CC_setHostPassword,
+    SE_CC_setHostIp,
+    SE_CC_setHostGateway,
+    SE_CC_setHostMask,
+    SE_CC_setNetworkName,
+    SE_CC_setNetworkPassword,
+
+    SE_CC_saveNetworkParameters,
+
+    SE_CC_loadFile,
+
+    SE_CC_dbgM,
+    SE_CC_dbgDM,
+    SE_CC_dbgDDM,
+    SE_CC_dbgXM,
+    SE_CC_dbgXXM,
+
+    SE_CC_hardReset,
+
+    SE_CC_dotUb,
+    SE_CC_strToInt,
+
+    SE_CC_checkPreferences,
+    SE_CC_storePreferences,
+
+    SE_CC_bleScan,
+    SE_CC_setBleLogState,
+    SE_CC_setBleScanInterval,
+    SE_CC_setBleScanWindow,
+    SE_CC_setBleDuration,
+    SE_CC_setBleScanActively,
+    SE_CC_setBleScanStartInterval,
+    SE_CC_setBleScanBoot,
+    SE_CC_setBleAddr,
+    SE_CC_setBleParser,
+    SE_CC_setBleEnable,
+    SE_CC_logBleParsers,
+    SE_CC_setVicKey,
+    SE_CC_setTempHumidityLogging,
+    SE_CC_setSen66Enable,
+
+    SE_CC_setUploadIp,
+    SE_CC_setUploadPort,
+
+    SE_CC_flashSize,
+    SE_CC_chipInfo,
+    SE_CC_sdkVersion,
+    SE_CC_numTasks,
+    SE_CC_cpuPerf,
+    SE_CC_heapPerf,
+    SE_CC_curTime,
+    SE_CC_setTime,
+
+    SE_CC_upload,
+    SE_CC_setLedStrip,
+
+    SE_CC_snapSave,
+    SE_CC_snapClear,
+    
+    SE_CC_last
+} SE_CC_functions;
+
+extern const FunctionEntry yr8266ShellExtensionFunctions[];
+
+#endif
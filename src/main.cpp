@@ -15,6 +15,8 @@
 #include "Sen66Device.h"
 #include "SdLogger.h"
 #include "Utilities.h"
+#include <core/LogRing.h>
+#include <core/DeferredLog.h>
 
 #include <SPI.h>
 #include <SD.h>
@@ -27,6 +29,7 @@
 //#include "esp_sntp.h"
 
 #include "esp_log_custom.h"
+#include "esp_memory_utils.h"
 
 //  0x01 - setup log
 //  0x02 - errors
@@ -54,7 +57,10 @@
 #define LED_PIN 21
 
 #define YRSHELL_ON_TELNET
+#define SLICE_GROUP_NETWORK 1
+#define SLICE_GROUP_NETWORK_CORE 0
 #define LOCAL_LOG_BUFFER_SIZE 8192
+#define LOG_RECORD_MAX 128
 
 #define I2C_SDA_PIN 1
 #define I2C_SCL_PIN 2
@@ -69,7 +75,7 @@ static const int8_t SD_MOSI = 8;
 static const int8_t SD_CS = 11;
 
 Preferences pref;
-CircularQ<char, LOCAL_LOG_BUFFER_SIZE> m_logQ;
+LogRing<LOCAL_LOG_BUFFER_SIZE> m_logRing;
 AppManager appMgr(s_appName, s_appVersion);
 YRShellEsp32 shell;
 #ifndef HAS_LED_STRIP
@@ -89,6 +95,9 @@ BleConnection bleConnection;
 VictronDevice victronParser;
 TempHumidityParser tempHumParser;
 
+// The telnet servers only exchange data through SPSC queues, so they can run on the other core
+SliceGroup networkGroup("network", SLICE_GROUP_NETWORK, SLICE_GROUP_NETWORK_CORE);
+
 SensirionI2cSen66 sensor;
 Sen66Device sen66Device(sensor);
 
@@ -111,6 +120,7 @@ void startSntp(void) {
 }
 
 void preSleepNotification(void) {
+    shell.saveSnapshot();
     bleConnection.off();
     wifiConnection.off();
 }
@@ -119,36 +129,35 @@ bool sleepReady(void) {
    return bleConnection.isOff() && wifiConnection.isOff();
 }
 
-bool logOut(char c) {
-  static char logOverflow[] = "\r\n\nLOG DATA DROPPED\r\n\n";
-  bool ret = true;
-    if( m_logQ.spaceAvailable( 24)) {
-      m_logQ.put( c);
-    } else {
-      char *s = logOverflow;
-      ret = false;
-      m_logQ.reset();
-      while( *s != '\0') {
-        m_logQ.put( *s++);
-      }
-    }
-    return ret;
+bool logOut(const char* p, uint32_t len) {
+  // Called from the BLE host task, the WiFi event task and loop(), the ring takes care of the locking
+  return m_logRing.write( p, len);
 }
 int custom_log_handler(const char* format, va_list args) {
+    // Literal formats in flash are stored unformatted, loop() formats them when the record is drained
+    uint8_t rec[LOG_RECORD_MAX];
+    uint32_t len = 0;
+    if( esp_ptr_in_drom( format)) {
+      va_list a;
+      va_copy( a, args);
+      len = DeferredLog::encode( rec, sizeof(rec), format, a);
+      va_end( a);
+    }
+    if( len > 0) {
+      logOut( (const char*) rec, len);
+      return len;
+    }
     // Format the message into a buffer
     char buf[128];
     int ret = vsnprintf(buf, sizeof(buf), format, args);
-    char *s = buf;
-    while( *s != '\0') {
-      if(!logOut( *s++)) {
-        break;
-      }
+    if( ret > 0) {
+      logOut( buf, ret < (int) sizeof(buf) ? ret : sizeof(buf) - 1);
     }
     return ret; 
 }
 
 static void log_char(char c) {
-  logOut(c);
+  logOut(&c, 1);
 }
 
 void setup(){
@@ -257,6 +266,12 @@ void setup(){
   sdLogger.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
 
   startSntp();
+
+  telnetServer.setSliceGroup(SLICE_GROUP_NETWORK);
+  telnetLogServer.setSliceGroup(SLICE_GROUP_NETWORK);
+  if(!networkGroup.start()) {
+    ESP_LOGW(TAG, "Could not start slice group %s", networkGroup.getName());
+  }
   ESP_LOGD(TAG, "Setup complete");
 }
 
@@ -282,20 +297,52 @@ void loop() {
   sdLogger.loop();
   sdLogTest();
 
-  bool telnetSpaceAvailable = telnetLogServer.spaceAvailable( 32);
-  bool serialSpaceAvailable = (Serial.availableForWrite() > 32);
-  if( m_logQ.valueAvailable() && (telnetSpaceAvailable || serialSpaceAvailable)) {
-    char c;
-    for( uint8_t i = 0; i < 32 && m_logQ.valueAvailable(); i++) {
-      c = m_logQ.get();
-      if(telnetSpaceAvailable) {
-        telnetLogServer.put( c);
-      }
+  static uint32_t lastDropped = 0;
+  uint32_t dropped = m_logRing.getDropped();
+  if( dropped != lastDropped) {
+    // Sent straight to the sinks, writing it to the ring could evict another record. Until a sink takes
+    // the notice the count keeps growing and is retried on the next loop.
+    char buf[48];
+    bool sent = false;
+    int len = snprintf( buf, sizeof(buf), "\r\n\nLOG DATA DROPPED: %lu\r\n\n", (unsigned long) (dropped - lastDropped));
+    if( telnetLogServer.spaceAvailable( len)) {
+      telnetLogServer.putN( buf, len);
+      sent = true;
+    }
 #ifdef YRSHELL_ON_TELNET
-      if(serialSpaceAvailable) {
-        Serial.print( c );
-      }
+    if( Serial.availableForWrite() >= len) {
+      Serial.write( (const uint8_t*) buf, len);
+      sent = true;
+    }
 #endif
+    if( sent) {
+      lastDropped = dropped;
     }
   }
+
+  static char logText[LOG_RECORD_MAX];
+  static uint32_t logTextLen = 0;
+  if( logTextLen == 0) {
+    uint8_t rec[LOG_RECORD_MAX];
+    uint32_t len = m_logRing.read( (char*) rec, sizeof(rec));
+    if( DeferredLog::isDeferred( rec, len)) {
+      logTextLen = DeferredLog::format( logText, sizeof(logText), rec, len);
+    } else if( len > 0) {
+      memcpy( logText, rec, len);
+      logTextLen = len;
+    }
+  }
+  bool telnetSpaceAvailable = logTextLen > 0 && telnetLogServer.spaceAvailable( logTextLen);
+  bool serialSpaceAvailable = logTextLen > 0 && (Serial.availableForWrite() >= (int) logTextLen);
+  if( telnetSpaceAvailable || serialSpaceAvailable) {
+    if(telnetSpaceAvailable) {
+      telnetLogServer.putN( logText, logTextLen);
+    }
+#ifdef YRSHELL_ON_TELNET
+    if(serialSpaceAvailable) {
+      Serial.write( (const uint8_t*) logText, logTextLen);
+    }
+#endif
+    logTextLen = 0;
+  }
 }
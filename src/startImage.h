@@ -0,0 +1,88 @@
+#ifndef StartImage_h
+#define StartImage_h
+
+// Generated by tools/startImage from data/start.yr, do not edit
+
+#include <stdint.h>
+
+static const uint32_t startImageSourceCrc = 0x09CB5ABE;
+static const uint32_t startImageFingerprint = 0x8F9EE753;
+static const uint16_t startImageLastWord = 0x02CB;
+static const uint16_t startImageSize = 0x02E0;
+static const uint16_t startImageIndexSlots = 0x0080;
+static const uint16_t startImageIndexCount = 0x002E;
+
+static const uint16_t startImageData[] = {
+0xFFFF , 0x7B2E , 0x0000 , 0xC009 , 0x007B , 0xC04F , 0xC001 , 0x0000 , 0x7D2E , 0x0000 , 0xC009 , 0x007D , 0xC04F , 0xC001 , 0x0007 , 0x5B2E , // 0x0000  ...{....{.O......}....}.O......[
+0x0000 , 0xC009 , 0x005B , 0xC04F , 0xC001 , 0x000E , 0x5D2E , 0x0000 , 0xC009 , 0x005D , 0xC04F , 0xC001 , 0x0015 , 0x222E , 0x0000 , 0xC009 , // 0x0010  ....[.O......]....].O......"....
+0x0022 , 0xC04F , 0xC001 , 0x001C , 0x2C2E , 0x0000 , 0xC009 , 0x002C , 0xC04F , 0xC001 , 0x0023 , 0x3A2E , 0x0000 , 0xC009 , 0x003A , 0xC04F , // 0x0020  ".O......,....,.O...#..:....:.O.
+0xC001 , 0x002A , 0x2C2E , 0x7263 , 0x0000 , 0xE026 , 0xC003 , 0xC001 , 0x0031 , 0x6D64 , 0x003F , 0x600D , 0xC014 , 0xC001 , 0x0038 , 0x6D68 , // 0x0030  ..*..,cr..&.....1.dm?..`....8.hm
+0x0021 , 0xC073 , 0xE046 , 0xC013 , 0xC074 , 0xE048 , 0xC014 , 0xC075 , 0xC001 , 0x003E , 0x712E , 0x616E , 0x656D , 0x0000 , 0xE01F , 0xC012 , // 0x0040  !.s.F...t.H...u...>..qname......
+0xE01F , 0xC001 , 0x0049 , 0x6A2E , 0x616E , 0x656D , 0x0000 , 0xE04E , 0xE02D , 0xC002 , 0xC001 , 0x0052 , 0x6961 , 0x006E , 0xE003 , 0xC016 , // 0x0050  ....I..jname..N.-.....R.ain.....
+0x6961 , 0x006E , 0xE057 , 0xE03B , 0x6007 , 0xC00C , 0xE041 , 0xE00A , 0xC003 , 0xC001 , 0x005B , 0x656C , 0x4F64 , 0x006E , 0xC00B , 0xFFFF , // 0x0060  ain.W.;..`..A.......[.ledOn.....
+0xC009 , 0x0001 , 0x600A , 0xC001 , 0x006A , 0x656C , 0x4F64 , 0x6666 , 0x0000 , 0xC009 , 0x0001 , 0xC00B , 0xFFFF , 0x600A , 0xC001 , 0x0074 , // 0x0070  .....`..j.ledOff...........`..t.
+0x6573 , 0x4C74 , 0x6465 , 0x6C42 , 0x6E69 , 0x006B , 0xC01E , 0x600A , 0xC001 , 0x007F , 0x672E , 0x0070 , 0xC01E , 0xC016 , 0x4722 , 0x4950 , // 0x0080  setLedBlink....`.....gp....."GPI
+0x004F , 0xC012 , 0xC01E , 0xC009 , 0x000A , 0xC033 , 0xC073 , 0xE09E , 0xC009 , 0x0031 , 0xC04F , 0xC0AC , 0x000A , 0xC075 , 0xC0AB , 0x0030 , // 0x0090  O.........3.s.....1.O.....u...0.
+0xC04F , 0xE01F , 0xE02D , 0xC002 , 0x6006 , 0xC00C , 0xE026 , 0xC005 , 0xC001 , 0x0089 , 0x3061 , 0x0000 , 0xC016 , 0x3041 , 0x0000 , 0xE057 , // 0x00A0  O...-....`..&.......a0....A0..W.
+0x6007 , 0xC00C , 0xE026 , 0xC005 , 0xC001 , 0x00A9 , 0x7067 , 0x6F69 , 0x0000 , 0xC009 , 0x0000 , 0xE08C , 0xC009 , 0x0001 , 0xE08C , 0xC009 , // 0x00B0  .`..&.......gpio................
+0x0002 , 0xE08C , 0xC009 , 0x0003 , 0xE08C , 0xC009 , 0x0004 , 0xE08C , 0xC009 , 0x0005 , 0xE08C , 0xC009 , 0x0009 , 0xE08C , 0xC009 , 0x000A , // 0x00C0  ................................
+0xE08C , 0xC009 , 0x000C , 0xE08C , 0xC009 , 0x000D , 0xE08C , 0xC009 , 0x000E , 0xE08C , 0xC009 , 0x000F , 0xE08C , 0xC009 , 0x0010 , 0xE08C , // 0x00D0  ................................
+0xC016 , 0x696D , 0x6C6C , 0x7369 , 0x0000 , 0xE057 , 0xC062 , 0xC00C , 0xC005 , 0xC001 , 0x00B5 , 0x736A , 0x6E6F , 0x6950 , 0x736E , 0x0000 , // 0x00E0  ..millis..W.b.........jsonPins..
+0xE03B , 0xE003 , 0xC005 , 0xE0AC , 0xE0B9 , 0xE00A , 0xC005 , 0xE041 , 0xC001 , 0x00EA , 0x696A , 0x5F70 , 0x0031 , 0xC01E , 0xC009 , 0x00FF , // 0x00F0  ;.............A.....jip_1.......
+0xC02C , 0x6032 , 0xE026 , 0xC002 , 0xC009 , 0x0008 , 0xC06D , 0xC001 , 0x00F9 , 0x696A , 0x0070 , 0xE011 , 0xE0FD , 0xE0FD , 0xE0FD , 0x6032 , // 0x0100  ,.2`&.......m.....jip.........2`
+0xE018 , 0xC001 , 0x0108 , 0x6D6A , 0x6361 , 0x315F , 0x0000 , 0xC01E , 0xC08B , 0x6032 , 0xE026 , 0xC0AB , 0x0001 , 0xC001 , 0x0112 , 0x6D6A , // 0x0110  ......jmac_1......2`&.........jm
+0x6361 , 0x0000 , 0xE011 , 0xE117 , 0xE117 , 0xE117 , 0xE117 , 0xE117 , 0xC08B , 0x6032 , 0xE018 , 0xC001 , 0x011E , 0x702E , 0x7361 , 0x7773 , // 0x0120  ac................2`.......passw
+0x726F , 0x0064 , 0xC009 , 0x0000 , 0xC08B , 0xC073 , 0xE14C , 0xC009 , 0x002A , 0xC009 , 0x0000 , 0xC08A , 0xC009 , 0x002A , 0xC009 , 0x0001 , // 0x0130  ord.......s.L...*.........*.....
+0xC08A , 0xC009 , 0x002A , 0xC009 , 0x0002 , 0xC08A , 0xC009 , 0x0000 , 0xC009 , 0x0003 , 0xC08A , 0xC075 , 0xE04E , 0xC001 , 0x012C , 0x7368 , // 0x0140  ....*.................u.N...,.hs
+0x0030 , 0xC016 , 0x6F68 , 0x7473 , 0x614E , 0x656D , 0x0000 , 0xE057 , 0x6016 , 0xE04E , 0xE035 , 0xC001 , 0x014E , 0x7368 , 0x0031 , 0xC016 , // 0x0150  0...hostName..W..`N.5...N.hs1...
+0x6F68 , 0x7473 , 0x6150 , 0x7373 , 0x6F77 , 0x6472 , 0x0000 , 0xE057 , 0x6017 , 0xE132 , 0xE035 , 0xC001 , 0x015C , 0x7368 , 0x0032 , 0xC016 , // 0x0160  hostPassword..W..`2.5...\.hs2...
+0x6F68 , 0x7473 , 0x7049 , 0x0000 , 0xE057 , 0x6018 , 0xC022 , 0x6033 , 0xE10B , 0xE035 , 0xC001 , 0x016C , 0x7368 , 0x0033 , 0xC016 , 0x6F68 , // 0x0170  hostIp..W..`".3`..5...l.hs3...ho
+0x7473 , 0x6147 , 0x6574 , 0x6177 , 0x0079 , 0xE057 , 0x6019 , 0xC022 , 0x6033 , 0xE10B , 0xE035 , 0xC001 , 0x017B , 0x7368 , 0x0034 , 0xC016 , // 0x0180  stGateway.W..`".3`..5...{.hs4...
+0x6F68 , 0x7473 , 0x614D , 0x6B73 , 0x0000 , 0xE057 , 0x601A , 0xC022 , 0x6033 , 0xE10B , 0xE035 , 0xC001 , 0x018C , 0x7368 , 0x0035 , 0xC016 , // 0x0190  hostMask..W..`".3`..5.....hs5...
+0x6F68 , 0x7473 , 0x614D , 0x0063 , 0xE057 , 0x601B , 0xE122 , 0xE035 , 0xC001 , 0x019C , 0x7368 , 0x0036 , 0xC016 , 0x7369 , 0x6F48 , 0x7473 , // 0x01A0  hostMac.W..`".5.....hs6...isHost
+0x6341 , 0x6974 , 0x6576 , 0x0000 , 0xE057 , 0x601C , 0xC00C , 0xC003 , 0xC001 , 0x01A9 , 0x736A , 0x6E6F , 0x6F48 , 0x7473 , 0x0000 , 0xC016 , // 0x01B0  Active..W..`........jsonHost....
+0x6F68 , 0x7473 , 0x0000 , 0xE057 , 0xE003 , 0xC003 , 0xE151 , 0xE15F , 0xE16F , 0xE17E , 0xE18F , 0xE19F , 0xE1AC , 0xE00A , 0xE035 , 0xC001 , // 0x01C0  host..W.....Q._.o.~.........5...
+0x01B9 , 0x6E6A , 0x7465 , 0x614E , 0x656D , 0x0000 , 0xC016 , 0x616E , 0x656D , 0x0000 , 0xE057 , 0xC01E , 0x6021 , 0xE04E , 0xC001 , 0x01D0 , // 0x01D0  ..jnetName....name..W...!`N.....
+0x6E6A , 0x7465 , 0x7750 , 0x0064 , 0xC016 , 0x6170 , 0x7373 , 0x6F77 , 0x6472 , 0x0000 , 0xE057 , 0xC01E , 0x6022 , 0xE132 , 0xC001 , 0x01DF , // 0x01E0  jnetPwd...password..W..."`2.....
+0x746E , 0x0030 , 0xC016 , 0x6F63 , 0x6E6E , 0x6365 , 0x6574 , 0x4E64 , 0x7465 , 0x6F77 , 0x6B72 , 0x0000 , 0xE057 , 0x601E , 0xC00C , 0xE035 , // 0x01F0  nt0...connectedNetwork..W..`..5.
+0xC001 , 0x01EF , 0x746E , 0x0031 , 0xC016 , 0x656E , 0x7774 , 0x726F , 0x496B , 0x0070 , 0xE057 , 0x601F , 0xC022 , 0x6033 , 0xE10B , 0xE035 , // 0x0200  ....nt1...networkIp.W..`".3`..5.
+0xC001 , 0x0201 , 0x746E , 0x0032 , 0xC016 , 0x656E , 0x7774 , 0x726F , 0x4D6B , 0x6361 , 0x0000 , 0xE057 , 0x6020 , 0xE122 , 0xE035 , 0xC001 , // 0x0210  ....nt2...networkMac..W. `".5...
+0x0211 , 0x6E6A , 0x7465 , 0x0000 , 0xC009 , 0x0000 , 0xC076 , 0xE003 , 0xE1D6 , 0xE026 , 0xC002 , 0xE1E4 , 0xE00A , 0xC0AB , 0x0001 , 0xC041 , // 0x0220  ..jnet......v.....&...........A.
+0xC032 , 0xC073 , 0xE238 , 0xE035 , 0xC009 , 0x0000 , 0xC074 , 0xE23C , 0xC042 , 0xC00B , 0xFFFF , 0xC075 , 0xC077 , 0xE227 , 0xC001 , 0x0220 , // 0x0230  2.s.8.5.....t.<.B.....u.w.'... .
+0x6E6A , 0x7465 , 0x0073 , 0xE1F2 , 0xE204 , 0xE214 , 0xC016 , 0x656E , 0x7774 , 0x726F , 0x736B , 0x0000 , 0xE057 , 0xE011 , 0xC003 , 0x601D , // 0x0240  jnets.........networks..W......`
+0xC01E , 0xC0B0 , 0xE256 , 0xC022 , 0xC074 , 0xE258 , 0xE224 , 0xC075 , 0xE018 , 0xC003 , 0xC001 , 0x023F , 0x736A , 0x6E6F , 0x654E , 0x0074 , // 0x0250  ....V.".t.X.$.u.......?.jsonNet.
+0xE003 , 0xC003 , 0xE1BF , 0xE243 , 0xE00A , 0xC003 , 0xC001 , 0x025B , 0x6664 , 0x0062 , 0xC01E , 0xC0AD , 0x000D , 0xC040 , 0xC0AD , 0x000A , // 0x0260  ......C.......[.dfb.......@.....
+0xC02D , 0xC01F , 0xC03E , 0xC02D , 0xC073 , 0xE278 , 0xC003 , 0xC075 , 0xC001 , 0x0267 , 0x6664 , 0x0065 , 0xC01E , 0xC009 , 0x001F , 0xC032 , // 0x0270  -...>.-.s.x...u...g.dfe.......2.
+0xC040 , 0xC009 , 0x007F , 0xC02F , 0xC02C , 0xC073 , 0xE28B , 0xC01E , 0xC04F , 0xC074 , 0xE28F , 0xC002 , 0xC01E , 0xC00D , 0xC075 , 0xC001 , // 0x0280  @...../.,.s.....O.t.........u...
+0x0279 , 0x7564 , 0x706D , 0x6946 , 0x656C , 0x0000 , 0x602B , 0xE03B , 0xC013 , 0xC076 , 0xC04C , 0xC073 , 0xE2A3 , 0xE27C , 0xE26A , 0xC009 , // 0x0290  y.dumpFile..+`;...v.L.s...|.j...
+0x0000 , 0xC074 , 0xE2A7 , 0xC022 , 0xC00B , 0xFFFF , 0xC075 , 0xC077 , 0xE29A , 0xE041 , 0xC001 , 0x0290 , 0x656C , 0x4F64 , 0x006E , 0xC00A , // 0x02A0  ..t...".....u.w...A.....ledOn...
+0xFFFF , 0x0FFF , 0xC009 , 0x0001 , 0x600A , 0xC001 , 0x02AB , 0x656C , 0x4F64 , 0x6666 , 0x0000 , 0xC009 , 0x0001 , 0xC00A , 0xFFFF , 0x0FFF , // 0x02B0  .........`....ledOff............
+0x600A , 0xC001 , 0x02B6 , 0x656C , 0x4264 , 0x696C , 0x6B6E , 0x0000 , 0xC01E , 0x600A , 0xC001 , 0x02C2 , 0x6F6D , 0x006E , 0xC009 , 0x0001 , // 0x02C0  .`....ledBlink.....`....mon.....
+0xC076 , 0x6036 , 0xC009 , 0x2710 , 0xC047 , 0xC009 , 0x2710 , 0xC047 , 0xC009 , 0x2710 , 0xC047 , 0x875B , 0xC077 , 0xE2D1 , 0xC022 , 0xC001 , // 0x02D0  v.6`...'G....'G....'G.[.w..."...
+};
+
+static const uint16_t startImageIndexValues[] = {
+0xFFFF , 0xFFFF , 0xFFFF , 0x004A , 0xFFFF , 0xFFFF , 0x025C , 0xFFFF , 0xFFFF , 0xFFFF , 0x0080 , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , // 0x0000
+0xFFFF , 0x002B , 0xFFFF , 0x01D1 , 0x014F , 0x00AA , 0x008A , 0x0268 , 0xFFFF , 0xFFFF , 0x0032 , 0x00EB , 0xFFFF , 0xFFFF , 0x000F , 0xFFFF , // 0x0010
+0x011F , 0xFFFF , 0xFFFF , 0x02AC , 0xFFFF , 0xFFFF , 0xFFFF , 0x015D , 0x02C3 , 0x001D , 0xFFFF , 0xFFFF , 0xFFFF , 0x01BA , 0xFFFF , 0xFFFF , // 0x0020
+0x0221 , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0x016D , 0xFFFF , 0xFFFF , 0x003F , 0x0001 , 0xFFFF , // 0x0030
+0xFFFF , 0x02CC , 0xFFFF , 0x01E0 , 0x0016 , 0xFFFF , 0xFFFF , 0xFFFF , 0x018D , 0xFFFF , 0xFFFF , 0xFFFF , 0x012D , 0x017C , 0xFFFF , 0xFFFF , // 0x0040
+0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0x0113 , 0xFFFF , 0xFFFF , 0x0212 , 0xFFFF , 0x0291 , 0xFFFF , 0x019D , 0xFFFF , 0xFFFF , 0x027A , 0x0039 , // 0x0050
+0xFFFF , 0xFFFF , 0xFFFF , 0x005C , 0x0109 , 0x0008 , 0xFFFF , 0x02B7 , 0x0024 , 0xFFFF , 0x0202 , 0xFFFF , 0xFFFF , 0xFFFF , 0x01AA , 0xFFFF , // 0x0060
+0x00FA , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0xFFFF , 0x0240 , 0x00B6 , 0x0053 , 0xFFFF , 0x01F0 , 0xFFFF , 0xFFFF , // 0x0070
+};
+
+static const uint8_t startImageIndexTags[] = {
+0x00 , 0x00 , 0x00 , 0x53 , 0x00 , 0x00 , 0x90 , 0x00 , 0x00 , 0x00 , 0x7B , 0x00 , 0x00 , 0x00 , 0x00 , 0x00 , // 0x0000
+0x00 , 0x8F , 0x00 , 0xDD , 0xC2 , 0x1B , 0x4E , 0xDB , 0x00 , 0x00 , 0x87 , 0xEA , 0x00 , 0x00 , 0x6E , 0x00 , // 0x0010
+0xE2 , 0x00 , 0x00 , 0xC4 , 0x00 , 0x00 , 0x00 , 0xC3 , 0x26 , 0x97 , 0x00 , 0x00 , 0x00 , 0xB5 , 0x00 , 0x00 , // 0x0020
+0x39 , 0x00 , 0x00 , 0x00 , 0x00 , 0x00 , 0x00 , 0x00 , 0x00 , 0x00 , 0xC4 , 0x00 , 0x00 , 0x37 , 0x4E , 0x00 , // 0x0030
+0x00 , 0xE9 , 0x00 , 0xE3 , 0x70 , 0x00 , 0x00 , 0x00 , 0xBE , 0x00 , 0x00 , 0x00 , 0x20 , 0xC5 , 0x00 , 0x00 , // 0x0040
+0x00 , 0x00 , 0x00 , 0x00 , 0xF4 , 0x00 , 0x00 , 0xED , 0x00 , 0xD1 , 0x00 , 0xBF , 0x00 , 0x00 , 0xD8 , 0x9E , // 0x0050
+0x00 , 0x00 , 0x00 , 0x37 , 0xDB , 0x50 , 0x00 , 0x08 , 0xA1 , 0x00 , 0xEE , 0x00 , 0x00 , 0x00 , 0xC0 , 0x00 , // 0x0060
+0x71 , 0x00 , 0x00 , 0x00 , 0x00 , 0x00 , 0x00 , 0x00 , 0x00 , 0x8D , 0x9D , 0x69 , 0x00 , 0xEF , 0x00 , 0x00 , // 0x0070
+};
+
+static const char startImageCommands[] = "0 setPromptEnable\r1 setPromptEnable\r1 setTelnetLogEnable\rchipInfo\rsdkVersion\rcurTime\rmainIO\r";
+
+#endif
@@ -0,0 +1,55 @@
+# Writes a YRShell script printing numbers, the seed is the first argument. The formatN.yr scripts were written with
+#   python3 format.py N > formatN.yr
+# and their golden output with yrhost -u. Integers with each print word in decimal and hex, floats, float bit
+# patterns, literals of every form the parser takes or rejects, compiled and interpreted, and the text buffer.
+import random, struct, sys
+random.seed(int(sys.argv[1]))
+L = []
+def ints():
+    c = [0, 1, -1, 9, 10, 99, 100, 999, 1000, 65535, 65536, -65536, 2147483647, -2147483648, 999999999, 1000000000, 4294967295, 123456789]
+    c += [random.randint(-2**31, 2**31 - 1) for _ in range(40)]
+    c += [random.randint(-1000, 1000) for _ in range(20)]
+    return c
+for w in ['.', '.b', '.w', '.x', '.bx', '.wx', '.n']:
+    v = ints()
+    for i in range(0, len(v), 6):
+        L.append(' '.join('%d %s' % (x, w) for x in v[i:i+6]))
+L.append('hex')
+for w in ['.', '.b', '.w', '.n']:
+    v = ints()
+    for i in range(0, len(v), 6):
+        L.append(' '.join('%d %s' % (x, w) for x in v[i:i+6]))
+L.append('decimal')
+def floats():
+    c = ['1.0', '0.1', '-0.5', '1.5', '-1.5', '3.14159', '1.0e10', '1.0e-10', '9.99999', '999.999', '1000.0', '0.001', '123.456e3', '1.0e38', '1.0e-37', '2.5E2', '-7.25', '100.0', '10.0', '0.0']
+    for _ in range(60):
+        m = random.randint(0, 99999)
+        f = random.randint(0, 9999)
+        e = random.randint(-30, 30)
+        c.append('%s%d.%de%d' % (random.choice(['', '-']), m, f, e))
+    return c
+for w in ['.f', '.e']:
+    v = floats()
+    for i in range(0, len(v), 5):
+        L.append(' '.join('%s %s' % (x, w) for x in v[i:i+5]))
+# Bit patterns as floats
+for i in range(40):
+    v = [random.getrandbits(32) for _ in range(4)]
+    L.append(' '.join('0x%X .f 0x%X .e' % (x, x) for x in v))
+# Literal forms
+lits = ['-', '0x', '0x1F', '0XFF', '0xfffffffff', '0x12345678', '12345678901234567', '1234567890123456', '.5', '5.', '1.e3', '1.-5', '-.5', '-0.5', '1.5e', '1.5e+3', '1.5e-3', '00012', '-000', '1-2', '0x-1', '3.2.1', '1e5', '-0x5', '99999999999', '4294967296', '-4294967297', '65535', '65536', '-65537', '0xFFFF0000', '0xFFFF', 'abc', '1.5x']
+for x in lits:
+    L.append('%s .x' % x)
+    L.append(': lt%d %s .x' % (len(L), x))
+    L.append('lt%d' % (len(L) - 1))
+# Text output
+L.append('0 0 c!')
+L.append('textIO 1 . 2 . 0x10 .x 1.5 .f mainIO 0 .str cr')
+L.append('textIO -5 .n 3.0e5 .e mainIO 0 .str cr')
+L.append('0 0 c! textIO 7 . mainIO 0 .str cr')
+L.append('65 3 c! 0 .str cr')
+L.append('0 2 c! textIO 9 . mainIO 0 .str cr')
+for i in range(12):
+    L.append('0 0 c! textIO %d . %d .x mainIO 0 .str cr' % (i * 1000, i))
+L.append('0 setExpandCR 1 . cr 2 . cr 1 setExpandCR')
+print('\n'.join(L))
@@ -0,0 +1,45 @@
+# Writes a random YRShell program, the seed is the first argument. The programNN.yr scripts were written with
+#   python3 programs.py NN > programNN.yr
+# and their golden output with yrhost -u. Lines are kept short of the 128 character pad. Each word mixes literals, stack and arithmetic words, ifs and loops
+# the way the peephole optimizer fuses them, is run as a command line twice, which the line cache answers the
+# second time, and then is called, alone or from another word.
+import random, sys
+random.seed(int(sys.argv[1]))
+ops = ['+', '-', '*', '&', '|', '^', '<', '<=', '==', '>', '>=', '!=', '0==', '0!=', 'dup', 'drop', 'swap', 'over', 'nip', 'tuck', 'rot', '2dup', '2drop', 'neg', '.']
+def lit():
+    return str(random.choice([0, 1, 2, 3, 5, 7, 10, 255, 65535, 65536, 100000, -1, -5]))
+def seq(depth):
+    out = []
+    for _ in range(random.randint(1, 8)):
+        r = random.random()
+        if r < 0.3:
+            out.append(lit())
+        elif r < 0.38 and depth < 3:
+            out += ['dup', lit(), '==', '['] + seq(depth + 1) + ([']['] + seq(depth + 1) if random.random() < 0.5 else []) + [']']
+        elif r < 0.45 and depth < 3:
+            out += [random.choice(['==', '!=', '0==']), '['] + seq(depth + 1) + [']']
+        elif r < 0.5 and depth < 2:
+            # The body leaves the counter alone so the loop ends
+            body = random.choice([[], ['dup', '.'], ['dup', lit(), '+', 'drop'], ['dup', '2', '==', '[', lit(), '.', ']']])
+            out += ['0', '{', '1', '+'] + body + ['dup', str(random.randint(1, 4)), random.choice(['==', '>=']), '}', 'drop']
+        elif r < 0.55:
+            out += ['over', '+']
+        elif r < 0.6:
+            out += [lit(), random.choice(['+', '-', '=='])]
+        else:
+            out.append(random.choice(ops))
+    return out
+# reset would also clear the words defined so far
+lines = [': clr psd? 0!= [ { drop psd? 0== } ]']
+for w in range(10):
+    body = ' '.join(seq(0))
+    while len(body) > 96:
+        body = ' '.join(seq(0))
+    lines.append(': w%d %s' % (w, body))
+    for _ in range(2):
+        lines.append('1 2 3 4 5 %s ps? clr' % body)
+    if w > 2 and random.random() < 0.5:
+        lines.append(': c%d w%d w%d' % (w, random.randrange(w), w))
+    lines.append('1 2 3 4 5 w%d ps?' % w)
+    lines.append('ps? clr')
+print('\n'.join(lines))
@@ -0,0 +1,881 @@
+/*
+ Runs the HttpExecServer on a Linux or macOS host against in memory connections and measures it under load.
+
+ The stubs directory stands in for the WiFi, network and LittleFS libraries: a connection is a HostSocket
+ holding the requests and following the responses, accept() takes the connections queued by the load
+ generator and the files are buffers in memory. /exec requests go to HostExec, which writes one line per
+ pass of the loop, the way a script that takes a while answers on the board.
+
+ It first checks that the files of assets.txt are given an ETag, and that one is not once a byte of it
+ changed. It then sends an /exec request on every slot at once with half as many sessions as slots, and
+ exits 1 unless each is answered 200 with output or 503 with Retry-After. Then it asks for /exec, /stats
+ and a file over HTTP/1.0 with Connection: keep-alive, and exits 1 if an answer is chunked, or if the
+ server does not close the connection after one without a Content-Length.
+
+ Each pass of the loop slices the server once and HostExec once. The load generator keeps a number of
+ clients busy with the mix of index.html, a script, /stats and an /exec request, each client sending its next
+ request as soon as it has the answer to the previous one. A new connection reaches accept() only after
+ the handshake time. The clients close the connection after each request, keep it alive, or keep it
+ alive and pipeline a number of requests. For each it prints requests per second, the 50th and 99th
+ percentile and the maximum latency, the connections opened, the requests sent again after the server
+ closed a connection before answering them, the responses other than 200 and the number of operator new
+ calls made by the server after the first pass. The stubs allocate nothing, on the board NetworkClient
+ allocates for each connection and LittleFS for each file opened.
+
+ Then it loads data/index.html with its style sheet, scripts and icon, each client over a new keep-alive
+ connection asking for one file after the other: without Accept-Encoding, accepting gzip, and accepting
+ gzip with If-None-Match holding the ETags of the last load, as a browser revalidates its cache. For each
+ it prints pages per second, the 50th and 99th percentile and the maximum time to load a page, the bytes
+ of a page load, headers included, and the bytes per second delivered. What the server writes drains
+ from the send buffer of each connection at the rate of the link, the way a WiFi client takes it. It exits 1
+ if the server read part of a file again because the socket did not take all it had read.
+
+ -f runs the request parser over streams of requests made from a corpus and mutated at random, fed in
+ pieces of random size, and exits 1 unless the results match those of the whole stream and stay in
+ bounds. -b measures the parser alone.
+
+ usage: httphost [-n requests] [-c clients] [-x lines] [-h us] [-d depth] [-p pages] [-r rate] [-a bundle] [-f count] [-b]
+   -n requests  requests per run, default 2000
+   -c clients   run only this number of concurrent clients, default 1, 4 and 16
+   -x lines     lines written by an /exec request, default 20
+   -h us        handshake time of a new connection, default 2000
+   -d depth     requests in flight on a pipelined connection, default 4
+   -p pages     pages loaded per run, default 200
+   -r rate      bytes per ms a connection delivers to the client, 0 for no limit, default 1000
+   -a bundle    serve the files from this asset bundle, written by tools/webAssets, rather than LittleFS
+   -f count     fuzz the request parser with count streams
+   -b           benchmark the request parser
+ */
+#include <HttpExecServer.h>
+#include <HttpParser.h>
+#include <YRShellExec.h>
+#include <Wifi.h>
+#include <esp_partition.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#define HOST_CLIENTS_MAX 16
+#define HOST_SOCKETS (HOST_CLIENTS_MAX * 3)
+#define HOST_PIPELINE_MAX 8
+#define HOST_EXEC_SESSIONS HTTP_SERVER_CONNECTIONS
+#define HOST_STALL_US 2000000
+#ifndef HOST_DATA
+#define HOST_DATA "../../data"
+#endif
+
+static bool s_countNew = false;
+static uint32_t s_newCount = 0;
+
+void* operator new( size_t size) {
+    if( s_countNew) {
+        s_newCount++;
+    }
+    void* p = malloc( size == 0 ? 1 : size);
+    if( p == NULL) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+void operator delete( void* p) noexcept {
+    free( p);
+}
+void operator delete( void* p, size_t) noexcept {
+    free( p);
+}
+
+/** \brief Answers /exec requests with a number of lines, one per slice.
+ */
+class HostExec : public YRShellExec {
+protected:
+    CircularQ<char, 512> m_outq[ HOST_EXEC_SESSIONS];
+    bool m_busy[ HOST_EXEC_SESSIONS];
+    uint16_t m_lines[ HOST_EXEC_SESSIONS];
+    uint16_t m_execLines;
+    uint8_t m_sessions;
+
+public:
+    HostExec( uint16_t lines) {
+        m_execLines = lines;
+        m_sessions = HOST_EXEC_SESSIONS;
+        for( uint8_t i = 0; i < HOST_EXEC_SESSIONS; i++) {
+            m_busy[ i] = false;
+            m_lines[ i] = 0;
+        }
+    }
+    int8_t execString( const char* p) {
+        int8_t rc = -1;
+        for( int8_t i = 0; rc < 0 && i < m_sessions; i++) {
+            if( !m_busy[ i]) {
+                m_busy[ i] = true;
+                m_lines[ i] = m_execLines;
+                m_outq[ i].reset();
+                rc = i;
+            }
+        }
+        return rc;
+    }
+    /** \brief Hands out only the first n sessions, fewer than the server has slots as on the board.
+     */
+    void setSessions( uint8_t n) { m_sessions = n < HOST_EXEC_SESSIONS ? n : HOST_EXEC_SESSIONS; }
+    uint8_t getSessions( void) { return m_sessions; }
+    CircularQBase<char>* getExecOutq( int8_t handle) { return &m_outq[ handle]; }
+    bool isExec( int8_t handle) { return m_lines[ handle] > 0; }
+    void endExec( int8_t handle) {
+        m_busy[ handle] = false;
+        m_lines[ handle] = 0;
+    }
+    void slice( void) {
+        static const char line[] = "{\"temperature\":21.5,\"humidity\":40.0}\r\n";
+        for( uint8_t i = 0; i < HOST_EXEC_SESSIONS; i++) {
+            if( m_lines[ i] > 0 && m_outq[ i].spaceAvailable( sizeof( line) - 1)) {
+                m_outq[ i].putN( line, sizeof( line) - 1);
+                m_lines[ i]--;
+            }
+        }
+    }
+};
+
+class HostServer : public HttpExecServer {
+public:
+    virtual const char* sliceName( ) { return "HostServer"; }
+    /** \brief Reads the manifest again, returns the number of files given an ETag.
+     */
+    uint8_t reloadAssets( void) {
+        loadAssets();
+        return m_assetCount;
+    }
+    bool isAsset( const char* path) { return findAsset( path) != NULL; }
+};
+
+typedef enum {
+    MODE_CLOSE      = 0,
+    MODE_KEEP_ALIVE = 1,
+    MODE_PIPELINE   = 2,
+} hostModes_t;
+
+typedef enum {
+    CLIENT_IDLE       = 0,
+    CLIENT_CONNECTING = 1,
+    CLIENT_OPEN       = 2,
+} hostClientStates_t;
+
+typedef struct {
+    HostSocket* socket;
+    uint8_t     state;
+    uint32_t    connectAt;
+    uint32_t    start[ HOST_PIPELINE_MAX];
+    uint16_t    sent;
+    uint16_t    answered;
+    uint16_t    failed;
+    uint16_t    counted;
+    bool        loading;
+} HostClient;
+
+static const char* s_modeNames[] = { "close", "keep-alive", "pipeline" };
+
+static const char* s_requests[] = {
+    "GET /index.html HTTP/1.1\r\nHost: yrshell\r\nAccept: text/html\r\n\r\n",
+    "GET /js/netConfig.js HTTP/1.1\r\nHost: yrshell\r\nAccept: */*\r\n\r\n",
+    "GET /exec/7374617473 HTTP/1.1\r\nHost: yrshell\r\nAccept: */*\r\n\r\n",
+    "GET /stats HTTP/1.1\r\nHost: yrshell\r\nAccept: */*\r\n\r\n",
+};
+static const char* s_closeRequests[] = {
+    "GET /index.html HTTP/1.1\r\nHost: yrshell\r\nAccept: text/html\r\nConnection: close\r\n\r\n",
+    "GET /js/netConfig.js HTTP/1.1\r\nHost: yrshell\r\nAccept: */*\r\nConnection: close\r\n\r\n",
+    "GET /exec/7374617473 HTTP/1.1\r\nHost: yrshell\r\nAccept: */*\r\nConnection: close\r\n\r\n",
+    "GET /stats HTTP/1.1\r\nHost: yrshell\r\nAccept: */*\r\nConnection: close\r\n\r\n",
+};
+#define HOST_REQUESTS (sizeof( s_requests) / sizeof( s_requests[ 0]))
+
+// What a browser sends for a fetch()
+static const char s_browserRequest[] =
+    "GET /exec/3220726567697374657273 HTTP/1.1\r\n"
+    "Host: 192.168.4.1\r\n"
+    "Connection: keep-alive\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+    "Accept: */*\r\n"
+    "Referer: http://192.168.4.1/index.html\r\n"
+    "Accept-Encoding: gzip, deflate\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+    "\r\n";
+
+// data/index.html and what it loads, in the order a browser asks for them
+static const char* s_pageFiles[] = {
+    "/index.html",
+    "/css/index.css",
+    "/js/logs.js",
+    "/js/global.js",
+    "/js/nav.js",
+    "/js/esp.js",
+    "/js/netConfig.js",
+    "/js/debug.js",
+    "/js/index.js",
+    "/favicon.ico",
+};
+#define HOST_PAGE_FILES (sizeof( s_pageFiles) / sizeof( s_pageFiles[ 0]))
+
+typedef enum {
+    PAGE_PLAIN      = 0,
+    PAGE_GZIP       = 1,
+    PAGE_REVALIDATE = 2,
+} hostPageModes_t;
+
+static const char* s_pageModeNames[] = { "page", "page-gzip", "page-304" };
+
+static std::string s_fileData[ HOST_PAGE_FILES];
+static std::string s_gzipPaths[ HOST_PAGE_FILES];
+static std::string s_gzipData[ HOST_PAGE_FILES];
+static std::string s_manifest;
+static std::vector<uint32_t> s_bundle;
+static std::string s_etags[ HOST_PAGE_FILES];
+
+/** \brief The request for file index of a page, revalidating sends back the ETag the file was last sent with.
+ */
+static std::string pageRequest( uint8_t mode, uint16_t index) {
+    std::string rc = std::string( "GET ") + s_pageFiles[ index] + " HTTP/1.1\r\nHost: yrshell\r\nAccept: */*\r\n";
+    if( mode != PAGE_PLAIN) {
+        rc += "Accept-Encoding: gzip, deflate\r\n";
+    }
+    if( mode == PAGE_REVALIDATE && !s_etags[ index].empty()) {
+        rc += "If-None-Match: " + s_etags[ index] + "\r\n";
+    }
+    return rc + "\r\n";
+}
+
+static bool loadFile( const char* path, std::string& data, const char* dir = HOST_DATA) {
+    bool rc = false;
+    FILE* f = fopen( (std::string( dir) + path).c_str(), "rb");
+    if( f != NULL) {
+        char buf[ 4096];
+        size_t n;
+        data.clear();
+        while( (n = fread( buf, 1, sizeof( buf), f)) > 0) {
+            data.append( buf, n);
+        }
+        rc = !ferror( f);
+        fclose( f);
+    }
+    return rc;
+}
+
+static HostServer s_server;
+static HostClient s_clients[ HOST_CLIENTS_MAX];
+static HostSocket s_sockets[ HOST_SOCKETS];
+
+static HostSocket* freeSocket( void) {
+    HostSocket* rc = NULL;
+    for( uint8_t i = 0; rc == NULL && i < HOST_SOCKETS; i++) {
+        if( !s_sockets[ i].m_open && !s_sockets[ i].m_accepted) {
+            rc = &s_sockets[ i];
+        }
+    }
+    return rc;
+}
+
+static void run( HostExec& exec, uint8_t mode, uint8_t clients, uint32_t requests, uint32_t handshake, uint8_t depth) {
+    std::vector<uint32_t> latency;
+    latency.reserve( requests);
+    const char** table = mode == MODE_CLOSE ? s_closeRequests : s_requests;
+    uint8_t inFlight = mode == MODE_PIPELINE ? depth : 1;
+    uint32_t started = 0;
+    uint32_t errors = 0;
+    uint32_t retries = 0;
+    uint32_t connections = 0;
+    s_newCount = 0;
+    uint32_t t0 = HW_getMicros();
+    uint32_t progress = t0;
+    while( latency.size() < requests) {
+        uint32_t now = HW_getMicros();
+        for( uint8_t i = 0; i < clients; i++) {
+            HostClient& c = s_clients[ i];
+            if( c.state == CLIENT_IDLE && started < requests && (c.socket = freeSocket()) != NULL) {
+                c.socket->open();
+                c.connectAt = now + handshake;
+                c.sent = 0;
+                c.answered = 0;
+                c.failed = 0;
+                c.state = CLIENT_CONNECTING;
+            }
+            if( c.state == CLIENT_CONNECTING && (int32_t) (now - c.connectAt) >= 0 && NetworkServer::connect( c.socket)) {
+                connections++;
+                c.state = CLIENT_OPEN;
+            }
+            while( c.state == CLIENT_OPEN && c.sent - c.answered < inFlight && started < requests && (mode != MODE_CLOSE || c.sent == 0)
+                    && !c.socket->m_closing && c.socket->send( table[ started % HOST_REQUESTS])) {
+                c.start[ c.sent % HOST_PIPELINE_MAX] = now;
+                c.sent++;
+                started++;
+            }
+        }
+        s_countNew = true;
+        s_server.slice();
+        s_countNew = false;
+        exec.slice();
+        now = HW_getMicros();
+        for( uint8_t i = 0; i < clients; i++) {
+            HostClient& c = s_clients[ i];
+            if( c.state == CLIENT_OPEN) {
+                c.socket->poll();
+                while( c.answered < c.socket->m_responses) {
+                    latency.push_back( now - c.start[ c.answered % HOST_PIPELINE_MAX]);
+                    c.answered++;
+                    progress = now;
+                }
+                errors += c.socket->m_failed - c.failed;
+                c.failed = c.socket->m_failed;
+                if( !c.socket->m_open) {
+                    // Closed before answering, a browser sends them again on a new connection
+                    retries += c.sent - c.answered;
+                    started -= c.sent - c.answered;
+                    c.state = CLIENT_IDLE;
+                } else if( c.sent == c.answered && (mode == MODE_CLOSE ? false : started >= requests)) {
+                    c.socket->m_open = false;
+                    c.state = CLIENT_IDLE;
+                }
+            }
+        }
+        if( now - progress > HOST_STALL_US) {
+            fprintf( stderr, "stalled with %u of %u requests answered\n", (unsigned) latency.size(), (unsigned) requests);
+            exit( 1);
+        }
+    }
+    uint32_t elapsed = HW_getMicros() - t0;
+    // Let the server see the last connections closed before the next run
+    for( uint16_t i = 0; i < 16; i++) {
+        s_server.slice();
+    }
+    for( uint8_t i = 0; i < clients; i++) {
+        s_clients[ i].state = CLIENT_IDLE;
+    }
+    std::sort( latency.begin(), latency.end());
+    printf( "%-10s %7u %9.0f %7u %7u %7u %6u %7u %6u %5u\n", s_modeNames[ mode], (unsigned) clients,
+        elapsed == 0 ? 0.0 : requests * 1000000.0 / elapsed,
+        (unsigned) latency[ latency.size() / 2], (unsigned) latency[ (latency.size() * 99) / 100],
+        (unsigned) latency.back(), (unsigned) connections, (unsigned) retries, (unsigned) errors, (unsigned) s_newCount);
+}
+
+/** \brief Every file of assets.txt must be given an ETag, and none once a byte of it changed, its size the same.
+ Returns false and prints what went wrong otherwise.
+ */
+static bool checkAssets( void) {
+    bool rc = true;
+    uint8_t listed = (uint8_t) std::count( s_manifest.begin(), s_manifest.end(), '\n');
+    uint8_t loaded = s_server.reloadAssets();
+    if( loaded != listed) {
+        fprintf( stderr, "assets: %u of the %u files of assets.txt given an ETag\n", (unsigned) loaded, (unsigned) listed);
+        rc = false;
+    }
+    s_fileData[ 0][ s_fileData[ 0].size() / 2] ^= 0x20;
+    loaded = s_server.reloadAssets();
+    if( rc && (s_server.isAsset( s_pageFiles[ 0]) || loaded != listed - 1)) {
+        fprintf( stderr, "assets: %s given an ETag after it changed\n", s_pageFiles[ 0]);
+        rc = false;
+    }
+    s_fileData[ 0][ s_fileData[ 0].size() / 2] ^= 0x20;
+    s_server.reloadAssets();
+    printf( "assets: %u files with an ETag, %s\n", (unsigned) listed, rc ? "a changed one without" : "failed");
+    return rc;
+}
+
+/** \brief Sends an /exec request on every slot at once with half as many shell sessions as slots, the way
+ the board has more connections than sessions. Each must be answered 200 with the output of the command,
+ or 503 with Retry-After, never an empty 200. Returns false and prints what went wrong otherwise.
+ */
+static bool checkExecBusy( HostExec& exec) {
+    bool rc = true;
+    uint8_t clients = HTTP_SERVER_CONNECTIONS;
+    uint8_t sessions = exec.getSessions();
+    uint8_t answered = 0;
+    uint8_t ok = 0;
+    uint8_t busy = 0;
+    exec.setSessions( (uint8_t) (clients / 2));
+    for( uint8_t i = 0; i < clients; i++) {
+        HostClient& c = s_clients[ i];
+        c.socket = freeSocket();
+        c.socket->open();
+        c.socket->send( s_closeRequests[ 2]);
+        NetworkServer::connect( c.socket);
+        c.state = CLIENT_OPEN;
+    }
+    uint32_t progress = HW_getMicros();
+    while( rc && answered < clients) {
+        s_server.slice();
+        exec.slice();
+        for( uint8_t i = 0; i < clients; i++) {
+            HostClient& c = s_clients[ i];
+            c.socket->poll();
+            if( c.state == CLIENT_OPEN && c.socket->m_responses > 0) {
+                HostSocket& s = *c.socket;
+                if( s.m_lastStatus == 200 && s.m_bodyLength > 0) {
+                    ok++;
+                } else if( s.m_lastStatus == 503 && s.m_retryAfter) {
+                    busy++;
+                } else {
+                    fprintf( stderr, "exec: client %u answered %u with %u body bytes%s\n", (unsigned) i, (unsigned) s.m_lastStatus,
+                        (unsigned) s.m_bodyLength, s.m_retryAfter ? " and Retry-After" : "");
+                    rc = false;
+                }
+                s.m_open = false;
+                c.state = CLIENT_IDLE;
+                answered++;
+                progress = HW_getMicros();
+            } else if( c.state == CLIENT_OPEN && !c.socket->m_open) {
+                fprintf( stderr, "exec: client %u closed without an answer\n", (unsigned) i);
+                rc = false;
+            }
+        }
+        if( HW_getMicros() - progress > HOST_STALL_US) {
+            fprintf( stderr, "exec: stalled with %u of %u clients answered\n", (unsigned) answered, (unsigned) clients);
+            rc = false;
+        }
+    }
+    for( uint16_t i = 0; i < 16; i++) {
+        s_server.slice();
+    }
+    if( rc && ok != exec.getSessions()) {
+        fprintf( stderr, "exec: %u of %u sessions answered 200\n", (unsigned) ok, (unsigned) exec.getSessions());
+        rc = false;
+    }
+    printf( "exec: %u clients, %u sessions, %u answered 200, %u answered 503 with Retry-After\n", (unsigned) clients,
+        (unsigned) exec.getSessions(), (unsigned) ok, (unsigned) busy);
+    exec.setSessions( sessions);
+    return rc;
+}
+
+// HTTP/1.0 clients asking to be kept alive, an answer of unknown length can not be chunked for them
+static const char* s_http10Requests[] = {
+    "GET /exec/7374617473 HTTP/1.0\r\nConnection: keep-alive\r\n\r\n",
+    "GET /stats HTTP/1.0\r\nConnection: keep-alive\r\n\r\n",
+    "GET /index.html HTTP/1.0\r\nConnection: keep-alive\r\n\r\n",
+};
+
+/** \brief Sends each of s_http10Requests on a new connection. Those without a Content-Length must come back
+ unchunked and the server must close the connection to end them, the file with a length keeps it open.
+ Returns false and prints what went wrong otherwise.
+ */
+static bool checkHttp10( HostExec& exec) {
+    bool rc = true;
+    for( uint8_t i = 0; rc && i < sizeof( s_http10Requests) / sizeof( s_http10Requests[ 0]); i++) {
+        HostSocket& s = *freeSocket();
+        bool file = strstr( s_http10Requests[ i], "/index.html") != NULL;
+        s.open();
+        s.send( s_http10Requests[ i]);
+        NetworkServer::connect( &s);
+        uint32_t start = HW_getMicros();
+        while( HW_getMicros() - start < HOST_STALL_US && (s.m_responses == 0 || (!file && s.m_open))) {
+            s_server.slice();
+            exec.slice();
+            s.poll();
+        }
+        if( s.m_responses != 1 || s.m_lastStatus != 200 || s.m_bodyLength == 0) {
+            fprintf( stderr, "HTTP/1.0: %.20s answered %u times, last %u with %u body bytes\n", s_http10Requests[ i],
+                (unsigned) s.m_responses, (unsigned) s.m_lastStatus, (unsigned) s.m_bodyLength);
+            rc = false;
+        } else if( s.isChunked() || (!file && (!s.m_closing || s.m_open)) || (file && s.m_closing)) {
+            fprintf( stderr, "HTTP/1.0: %.20s answered%s, connection %s\n", s_http10Requests[ i], s.isChunked() ? " in chunks" : "",
+                s.m_closing ? "closed" : "kept alive");
+            rc = false;
+        }
+        s.m_open = false;
+        for( uint16_t j = 0; j < 16; j++) {
+            s_server.slice();
+        }
+    }
+    printf( "HTTP/1.0 keep-alive: %s\n", rc ? "unchunked, closed without a length" : "failed");
+    return rc;
+}
+
+/** \brief Loads index.html and what it loads over new keep-alive connections, one request at a time,
+ the way a browser with a single connection does. Each file should come back 200, 304 when revalidating.
+ */
+static void runPages( HostExec& exec, uint8_t mode, uint8_t clients, uint32_t pages, uint32_t handshake) {
+    std::vector<uint32_t> latency;
+    latency.reserve( pages);
+    uint32_t started = 0;
+    uint32_t errors = 0;
+    uint32_t retries = 0;
+    uint64_t bytes = 0;
+    uint32_t t0 = HW_getMicros();
+    uint32_t progress = t0;
+    while( latency.size() < pages) {
+        uint32_t now = HW_getMicros();
+        for( uint8_t i = 0; i < clients; i++) {
+            HostClient& c = s_clients[ i];
+            if( c.state == CLIENT_IDLE && (c.loading || started < pages) && (c.socket = freeSocket()) != NULL) {
+                if( !c.loading) {
+                    // A new page, one whose connection was closed goes on from where it stopped
+                    c.start[ 0] = now;
+                    c.answered = 0;
+                    c.loading = true;
+                    started++;
+                }
+                c.socket->open();
+                c.connectAt = now + handshake;
+                c.sent = c.answered;
+                c.counted = 0;
+                c.state = CLIENT_CONNECTING;
+            }
+            if( c.state == CLIENT_CONNECTING && (int32_t) (now - c.connectAt) >= 0 && NetworkServer::connect( c.socket)) {
+                c.state = CLIENT_OPEN;
+            }
+            if( c.state == CLIENT_OPEN && c.sent == c.answered && !c.socket->m_closing
+                    && c.socket->send( pageRequest( mode, c.sent).c_str())) {
+                c.sent++;
+            }
+        }
+        s_server.slice();
+        exec.slice();
+        now = HW_getMicros();
+        for( uint8_t i = 0; i < clients; i++) {
+            HostClient& c = s_clients[ i];
+            if( c.state == CLIENT_OPEN) {
+                c.socket->poll();
+                if( c.socket->m_responses > c.counted) {
+                    c.answered += c.socket->m_responses - c.counted;
+                    c.counted = c.socket->m_responses;
+                    errors += c.socket->m_lastStatus != (mode == PAGE_REVALIDATE ? 304 : 200);
+                    if( c.socket->m_etag[ 0] != '\0') {
+                        s_etags[ c.answered - 1] = c.socket->m_etag;
+                    }
+                    progress = now;
+                }
+                if( c.answered == HOST_PAGE_FILES) {
+                    bytes += c.socket->m_responseLength;
+                    latency.push_back( now - c.start[ 0]);
+                    c.socket->m_open = false;
+                    c.loading = false;
+                    c.state = CLIENT_IDLE;
+                } else if( !c.socket->m_open) {
+                    bytes += c.socket->m_responseLength;
+                    retries += c.sent - c.answered;
+                    c.state = CLIENT_IDLE;
+                }
+            }
+        }
+        if( now - progress > HOST_STALL_US) {
+            fprintf( stderr, "stalled with %u of %u pages loaded\n", (unsigned) latency.size(), (unsigned) pages);
+            exit( 1);
+        }
+    }
+    uint32_t elapsed = HW_getMicros() - t0;
+    for( uint16_t i = 0; i < 16; i++) {
+        s_server.slice();
+    }
+    for( uint8_t i = 0; i < clients; i++) {
+        s_clients[ i].state = CLIENT_IDLE;
+    }
+    std::sort( latency.begin(), latency.end());
+    printf( "%-10s %7u %9.1f %7.2f %7.2f %7.2f %7.0f %9.0f %7u %6u\n", s_pageModeNames[ mode], (unsigned) clients,
+        elapsed == 0 ? 0.0 : pages * 1000000.0 / elapsed,
+        latency[ latency.size() / 2] / 1000.0, latency[ (latency.size() * 99) / 100] / 1000.0, latency.back() / 1000.0,
+        (double) bytes / pages, elapsed == 0 ? 0.0 : bytes * 1000000.0 / 1024 / elapsed, (unsigned) retries, (unsigned) errors);
+}
+
+typedef struct {
+    uint32_t    consumed;
+    bool        complete;
+    uint16_t    error;
+    uint8_t     method;
+    bool        keepAlive;
+    uint32_t    contentLength;
+    bool        acceptGzip;
+    bool        etagMatch;
+    std::string ifNoneMatch;
+    std::string url;
+} ParseResult;
+
+/** \brief Parses a stream of requests in pieces of at most maxPiece bytes, random sizes if random is set.
+ */
+static bool parseStream( const std::string& stream, uint16_t urlSize, uint16_t maxPiece, bool random, std::vector<ParseResult>& out) {
+    bool rc = true;
+    char url[ 520];
+    HttpParser parser;
+    uint32_t pos = 0;
+    out.clear();
+    while( rc && pos < stream.size()) {
+        memset( url, 0x5A, sizeof( url));
+        parser.reset( url, urlSize);
+        uint32_t consumed = 0;
+        bool done = false;
+        while( rc && !done && pos < stream.size()) {
+            uint32_t piece = stream.size() - pos;
+            uint32_t limit = random ? 1 + rand() % maxPiece : maxPiece;
+            if( piece > limit) {
+                piece = limit;
+            }
+            uint16_t n = parser.parse( &stream[ pos], (uint16_t) piece);
+            done = parser.isComplete() || parser.getError() != 0;
+            if( n > piece || (n < piece && !done) || (parser.isComplete() && parser.getError() != 0)) {
+                rc = false;
+            }
+            pos += n;
+            consumed += n;
+        }
+        // Nothing past the url buffer, which always ends in a nul
+        for( uint16_t i = urlSize; rc && i < sizeof( url); i++) {
+            rc = url[ i] == 0x5A;
+        }
+        if( rc && parser.isComplete()) {
+            rc = memchr( url, '\0', urlSize) != NULL;
+        }
+        ParseResult r;
+        r.consumed = consumed;
+        r.complete = parser.isComplete();
+        r.error = parser.getError();
+        r.method = parser.getMethod();
+        r.keepAlive = parser.isKeepAlive();
+        r.contentLength = parser.getContentLength();
+        r.acceptGzip = parser.acceptsGzip();
+        r.etagMatch = parser.matchesEtag( "\"c909495b\"");
+        r.ifNoneMatch = parser.getIfNoneMatch();
+        if( r.ifNoneMatch.size() >= HTTP_PARSER_IF_NONE_MATCH) {
+            rc = false;
+        }
+        r.url = parser.isComplete() ? url : "";
+        out.push_back( r);
+        if( r.error != 0) {
+            break;
+        }
+    }
+    return rc;
+}
+
+static bool sameResults( const std::vector<ParseResult>& a, const std::vector<ParseResult>& b) {
+    bool rc = a.size() == b.size();
+    for( size_t i = 0; rc && i < a.size(); i++) {
+        rc = a[ i].consumed == b[ i].consumed && a[ i].complete == b[ i].complete && a[ i].error == b[ i].error &&
+            a[ i].method == b[ i].method && a[ i].keepAlive == b[ i].keepAlive && a[ i].contentLength == b[ i].contentLength &&
+            a[ i].acceptGzip == b[ i].acceptGzip && a[ i].etagMatch == b[ i].etagMatch && a[ i].ifNoneMatch == b[ i].ifNoneMatch &&
+            a[ i].url == b[ i].url;
+    }
+    return rc;
+}
+
+static const char* s_corpus[] = {
+    "GET / HTTP/1.1\r\nHost: a\r\n\r\n",
+    "GET /index.html HTTP/1.0\r\nConnection: keep-alive\r\n\r\n",
+    "GET /index.html HTTP/1.0\r\n\r\n",
+    "HEAD /app.js HTTP/1.1\r\nConnection: close\r\n\r\n",
+    "POST /exec/41 HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello",
+    "PUT /x HTTP/1.1\r\ncontent-length:  12 \r\n\r\nhello world!",
+    "GET /a HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 4\r\n\r\nabc",
+    "GET /a HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n",
+    "GET /a HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n0\r\n\r\n",
+    "\r\nGET /b HTTP/1.1\nHost: b\n\n",
+    "GET /c HTTP/2.0\r\n\r\n",
+    "GET /c HTTP/1.1 extra\r\n\r\n",
+    "BREW /pot HTTP/1.1\r\n\r\n",
+    "get /lower HTTP/1.1\r\n\r\n",
+    "GET /x HTTP/1.1\r\nX: a\r\n folded\r\n\r\n",
+    "GET /x HTTP/1.1\r\nBad Header: a\r\n\r\n",
+    "GET /x HTTP/1.1\r\nX-A-Very-Long-Header-Name-That-Is-Not-Looked-At: 1\r\nConnection: Keep-Alive, Upgrade, Something-Else-Too\r\n\r\n",
+    "GET /exec/2220726567697374657273222074797065 HTTP/1.1\r\nConnection: close\r\n\r\n",
+    "GET /index.html HTTP/1.1\r\nAccept-Encoding: br, GZip;q=1.0\r\nIf-None-Match: \"c909495b\"\r\n\r\n",
+    "GET /index.html HTTP/1.1\r\nIf-None-Match: W/\"a29ed637\" , W/\"c909495b\"\r\nIf-None-Match: *\r\n\r\n",
+    "GET /index.html HTTP/1.1\r\nAccept-Encoding: gzi, ggzip\r\nIf-None-Match: \"0123456789abcdef0123456789abcdef\", \"0123456789abcdef0123456789abcdef\"\r\n\r\n",
+    s_browserRequest,
+};
+#define HOST_CORPUS (sizeof( s_corpus) / sizeof( s_corpus[ 0]))
+
+static void mutate( std::string& s) {
+    uint8_t ops = (uint8_t) (rand() % 4);
+    for( uint8_t i = 0; i < ops && !s.empty(); i++) {
+        size_t at = rand() % s.size();
+        switch( rand() % 6) {
+            case 0: s[ at] = (char) (rand() % 256); break;
+            case 1: s.insert( at, 1, "\r\n :/ A0\t\x7F"[ rand() % 11]); break;
+            case 2: s.erase( at, 1 + rand() % 4); break;
+            case 3: s.resize( at); break;
+            case 4: s.insert( at, s.substr( at, rand() % 64)); break;
+            case 5: s.insert( at, std::string( rand() % 600, 'a' + rand() % 26)); break;
+        }
+    }
+}
+
+static int fuzz( uint32_t count) {
+    int rc = 0;
+    uint32_t requests = 0;
+    uint32_t errors = 0;
+    std::vector<ParseResult> whole;
+    std::vector<ParseResult> pieces;
+    srand( 1);
+    for( uint32_t i = 0; rc == 0 && i < count; i++) {
+        std::string stream;
+        uint8_t n = 1 + rand() % 4;
+        for( uint8_t j = 0; j < n; j++) {
+            stream += s_corpus[ rand() % HOST_CORPUS];
+        }
+        if( rand() % 4 != 0) {
+            mutate( stream);
+        }
+        if( stream.size() > 0xFFFF) {
+            stream.resize( 0xFFFF);
+        }
+        uint16_t urlSize = rand() % 4 == 0 ? (uint16_t) (1 + rand() % 32) : 512;
+        if( !parseStream( stream, urlSize, 0xFFFF, false, whole) || !parseStream( stream, urlSize, 1 + rand() % 64, true, pieces)
+                || !sameResults( whole, pieces)) {
+            fprintf( stderr, "fuzz failed at stream %u, url buffer %u:\n", (unsigned) i, (unsigned) urlSize);
+            fwrite( stream.data(), 1, stream.size(), stderr);
+            fprintf( stderr, "\n");
+            rc = 1;
+        }
+        for( size_t j = 0; j < whole.size(); j++) {
+            if( whole[ j].complete) {
+                requests++;
+            } else if( whole[ j].error != 0) {
+                errors++;
+            }
+        }
+    }
+    if( rc == 0) {
+        printf( "fuzz: %u streams, %u requests parsed, %u rejected\n", (unsigned) count, (unsigned) requests, (unsigned) errors);
+    }
+    return rc;
+}
+
+static void benchParser( void) {
+    char url[ 512];
+    HttpParser parser;
+    uint16_t len = (uint16_t) strlen( s_browserRequest);
+    uint32_t count = 200000;
+    uint32_t t0 = HW_getMicros();
+    for( uint32_t i = 0; i < count; i++) {
+        parser.reset( url, sizeof( url));
+        parser.parse( s_browserRequest, len);
+    }
+    uint32_t elapsed = HW_getMicros() - t0;
+    printf( "parse: %u byte browser request, %.0f requests/s, %.1f MB/s\n", (unsigned) len,
+        count * 1000000.0 / elapsed, (double) count * len / elapsed);
+
+    // One byte at a time, as a slow connection delivers it
+    t0 = HW_getMicros();
+    for( uint32_t i = 0; i < count / 10; i++) {
+        parser.reset( url, sizeof( url));
+        for( uint16_t j = 0; j < len; j++) {
+            parser.parse( &s_browserRequest[ j], 1);
+        }
+    }
+    elapsed = HW_getMicros() - t0;
+    printf( "parse: byte at a time, %.0f requests/s\n", count / 10 * 1000000.0 / elapsed);
+}
+
+int main( int argc, char** argv) {
+    uint32_t requests = 2000;
+    uint8_t clients = 0;
+    uint16_t lines = 20;
+    uint32_t handshake = 2000;
+    uint8_t depth = 4;
+    uint32_t pages = 200;
+    uint32_t rate = 1000;
+    uint32_t fuzzCount = 0;
+    const char* bundle = NULL;
+    bool bench = false;
+    int i;
+    for( i = 1; i < argc && argv[ i][ 0] == '-'; i++) {
+        if( !strcmp( argv[ i], "-n") && i + 1 < argc) {
+            requests = (uint32_t) atol( argv[ ++i]);
+        } else if( !strcmp( argv[ i], "-c") && i + 1 < argc) {
+            clients = (uint8_t) atoi( argv[ ++i]);
+        } else if( !strcmp( argv[ i], "-x") && i + 1 < argc) {
+            lines = (uint16_t) atoi( argv[ ++i]);
+        } else if( !strcmp( argv[ i], "-h") && i + 1 < argc) {
+            handshake = (uint32_t) atol( argv[ ++i]);
+        } else if( !strcmp( argv[ i], "-d") && i + 1 < argc) {
+            depth = (uint8_t) atoi( argv[ ++i]);
+        } else if( !strcmp( argv[ i], "-p") && i + 1 < argc) {
+            pages = (uint32_t) atol( argv[ ++i]);
+        } else if( !strcmp( argv[ i], "-r") && i + 1 < argc) {
+            rate = (uint32_t) atol( argv[ ++i]);
+        } else if( !strcmp( argv[ i], "-a") && i + 1 < argc) {
+            bundle = argv[ ++i];
+        } else if( !strcmp( argv[ i], "-f") && i + 1 < argc) {
+            fuzzCount = (uint32_t) atol( argv[ ++i]);
+        } else if( !strcmp( argv[ i], "-b")) {
+            bench = true;
+        } else {
+            break;
+        }
+    }
+    if( i != argc || requests == 0 || pages == 0 || clients > HOST_CLIENTS_MAX || depth == 0 || depth > HOST_PIPELINE_MAX) {
+        fprintf( stderr, "usage: httphost [-n requests] [-c clients] [-x lines] [-h us] [-d depth] [-p pages] [-r rate] [-a bundle] [-f count] [-b]\n");
+        return 2;
+    }
+    if( fuzzCount > 0) {
+        return fuzz( fuzzCount);
+    }
+    if( bench) {
+        benchParser();
+        return 0;
+    }
+    s_hostBytesPerMs = rate;
+    for( uint8_t j = 0; j < HOST_PAGE_FILES; j++) {
+        if( !loadFile( s_pageFiles[ j], s_fileData[ j])) {
+            fprintf( stderr, "can not read %s%s\n", HOST_DATA, s_pageFiles[ j]);
+            return 1;
+        }
+        LittleFS.add( s_pageFiles[ j], s_fileData[ j].data(), s_fileData[ j].size());
+        // Written by tools/webAssets, a file without one is sent as is
+        s_gzipPaths[ j] = std::string( s_pageFiles[ j]) + ".gz";
+        if( loadFile( s_gzipPaths[ j].c_str(), s_gzipData[ j])) {
+            LittleFS.add( s_gzipPaths[ j].c_str(), s_gzipData[ j].data(), s_gzipData[ j].size());
+        }
+    }
+    if( loadFile( "/assets.txt", s_manifest)) {
+        LittleFS.add( "/assets.txt", s_manifest.data(), s_manifest.size());
+    }
+    if( bundle != NULL) {
+        // Word aligned, as the mapped partition is
+        std::string image;
+        if( !loadFile( bundle, image, "")) {
+            fprintf( stderr, "can not read %s\n", bundle);
+            return 1;
+        }
+        s_bundle.resize( (image.size() + 3) / 4);
+        memcpy( s_bundle.data(), image.data(), image.size());
+        hostSetPartition( HTTP_BUNDLE_PARTITION, s_bundle.data(), (uint32_t) image.size());
+    }
+
+    HostExec exec( lines);
+    s_server.setYRShell( &exec);
+    s_server.init( 80);
+    // The first slice creates the listening socket
+    s_server.slice();
+    if( (!s_manifest.empty() && !checkAssets()) || !checkExecBusy( exec) || !checkHttp10( exec)) {
+        return 1;
+    }
+
+    printf( "slots %u, %u requests per run, /exec writes %u lines, handshake %u us, pipeline depth %u, link %u bytes/ms, files from %s\n",
+        (unsigned) HTTP_SERVER_CONNECTIONS, (unsigned) requests, (unsigned) lines, (unsigned) handshake, (unsigned) depth,
+        (unsigned) rate, bundle != NULL ? bundle : "LittleFS");
+    printf( "mode       clients     req/s  p50 us  p99 us  max us  conns retries errors   new\n");
+    for( uint8_t mode = MODE_CLOSE; mode <= MODE_PIPELINE; mode++) {
+        if( clients != 0) {
+            run( exec, mode, clients, requests, handshake, depth);
+        } else {
+            run( exec, mode, 1, requests, handshake, depth);
+            run( exec, mode, 4, requests, handshake, depth);
+            run( exec, mode, 16, requests, handshake, depth);
+        }
+    }
+    printf( "\nmode       clients   pages/s  p50 ms  p99 ms  max ms  B/page      KB/s retries errors\n");
+    for( uint8_t mode = PAGE_PLAIN; mode <= PAGE_REVALIDATE; mode++) {
+        if( clients != 0) {
+            runPages( exec, mode, clients, pages, handshake);
+        } else {
+            runPages( exec, mode, 1, pages, handshake);
+            runPages( exec, mode, 4, pages, handshake);
+        }
+    }
+    // A file is read only as far as the socket takes it
+    if( s_hostFsReread > 0) {
+        fprintf( stderr, "%u bytes of files were read again\n", (unsigned) s_hostFsReread);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+#ifndef LittleFS_h
+#define LittleFS_h
+
+// Host stand-in for LittleFS, the files are a table of buffers registered by the host program
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define HOST_FS_FILES 32
+
+inline uint32_t s_hostFsReread = 0; // bytes given up by a seek back, to be read again
+
+class File {
+protected:
+  const char* m_data;
+  size_t m_size;
+  size_t m_position;
+
+public:
+  File( ) { m_data = NULL; m_size = 0; m_position = 0; }
+  File( const char* data, size_t size) { m_data = data; m_size = size; m_position = 0; }
+  size_t readBytes( char* buf, size_t length) {
+    size_t rc = 0;
+    if( m_data != NULL) {
+      rc = m_size - m_position < length ? m_size - m_position : length;
+      memcpy( buf, &m_data[ m_position], rc);
+      m_position += rc;
+    }
+    return rc;
+  }
+  size_t size( ) { return m_size; }
+  size_t position( ) { return m_position; }
+  bool seek( uint32_t pos) {
+    bool rc = m_data != NULL && pos <= m_size;
+    if( rc) {
+      if( pos < m_position) {
+        s_hostFsReread += (uint32_t) (m_position - pos);
+      }
+      m_position = pos;
+    }
+    return rc;
+  }
+  void close( ) { m_data = NULL; }
+  operator bool( ) { return m_data != NULL; }
+};
+
+class HostFS {
+protected:
+  const char* m_path[ HOST_FS_FILES];
+  const char* m_data[ HOST_FS_FILES];
+  size_t m_size[ HOST_FS_FILES];
+  uint8_t m_count;
+
+public:
+  HostFS( ) { m_count = 0; }
+  bool add( const char* path, const char* data, size_t size) {
+    bool rc = false;
+    if( m_count < HOST_FS_FILES) {
+      m_path[ m_count] = path;
+      m_data[ m_count] = data;
+      m_size[ m_count] = size;
+      m_count++;
+      rc = true;
+    }
+    return rc;
+  }
+  File open( const char* path, const char* mode) {
+    File rc;
+    for( uint8_t i = 0; i < m_count; i++) {
+      if( !strcmp( path, m_path[ i])) {
+        rc = File( m_data[ i], m_size[ i]);
+        break;
+      }
+    }
+    return rc;
+  }
+};
+
+inline HostFS LittleFS;
+
+#endif
@@ -0,0 +1,340 @@
+#ifndef NetworkClient_h
+#define NetworkClient_h
+
+// Host stand-in for the Arduino NetworkClient, a connection in memory between the load generator and the server
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <core/HardwareSpecific.h>
+
+#define HOST_SOCKET_REQUEST 1024
+#define HOST_SOCKET_HEAD 64
+#define HOST_SOCKET_LINE 128
+#define HOST_SOCKET_ETAG 24
+#define HOST_SOCKET_SEND 5744 // TCP_SND_BUF of the ESP32 lwIP, 4 segments
+#define HOST_SOCKET_FDS 64
+
+class HostSocket;
+
+inline HostSocket* s_hostSockets[ HOST_SOCKET_FDS];
+inline int s_hostSocketCount = 0;
+inline uint32_t s_hostBytesPerMs = 1000; // rate each connection's send buffer drains to the client, 0 for no limit
+
+/** \brief Both ends of one connection. The load generator owns it, the server sees it through a NetworkClient.
+
+ The requests the load generator sends wait in m_request until the server reads them. What the server
+ writes waits in a send buffer of HOST_SOCKET_SEND bytes, which drains at s_hostBytesPerMs as time
+ passes. A write() that does not fit waits for it, like the blocking write of the ESP32 NetworkClient,
+ lwip_send() takes what fits. The response is not kept, it is followed as it drains far enough to count
+ the responses, each framed by Content-Length, chunked or by the close, and to keep the start of the
+ last one in m_head, its ETag in m_etag, the length of its body and whether it asked to retry. The load generator closes the connection by clearing m_open.
+ The server closes it with stop(), m_open is cleared once the send buffer has drained. The socket can be
+ opened again once the server has let go of it, m_accepted false.
+ */
+class HostSocket {
+protected:
+  typedef enum {
+    RESPONSE_STATUS,
+    RESPONSE_HEADER,
+    RESPONSE_BODY,
+    RESPONSE_CHUNK_SIZE,
+    RESPONSE_CHUNK_DATA,
+    RESPONSE_CHUNK_END,
+    RESPONSE_TRAILER,
+    RESPONSE_UNTIL_CLOSE,
+  } responseStates_t;
+
+  uint8_t m_responseState;
+  char m_line[ HOST_SOCKET_LINE];
+  uint16_t m_lineLength;
+  uint16_t m_headLength;
+  uint16_t m_status;
+  int32_t m_contentLength;
+  bool m_chunked;
+  uint32_t m_left;
+  char m_send[ HOST_SOCKET_SEND];
+  uint16_t m_sendHead;
+  uint16_t m_sendCount;
+  uint32_t m_lastDrain;
+  bool m_registered;
+
+  void endResponse( ) {
+    m_responses++;
+    if( m_status != 200 && m_status != 304) {
+      m_failed++;
+    }
+    m_lastStatus = m_status;
+    m_responseState = RESPONSE_STATUS;
+  }
+  void endLine( ) {
+    m_line[ m_lineLength] = '\0';
+    if( m_lineLength > 0 && m_line[ m_lineLength - 1] == '\r') {
+      m_line[ --m_lineLength] = '\0';
+    }
+    switch( m_responseState) {
+      case RESPONSE_STATUS:
+        m_etag[ 0] = '\0';
+        m_retryAfter = false;
+        m_bodyLength = 0;
+        m_status = !strncmp( m_line, "HTTP/1.", 7) && m_lineLength >= 12 ? (uint16_t) atoi( &m_line[ 9]) : 0;
+        m_contentLength = -1;
+        m_chunked = false;
+        m_responseState = RESPONSE_HEADER;
+      break;
+      case RESPONSE_HEADER:
+        if( m_lineLength == 0) {
+          if( m_status == 304) {
+            endResponse();
+          } else if( m_chunked) {
+            m_responseState = RESPONSE_CHUNK_SIZE;
+          } else if( m_contentLength == 0) {
+            endResponse();
+          } else if( m_contentLength > 0) {
+            m_left = (uint32_t) m_contentLength;
+            m_responseState = RESPONSE_BODY;
+          } else {
+            m_responseState = RESPONSE_UNTIL_CLOSE;
+          }
+        } else if( !strncasecmp( m_line, "Content-Length:", 15)) {
+          m_contentLength = atol( &m_line[ 15]);
+        } else if( !strncasecmp( m_line, "Transfer-Encoding:", 18) && strstr( m_line, "chunked") != NULL) {
+          m_chunked = true;
+        } else if( !strncasecmp( m_line, "Connection:", 11) && strstr( m_line, "close") != NULL) {
+          m_closing = true;
+        } else if( !strncasecmp( m_line, "Retry-After:", 12)) {
+          m_retryAfter = true;
+        } else if( !strncasecmp( m_line, "ETag:", 5)) {
+          const char* p = &m_line[ 5];
+          while( *p == ' ') {
+            p++;
+          }
+          strncpy( m_etag, p, sizeof( m_etag) - 1);
+          m_etag[ sizeof( m_etag) - 1] = '\0';
+        }
+      break;
+      case RESPONSE_CHUNK_SIZE:
+        m_left = (uint32_t) strtoul( m_line, NULL, 16);
+        m_responseState = m_left == 0 ? RESPONSE_TRAILER : RESPONSE_CHUNK_DATA;
+      break;
+      case RESPONSE_CHUNK_END:
+        m_responseState = m_lineLength == 0 ? RESPONSE_CHUNK_SIZE : RESPONSE_UNTIL_CLOSE;
+      break;
+      case RESPONSE_TRAILER:
+        if( m_lineLength == 0) {
+          endResponse();
+        }
+      break;
+    }
+    m_lineLength = 0;
+  }
+
+public:
+  char m_request[ HOST_SOCKET_REQUEST];
+  uint16_t m_requestLength;
+  uint16_t m_requestRead;
+  char m_head[ HOST_SOCKET_HEAD];
+  char m_etag[ HOST_SOCKET_ETAG];
+  uint32_t m_responseLength;
+  uint32_t m_bodyLength;    // of the last response, chunk framing left out
+  bool m_retryAfter;        // the last response had a Retry-After header
+  int m_fd;
+  uint16_t m_responses;
+  uint16_t m_lastStatus;
+  uint16_t m_failed;
+  bool m_closing;
+  bool m_open;
+  bool m_accepted;
+  bool m_serverClosed;
+
+  void open( ) {
+    if( !m_registered && s_hostSocketCount < HOST_SOCKET_FDS) {
+      m_fd = s_hostSocketCount;
+      s_hostSockets[ s_hostSocketCount++] = this;
+      m_registered = true;
+    }
+    m_requestLength = 0;
+    m_requestRead = 0;
+    m_head[ 0] = '\0';
+    m_etag[ 0] = '\0';
+    m_headLength = 0;
+    m_responseLength = 0;
+    m_bodyLength = 0;
+    m_retryAfter = false;
+    m_sendHead = 0;
+    m_sendCount = 0;
+    m_lastDrain = HW_getMicros();
+    m_responses = 0;
+    m_lastStatus = 0;
+    m_failed = 0;
+    m_closing = false;
+    m_responseState = RESPONSE_STATUS;
+    m_lineLength = 0;
+    m_open = true;
+    m_accepted = false;
+    m_serverClosed = false;
+  }
+  /** \brief The last response was sent in chunks.
+   */
+  bool isChunked( ) { return m_chunked; }
+  uint16_t sendSpace( ) { return sizeof( m_send) - m_sendCount; }
+  /** \brief Queues up to len bytes from the server in the send buffer, returns the number queued.
+   */
+  uint16_t queue( const uint8_t* p, size_t len) {
+    uint16_t rc = len < sendSpace() ? (uint16_t) len : sendSpace();
+    for( uint16_t i = 0; i < rc; i++) {
+      m_send[ (m_sendHead + m_sendCount + i) % sizeof( m_send)] = (char) p[ i];
+    }
+    m_sendCount += rc;
+    if( s_hostBytesPerMs == 0) {
+      poll();
+    }
+    return rc;
+  }
+  /** \brief Delivers what the link has sent since the last call, and the close after it.
+   */
+  void poll( ) {
+    uint32_t now = HW_getMicros();
+    uint32_t n = m_sendCount;
+    if( s_hostBytesPerMs != 0) {
+      uint64_t budget = (uint64_t) (now - m_lastDrain) * s_hostBytesPerMs / 1000;
+      if( budget < n) {
+        n = (uint32_t) budget;
+      }
+      if( n > 0 || m_sendCount == 0) {
+        m_lastDrain += (uint32_t) ((uint64_t) n * 1000 / s_hostBytesPerMs);
+        if( m_sendCount == 0) {
+          m_lastDrain = now;
+        }
+      }
+    }
+    while( n > 0) {
+      uint16_t run = (uint16_t) (sizeof( m_send) - m_sendHead);
+      if( run > n) {
+        run = (uint16_t) n;
+      }
+      received( (const uint8_t*) &m_send[ m_sendHead], run);
+      m_sendHead = (uint16_t) ((m_sendHead + run) % sizeof( m_send));
+      m_sendCount -= run;
+      n -= run;
+    }
+    if( m_serverClosed && m_sendCount == 0 && m_open) {
+      closed();
+    }
+  }
+  /** \brief Queues a request for the server, false if there is no room.
+   */
+  bool send( const char* request) {
+    bool rc = false;
+    uint16_t len = (uint16_t) strlen( request);
+    if( m_requestRead == m_requestLength) {
+      m_requestRead = 0;
+      m_requestLength = 0;
+    }
+    if( m_requestLength + len <= sizeof( m_request)) {
+      memcpy( &m_request[ m_requestLength], request, len);
+      m_requestLength += len;
+      rc = true;
+    }
+    return rc;
+  }
+  /** \brief Follows the bytes written by the server.
+   */
+  void received( const uint8_t* p, size_t len) {
+    m_responseLength += len;
+    size_t i = 0;
+    while( i < len) {
+      if( m_responseState == RESPONSE_STATUS && m_lineLength == 0) {
+        m_headLength = 0;
+      }
+      if( m_responseState == RESPONSE_BODY || m_responseState == RESPONSE_CHUNK_DATA) {
+        size_t n = len - i < m_left ? len - i : m_left;
+        i += n;
+        m_left -= (uint32_t) n;
+        m_bodyLength += (uint32_t) n;
+        if( m_left == 0) {
+          if( m_responseState == RESPONSE_BODY) {
+            endResponse();
+          } else {
+            m_responseState = RESPONSE_CHUNK_END;
+          }
+        }
+      } else if( m_responseState == RESPONSE_UNTIL_CLOSE) {
+        m_bodyLength += (uint32_t) (len - i);
+        i = len;
+      } else {
+        char c = (char) p[ i++];
+        if( m_headLength < sizeof( m_head) - 1) {
+          m_head[ m_headLength++] = c;
+          m_head[ m_headLength] = '\0';
+        }
+        if( c == '\n') {
+          endLine();
+        } else if( m_lineLength < sizeof( m_line) - 1) {
+          m_line[ m_lineLength++] = c;
+        }
+      }
+    }
+  }
+  /** \brief The server closed the connection, which ends a response without a length.
+   */
+  void closed( ) {
+    if( m_responseState == RESPONSE_UNTIL_CLOSE) {
+      endResponse();
+    }
+    m_open = false;
+  }
+};
+
+class NetworkClient {
+protected:
+  HostSocket* m_socket;
+
+public:
+  NetworkClient( ) { m_socket = NULL; }
+  NetworkClient( HostSocket* s) { m_socket = s; }
+  int read( uint8_t* buf, size_t size) {
+    int rc = -1;
+    if( m_socket != NULL && m_socket->m_open && m_socket->m_requestRead < m_socket->m_requestLength) {
+      rc = m_socket->m_requestLength - m_socket->m_requestRead;
+      if( (size_t) rc > size) {
+        rc = (int) size;
+      }
+      memcpy( buf, &m_socket->m_request[ m_socket->m_requestRead], rc);
+      m_socket->m_requestRead += rc;
+    }
+    return rc;
+  }
+  int available( ) {
+    return m_socket != NULL && m_socket->m_open ? m_socket->m_requestLength - m_socket->m_requestRead : 0;
+  }
+  int fd( ) const { return m_socket != NULL ? m_socket->m_fd : -1; }
+  size_t write( const uint8_t* buf, size_t size) {
+    size_t rc = 0;
+    while( m_socket != NULL && m_socket->m_open && rc < size) {
+      m_socket->poll();
+      rc += m_socket->queue( &buf[ rc], size - rc);
+    }
+    return rc;
+  }
+  size_t write( const char* buf, size_t size) { return write( (const uint8_t*) buf, size); }
+  void clear( ) {
+    if( m_socket != NULL) {
+      m_socket->m_requestRead = m_socket->m_requestLength;
+    }
+  }
+  void stop( ) {
+    if( m_socket != NULL) {
+      m_socket->m_serverClosed = true;
+      m_socket->poll();
+      m_socket->m_accepted = false;
+      m_socket = NULL;
+    }
+  }
+  uint8_t connected( ) { return m_socket != NULL && m_socket->m_open && !m_socket->m_serverClosed; }
+  operator bool( ) { return connected(); }
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef NetworkServer_h
+#define NetworkServer_h
+
+// Host stand-in for the Arduino NetworkServer, accept() takes the connections the load generator queued
+
+#include "NetworkClient.h"
+
+#define HOST_SERVER_BACKLOG 64
+
+class NetworkServer {
+protected:
+  static inline HostSocket* s_pending[ HOST_SERVER_BACKLOG];
+  static inline uint8_t s_head = 0;
+  static inline uint8_t s_count = 0;
+
+public:
+  NetworkServer( int port) { }
+  void begin( ) { }
+  bool hasClient( ) { return s_count > 0; }
+  NetworkClient accept( ) {
+    HostSocket* s = NULL;
+    if( s_count > 0) {
+      s = s_pending[ s_head];
+      s_head = (uint8_t) ((s_head + 1) % HOST_SERVER_BACKLOG);
+      s_count--;
+      s->m_accepted = true;
+    }
+    return NetworkClient( s);
+  }
+  /** \brief Queues a connection for accept(), false when the backlog is full.
+   */
+  static bool connect( HostSocket* s) {
+    bool rc = false;
+    if( s_count < HOST_SERVER_BACKLOG) {
+      s_pending[ (s_head + s_count) % HOST_SERVER_BACKLOG] = s;
+      s_count++;
+      rc = true;
+    }
+    return rc;
+  }
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef Wifi_h
+#define Wifi_h
+
+// Host stand-in for the Arduino WiFi library, always up in station mode
+
+#include "NetworkServer.h"
+
+#define WIFI_MODE_NULL 0
+#define WIFI_MODE_STA 1
+
+class HostWiFi {
+public:
+  int getMode( ) { return WIFI_MODE_STA; }
+};
+
+inline HostWiFi WiFi;
+
+typedef NetworkServer WiFiServer;
+typedef NetworkClient WiFiClient;
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef esp32_hal_log_h
+#define esp32_hal_log_h
+
+// Host stand-in for the Arduino core log helpers
+
+#define ARDUHAL_LOG_COLOR_E ""
+#define ARDUHAL_LOG_COLOR_W ""
+#define ARDUHAL_LOG_COLOR_I ""
+#define ARDUHAL_LOG_COLOR_D ""
+#define ARDUHAL_LOG_COLOR_V ""
+#define ARDUHAL_LOG_RESET_COLOR ""
+
+inline const char* pathToFileName( const char* path) { return path; }
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef esp_log_h
+#define esp_log_h
+
+// Host stand-in for the ESP-IDF log, logging compiles to nothing
+
+#define ESP_LOG_NONE 0
+#define ESP_LOG_ERROR 1
+#define ESP_LOG_WARN 2
+#define ESP_LOG_INFO 3
+#define ESP_LOG_DEBUG 4
+#define ESP_LOG_VERBOSE 5
+
+#define ESP_LOG_LEVEL_LOCAL( level, tag, format, ...) do { (void) (tag); } while( 0)
+
+#endif
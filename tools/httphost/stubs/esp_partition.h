@@ -0,0 +1,75 @@
+#ifndef esp_partition_h
+#define esp_partition_h
+
+// Host stand-in for the ESP-IDF partition API, one data partition held in memory by the host program
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef enum {
+  ESP_PARTITION_TYPE_APP  = 0x00,
+  ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+  ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef enum {
+  ESP_PARTITION_MMAP_DATA,
+  ESP_PARTITION_MMAP_INST,
+} esp_partition_mmap_memory_t;
+
+typedef uint32_t esp_partition_mmap_handle_t;
+
+typedef struct {
+  esp_partition_type_t type;
+  uint8_t subtype;
+  uint32_t address;
+  uint32_t size;
+  char label[ 17];
+  const uint8_t* data;
+} esp_partition_t;
+
+inline esp_partition_t s_hostPartition;
+inline int32_t s_hostPartitionMaps = 0; // mappings not yet unmapped
+
+/** \brief Makes data, size bytes, the partition called label, NULL data for none.
+ */
+inline void hostSetPartition( const char* label, const void* data, uint32_t size) {
+  memset( &s_hostPartition, 0, sizeof( s_hostPartition));
+  s_hostPartition.type = ESP_PARTITION_TYPE_DATA;
+  s_hostPartition.subtype = 0x40;
+  s_hostPartition.size = size;
+  strncpy( s_hostPartition.label, label, sizeof( s_hostPartition.label) - 1);
+  s_hostPartition.data = (const uint8_t*) data;
+}
+
+inline const esp_partition_t* esp_partition_find_first( esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label) {
+  bool found = s_hostPartition.data != NULL && type == s_hostPartition.type
+    && (subtype == ESP_PARTITION_SUBTYPE_ANY || subtype == s_hostPartition.subtype) && (label == NULL || !strcmp( label, s_hostPartition.label));
+  return found ? &s_hostPartition : NULL;
+}
+
+inline esp_err_t esp_partition_mmap( const esp_partition_t* partition, size_t offset, size_t size, esp_partition_mmap_memory_t memory,
+    const void** out_ptr, esp_partition_mmap_handle_t* out_handle) {
+  esp_err_t rc = ESP_FAIL;
+  if( partition != NULL && offset <= partition->size && size <= partition->size - offset) {
+    *out_ptr = &partition->data[ offset];
+    *out_handle = (esp_partition_mmap_handle_t) offset;
+    s_hostPartitionMaps++;
+    rc = ESP_OK;
+  }
+  return rc;
+}
+
+inline void esp_partition_munmap( esp_partition_mmap_handle_t handle) {
+  s_hostPartitionMaps--;
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef lwip_sockets_h
+#define lwip_sockets_h
+
+// Host stand-in for the lwIP socket calls, on the HostSocket a NetworkClient fd() refers to
+
+#include <sys/select.h>
+#include <sys/types.h>
+#include <errno.h>
+
+#include "../NetworkClient.h"
+
+#define TCP_MSS 1436
+#define TCP_SND_BUF HOST_SOCKET_SEND
+// As lwIP/opt.h has it, a socket is writable while more than this is free in its send buffer
+#define TCP_SNDLOWAT (TCP_SND_BUF / 2 > 2 * TCP_MSS + 1 ? TCP_SND_BUF / 2 : 2 * TCP_MSS + 1)
+
+#ifndef MSG_DONTWAIT
+#define MSG_DONTWAIT 0x08
+#endif
+
+inline HostSocket* hostSocket( int s) {
+  return s >= 0 && s < s_hostSocketCount ? s_hostSockets[ s] : NULL;
+}
+
+/** \brief Only writefds and a zero timeout. Writable while more than TCP_SNDLOWAT is free, like lwIP.
+ */
+inline int lwip_select( int maxfdp1, fd_set* readset, fd_set* writeset, fd_set* exceptset, struct timeval* timeout) {
+  int rc = 0;
+  for( int s = 0; writeset != NULL && s < maxfdp1; s++) {
+    if( FD_ISSET( s, writeset)) {
+      HostSocket* h = hostSocket( s);
+      if( h != NULL) {
+        h->poll();
+      }
+      if( h == NULL || !h->m_open || h->sendSpace() > TCP_SNDLOWAT) {
+        rc++;
+      } else {
+        FD_CLR( s, writeset);
+      }
+    }
+  }
+  return rc;
+}
+
+inline ssize_t lwip_send( int s, const void* dataptr, size_t size, int flags) {
+  ssize_t rc = -1;
+  HostSocket* h = hostSocket( s);
+  if( h == NULL || !h->m_open || h->m_serverClosed) {
+    errno = ENOTCONN;
+  } else {
+    h->poll();
+    rc = h->queue( (const uint8_t*) dataptr, size);
+    if( rc == 0 && size > 0) {
+      errno = EWOULDBLOCK;
+      rc = -1;
+    }
+  }
+  return rc;
+}
+
+#endif
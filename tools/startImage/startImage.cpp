@@ -0,0 +1,193 @@
+/*
+ Builds src/startImage.h from data/start.yr on the host.
+
+ The definitions in start.yr are compiled by the real interpreter, with the same dictionaries as the
+ firmware, and the resulting current dictionary is written out as an image for the extension compiled
+ slot, along with its name index. The other lines are collected into startImageCommands, which the
+ firmware runs after mapping the image. At boot the image is only used if the CRC of /start.yr and the
+ dictionary fingerprint still match, otherwise the file is interpreted as before.
+
+ usage: startImage <start.yr> <startImage.h>
+ */
+#include <YRShell.h>
+#include <YRShellEsp32Functions.h>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#define IMAGE_DICTIONARY_SIZE 8000
+
+static FunctionDictionary dictionaryExtensionFunction( yr8266ShellExtensionFunctions, YRSHELL_DICTIONARY_EXTENSION_FUNCTION );
+
+class ImageShell : public virtual YRShellBase<IMAGE_DICTIONARY_SIZE, 128, 128, 16, 16, 16, 8, 256, 512, 256, 512, 128> {
+protected:
+    virtual const char* mainFileName( ) { return "startImage.cpp"; }
+public:
+    virtual void init( void) {
+        YRShellBase::init();
+        m_dictionaryList[ YRSHELL_DICTIONARY_EXTENSION_FUNCTION_INDEX] = &dictionaryExtensionFunction;
+    }
+    CurrentVariableDictionary* getCurrentDictionary( void) { return m_DictionaryCurrent; }
+    /** \brief Runs one line, returns the output it produced.
+     */
+    std::string run( const std::string& line) {
+        std::string out;
+        std::string l = line + "\r";
+        const char* p = l.c_str();
+        do {
+            while( *p != '\0' && getInq().put( *p)) {
+                p++;
+            }
+            slice();
+            while( getOutq().valueAvailable()) {
+                out += getOutq().get();
+            }
+        } while( *p != '\0' || !isIdle() || getInq().valueAvailable());
+        return out;
+    }
+};
+
+static bool isBlank( const std::string& s) {
+    return s.find_first_not_of( " \t\r\n") == std::string::npos;
+}
+static std::vector<std::string> split( const std::string& s) {
+    std::vector<std::string> rc;
+    size_t b = 0;
+    while( (b = s.find_first_not_of( " \t", b)) != std::string::npos) {
+        size_t e = s.find_first_of( " \t", b);
+        rc.push_back( s.substr( b, e == std::string::npos ? std::string::npos : e - b));
+        b = e;
+    }
+    return rc;
+}
+static void writeWords( FILE* f, const char* type, const char* name, const uint16_t* data, uint16_t size, const char* format, bool ascii) {
+    fprintf( f, "static const %s %s[] = {\n", type, name);
+    for( uint16_t i = 0; i < size; i += 16) {
+        for( uint16_t j = i; j < i + 16 && j < size; j++) {
+            fprintf( f, format, data[ j]);
+        }
+        fprintf( f, "// 0x%04X", i);
+        if( ascii) {
+            fprintf( f, "  ");
+            for( uint16_t j = i; j < i + 16 && j < size; j++) {
+                for( uint8_t k = 0; k < 2; k++) {
+                    char c = (char) (k == 0 ? data[ j] & 0xFF : data[ j] >> 8);
+                    fputc( c < 0x20 || c > 0x7E ? '.' : c, f);
+                }
+            }
+        }
+        fprintf( f, "\n");
+    }
+    fprintf( f, "};\n");
+}
+
+int main( int argc, char** argv) {
+    if( argc != 3) {
+        fprintf( stderr, "usage: %s <start.yr> <startImage.h>\n", argv[ 0]);
+        return 2;
+    }
+    FILE* in = fopen( argv[ 1], "rb");
+    if( in == NULL) {
+        fprintf( stderr, "can't open %s\n", argv[ 1]);
+        return 1;
+    }
+    std::string text;
+    char buf[ 512];
+    size_t n;
+    while( (n = fread( buf, 1, sizeof( buf), in)) > 0) {
+        text.append( buf, n);
+    }
+    fclose( in);
+    uint32_t sourceCrc = Dictionary::crc32( 0, text.data(), (uint32_t) text.size());
+
+    std::vector<std::string> lines;
+    size_t b = 0;
+    while( b < text.size()) {
+        size_t e = text.find_first_of( "\r\n", b);
+        if( e == std::string::npos) {
+            e = text.size();
+        }
+        lines.push_back( text.substr( b, e - b));
+        b = e + 1;
+    }
+
+    ImageShell shell;
+    shell.init();
+    shell.setPromptEnable( false);
+    shell.setCommandEcho( false);
+    shell.run( "");
+
+    // Commands run after every definition at boot, so they must not use a word that is redefined later
+    std::string commands;
+    for( size_t i = 0; i < lines.size(); i++) {
+        std::vector<std::string> tokens = split( lines[ i]);
+        if( tokens.empty()) {
+            continue;
+        }
+        if( tokens[ 0] == ":") {
+            std::string out = shell.run( lines[ i]);
+            if( !isBlank( out)) {
+                fprintf( stderr, "%s:%u: %s\n", argv[ 1], (unsigned) i + 1, out.c_str() + out.find_first_not_of( " \t\r\n"));
+                return 1;
+            }
+        } else {
+            for( size_t j = i + 1; j < lines.size(); j++) {
+                std::vector<std::string> later = split( lines[ j]);
+                for( size_t k = 0; later.size() > 1 && later[ 0] == ":" && k < tokens.size(); k++) {
+                    if( tokens[ k] == later[ 1]) {
+                        fprintf( stderr, "%s:%u: %s is redefined on line %u\n", argv[ 1], (unsigned) i + 1, tokens[ k].c_str(), (unsigned) j + 1);
+                        return 1;
+                    }
+                }
+            }
+            for( size_t k = 0; k < lines[ i].size(); k++) {
+                if( lines[ i][ k] == '"' || lines[ i][ k] == '\\') {
+                    commands += '\\';
+                }
+                commands += lines[ i][ k];
+            }
+            commands += "\\r";
+        }
+    }
+
+    CurrentVariableDictionary* current = shell.getCurrentDictionary();
+    uint16_t size;
+    const uint16_t* code = current->getCode( &size);
+    uint16_t lastWord = current->getFirstEntry();
+    CompiledDictionary image( code, lastWord, size, YRSHELL_DICTIONARY_EXTENSION_COMPILED);
+    DictionaryIndex& index = image.getIndex();
+
+    FILE* out = fopen( argv[ 2], "w");
+    if( out == NULL) {
+        fprintf( stderr, "can't write %s\n", argv[ 2]);
+        return 1;
+    }
+    fprintf( out, "#ifndef StartImage_h\n#define StartImage_h\n\n");
+    fprintf( out, "// Generated by tools/startImage from data/start.yr, do not edit\n\n");
+    fprintf( out, "#include <stdint.h>\n\n");
+    fprintf( out, "static const uint32_t startImageSourceCrc = 0x%08X;\n", sourceCrc);
+    fprintf( out, "static const uint32_t startImageFingerprint = 0x%08X;\n", shell.getDictionaryFingerprint());
+    fprintf( out, "static const uint16_t startImageLastWord = 0x%04X;\n", lastWord);
+    fprintf( out, "static const uint16_t startImageSize = 0x%04X;\n", size);
+    fprintf( out, "static const uint16_t startImageIndexSlots = 0x%04X;\n", index.getSlots());
+    fprintf( out, "static const uint16_t startImageIndexCount = 0x%04X;\n\n", index.getCount());
+    writeWords( out, "uint16_t", "startImageData", code, size, "0x%04X , ", true);
+    fprintf( out, "\n");
+    writeWords( out, "uint16_t", "startImageIndexValues", index.getValues(), index.getSlots(), "0x%04X , ", false);
+    fprintf( out, "\n");
+    // Tags of empty slots are never read, zero them so the output only changes with the contents
+    std::vector<uint16_t> tags( index.getTags(), index.getTags() + index.getSlots());
+    for( uint16_t i = 0; i < index.getSlots(); i++) {
+        if( index.getValues()[ i] == YRSHELL_DICTIONARY_INVALID) {
+            tags[ i] = 0;
+        }
+    }
+    writeWords( out, "uint8_t", "startImageIndexTags", tags.data(), index.getSlots(), "0x%02X , ", false);
+    fprintf( out, "\nstatic const char startImageCommands[] = \"%s\";\n\n#endif\n", commands.c_str());
+    fclose( out);
+
+    fprintf( stderr, "%s: %u words, %u of %u index slots, source crc 0x%08X\n", argv[ 2], (unsigned) size,
+        (unsigned) index.getCount(), (unsigned) index.getSlots(), sourceCrc);
+    return 0;
+}
@@ -0,0 +1,343 @@
+/*
+ Packs the web assets in data/ for the HttpServer: gzip siblings and a manifest for LittleFS, and a bundle
+ image for the assets flash partition.
+
+ Every file under the data directory the server has a MIME type for is compressed at the highest level
+ into a file of the same name ending in .gz, kept only if it is at least a tenth smaller. The output does
+ not depend on the time or the host, so a file that did not change gives the same .gz. assets.txt in the
+ data directory lists each asset, sorted by path, with its size and CRC-32 and those of its .gz, 0 and 0
+ when there is none:
+
+   /index.html 5749 1a2b3c4d 1892 5e6f7a8b
+
+ The server sends the CRC of what it sends as the ETag and checks the sizes against the files on
+ LittleFS before it trusts the list.
+
+ Given a bundle file, the same assets and their .gz are also packed into one HttpAssetBundle image, read
+ back with the server's reader and compared with the files before it is written.
+
+ -t checks the packer and the reader against each other: bundles of made up files, found and not found by
+ path, and every damaged header or entry byte, truncation and misalignment rejected. Then it compresses
+ the files of the data directory and round trips a bundle of them in memory. It writes nothing.
+
+ usage: webAssets <data directory> [bundle]
+        webAssets -t <data directory>
+ */
+#include <HttpAssetBundle.h>
+
+#include <zlib.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+typedef struct {
+    std::string path;
+    std::string data;
+    std::string gzip;
+    uint32_t    crc;
+    uint32_t    gzipCrc;
+} Asset;
+
+static void findAssets( const std::string& root, const std::string& dir, std::vector<std::string>& out) {
+    DIR* d = opendir( (root + dir).c_str());
+    if( d != NULL) {
+        struct dirent* e;
+        while( (e = readdir( d)) != NULL) {
+            std::string path = dir + "/" + e->d_name;
+            struct stat st;
+            if( e->d_name[ 0] == '.' || stat( (root + path).c_str(), &st) != 0) {
+                continue;
+            }
+            if( S_ISDIR( st.st_mode)) {
+                findAssets( root, path, out);
+            } else if( S_ISREG( st.st_mode) && httpMimeType( path.c_str()) != NULL) {
+                out.push_back( path);
+            }
+        }
+        closedir( d);
+    }
+}
+
+static bool readFile( const std::string& name, std::string& data) {
+    bool rc = false;
+    FILE* f = fopen( name.c_str(), "rb");
+    if( f != NULL) {
+        char buf[ 4096];
+        size_t n;
+        data.clear();
+        while( (n = fread( buf, 1, sizeof( buf), f)) > 0) {
+            data.append( buf, n);
+        }
+        rc = !ferror( f);
+        fclose( f);
+    }
+    return rc;
+}
+
+static bool writeFile( const std::string& name, const std::string& data) {
+    bool rc = false;
+    FILE* f = fopen( name.c_str(), "wb");
+    if( f != NULL) {
+        rc = fwrite( data.data(), 1, data.size(), f) == data.size();
+        rc = fclose( f) == 0 && rc;
+    }
+    return rc;
+}
+
+/** \brief gzip with no name and no time in the header, so the output depends only on the input.
+ */
+static bool gzip( const std::string& in, std::string& out) {
+    bool rc = false;
+    z_stream z;
+    memset( &z, 0, sizeof( z));
+    if( deflateInit2( &z, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) == Z_OK) {
+        out.resize( deflateBound( &z, in.size()));
+        z.next_in = (Bytef*) in.data();
+        z.avail_in = (uInt) in.size();
+        z.next_out = (Bytef*) &out[ 0];
+        z.avail_out = (uInt) out.size();
+        rc = deflate( &z, Z_FINISH) == Z_STREAM_END;
+        out.resize( z.total_out);
+        deflateEnd( &z);
+    }
+    return rc;
+}
+
+static uint32_t crc( const std::string& data) {
+    return (uint32_t) crc32( crc32( 0, NULL, 0), (const Bytef*) data.data(), (uInt) data.size());
+}
+
+/** \brief Fills in the CRCs and the .gz of an asset whose path and data are set.
+ */
+static bool prepare( Asset& a) {
+    std::string packed;
+    bool rc = gzip( a.data, packed);
+    a.crc = crc( a.data);
+    a.gzip.clear();
+    a.gzipCrc = 0;
+    if( rc && packed.size() * 10 <= a.data.size() * 9) {
+        a.gzip = packed;
+        a.gzipCrc = crc( packed);
+    }
+    return rc;
+}
+
+static void align( std::string& s) {
+    while( s.size() % HTTP_BUNDLE_ALIGN != 0) {
+        s += '\0';
+    }
+}
+
+/** \brief The bundle image of assets sorted by path, empty if a path or a type does not fit an entry.
+ */
+static std::string pack( const std::vector<Asset>& assets) {
+    std::string rc;
+    HttpBundleHeader h;
+    std::vector<HttpBundleEntry> entries( assets.size());
+    std::string data;
+    bool fits = assets.size() <= 0xFFFF;
+    memset( &h, 0, sizeof( h));
+    h.magic = HTTP_BUNDLE_MAGIC;
+    h.version = HTTP_BUNDLE_VERSION;
+    h.count = (uint16_t) assets.size();
+    uint32_t start = sizeof( HttpBundleHeader) + assets.size() * sizeof( HttpBundleEntry);
+    for( size_t i = 0; fits && i < assets.size(); i++) {
+        const Asset& a = assets[ i];
+        HttpBundleEntry& e = entries[ i];
+        const char* type = httpMimeType( a.path.c_str());
+        memset( &e, 0, sizeof( e));
+        fits = a.path.size() < sizeof( e.path) && type != NULL && strlen( type) < sizeof( e.type);
+        if( fits) {
+            strcpy( e.path, a.path.c_str());
+            strcpy( e.type, type);
+            e.offset = start + data.size();
+            e.size = a.data.size();
+            e.crc = a.crc;
+            data += a.data;
+            align( data);
+            if( !a.gzip.empty()) {
+                e.flags |= HTTP_BUNDLE_GZIP;
+                e.gzipOffset = start + data.size();
+                e.gzipSize = a.gzip.size();
+                e.gzipCrc = a.gzipCrc;
+                data += a.gzip;
+                align( data);
+            }
+        }
+    }
+    if( fits) {
+        h.size = start + data.size();
+        rc.assign( (const char*) &h, sizeof( h));
+        if( !entries.empty()) {
+            rc.append( (const char*) entries.data(), entries.size() * sizeof( HttpBundleEntry));
+        }
+        rc += data;
+        h.crc = HttpAssetBundle::bundleCrc( rc.data(), h.size);
+        memcpy( &rc[ offsetof( HttpBundleHeader, crc)], &h.crc, sizeof( h.crc));
+    }
+    return rc;
+}
+
+/** \brief Reads the bundle back with the server's reader and compares it with the assets it was packed from.
+ */
+static bool check( const std::string& bundle, const std::vector<Asset>& assets, bool damage) {
+    // A copy in memory of its own, aligned the way the mapped partition is
+    std::vector<uint32_t> words( (bundle.size() + 3) / 4 + 1);
+    uint8_t* p = (uint8_t*) words.data();
+    memcpy( p, bundle.data(), bundle.size());
+    HttpAssetBundle b;
+    bool rc = b.map( p, bundle.size()) && b.getCount() == assets.size();
+    for( size_t i = 0; rc && i < assets.size(); i++) {
+        const Asset& a = assets[ i];
+        const HttpBundleEntry* e = b.find( a.path.c_str());
+        rc = e != NULL && e == b.getEntry( i) && !strcmp( e->type, httpMimeType( a.path.c_str())) && e->crc == a.crc
+            && e->size == a.data.size() && !memcmp( b.getData( e, false), a.data.data(), e->size)
+            && ((e->flags & HTTP_BUNDLE_GZIP) != 0) == !a.gzip.empty() && e->offset % HTTP_BUNDLE_ALIGN == 0;
+        if( rc && !a.gzip.empty()) {
+            rc = e->gzipSize == a.gzip.size() && e->gzipCrc == a.gzipCrc && e->gzipOffset % HTTP_BUNDLE_ALIGN == 0
+                && !memcmp( b.getData( e, true), a.gzip.data(), e->gzipSize);
+        }
+        // Near misses are not found
+        rc = rc && b.find( (a.path + "x").c_str()) == NULL && b.find( a.path.substr( 0, a.path.size() - 1).c_str()) == NULL;
+    }
+    rc = rc && b.find( "") == NULL && b.find( "/") == NULL && b.find( "~") == NULL;
+    if( rc && damage) {
+        // Every byte of the header and the entries, and some of the files, damaged in turn
+        uint32_t table = sizeof( HttpBundleHeader) + assets.size() * sizeof( HttpBundleEntry);
+        for( uint32_t i = 0; rc && i < bundle.size(); i += i < table ? 1 : 61) {
+            p[ i] ^= (uint8_t) (1 << (i % 8));
+            rc = !b.map( p, bundle.size());
+            p[ i] ^= (uint8_t) (1 << (i % 8));
+        }
+        rc = rc && !b.map( p, bundle.size() - 1) && !b.map( p, 0) && b.map( p, bundle.size() + 4);
+        memmove( p + 1, p, bundle.size());
+        rc = rc && !b.map( p + 1, bundle.size());
+    }
+    return rc;
+}
+
+/** \brief Round trips bundles of made up files, of random paths, sizes and contents.
+ */
+static bool selfTest( void) {
+    bool rc = true;
+    srand( 1);
+    const uint16_t counts[] = { 0, 1, 2, 3, 17, 300 };
+    for( size_t t = 0; rc && t < sizeof( counts) / sizeof( counts[ 0]); t++) {
+        std::vector<Asset> assets;
+        std::vector<std::string> paths;
+        static const char* suffixes[] = { ".html", ".css", ".js", ".ico", ".png" };
+        while( paths.size() < counts[ t]) {
+            std::string path = "/";
+            uint8_t len = 1 + rand() % 20;
+            for( uint8_t i = 0; i < len; i++) {
+                path += "abz/_-09"[ rand() % 8];
+            }
+            path += suffixes[ rand() % 5];
+            if( std::find( paths.begin(), paths.end(), path) == paths.end()) {
+                paths.push_back( path);
+            }
+        }
+        std::sort( paths.begin(), paths.end());
+        for( size_t i = 0; rc && i < paths.size(); i++) {
+            Asset a;
+            a.path = paths[ i];
+            uint32_t size = rand() % 3 == 0 ? rand() % 8 : rand() % 6000;
+            bool text = rand() % 2 == 0;
+            for( uint32_t j = 0; j < size; j++) {
+                a.data += text ? "<p>hello</p>\n"[ j % 13] : (char) rand();
+            }
+            rc = prepare( a);
+            assets.push_back( a);
+        }
+        std::string bundle = pack( assets);
+        rc = rc && !bundle.empty() && check( bundle, assets, counts[ t] < 100);
+        printf( "bundle of %3u files, %7u bytes: %s\n", (unsigned) counts[ t], (unsigned) bundle.size(), rc ? "ok" : "FAILED");
+    }
+    // Paths and types that do not fit an entry are not packed
+    Asset a;
+    a.path = "/" + std::string( HTTP_BUNDLE_PATH, 'a') + ".js";
+    a.data = "x";
+    std::vector<Asset> tooLong( 1, a);
+    rc = rc && prepare( tooLong[ 0]) && pack( tooLong).empty();
+    return rc;
+}
+
+int main( int argc, char** argv) {
+    bool test = argc > 1 && !strcmp( argv[ 1], "-t");
+    int first = test ? 2 : 1;
+    if( argc - first < 1 || argc - first > (test ? 1 : 2)) {
+        fprintf( stderr, "usage: webAssets <data directory> [bundle]\n       webAssets -t <data directory>\n");
+        return 2;
+    }
+    if( test && !selfTest()) {
+        return 1;
+    }
+    std::string root = argv[ first];
+    std::vector<std::string> paths;
+    findAssets( root, "", paths);
+    std::sort( paths.begin(), paths.end());
+
+    std::vector<Asset> assets;
+    uint32_t total = 0;
+    uint32_t sent = 0;
+    for( size_t i = 0; i < paths.size(); i++) {
+        Asset a;
+        a.path = paths[ i];
+        if( !readFile( root + paths[ i], a.data) || !prepare( a)) {
+            fprintf( stderr, "can not compress %s%s\n", root.c_str(), paths[ i].c_str());
+            return 1;
+        }
+        std::string gzName = root + paths[ i] + ".gz";
+        if( test) {
+            // Checked in memory, data/ is left as it is
+        } else if( !a.gzip.empty()) {
+            if( !writeFile( gzName, a.gzip)) {
+                fprintf( stderr, "can not write %s\n", gzName.c_str());
+                return 1;
+            }
+        } else {
+            remove( gzName.c_str());
+        }
+        total += a.data.size();
+        sent += a.gzip.empty() ? a.data.size() : a.gzip.size();
+        printf( "%-24s %7u %7u\n", a.path.c_str(), (unsigned) a.data.size(), (unsigned) a.gzip.size());
+        assets.push_back( a);
+    }
+
+    std::string manifest;
+    for( size_t i = 0; i < assets.size(); i++) {
+        char line[ 64];
+        snprintf( line, sizeof( line), " %u %08x %u %08x\n", (unsigned) assets[ i].data.size(), (unsigned) assets[ i].crc,
+            (unsigned) assets[ i].gzip.size(), (unsigned) assets[ i].gzipCrc);
+        manifest += assets[ i].path + line;
+    }
+    if( !test && !writeFile( root + "/assets.txt", manifest)) {
+        fprintf( stderr, "can not write %s/assets.txt\n", root.c_str());
+        return 1;
+    }
+    printf( "%u assets, %u bytes, %u with gzip\n", (unsigned) assets.size(), (unsigned) total, (unsigned) sent);
+
+    if( test || argc - first == 2) {
+        std::string bundle = pack( assets);
+        if( bundle.empty() || !check( bundle, assets, test)) {
+            fprintf( stderr, "can not pack the bundle, a path longer than %u characters?\n", (unsigned) HTTP_BUNDLE_PATH - 1);
+            return 1;
+        }
+        if( test) {
+            printf( "bundle of the data directory, %u bytes: ok\n", (unsigned) bundle.size());
+        } else if( !writeFile( argv[ first + 1], bundle)) {
+            fprintf( stderr, "can not write %s\n", argv[ first + 1]);
+            return 1;
+        } else {
+            printf( "bundle %s, %u bytes\n", argv[ first + 1], (unsigned) bundle.size());
+        }
+    }
+    return 0;
+}
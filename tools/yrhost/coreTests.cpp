@@ -0,0 +1,1172 @@
+/*
+ Tests and benchmarks of the YRShell core on a Linux or macOS host, with the same sources as the firmware.
+
+ Each entry of s_tests has a test, which returns false after printing what went wrong, and a benchmark,
+ which prints its rates. The tests run from "make check", the benchmarks from "make bench".
+
+ usage: coreTests [-b] [name...]
+   -b      run the benchmarks instead of the tests
+   name    run only the named entries
+ */
+#include <YRShell.h>
+#include <core/CircularQ.h>
+#include <core/DeferredLog.h>
+#include <core/Dictionary.h>
+#include <core/HardwareSpecific.h>
+#include <core/LogRing.h>
+#include <core/Sliceable.h>
+#include <core/TimerService.h>
+
+// The core is built without YRSHELL_TRACE, as for the firmware, the trace ring is compiled in here
+#define YRSHELL_TRACE
+#include <core/Trace.h>
+#include <core/Trace.cpp>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+static bool check( bool ok, const char* name, const char* what) {
+    if( !ok) {
+        fprintf( stderr, "%s: %s\n", name, what);
+    }
+    return ok;
+}
+static double rate( uint64_t n, uint32_t us) {
+    return n / (double) (us > 0 ? us : 1);
+}
+
+/*
+ CircularQSpsc: a writer and a reader on two threads, with put / get and with the bulk calls in runs that
+ cross the wrap point. Every value has to come out once and in order. A side that can't move yields, the
+ host may have a single core.
+ */
+template<class Q>
+static bool spscOrder( Q& q, uint32_t count, bool bulk) {
+    bool rc = true;
+    std::thread writer( [ &q, count, bulk]( ) {
+        uint32_t buf[ 37];
+        for( uint32_t v = 0; v < count; ) {
+            if( bulk) {
+                uint32_t n = 1 + v % 37;
+                n = n < count - v ? n : count - v;
+                for( uint32_t i = 0; i < n; i++) {
+                    buf[ i] = v + i;
+                }
+                uint32_t put = q.putN( buf, n);
+                v += put;
+                if( put == 0) {
+                    std::this_thread::yield();
+                }
+            } else if( q.put( v)) {
+                v++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint32_t buf[ 29];
+    for( uint32_t v = 0; rc && v < count; ) {
+        if( bulk) {
+            uint32_t n = q.getN( buf, 1 + v % 29);
+            for( uint32_t i = 0; rc && i < n; i++) {
+                rc = buf[ i] == v + i;
+            }
+            v += n;
+            if( n == 0) {
+                std::this_thread::yield();
+            }
+        } else if( q.valueAvailable()) {
+            rc = q.get() == v++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    writer.join();
+    return rc && !q.valueAvailable() && q.used() == 0;
+}
+static bool testSpsc( void) {
+    static CircularQSpsc<uint32_t, 1024> q;
+    static CircularQSpsc<uint8_t, 0x20000> big;
+    bool rc = check( spscOrder( q, 2000000, false), "spsc", "put / get out of order");
+    rc = check( spscOrder( q, 2000000, true), "spsc", "putN / getN out of order") && rc;
+    // Queues larger than 64K values
+    for( uint32_t i = 0; i < big.size(); i++) {
+        big.put( (uint8_t) (i * 7));
+    }
+    rc = check( big.used() == 0x20000 && !big.spaceAvailable() && !big.put( 0), "spsc", "a full 128K queue accepts more") && rc;
+    bool same = true;
+    for( uint32_t i = 0; i < 0x20000; i++) {
+        same = same && big.get() == (uint8_t) (i * 7);
+    }
+    rc = check( same && big.used() == 0, "spsc", "128K queue content") && rc;
+    return rc;
+}
+template<class Q>
+static uint32_t spscTransfer( Q& q, uint32_t count) {
+    uint32_t start = HW_getMicros();
+    std::thread writer( [ &q, count]( ) {
+        for( uint32_t v = 0; v < count; ) {
+            if( q.put( (char) v)) {
+                v++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for( uint32_t v = 0; v < count; ) {
+        if( q.valueAvailable()) {
+            q.get();
+            v++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    writer.join();
+    return HW_getMicros() - start;
+}
+static void benchSpsc( void) {
+    static const uint32_t s_count = 20000000;
+    static CircularQ<char, 1024> q;
+    static CircularQSpsc<char, 1024> spsc;
+    uint32_t plain = spscTransfer( q, s_count);
+    uint32_t lockFree = spscTransfer( spsc, s_count);
+    printf( "spsc:    %u chars between two threads, CircularQ %.1f Mchars/s, CircularQSpsc %.1f Mchars/s\n", s_count,
+        rate( s_count, plain), rate( s_count, lockFree));
+}
+
+/*
+ Bulk transfer: putN, getN, peekN and reserve / commit on both queue classes, at every offset of the wrap
+ point, then bytes per second moved a char at a time against in runs.
+ */
+static bool bulkWrap( CircularQBase<char>& q) {
+    bool rc = true;
+    char in[ 64], out[ 64];
+    for( uint32_t i = 0; i < sizeof( in); i++) {
+        in[ i] = (char) ('A' + i % 26);
+    }
+    for( uint32_t at = 0; rc && at < q.size(); at++) {
+        q.reset();
+        for( uint32_t i = 0; i < at; i++) {
+            q.put( 'x');
+            q.get();
+        }
+        uint32_t n = q.putN( in, 20);
+        rc = n == 20 && q.used() == 20 && q.peekN( out, 64) == 20 && !memcmp( in, out, 20);
+        memset( out, 0, sizeof( out));
+        rc = rc && q.getN( out, 7) == 7 && !memcmp( in, out, 7) && q.getN( out + 7, 64) == 13 && !memcmp( in, out, 20);
+        // A reserve can be shorter than asked for at the wrap point, the rest goes in a second one
+        uint32_t len = 12;
+        char* p = q.reserve( len);
+        rc = rc && len > 0 && len <= 12;
+        memcpy( p, in, len);
+        q.commit( len);
+        uint32_t rest = 12 - len;
+        p = q.reserve( rest);
+        rc = rc && rest == 12 - len;
+        memcpy( p, in + len, rest);
+        q.commit( rest);
+        rc = rc && q.getN( out, 64) == 12 && !memcmp( in, out, 12) && q.used() == 0;
+    }
+    return rc;
+}
+static bool testBulk( void) {
+    static CircularQ<char, 32> q;
+    static CircularQSpsc<char, 32> spsc;
+    bool rc = check( bulkWrap( q), "bulk", "CircularQ runs across the wrap point");
+    rc = check( bulkWrap( spsc), "bulk", "CircularQSpsc runs across the wrap point") && rc;
+    char buf[ 40];
+    memset( buf, 'y', sizeof( buf));
+    rc = check( q.putN( buf, 40) == 31 && q.putN( buf, 1) == 0, "bulk", "CircularQ putN past full") && rc;
+    rc = check( spsc.putN( buf, 40) == 32 && spsc.putN( buf, 1) == 0, "bulk", "CircularQSpsc putN past full") && rc;
+    return rc;
+}
+static uint32_t bulkTransfer( CircularQBase<char>& q, uint32_t bytes, uint32_t run) {
+    char in[ 256], out[ 256];
+    memset( in, 'z', sizeof( in));
+    uint32_t start = HW_getMicros();
+    for( uint32_t moved = 0; moved < bytes; ) {
+        if( run == 1) {
+            while( q.put( 'z')) {
+            }
+            while( q.valueAvailable()) {
+                out[ 0] = q.get();
+                moved++;
+            }
+        } else {
+            while( q.putN( in, run) > 0) {
+            }
+            uint32_t n;
+            while( (n = q.getN( out, run)) > 0) {
+                moved += n;
+            }
+        }
+    }
+    return HW_getMicros() - start;
+}
+static void benchBulk( void) {
+    static const uint32_t s_bytes = 50000000;
+    static CircularQ<char, 1024> q;
+    static CircularQSpsc<char, 1024> spsc;
+    CircularQBase<char>* queues[] = { &q, &spsc };
+    const char* names[] = { "CircularQ", "CircularQSpsc" };
+    for( uint8_t i = 0; i < 2; i++) {
+        uint32_t one = bulkTransfer( *queues[ i], s_bytes, 1);
+        uint32_t run32 = bulkTransfer( *queues[ i], s_bytes, 32);
+        uint32_t run256 = bulkTransfer( *queues[ i], s_bytes, 256);
+        printf( "bulk:    %-13s put / get %.0f MB/s, 32 byte runs %.0f MB/s, 256 byte runs %.0f MB/s\n", names[ i],
+            rate( s_bytes, one), rate( s_bytes, run32), rate( s_bytes, run256));
+    }
+}
+
+/*
+ LogRing: several writer threads and a reader on a small ring, so records are evicted all the time. A record
+ holds its writer, its sequence number and bytes derived from both, the reader checks every byte and that the
+ records of a writer come out in order. Every record written is read or counted as dropped.
+ */
+#define LOG_WRITERS 4
+#define LOG_HEADER 5
+
+typedef struct {
+    uint64_t written;
+    uint64_t read;
+    uint64_t torn;
+    uint64_t reordered;
+    uint32_t dropped;
+    uint32_t us;
+} LogHammer;
+
+static void logHammer( uint32_t perWriter, LogHammer& r) {
+    static LogRing<2048> ring;
+    std::atomic<uint32_t> running( LOG_WRITERS);
+    std::vector<std::thread> writers;
+    ring.reset();
+    memset( &r, 0, sizeof( r));
+    uint32_t start = HW_getMicros();
+    for( uint8_t w = 0; w < LOG_WRITERS; w++) {
+        writers.emplace_back( [ w, perWriter, &running]( ) {
+            char b[ 160];
+            for( uint32_t seq = 0; seq < perWriter; seq++) {
+                uint32_t len = LOG_HEADER + (seq * 7 + w) % 150;
+                b[ 0] = (char) w;
+                memcpy( &b[ 1], &seq, 4);
+                for( uint32_t k = LOG_HEADER; k < len; k++) {
+                    b[ k] = (char) (w * 31 + seq + k);
+                }
+                ring.write( b, len);
+                if( seq % 8 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            running--;
+        });
+    }
+    int64_t last[ LOG_WRITERS];
+    for( uint8_t w = 0; w < LOG_WRITERS; w++) {
+        last[ w] = -1;
+    }
+    char b[ 160];
+    while( running > 0 || !ring.empty()) {
+        uint32_t len = ring.read( b, sizeof( b));
+        if( len == 0) {
+            std::this_thread::yield();
+        } else if( len < LOG_HEADER || (uint8_t) b[ 0] >= LOG_WRITERS) {
+            r.torn++;
+        } else {
+            uint8_t w = (uint8_t) b[ 0];
+            uint32_t seq;
+            memcpy( &seq, &b[ 1], 4);
+            bool same = len == LOG_HEADER + (seq * 7 + w) % 150;
+            for( uint32_t k = LOG_HEADER; same && k < len; k++) {
+                same = b[ k] == (char) (w * 31 + seq + k);
+            }
+            r.torn += same ? 0 : 1;
+            r.reordered += (int64_t) seq > last[ w] ? 0 : 1;
+            last[ w] = seq;
+            r.read++;
+        }
+    }
+    for( std::thread& t : writers) {
+        t.join();
+    }
+    r.us = HW_getMicros() - start;
+    r.written = (uint64_t) perWriter * LOG_WRITERS;
+    r.dropped = ring.getDropped();
+}
+static bool testLogRing( void) {
+    LogHammer r;
+    logHammer( 200000, r);
+    bool rc = check( r.torn == 0, "logRing", "torn record");
+    rc = check( r.reordered == 0, "logRing", "records of a writer out of order") && rc;
+    rc = check( r.read > 0 && r.read + r.dropped == r.written, "logRing", "records neither read nor dropped") && rc;
+    return rc;
+}
+static void benchLogRing( void) {
+    LogHammer r;
+    logHammer( 1000000, r);
+    printf( "logRing: %u writers, %.2f Mrecords/s written, %.2f Mrecords/s read, %.1f%% dropped\n", LOG_WRITERS,
+        rate( r.written, r.us), rate( r.read, r.us), 100.0 * r.dropped / r.written);
+}
+
+/*
+ DeferredLog: a record formatted when it is drained has to read like vsnprintf of the same call. The
+ benchmark compares the cost of a log call, encode() into a LogRing against vsnprintf into it as
+ custom_log_handler() did, and the cost of formatting a record when it is drained.
+ */
+#define LOG_FORMAT "%c (%lu) %s: [%s:%u] %s(): value %d\n"
+#define LOG_ARGS 'I', 123456ul, "Main   ", "main.cpp", 42u, "loop"
+
+static uint32_t deferredEncode( uint8_t* rec, uint32_t max, const char* fmt, ...) {
+    va_list args;
+    va_start( args, fmt);
+    uint32_t rc = DeferredLog::encode( rec, max, fmt, args);
+    va_end( args);
+    return rc;
+}
+static int deferredPrintf( char* out, uint32_t max, const char* fmt, ...) {
+    va_list args;
+    va_start( args, fmt);
+    int rc = vsnprintf( out, max, fmt, args);
+    va_end( args);
+    return rc;
+}
+static bool deferredSame( const char* fmt, ...) {
+    uint8_t rec[ 128];
+    char text[ 128], expect[ 128];
+    va_list args, copy;
+    va_start( args, fmt);
+    va_copy( copy, args);
+    uint32_t len = DeferredLog::encode( rec, sizeof( rec), fmt, args);
+    vsnprintf( expect, sizeof( expect), fmt, copy);
+    va_end( copy);
+    va_end( args);
+    bool rc = len > 0 && DeferredLog::isDeferred( rec, len);
+    if( rc) {
+        DeferredLog::format( text, sizeof( text), rec, len);
+        rc = !strcmp( text, expect);
+    }
+    if( !rc) {
+        fprintf( stderr, "deferredLog: \"%s\" gives \"%s\", not \"%s\"\n", fmt, rc ? text : "", expect);
+    }
+    return rc;
+}
+static bool testDeferredLog( void) {
+    char buf[ 20];
+    strcpy( buf, "stack");
+    bool rc = deferredSame( LOG_FORMAT, LOG_ARGS, -7);
+    rc = deferredSame( "%*d|%-*.*s|%lld|%zu|%5.2f|%x%%", 6, 42, 8, 3, buf, -5ll, (size_t) 99, 3.14159, 0xbeef) && rc;
+    rc = deferredSame( "no arguments") && rc;
+    // The copied string outlives the buffer it came from
+    uint8_t rec[ 128];
+    char text[ 128];
+    uint32_t len = deferredEncode( rec, sizeof( rec), "[%s]", buf);
+    strcpy( buf, "reused");
+    DeferredLog::format( text, sizeof( text), rec, len);
+    rc = check( !strcmp( text, "[stack]"), "deferredLog", "%s not copied into the record") && rc;
+    rc = check( deferredEncode( rec, 8, LOG_FORMAT, LOG_ARGS, 1) == 0, "deferredLog", "a call larger than the record encoded") && rc;
+    return rc;
+}
+static void benchDeferredLog( void) {
+    static const uint32_t s_calls = 1000000;
+    static LogRing<8192> ring;
+    uint8_t rec[ 128];
+    char text[ 128];
+    uint32_t start = HW_getMicros();
+    for( uint32_t i = 0; i < s_calls; i++) {
+        uint32_t len = deferredEncode( rec, sizeof( rec), LOG_FORMAT, LOG_ARGS, (int) i);
+        ring.write( (const char*) rec, len);
+        ring.read( (char*) rec, sizeof( rec));
+    }
+    uint32_t deferred = HW_getMicros() - start;
+    start = HW_getMicros();
+    for( uint32_t i = 0; i < s_calls; i++) {
+        int len = deferredPrintf( text, sizeof( text), LOG_FORMAT, LOG_ARGS, (int) i);
+        ring.write( text, len);
+        ring.read( text, sizeof( text));
+    }
+    uint32_t printed = HW_getMicros() - start;
+    uint32_t len = deferredEncode( rec, sizeof( rec), LOG_FORMAT, LOG_ARGS, 7);
+    start = HW_getMicros();
+    for( uint32_t i = 0; i < s_calls; i++) {
+        DeferredLog::format( text, sizeof( text), rec, len);
+    }
+    uint32_t drained = HW_getMicros() - start;
+    printf( "deferredLog: log call with encode %.0f ns, with vsnprintf %.0f ns, format when drained %.0f ns\n",
+        1000.0 * deferred / s_calls, 1000.0 * printed / s_calls, 1000.0 * drained / s_calls);
+}
+
+/*
+ Trace: the Chrome trace-event JSON of a known set of events, exported through buffers of several sizes,
+ the threshold and enable switches, then an export while another thread records, which has to stay well
+ formed. The benchmark reports the cost of a span enabled and disabled at run time.
+ */
+static std::string traceExport( uint32_t size) {
+    std::string rc = "{\"traceEvents\":[";
+    char buf[ 512];
+    uint32_t cursor = Trace::first();
+    uint32_t end = Trace::last();
+    bool firstEvent = true;
+    while( cursor != end) {
+        rc.append( buf, Trace::json( buf, size, cursor, end, firstEvent));
+    }
+    return rc + "]}";
+}
+// Returns the number of events, -1 if the JSON is not a list of flat objects
+static int32_t traceEvents( const std::string& json) {
+    static const std::string s_begin = "{\"traceEvents\":[";
+    int32_t rc = -1;
+    if( json.compare( 0, s_begin.size(), s_begin) == 0 && json.size() >= s_begin.size() + 2 && json.compare( json.size() - 2, 2, "]}") == 0) {
+        size_t at = s_begin.size();
+        size_t end = json.size() - 2;
+        rc = 0;
+        while( rc >= 0 && at < end) {
+            size_t close = json.find( '}', at);
+            if( (rc > 0 && json[ at++] != ',') || json.compare( at, 9, "{\"name\":\"") != 0 || close == std::string::npos || close >= end
+                    || json.find( '{', at + 1) < close) {
+                rc = -1;
+            } else {
+                rc++;
+                at = close + 1;
+            }
+        }
+    }
+    return rc;
+}
+static bool testTrace( void) {
+    char expect[ 128];
+    std::string events;
+    Trace::enable( true);
+    Trace::setThreshold( 0);
+    Trace::clear();
+    // One and a half rings, only the newest TRACE_EVENTS are exported
+    for( uint32_t i = 0; i < TRACE_EVENTS * 3 / 2; i++) {
+        Trace::complete( "traceTest", 1000 * i, i % 7);
+        if( i >= TRACE_EVENTS / 2) {
+            snprintf( expect, sizeof( expect), "%s{\"name\":\"traceTest\",\"ph\":\"X\",\"ts\":%u,\"dur\":%u,\"pid\":0,\"tid\":%u}",
+                events.empty() ? "" : ",", (unsigned) (1000 * i), (unsigned) (i % 7), (unsigned) HW_getCore());
+            events += expect;
+        }
+    }
+    events = "{\"traceEvents\":[" + events + "]}";
+    bool rc = true;
+    for( uint32_t size : { 90, 100, 129, 512 }) {
+        rc = check( traceExport( size) == events, "trace", "export differs from the events recorded") && rc;
+    }
+    Trace::clear();
+    rc = check( traceExport( 512) == "{\"traceEvents\":[]}", "trace", "events left after clear") && rc;
+    Trace::setThreshold( 3);
+    for( uint32_t i = 0; i < 10; i++) {
+        Trace::complete( "traceTest", i, i);
+    }
+    Trace::setThreshold( 0);
+    rc = check( traceEvents( traceExport( 512)) == 7, "trace", "spans below the threshold recorded") && rc;
+    Trace::instant( "traceInstant");
+    std::string json = traceExport( 512);
+    rc = check( traceEvents( json) == 8 && json.find( "{\"name\":\"traceInstant\",\"ph\":\"i\",\"s\":\"t\"") != std::string::npos,
+        "trace", "instant event") && rc;
+    uint32_t last = Trace::last();
+    Trace::enable( false);
+    {
+        TRACE_SCOPE( "traceTest");
+        TRACE_INSTANT( "traceTest");
+    }
+    Trace::enable( true);
+    rc = check( Trace::last() == last, "trace", "events recorded while disabled") && rc;
+    // Events overwritten while an export runs are skipped, the JSON stays well formed
+    std::atomic<bool> done( false);
+    std::thread writer( [ &done]( ) {
+        for( uint32_t i = 0; i < 200000; i++) {
+            TRACE_SCOPE( "traceWriter");
+        }
+        done = true;
+    });
+    while( rc && !done) {
+        rc = check( traceEvents( traceExport( 100)) >= 0, "trace", "export during recording is not well formed");
+    }
+    writer.join();
+    return rc;
+}
+static void benchTrace( void) {
+    static const uint32_t s_spans = 10000000;
+    uint32_t start = HW_getMicros();
+    for( uint32_t i = 0; i < s_spans; i++) {
+        TRACE_SCOPE( "traceBench");
+    }
+    uint32_t enabled = HW_getMicros() - start;
+    Trace::enable( false);
+    start = HW_getMicros();
+    for( uint32_t i = 0; i < s_spans; i++) {
+        TRACE_SCOPE( "traceBench");
+    }
+    uint32_t disabled = HW_getMicros() - start;
+    Trace::enable( true);
+    std::string json;
+    start = HW_getMicros();
+    for( uint32_t i = 0; i < 100; i++) {
+        json = traceExport( 512);
+    }
+    uint32_t exported = HW_getMicros() - start;
+    printf( "trace:   span %.1f ns, disabled at run time %.1f ns, export %.1f MB/s\n", 1000.0 * enabled / s_spans,
+        1000.0 * disabled / s_spans, rate( 100 * json.size(), exported));
+}
+
+/*
+ TimerService in virtual time: timers of every wheel level and beyond its range, one shot and periodic,
+ some stopped, with the clock starting at 0 and just before it wraps. Each expiry has to come on its
+ millisecond. Sliceables are never unlinked, so the services and the notified object are static.
+ */
+typedef struct {
+    ServiceTimer timer;
+    TimerService* service;
+    uint32_t due;
+    uint32_t period;
+    uint32_t fired;
+    bool late;
+} TimerRecord;
+
+static uint32_t s_random = 1;
+
+static uint32_t nextRandom( void) {
+    s_random ^= s_random << 13;
+    s_random ^= s_random >> 17;
+    s_random ^= s_random << 5;
+    return s_random;
+}
+static void timerExpired( void* arg) {
+    TimerRecord* r = (TimerRecord*) arg;
+    // The service has moved past the millisecond that expired
+    r->late = r->late || r->service->getNow() - 1 != r->due;
+    r->fired++;
+    r->due += r->period;
+}
+static bool timerWheel( TimerService& service, uint32_t start) {
+    static const uint32_t s_timers = 3000;
+    static const uint32_t s_range = TIMER_WHEEL_RANGE + 1000000;
+    std::vector<TimerRecord> timers( s_timers);
+    s_random = start | 1;
+    for( TimerRecord& r : timers) {
+        uint32_t k = nextRandom() % 4;
+        uint32_t delay = nextRandom() % (k == 0 ? 64 : k == 1 ? 5000 : k == 2 ? 400000 : s_range - 100000);
+        r.service = &service;
+        r.period = nextRandom() % 3 == 0 ? 1 + nextRandom() % 3000 : 0;
+        r.due = start + delay;
+        r.fired = 0;
+        r.late = false;
+        r.timer.setCallback( timerExpired, &r);
+        r.timer.start( delay, r.period, &service);
+    }
+    for( uint32_t i = 0; i < s_timers; i += 7) {
+        timers[ i].timer.stop();
+    }
+    bool rc = service.getCount() == s_timers - (s_timers + 6) / 7;
+    for( uint32_t t = 0; t < s_range; t += 1 + nextRandom() % 500) {
+        service.advance( start + t);
+    }
+    for( uint32_t i = 0; rc && i < s_timers; i++) {
+        TimerRecord& r = timers[ i];
+        rc = !r.late && (i % 7 == 0 ? r.fired == 0 : r.fired > 0 && (r.period != 0 || r.fired == 1));
+        if( !rc) {
+            fprintf( stderr, "timerService: timer %u from %u fired %u times, %s\n", (unsigned) i, (unsigned) start,
+                (unsigned) r.fired, r.late ? "late" : "on time");
+        }
+    }
+    for( TimerRecord& r : timers) {
+        r.timer.stop();
+    }
+    return rc && service.getCount() == 0;
+}
+
+class TimerTarget : public Sliceable {
+public:
+    TimerTarget( void) { sliceDisable(); }
+    virtual const char* sliceName( void) { return "TimerTarget"; }
+};
+
+static TimerService s_timerService( true, 0);
+static TimerService s_timerServiceWrap( true, 0xFFFFF000);
+static TimerService s_timerServiceWrap2( true, 0xFFFF0000 - 12345);
+static TimerTarget s_timerTarget;
+
+static void timerRestart( void* arg) {
+    ServiceTimer* t = (ServiceTimer*) arg;
+    t->start( 5);
+}
+static bool testTimerService( void) {
+    bool rc = check( timerWheel( s_timerService, 0), "timerService", "wheel from 0");
+    rc = check( timerWheel( s_timerServiceWrap, 0xFFFFF000), "timerService", "wheel across the wrap") && rc;
+    rc = check( timerWheel( s_timerServiceWrap2, 0xFFFF0000 - 12345), "timerService", "wheel across the wrap, higher levels") && rc;
+    // A callback restarting its own timer, a notify and getRemaining()
+    TimerService& s = s_timerService;
+    ServiceTimer restart, notify;
+    restart.setCallback( timerRestart, &restart);
+    restart.start( 10, 0, &s);
+    notify.setNotify( &s_timerTarget, 0x4);
+    notify.start( 20, 0, &s);
+    // getNow() is the next millisecond to run, advance( t) runs up to and including t
+    uint32_t now = s.getNow();
+    s.advance( now + 8);
+    rc = check( restart.getRemaining() == 1 && notify.getRemaining() == 11, "timerService", "remaining time") && rc;
+    s.advance( now + 10);
+    rc = check( restart.isRunning() && restart.getRemaining() == 5, "timerService", "restart from the callback") && rc;
+    s.advance( now + 19);
+    rc = check( s_timerTarget.takeEvents() == 0, "timerService", "notified early") && rc;
+    s.advance( now + 20);
+    rc = check( s_timerTarget.takeEvents() == 0x4 && !notify.isRunning(), "timerService", "notify on expiry") && rc;
+    restart.stop();
+    rc = check( s.getCount() == 0, "timerService", "timers left running") && rc;
+    return rc;
+}
+/*
+ The cost of a tick with 100, 10k and 100k timers waiting, which should not grow with the number of timers,
+ and of starting and stopping them.
+ */
+static void benchTimerService( void) {
+    static TimerService s_bench( true, 0);
+    static const uint32_t s_ticks = 500000;
+    for( uint32_t n : { 100, 10000, 100000 }) {
+        std::vector<ServiceTimer> timers( n);
+        uint32_t now = s_bench.getNow();
+        uint32_t start = HW_getMicros();
+        for( uint32_t i = 0; i < n; i++) {
+            timers[ i].start( 1000000 + i * 37, 0, &s_bench);
+        }
+        uint32_t armed = HW_getMicros() - start;
+        start = HW_getMicros();
+        s_bench.advance( now + s_ticks);
+        uint32_t ticked = HW_getMicros() - start;
+        start = HW_getMicros();
+        for( uint32_t i = 0; i < n; i++) {
+            timers[ i].stop();
+        }
+        uint32_t stopped = HW_getMicros() - start;
+        printf( "timerService: %6u timers, tick %.1f ns, start %.1f ns, stop %.1f ns\n", (unsigned) n, 1000.0 * ticked / s_ticks,
+            1000.0 * armed / n, 1000.0 * stopped / n);
+    }
+}
+
+/*
+ Dictionary lookup: the hash indexes have to give what the linear searches they replaced give. A current
+ dictionary is driven through random compiles, redefinitions, roll backs and index rebuilds and compared
+ with a walk of its link chain after every step, also with an index too small for its words. The function
+ dictionary index is compared with the reverse strcmp search over a table with repeated names.
+ */
+template<unsigned SIZE, uint16_t SLOTS = DictionaryIndex::slotsFor( SIZE)>
+class LookupDictionary : public CurrentDictionary<SIZE, SLOTS> {
+public:
+    // The entry being compiled is skipped
+    uint16_t chainFind( const char* name) {
+        uint16_t last = this->m_lastWord;
+        return last == YRSHELL_DICTIONARY_INVALID ? YRSHELL_DICTIONARY_INVALID
+            : this->findInternal( name, last != this->m_dictionaryBackupLastWord ? this->m_dictionary[ last] : last);
+    }
+    uint16_t chainFindEntry( const char* name) {
+        return this->m_lastWord == YRSHELL_DICTIONARY_INVALID ? YRSHELL_DICTIONARY_INVALID : this->findInternalEntry( name, this->m_lastWord);
+    }
+    bool isIndexFull( void) { return this->m_indexFull; }
+};
+
+static std::vector<std::string> lookupNames( const char* prefix, uint32_t count, uint32_t spread) {
+    std::vector<std::string> rc;
+    for( uint32_t i = 0; i < count; i++) {
+        rc.push_back( prefix + std::to_string( i * 7919 % spread));
+    }
+    return rc;
+}
+template<class D>
+static uint32_t lookupMismatches( D& d, const std::vector<std::string>& names, uint32_t steps) {
+    uint32_t rc = 0;
+    for( uint32_t i = 0; i < steps; i++) {
+        uint32_t op = nextRandom() % 20;
+        if( op < 8) {
+            d.newCompile( names[ nextRandom() % names.size()].c_str());
+        } else if( op < 12) {
+            d.newCompileDone();
+        } else if( op < 16) {
+            d.rollBack();
+        } else if( op < 19) {
+            d.addToken( 5);
+        } else {
+            d.rebuildIndex();
+        }
+        for( const std::string& n : names) {
+            rc += d.find( n.c_str()) != d.chainFind( n.c_str()) ? 1 : 0;
+            rc += d.findEntry( n.c_str()) != d.chainFindEntry( n.c_str()) ? 1 : 0;
+        }
+    }
+    return rc;
+}
+static std::vector<FunctionEntry> lookupFunctions( const std::vector<std::string>& names) {
+    std::vector<FunctionEntry> rc;
+    for( size_t i = 0; i < names.size(); i++) {
+        rc.push_back( { (uint16_t) (i + 1), names[ i].c_str() });
+    }
+    rc.push_back( { 0, NULL });
+    return rc;
+}
+static uint16_t linearFind( const std::vector<FunctionEntry>& table, const char* name) {
+    uint16_t rc = YRSHELL_DICTIONARY_INVALID;
+    for( size_t i = table.size() - 1; rc == YRSHELL_DICTIONARY_INVALID && i > 0; i--) {
+        if( table[ i - 1].isMatch( name)) {
+            rc = table[ i - 1].getFunctionNumber() | YRSHELL_DICTIONARY_INTERPRETER_FUNCTION;
+        }
+    }
+    return rc;
+}
+static bool testLookup( void) {
+    std::vector<std::string> names = lookupNames( "w", 60, 1000);
+    names.push_back( "_");
+    uint32_t mismatches = 0;
+    s_random = 1;
+    for( uint32_t round = 0; round < 40; round++) {
+        LookupDictionary<2048> d;
+        mismatches += lookupMismatches( d, names, 300);
+    }
+    bool rc = check( mismatches == 0, "lookup", "the current dictionary index differs from its chain");
+    // 16 slots for up to 61 names, the dictionary falls back to its chain once the index is full
+    mismatches = 0;
+    bool full = false;
+    for( uint32_t round = 0; round < 10; round++) {
+        LookupDictionary<2048, 16> d;
+        mismatches += lookupMismatches( d, names, 300);
+        full = full || d.isIndexFull();
+    }
+    rc = check( full && mismatches == 0, "lookup", "a full index differs from the chain") && rc;
+    // Repeated names, the later entry wins
+    std::vector<std::string> functionNames = lookupNames( "f", 300, 250);
+    std::vector<FunctionEntry> table = lookupFunctions( functionNames);
+    FunctionDictionary functions( table.data(), YRSHELL_DICTIONARY_INTERPRETER_FUNCTION);
+    mismatches = 0;
+    for( const std::string& n : lookupNames( "f", 300, 300)) {
+        mismatches += functions.find( n.c_str()) != linearFind( table, n.c_str()) ? 1 : 0;
+    }
+    rc = check( mismatches == 0, "lookup", "the function dictionary index differs from a linear search") && rc;
+    return rc;
+}
+static void benchLookup( void) {
+    static const uint32_t s_lookups = 2000000;
+    std::vector<std::string> names = lookupNames( "word", 150, 100000);
+    LookupDictionary<2048> d;
+    for( const std::string& n : names) {
+        d.newCompile( n.c_str());
+        d.addToken( 1);
+        d.newCompileDone();
+    }
+    uint32_t times[ 4];
+    uint32_t found = 0;
+    for( uint8_t pass = 0; pass < 4; pass++) {
+        uint32_t start = HW_getMicros();
+        for( uint32_t i = 0; i < s_lookups; i++) {
+            const char* name = pass < 2 ? names[ i % names.size()].c_str() : "missingWord";
+            found += (pass % 2 == 0 ? d.findEntry( name) : d.chainFindEntry( name)) != YRSHELL_DICTIONARY_INVALID;
+        }
+        times[ pass] = HW_getMicros() - start;
+    }
+    printf( "lookup:  %u words, hit %.1f M/s indexed, %.1f M/s chain, miss %.1f M/s indexed, %.1f M/s chain\n",
+        (unsigned) names.size(), rate( s_lookups, times[ 0]), rate( s_lookups, times[ 1]), rate( s_lookups, times[ 2]),
+        rate( s_lookups, times[ 3]));
+    std::vector<FunctionEntry> table = lookupFunctions( lookupNames( "f", 250, 100000));
+    FunctionDictionary functions( table.data(), YRSHELL_DICTIONARY_INTERPRETER_FUNCTION);
+    for( uint8_t pass = 0; pass < 2; pass++) {
+        uint32_t start = HW_getMicros();
+        for( uint32_t i = 0; i < s_lookups; i++) {
+            const char* name = table[ i % (table.size() - 1)].getName();
+            found += (pass == 0 ? functions.find( name) : linearFind( table, name)) != YRSHELL_DICTIONARY_INVALID;
+        }
+        times[ pass] = HW_getMicros() - start;
+    }
+    printf( "lookup:  %u functions, %.1f M/s indexed, %.1f M/s linear, %u found\n", (unsigned) table.size() - 1,
+        rate( s_lookups, times[ 0]), rate( s_lookups, times[ 1]), (unsigned) found);
+}
+
+/*
+ Sliceable ready list: in group 1, which nothing else uses, an object that stays awake, one that sleeps, one that
+ waits for an event and one that waits with a timeout. Only the awake one may be sliced until a sleep ends or an
+ event it waits for is notified, from another thread as a group would.
+ */
+class SliceCounter : public Sliceable {
+public:
+    uint32_t m_count;
+    uint32_t m_sleepMs;
+    uint32_t m_waitEvents;
+    uint32_t m_waitMs;
+    SliceCounter( uint32_t sleepMs = 0, uint32_t waitEvents = 0, uint32_t waitMs = SLICE_WAIT_FOREVER) {
+        m_count = 0;
+        m_sleepMs = sleepMs;
+        m_waitEvents = waitEvents;
+        m_waitMs = waitMs;
+    }
+    virtual const char* sliceName( void) { return "SliceCounter"; }
+    virtual void slice( void) {
+        m_count++;
+        takeEvents();
+        if( m_sleepMs > 0) {
+            sliceSleep( m_sleepMs);
+        } else if( m_waitEvents != 0) {
+            sliceWaitFor( m_waitEvents, m_waitMs);
+        }
+    }
+};
+static SliceCounter s_sliceAwake;
+static SliceCounter s_sliceSleeper( 20);
+static SliceCounter s_sliceWaiter( 0, 0x1);
+static SliceCounter s_sliceTimeout( 0, 0x2, 10);
+
+static void slicePasses( uint32_t ms) {
+    uint32_t start = HW_getMillis();
+    do {
+        Sliceable::sliceAll( 1);
+    } while( HW_getMillis() - start < ms);
+}
+static bool testSlice( void) {
+    SliceCounter* all[] = { &s_sliceAwake, &s_sliceSleeper, &s_sliceWaiter, &s_sliceTimeout };
+    for( SliceCounter* s : all) {
+        s->setSliceGroup( 1);
+    }
+    Sliceable::sliceAll( 1);
+    bool rc = check( s_sliceAwake.m_count == 1 && s_sliceSleeper.m_count == 1 && s_sliceWaiter.m_count == 1 && s_sliceTimeout.m_count == 1,
+        "slice", "the first pass did not slice each object once");
+    slicePasses( 5);
+    rc = check( s_sliceAwake.m_count > 1 && s_sliceSleeper.m_count == 1 && s_sliceWaiter.m_count == 1 && s_sliceTimeout.m_count == 1,
+        "slice", "a sleeper was sliced") && rc;
+    std::thread( [] { s_sliceWaiter.notify( 0x2); }).join();
+    Sliceable::sliceAll( 1);
+    rc = check( s_sliceWaiter.m_count == 1, "slice", "an event that was not waited for woke the object") && rc;
+    std::thread( [] { s_sliceWaiter.notify( 0x1); }).join();
+    Sliceable::sliceAll( 1);
+    rc = check( s_sliceWaiter.m_count == 2, "slice", "notify() did not wake the object") && rc;
+    slicePasses( 30);
+    rc = check( s_sliceSleeper.m_count >= 2 && s_sliceTimeout.m_count >= 3 && s_sliceWaiter.m_count == 2, "slice", "the wheel wakes are wrong") && rc;
+    std::thread( [] { s_sliceWaiter.sliceWake(); }).join();
+    Sliceable::sliceAll( 1);
+    rc = check( s_sliceWaiter.m_count == 3, "slice", "sliceWake() did not wake the object") && rc;
+    // Off the group, none of them is sliced any more
+    for( SliceCounter* s : all) {
+        s->m_sleepMs = 0;
+        s->m_waitEvents = 0;
+        s->sliceWake();
+    }
+    Sliceable::sliceAll( 1);
+    for( SliceCounter* s : all) {
+        s->setSliceGroup( 0);
+        s->m_count = 0;
+    }
+    slicePasses( 2);
+    for( SliceCounter* s : all) {
+        rc = check( s->m_count == 0, "slice", "an object was sliced in the group it left") && rc;
+    }
+    return rc;
+}
+/*
+ The idle loop: the passes per second over 100 sleeping objects, which the ready list skips, and over the same
+ objects awake with nothing to do, as every object was walked before. The CPU time is what a loop run 1000
+ times a second would spend slicing.
+ */
+static SliceCounter s_sliceIdle[ 100];
+
+static void benchSlice( void) {
+    static const uint32_t s_ms = 200;
+    for( SliceCounter& s : s_sliceIdle) {
+        s.setSliceGroup( 1);
+    }
+    for( int pass = 0; pass < 2; pass++) {
+        if( pass == 1) {
+            for( SliceCounter& s : s_sliceIdle) {
+                s.m_waitEvents = 0x1;
+            }
+            Sliceable::sliceAll( 1);
+        }
+        uint64_t loops = 0;
+        uint32_t start = HW_getMicros();
+        uint32_t t;
+        do {
+            for( int i = 0; i < 100; i++) {
+                Sliceable::sliceAll( 1);
+            }
+            loops += 100;
+            t = HW_getMicros() - start;
+        } while( t < s_ms * 1000);
+        printf( "slice:   100 %s objects, %.2f M loops/s, %.1f us CPU per second at 1000 loops/s\n", pass == 0 ? "awake" : "sleeping",
+            rate( loops, t), 1000.0 * t / loops);
+    }
+}
+
+/*
+ Group scheduling and queue handoff: a SliceGroup thread slices a reader in group 1, which waits for the writer's
+ notify() and drains a CircularQSpsc. The writer, on the main thread, discards what is queued now and then. The
+ reader must see increasing values, skipping only values written before a discard, and every value after the last.
+ First discard() on one thread: the reader drops the values on its next read, which gives the writer the space.
+ */
+#define HANDOFF_EVENT 0x1
+#define HANDOFF_COUNT 400000
+
+static const std::thread::id s_mainThread = std::this_thread::get_id();
+static CircularQSpsc<uint32_t, 256> s_handoffQ;
+static std::vector<uint32_t> s_handoffMarks;
+
+class HandoffReader : public Sliceable {
+public:
+    std::atomic<uint32_t> m_last;
+    std::atomic<bool> m_mainThread;
+    std::vector<std::pair<uint32_t, uint32_t> > m_gaps;
+    HandoffReader( void) {
+        m_last = 0;
+        m_mainThread = false;
+    }
+    virtual const char* sliceName( void) { return "HandoffReader"; }
+    virtual void slice( void) {
+        uint32_t buf[ 64];
+        takeEvents( HANDOFF_EVENT);
+        m_mainThread = m_mainThread || std::this_thread::get_id() == s_mainThread;
+        uint32_t n = s_handoffQ.getN( buf, 64);
+        uint32_t last = m_last;
+        for( uint32_t i = 0; i < n; i++) {
+            if( buf[ i] != last + 1) {
+                m_gaps.push_back( std::make_pair( last, buf[ i]));
+            }
+            last = buf[ i];
+        }
+        m_last = last;
+        if( last == HANDOFF_COUNT) {
+            sliceWaitFor( HANDOFF_EVENT);
+        } else if( n == 0) {
+            sliceWaitFor( HANDOFF_EVENT, 1);
+        }
+    }
+};
+static HandoffReader s_handoffReader;
+static SliceGroup s_handoffGroup( "handoff", 1, 0);
+
+// Writes 1 to HANDOFF_COUNT, discarding in the middle of every discardEvery values, returns the microseconds taken or 0
+static uint32_t handoffRun( uint32_t discardEvery) {
+    uint32_t rc = 0;
+    s_handoffReader.m_last = 0;
+    s_handoffReader.m_gaps.clear();
+    s_handoffMarks.clear();
+    s_handoffReader.setSliceGroup( 1);
+    s_handoffReader.sliceWake();
+    if( s_handoffGroup.start()) {
+        uint32_t start = HW_getMicros();
+        uint32_t next = 1;
+        while( next <= HANDOFF_COUNT) {
+            if( s_handoffQ.put( next)) {
+                if( (next & 0x3F) == 0) {
+                    s_handoffReader.notify( HANDOFF_EVENT);
+                }
+                if( discardEvery != 0 && next % discardEvery == discardEvery / 2) {
+                    s_handoffQ.discard();
+                    s_handoffMarks.push_back( next);
+                }
+                next++;
+            } else {
+                s_handoffReader.notify( HANDOFF_EVENT);
+                std::this_thread::yield();
+            }
+        }
+        s_handoffReader.notify( HANDOFF_EVENT);
+        uint32_t wait = HW_getMillis();
+        while( s_handoffReader.m_last != HANDOFF_COUNT && HW_getMillis() - wait < 5000) {
+            std::this_thread::yield();
+        }
+        rc = HW_getMicros() - start;
+        s_handoffGroup.stop();
+        // Lets the group finish its last pass
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10));
+    }
+    return rc;
+}
+static bool testHandoff( void) {
+    CircularQSpsc<uint32_t, 16>* q = new CircularQSpsc<uint32_t, 16>;
+    for( uint32_t i = 1; i <= 16; i++) {
+        q->put( i);
+    }
+    q->discard( 10);
+    bool rc = check( q->free() == 0, "handoff", "the writer moved the reader");
+    rc = check( q->valueAvailable( 6) && !q->valueAvailable( 7) && q->free() == 10, "handoff", "the reader did not drop the values") && rc;
+    for( uint32_t i = 17; i <= 26; i++) {
+        rc = check( q->put( i), "handoff", "no space after a discard") && rc;
+    }
+    q->discard( 4);
+    for( uint32_t i = 15; i <= 26; i++) {
+        rc = check( q->valueAvailable() && q->get() == i, "handoff", "the reader read a discarded value") && rc;
+    }
+    q->discard();
+    rc = check( !q->valueAvailable() && q->free() == 16, "handoff", "discarding an empty queue") && rc;
+    delete q;
+
+    rc = check( handoffRun( 25000) != 0, "handoff", "the group did not start") && rc;
+    rc = check( s_handoffReader.m_last == HANDOFF_COUNT, "handoff", "the reader did not get the last value") && rc;
+    rc = check( !s_handoffReader.m_mainThread, "handoff", "the reader was sliced on the main thread") && rc;
+    for( const std::pair<uint32_t, uint32_t>& g : s_handoffReader.m_gaps) {
+        bool marked = false;
+        for( uint32_t m : s_handoffMarks) {
+            marked = marked || (g.first < m && g.second > m && g.second - 1 <= m);
+        }
+        rc = check( marked, "handoff", "values were lost or reordered") && rc;
+    }
+    return rc;
+}
+static void benchHandoff( void) {
+    uint32_t t = handoffRun( 0);
+    printf( "handoff: %u values to a group thread woken by notify(), %.1f M values/s\n", HANDOFF_COUNT, rate( HANDOFF_COUNT, t));
+}
+
+/*
+ Dictionary snapshots: words, a redefinition, a register and hex mode saved from one shell and restored into a
+ fresh one, which then has to answer like the first. A word still being compiled is not saved. A snapshot of
+ another build, with a flipped byte or cut short is refused and leaves the shell as it was.
+ */
+#define SNAPSHOT_BUILD 0x5EED1234
+
+static std::string shellRun( YRShellInterpreter& shell, const std::string& text) {
+    std::string out;
+    size_t at = 0;
+    bool lineSent = false;
+    do {
+        if( lineSent && shell.isIdle()) {
+            lineSent = false;
+        }
+        while( !lineSent && at < text.size() && shell.getInq().put( text[ at])) {
+            lineSent = text[ at++] == '\r';
+        }
+        shell.slice();
+        while( shell.getOutq().valueAvailable()) {
+            out += shell.getOutq().get();
+        }
+    } while( at < text.size() || !shell.isIdle());
+    return out;
+}
+class SnapshotShell : public YRShell {
+public:
+    SnapshotShell( ) {
+        init();
+        shellRun( *this, "");
+    }
+};
+static std::vector<uint8_t> snapshotSave( SnapshotShell& shell) {
+    std::vector<uint8_t> rc( shell.getSnapshotSize());
+    rc.resize( shell.saveSnapshot( rc.data(), (uint32_t) rc.size(), SNAPSHOT_BUILD, 0x55));
+    return rc;
+}
+static const char s_snapshotProbe[] = "5 sq . 3 @ . part\r";
+
+static bool testSnapshot( void) {
+    bool rc = true;
+    static SnapshotShell s_saved;
+    s_saved.setPromptEnable( false);
+    s_saved.setCommandEcho( false);
+    shellRun( s_saved, ": sq dup *\r: sq sq 1 +\r7 3 !\rhex\r");
+    std::string expect = shellRun( s_saved, s_snapshotProbe);
+    // Part of a line that defines a word
+    s_saved.setSliceBudget( 1, YRSHELL_SLICE_TIME_BUDGET);
+    for( const char* p = ": part 1 + 2 + 3 +\r"; *p != '\0'; p++) {
+        s_saved.getInq().put( *p);
+    }
+    for( int i = 0; i < 4; i++) {
+        s_saved.slice();
+    }
+    rc = check( !s_saved.isIdle(), "snapshot", "the word is not being compiled") && rc;
+    std::vector<uint8_t> blob = snapshotSave( s_saved);
+    rc = check( !blob.empty(), "snapshot", "save failed") && rc;
+    rc = check( shellRun( s_saved, "part\r").find( "UNDEFINED") == std::string::npos, "snapshot", "the word was not compiled after the save") && rc;
+
+    static SnapshotShell s_restored;
+    s_restored.setPromptEnable( false);
+    s_restored.setCommandEcho( false);
+    std::string fresh = shellRun( s_restored, s_snapshotProbe);
+    uint32_t flags = 0;
+    rc = check( !s_restored.restoreSnapshot( blob.data(), (uint32_t) blob.size(), SNAPSHOT_BUILD + 1, &flags), "snapshot", "restored another build") && rc;
+    for( uint32_t at = 0; at < blob.size(); at += 7) {
+        blob[ at] ^= 0x10;
+        rc = check( !s_restored.restoreSnapshot( blob.data(), (uint32_t) blob.size(), SNAPSHOT_BUILD, &flags), "snapshot", "restored a flipped byte") && rc;
+        blob[ at] ^= 0x10;
+    }
+    for( uint32_t size = 0; size < blob.size(); size += 5) {
+        rc = check( !s_restored.restoreSnapshot( blob.data(), size, SNAPSHOT_BUILD, &flags), "snapshot", "restored a truncated snapshot") && rc;
+    }
+    rc = check( shellRun( s_restored, s_snapshotProbe) == fresh && flags == 0, "snapshot", "a refused snapshot changed the shell") && rc;
+    s_restored.setPromptEnable( true);
+    s_restored.setCommandEcho( true);
+    rc = check( s_restored.restoreSnapshot( blob.data(), (uint32_t) blob.size(), SNAPSHOT_BUILD, &flags) && flags == 0x55, "snapshot", "restore failed") && rc;
+    rc = check( shellRun( s_restored, s_snapshotProbe) == expect, "snapshot", "the restored shell answers differently") && rc;
+    return rc;
+}
+static void benchSnapshot( void) {
+    static SnapshotShell s_shell;
+    static const unsigned s_words = 150;
+    static const unsigned s_rounds = 20000;
+    std::string text;
+    for( unsigned i = 0; i < s_words; i++) {
+        text += ": w" + std::to_string( i) + " " + std::to_string( i) + " dup * 1 +\r";
+    }
+    shellRun( s_shell, text);
+    std::vector<uint8_t> blob = snapshotSave( s_shell);
+    uint32_t start = HW_getMicros();
+    for( unsigned i = 0; i < s_rounds; i++) {
+        s_shell.saveSnapshot( blob.data(), (uint32_t) blob.size(), SNAPSHOT_BUILD);
+    }
+    uint32_t save = HW_getMicros() - start;
+    bool ok = true;
+    start = HW_getMicros();
+    for( unsigned i = 0; i < s_rounds; i++) {
+        ok = s_shell.restoreSnapshot( blob.data(), (uint32_t) blob.size(), SNAPSHOT_BUILD) && ok;
+    }
+    uint32_t restore = HW_getMicros() - start;
+    start = HW_getMicros();
+    shellRun( s_shell, text);
+    uint32_t parse = HW_getMicros() - start;
+    printf( "snapshot: %u words in %u bytes, save %.2f us, restore %.2f us%s, parsing them %u us\n", s_words, (unsigned) blob.size(),
+        save / (double) s_rounds, restore / (double) s_rounds, ok ? "" : " (failed)", (unsigned) parse);
+}
+
+typedef struct {
+    const char* name;
+    bool (*test)( void);
+    void (*bench)( void);
+} CoreTest;
+
+static const CoreTest s_tests[] = {
+    { "spsc", testSpsc, benchSpsc },
+    { "bulk", testBulk, benchBulk },
+    { "logRing", testLogRing, benchLogRing },
+    { "deferredLog", testDeferredLog, benchDeferredLog },
+    { "trace", testTrace, benchTrace },
+    { "timerService", testTimerService, benchTimerService },
+    { "slice", testSlice, benchSlice },
+    { "handoff", testHandoff, benchHandoff },
+    { "lookup", testLookup, benchLookup },
+    { "snapshot", testSnapshot, benchSnapshot },
+};
+
+int main( int argc, char** argv) {
+    bool bench = argc > 1 && !strcmp( argv[ 1], "-b");
+    int first = bench ? 2 : 1;
+    int rc = 0;
+    unsigned run = 0;
+    for( const CoreTest& t : s_tests) {
+        bool selected = first >= argc;
+        for( int i = first; !selected && i < argc; i++) {
+            selected = !strcmp( argv[ i], t.name);
+        }
+        if( selected) {
+            run++;
+            if( bench) {
+                t.bench();
+            } else if( !t.test()) {
+                fprintf( stderr, "%s failed\n", t.name);
+                rc = 1;
+            }
+        }
+    }
+    if( run == 0) {
+        fprintf( stderr, "usage: %s [-b] [name...]\n", argv[ 0]);
+        rc = 2;
+    } else if( !bench && rc == 0) {
+        printf( "%u core tests pass\n", run);
+    }
+    return rc;
+}
@@ -0,0 +1,553 @@
+/*
+ Runs YRShell scripts on a Linux or macOS host, with the same interpreter sources as the firmware.
+
+ The script is fed through getInq() a line at a time and the output is collected from getOutq(). The
+ version banner printed at start up is dropped, and the compile time in the one printed by reset and the
+ source line number of an error are blanked, so the output of a script is the same from build to build
+ and can be kept as a golden file.
+
+ Extension words (YRShellEsp32Functions) are found, so data/start.yr compiles, but they only print
+ their name in brackets and leave the stacks alone.
+
+ usage: yrhost [-e golden] [-u golden] [-b] [-S] [-p count] [-n count] [-x line] script.yr...
+   -e golden    compare the output with golden, exit 1 if it differs
+   -u golden    write the output to golden
+   -b           benchmark: parse, execute, tokens per slice, lookup, /exec line, number format and literal rates, peak stack use
+   -S           run the script in the shell and in two sessions at once, exit 1 unless the outputs match
+   -p count     profile the script and list the count words with the most exclusive time
+   -n count     benchmark repeat count, default 20
+   -x line      command line the benchmark runs as an /exec request
+ */
+#include <YRShell.h>
+#include <YRShellEsp32Functions.h>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define STACK_PAINT 0xA5C3A5C3
+#define HOST_SESSIONS 2
+
+static FunctionDictionary dictionaryExtensionFunction( yr8266ShellExtensionFunctions, YRSHELL_DICTIONARY_EXTENSION_FUNCTION );
+
+// Sized like YRShellEsp32
+class HostShell : public virtual YRShellBase<2048, 128, 128, 16, 16, 16, 8, 256, 512, 256, 512, 128> {
+protected:
+    LineCache<16, 128> m_cache;
+    Profiler<64> m_profile;
+    // Sized like the YRShellEsp32 exec sessions
+    YRShellSession<128, 16, 16, 8, 256, 512> m_sessions[ HOST_SESSIONS];
+    uint32_t m_slices;
+    virtual const char* shellClass( void) { return "HostShell"; }
+    virtual const char* mainFileName( ) { return "yrhost.cpp"; }
+    virtual void executeFunction( uint16_t n) {
+        if( n <= SE_CC_first || n >= SE_CC_last) {
+            YRShellBase::executeFunction( n);
+        } else {
+            for( const FunctionEntry* e = yr8266ShellExtensionFunctions; e->isValid(); e++) {
+                if( e->getFunctionNumber() == n) {
+                    outChar( '[');
+                    outString( e->getName());
+                    outChar( ']');
+                    break;
+                }
+            }
+        }
+    }
+    static uint8_t paintedDepth( const uint32_t* stack, uint8_t size) {
+        uint8_t rc = size;
+        while( rc > 0 && stack[ rc - 1] == STACK_PAINT) {
+            rc--;
+        }
+        return rc;
+    }
+public:
+    HostShell( ) {
+        m_slices = 0;
+        init();
+        run( "");
+    }
+    virtual void init( void) {
+        YRShellBase::init();
+        m_dictionaryList[ YRSHELL_DICTIONARY_EXTENSION_FUNCTION_INDEX] = &dictionaryExtensionFunction;
+        setLineCache( &m_cache);
+        setProfiler( &m_profile);
+    }
+    void enableLineCache( bool s) { setLineCache( s ? &m_cache : NULL); }
+    bool addSessions( void) {
+        bool rc = true;
+        for( uint8_t i = 0; rc && i < HOST_SESSIONS; i++) {
+            rc = addContext( &m_sessions[ i]);
+        }
+        return rc;
+    }
+    YRShellContext& getSession( uint8_t i) { return m_sessions[ i]; }
+    /** \brief Feeds each text to the shell, -1, or a session until all of them have been processed.
+
+     Returns the outputs in the same order. Stops early when one is done if any is false.
+     */
+    std::vector<std::string> runConcurrent( const std::vector<std::string>& text, bool all = true) {
+        std::vector<std::string> out( text.size());
+        std::vector<size_t> at( text.size(), 0);
+        bool busy;
+        do {
+            busy = false;
+            bool done = false;
+            for( size_t i = 0; i < text.size(); i++) {
+                CircularQBase<char>& inq = i == 0 ? getInq() : m_sessions[ i - 1].getInq();
+                CircularQBase<char>& outq = i == 0 ? getOutq() : m_sessions[ i - 1].getOutq();
+                while( at[ i] < text[ i].size() && inq.put( text[ i][ at[ i]])) {
+                    at[ i]++;
+                }
+                while( outq.valueAvailable()) {
+                    out[ i] += outq.get();
+                }
+                bool idle = at[ i] >= text[ i].size() && (i == 0 ? isIdle() && !inq.valueAvailable() : m_sessions[ i - 1].isIdle());
+                busy = busy || !idle;
+                done = done || (idle && !text[ i].empty());
+            }
+            busy = busy && (all || !done);
+            if( busy) {
+                slice();
+            }
+        } while( busy);
+        return out;
+    }
+    LineCacheBase& getLineCache( void) { return m_cache; }
+    /** \brief The number of slices run() has called since the last call.
+     */
+    uint32_t takeSlices( void) {
+        uint32_t rc = m_slices;
+        m_slices = 0;
+        return rc;
+    }
+    /** \brief Feeds text to the interpreter until it has been processed, returns the output.
+
+     A line at a time, the next one once the interpreter is idle again, as typed at a terminal. A reset empties
+     the input queue, lines fed ahead of it would be lost.
+     */
+    std::string run( const std::string& text) {
+        std::string out;
+        const char* p = text.c_str();
+        bool lineSent = false;
+        do {
+            if( lineSent && isIdle() && !getInq().valueAvailable()) {
+                lineSent = false;
+            }
+            while( !lineSent && *p != '\0' && getInq().put( *p)) {
+                lineSent = *p++ == '\r';
+            }
+            slice();
+            m_slices++;
+            while( getOutq().valueAvailable()) {
+                out += getOutq().get();
+            }
+        } while( *p != '\0' || !isIdle() || getInq().valueAvailable());
+        return out;
+    }
+    /** \brief Fills the unused part of the stacks, see peak().
+     */
+    void paintStacks( void) {
+        for( uint8_t i = 0; i < m_parameterStackSize; i++) {
+            m_parameterStack[ i] = STACK_PAINT;
+        }
+        for( uint8_t i = 0; i < m_returnStackSize; i++) {
+            m_returnStack[ i] = STACK_PAINT;
+        }
+        for( uint8_t i = 0; i < m_compileStackSize; i++) {
+            m_compileStack[ i] = STACK_PAINT;
+        }
+    }
+    /** \brief Returns the deepest stack use since paintStacks() as "parameter/size return/size compile/size".
+     */
+    std::string peak( void) {
+        char buf[ 96];
+        snprintf( buf, sizeof( buf), "parameter %u/%u, return %u/%u, compile %u/%u",
+            paintedDepth( m_parameterStack, m_parameterStackSize), m_parameterStackSize,
+            paintedDepth( m_returnStack, m_returnStackSize), m_returnStackSize,
+            paintedDepth( m_compileStack, m_compileStackSize), m_compileStackSize);
+        return buf;
+    }
+    /** \brief Returns the names of every entry the interpreter can find.
+     */
+    std::vector<std::string> names( void) {
+        std::vector<std::string> rc;
+        for( uint8_t i = 0; i < YRSHELL_DICTIONARY_LAST_INDEX; i++) {
+            Dictionary* D = m_dictionaryList[ i];
+            uint16_t end;
+            if( D == NULL || i == YRSHELL_DICTIONARY_DUMMY_INDEX) {
+                continue;
+            }
+            bool compiled = D->getCode( &end) != NULL;
+            for( uint16_t e = D->getFirstEntry(); e != YRSHELL_DICTIONARY_INVALID; e = D->getNextEntry( e)) {
+                rc.push_back( D->getAddress( compiled ? e + 1 : e));
+            }
+        }
+        return rc;
+    }
+    uint16_t lookup( const char* name) { return find( name); }
+    uint16_t dictionaryUsed( void) { return m_DictionaryCurrent->getWordEnd(); }
+    /** \brief Prints n values with ., .x and .f into the output queue, returns the characters printed.
+     */
+    uint32_t format( unsigned n) {
+        uint32_t rc = 0;
+        for( unsigned i = 0; i < n; i++) {
+            uint32_t v = i * 2654435761u;
+            outInt32( (int32_t) v);
+            outUint32X( v);
+            outFloat( (float) (int32_t) v / 7.0f);
+            while( getOutq().valueAvailable()) {
+                getOutq().get();
+                rc++;
+            }
+        }
+        return rc;
+    }
+};
+
+static bool readFile( const char* name, std::string& text) {
+    FILE* f = fopen( name, "rb");
+    if( f == NULL) {
+        return false;
+    }
+    char buf[ 1024];
+    size_t n;
+    while( (n = fread( buf, 1, sizeof( buf), f)) > 0) {
+        text.append( buf, n);
+    }
+    fclose( f);
+    return true;
+}
+// Each line ends with the CR the terminal sends
+static std::string toInput( const std::string& text) {
+    std::string rc;
+    for( size_t i = 0; i < text.size(); i++) {
+        if( text[ i] == '\n') {
+            if( i == 0 || text[ i - 1] != '\r') {
+                rc += '\r';
+            }
+        } else {
+            rc += text[ i];
+        }
+    }
+    if( !rc.empty() && rc.back() != '\r') {
+        rc += '\r';
+    }
+    return rc;
+}
+static void blankBuild( std::string& out) {
+    static const char s_begin[] = "Compile Time: ";
+    static const char s_end[] = " Main File: ";
+    static const char s_source[] = ".cpp ";
+    size_t b = 0;
+    while( (b = out.find( s_begin, b)) != std::string::npos) {
+        b += sizeof( s_begin) - 1;
+        size_t e = out.find( s_end, b);
+        if( e != std::string::npos) {
+            out.replace( b, e - b, "-");
+        }
+    }
+    // The line number printed after the source file name of an error
+    b = 0;
+    while( (b = out.find( s_source, b)) != std::string::npos) {
+        b += sizeof( s_source) - 1;
+        size_t e = out.find_first_not_of( ' ', b);
+        if( e != std::string::npos && isdigit( (unsigned char) out[ e])) {
+            size_t d = out.find_first_not_of( "0123456789", e);
+            out.replace( b, (d == std::string::npos ? out.size() : d) - b, "-");
+        }
+    }
+}
+static unsigned countTokens( const std::string& text) {
+    unsigned rc = 0;
+    bool in = false;
+    for( char c : text) {
+        bool space = c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        if( !space && !in) {
+            rc++;
+        }
+        in = !space;
+    }
+    return rc;
+}
+
+static void benchmark( const std::string& input, unsigned count, const std::string& exec) {
+    unsigned tokens = countTokens( input);
+    uint32_t best = 0xFFFFFFFF;
+    std::string peak;
+    uint16_t used = 0;
+    for( unsigned i = 0; i < count; i++) {
+        HostShell shell;
+        shell.paintStacks();
+        uint32_t start = HW_getMicros();
+        shell.run( input);
+        uint32_t t = HW_getMicros() - start;
+        if( t < best) {
+            best = t;
+        }
+        peak = shell.peak();
+        used = shell.dictionaryUsed();
+    }
+    best = best > 0 ? best : 1;
+    printf( "parse:   %u bytes, %u tokens in %u us, %.2f Mtokens/s, %.2f MB/s, %u dictionary words\n", (unsigned) input.size(),
+        tokens, (unsigned) best, tokens / (double) best, input.size() / (double) best, (unsigned) used);
+    printf( "stack:   %s\n", peak.c_str());
+
+    // Six tokens per iteration as written, before superinstructions
+    static const unsigned s_loops = 1000000;
+    HostShell shell;
+    shell.run( ": benchLoop 0 { 1 + dup " + std::to_string( s_loops) + " >= } drop\r");
+    best = 0xFFFFFFFF;
+    for( unsigned i = 0; i < (count + 3) / 4; i++) {
+        uint32_t start = HW_getMicros();
+        shell.run( "benchLoop\r");
+        uint32_t t = HW_getMicros() - start;
+        best = t < best ? t : best;
+    }
+    best = best > 0 ? best : 1;
+    printf( "execute: %u loop iterations in %u us, %.2f Mtokens/s\n", s_loops, (unsigned) best, 6.0 * s_loops / best);
+
+    // The script and the loop again, one token per slice as before the slice budget, then with the default budget
+    for( int pass = 0; pass < 2; pass++) {
+        uint16_t budget = pass == 0 ? 1 : YRSHELL_SLICE_TOKEN_BUDGET;
+        uint32_t parse = 0xFFFFFFFF, loop = 0xFFFFFFFF, parseSlices = 0, loopSlices = 0;
+        for( unsigned i = 0; i < (count + 3) / 4; i++) {
+            HostShell batch;
+            batch.setSliceBudget( budget, YRSHELL_SLICE_TIME_BUDGET);
+            batch.takeSlices();
+            uint32_t start = HW_getMicros();
+            batch.run( input);
+            uint32_t t = HW_getMicros() - start;
+            parse = t < parse ? t : parse;
+            parseSlices = batch.takeSlices();
+            batch.run( ": benchLoop 0 { 1 + dup " + std::to_string( s_loops) + " >= } drop\r");
+            batch.takeSlices();
+            start = HW_getMicros();
+            batch.run( "benchLoop\r");
+            t = HW_getMicros() - start;
+            loop = t < loop ? t : loop;
+            loopSlices = batch.takeSlices();
+        }
+        parse = parse > 0 ? parse : 1;
+        loop = loop > 0 ? loop : 1;
+        printf( "slice:   budget %u, script %.2f Mtokens/s in %u slices, loop %.2f Mtokens/s in %u slices\n", (unsigned) budget,
+            tokens / (double) parse, (unsigned) parseSlices, 6.0 * s_loops / loop, (unsigned) loopSlices);
+    }
+
+    HostShell loaded;
+    loaded.run( input);
+
+    // Per request cost of an /exec command line, as the web UI repeats them
+    static const unsigned s_requests = 2000;
+    std::string line = exec + "\r";
+    uint32_t parsed = 0, cached = 0;
+    for( int pass = 0; pass < 2; pass++) {
+        loaded.enableLineCache( pass != 0);
+        loaded.run( line);
+        best = 0xFFFFFFFF;
+        for( unsigned i = 0; i < (count + 3) / 4; i++) {
+            uint32_t start = HW_getMicros();
+            for( unsigned j = 0; j < s_requests; j++) {
+                loaded.run( line);
+            }
+            uint32_t t = HW_getMicros() - start;
+            best = t < best ? t : best;
+        }
+        (pass == 0 ? parsed : cached) = best;
+    }
+    printf( "exec:    \"%s\" parsed %.2f us, cached %.2f us per line, %u cache hits\n", exec.c_str(), parsed / (double) s_requests,
+        cached / (double) s_requests, (unsigned) loaded.getLineCache().getHits());
+    // Formatting straight into the output queue, then the same words appending to the text buffer
+    static const unsigned s_values = 20000;
+    uint32_t chars = 0;
+    best = 0xFFFFFFFF;
+    for( unsigned i = 0; i < (count + 3) / 4; i++) {
+        uint32_t start = HW_getMicros();
+        chars = loaded.format( s_values);
+        uint32_t t = HW_getMicros() - start;
+        best = t < best ? t : best;
+    }
+    best = best > 0 ? best : 1;
+    loaded.run( ": benchText 0 0 c! textIO 0 { dup . dup .x 1 + dup 4 >= } drop mainIO\r");
+    uint32_t text = 0xFFFFFFFF;
+    for( unsigned i = 0; i < (count + 3) / 4; i++) {
+        uint32_t start = HW_getMicros();
+        for( unsigned j = 0; j < s_requests; j++) {
+            loaded.run( "benchText\r");
+        }
+        uint32_t t = HW_getMicros() - start;
+        text = t < text ? t : text;
+    }
+    printf( "format:  %u values with . .x .f in %u us, %.2f Mchars/s, text buffer line %.2f us\n", s_values, (unsigned) best,
+        chars / (double) best, text / (double) s_requests);
+    loaded.enableLineCache( false);
+    std::string literals;
+    for( unsigned i = 0; i < 8; i++) {
+        literals += std::to_string( i * 40503) + " drop 0x" + std::to_string( i * 1111) + " drop -" + std::to_string( i) + ".25e3 drop ";
+    }
+    literals += "\r";
+    best = 0xFFFFFFFF;
+    for( unsigned i = 0; i < (count + 3) / 4; i++) {
+        uint32_t start = HW_getMicros();
+        for( unsigned j = 0; j < s_requests; j++) {
+            loaded.run( literals);
+        }
+        uint32_t t = HW_getMicros() - start;
+        best = t < best ? t : best;
+    }
+    loaded.enableLineCache( true);
+    printf( "literal: 24 literals per line in %.2f us per line\n", best / (double) s_requests);
+    std::vector<std::string> names = loaded.names();
+    unsigned lookups = 0;
+    best = 0xFFFFFFFF;
+    for( unsigned i = 0; i < count; i++) {
+        uint32_t start = HW_getMicros();
+        for( const std::string& n : names) {
+            lookups += loaded.lookup( n.c_str()) != YRSHELL_DICTIONARY_INVALID;
+        }
+        uint32_t t = HW_getMicros() - start;
+        best = t < best ? t : best;
+    }
+    best = best > 0 ? best : 1;
+    printf( "lookup:  %u names in %u us, %.2f Mlookups/s, %u misses\n", (unsigned) names.size(), (unsigned) best,
+        names.size() / (double) best, (unsigned) (names.size() * count - lookups));
+}
+
+/*
+ Every session runs the whole script while the shell runs it too, so words get defined three times and a
+ line of one is compiled between the lines of the others. The script has to fit in the dictionary three
+ times, and scripts that print dictionary addresses differ.
+ */
+static int concurrent( const std::string& input) {
+    int rc = 0;
+    HostShell shell;
+    shell.setCommandEcho( false);
+    shell.setPromptEnable( false);
+    if( !shell.addSessions()) {
+        fprintf( stderr, "no room for the sessions\n");
+        return 2;
+    }
+    std::vector<std::string> out = shell.runConcurrent( std::vector<std::string>( HOST_SESSIONS + 1, input));
+    for( size_t i = 0; i < out.size(); i++) {
+        blankBuild( out[ i]);
+    }
+    size_t bytes = out[ 0].size();
+    for( size_t i = 1; i < out.size(); i++) {
+        if( out[ i] != out[ 0]) {
+            size_t at = 0;
+            while( at < out[ i].size() && at < out[ 0].size() && out[ i][ at] == out[ 0][ at]) {
+                at++;
+            }
+            fprintf( stderr, "session %u output differs at byte %u\n", (unsigned) i - 1, (unsigned) at);
+            rc = 1;
+        }
+    }
+    // A session line is answered while the shell waits in a delay
+    static const unsigned s_delay = 200;
+    std::vector<std::string> text( 2);
+    text[ 0] = std::to_string( s_delay) + " delay\r";
+    text[ 1] = "1 2 + . cr\r";
+    uint32_t start = HW_getMicros();
+    out = shell.runConcurrent( text, false);
+    uint32_t t = HW_getMicros() - start;
+    shell.runConcurrent( std::vector<std::string>( 1));
+    printf( "sessions: %u bytes of output each, %s, session line answered in %u us during a %u ms delay\n",
+        (unsigned) bytes, rc == 0 ? "match" : "differ", (unsigned) t, s_delay);
+    if( out[ 1].find_first_not_of( " \r") == std::string::npos || out[ 1].substr( out[ 1].find_first_not_of( " \r"), 2) != "3 ") {
+        fprintf( stderr, "session answered \"%s\"\n", out[ 1].c_str());
+        rc = 1;
+    }
+    return rc;
+}
+
+int main( int argc, char** argv) {
+    const char* expect = NULL;
+    const char* update = NULL;
+    bool bench = false;
+    bool sessions = false;
+    unsigned profile = 0;
+    unsigned count = 20;
+    std::string exec = "1 2 + 3 * 4 - dup 10 > [ 1 + ] drop cr execDone";
+    std::string input;
+    int i;
+    for( i = 1; i < argc && argv[ i][ 0] == '-'; i++) {
+        if( !strcmp( argv[ i], "-e") && i + 1 < argc) {
+            expect = argv[ ++i];
+        } else if( !strcmp( argv[ i], "-u") && i + 1 < argc) {
+            update = argv[ ++i];
+        } else if( !strcmp( argv[ i], "-b")) {
+            bench = true;
+        } else if( !strcmp( argv[ i], "-S")) {
+            sessions = true;
+        } else if( !strcmp( argv[ i], "-p") && i + 1 < argc) {
+            profile = (unsigned) atoi( argv[ ++i]);
+        } else if( !strcmp( argv[ i], "-x") && i + 1 < argc) {
+            exec = argv[ ++i];
+        } else if( !strcmp( argv[ i], "-n") && i + 1 < argc) {
+            count = (unsigned) atoi( argv[ ++i]);
+            count = count > 0 ? count : 1;
+        } else {
+            i = argc;
+        }
+    }
+    if( i >= argc) {
+        fprintf( stderr, "usage: %s [-e golden] [-u golden] [-b] [-S] [-p count] [-n count] [-x line] script.yr...\n", argv[ 0]);
+        return 2;
+    }
+    for( ; i < argc; i++) {
+        std::string text;
+        if( !readFile( argv[ i], text)) {
+            fprintf( stderr, "can't open %s\n", argv[ i]);
+            return 2;
+        }
+        input += toInput( text);
+    }
+
+    if( bench) {
+        benchmark( input, count, exec);
+        return 0;
+    }
+    if( sessions) {
+        return concurrent( input);
+    }
+    if( profile > 0) {
+        input = "1 setProfile\r" + input + "0 setProfile " + std::to_string( profile) + " runProfile\r";
+    }
+    HostShell shell;
+    std::string out = shell.run( input);
+    blankBuild( out);
+    int rc = 0;
+    if( update != NULL) {
+        FILE* f = fopen( update, "wb");
+        if( f == NULL || fwrite( out.data(), 1, out.size(), f) != out.size()) {
+            fprintf( stderr, "can't write %s\n", update);
+            rc = 2;
+        }
+        if( f != NULL) {
+            fclose( f);
+        }
+    } else if( expect != NULL) {
+        std::string golden;
+        if( !readFile( expect, golden)) {
+            fprintf( stderr, "can't open %s\n", expect);
+            rc = 2;
+        } else if( golden != out) {
+            size_t at = 0;
+            while( at < out.size() && at < golden.size() && out[ at] == golden[ at]) {
+                at++;
+            }
+            unsigned line = 1;
+            for( size_t j = 0; j < at; j++) {
+                line += golden[ j] == '\r';
+            }
+            fprintf( stderr, "%s: output differs at byte %u, line %u\n", expect, (unsigned) at, line);
+            rc = 1;
+        }
+    } else {
+        fwrite( out.data(), 1, out.size(), stdout);
+    }
+    return rc;
+}